@@ -865,30 +865,16 @@ VOID MacTableMaintenance(IN PRTMP_ADAPTER pAd) {
 
 	pMacTable = &pAd->MacTab;
 	pMacTable->fAnyStationInPsm = FALSE;
-	pMacTable->fAnyStationBadAtheros = FALSE;
 	pMacTable->fAnyTxOPForceDisable = FALSE;
-	pMacTable->fAllStationAsRalink = TRUE;
 #ifdef DOT11_N_SUPPORT
-	pMacTable->fAnyStationNonGF = FALSE;
-	pMacTable->fAnyStation20Only = FALSE;
-	pMacTable->fAnyStationIsLegacy = FALSE;
-	pMacTable->fAnyStationMIMOPSDynamic = FALSE;
-#ifdef GREENAP_SUPPORT
-	/*Support Green AP */
-	pMacTable->fAnyStationIsHT = FALSE;
-#endif /* GREENAP_SUPPORT */
-
-#ifdef DOT11N_DRAFT3
-	pMacTable->fAnyStaFortyIntolerant = FALSE;
-#endif /* DOT11N_DRAFT3 */
 	pMacTable->fAllStationGainGoodMCS = TRUE;
 #endif /* DOT11_N_SUPPORT */
 
-#ifdef WAPI_SUPPORT
-	pMacTable->fAnyWapiStation = FALSE;
-#endif /* WAPI_SUPPORT */
-
-	for (i = 1; i < MAX_LEN_OF_MAC_TABLE; i++) {
+	/*
+		Capability flags are counted in MAC_TABLE.AggCount as stations
+		come and go, only walk the entries in use.
+	*/
+	for (i = MacTableNextEntry(pMacTable, 0); i < MAX_LEN_OF_MAC_TABLE; i = MacTableNextEntry(pMacTable, i)) {
 		MAC_TABLE_ENTRY *pEntry = &pMacTable->Content[i];
 		bool bDisconnectSta = FALSE;
 #ifdef APCLI_SUPPORT
@@ -936,41 +922,15 @@ VOID MacTableMaintenance(IN PRTMP_ADAPTER pAd) {
 		if (pEntry->PsMode == PWR_SAVE)
 			pMacTable->fAnyStationInPsm = TRUE;
 
-#ifdef DOT11_N_SUPPORT
-		if (pEntry->MmpsMode == MMPS_DYNAMIC)
-			pMacTable->fAnyStationMIMOPSDynamic = TRUE;
-
-		if (pEntry->MaxHTPhyMode.field.BW == BW_20)
-			pMacTable->fAnyStation20Only = TRUE;
-
-		if (pEntry->MaxHTPhyMode.field.MODE != MODE_HTGREENFIELD)
-			pMacTable->fAnyStationNonGF = TRUE;
-
-		if ((pEntry->MaxHTPhyMode.field.MODE == MODE_OFDM) || (pEntry->MaxHTPhyMode.field.MODE == MODE_CCK))
-			pMacTable->fAnyStationIsLegacy = TRUE;
-#ifdef GREENAP_SUPPORT
-		else
-			pMacTable->fAnyStationIsHT = TRUE;
-#endif /* GREENAP_SUPPORT */
-
-#ifdef DOT11N_DRAFT3
-		if (pEntry->bForty_Mhz_Intolerant)
-			pMacTable->fAnyStaFortyIntolerant = TRUE;
-#endif /* DOT11N_DRAFT3 */
+		/* catch capability changes made without MacTableAggUpdate() */
+		MacTableAggUpdate(pAd, pEntry);
 
+#ifdef DOT11_N_SUPPORT
 		/* Get minimum AMPDU size from STA */
 		if (MinimumAMPDUSize > pEntry->MaxRAmpduFactor)
 			MinimumAMPDUSize = pEntry->MaxRAmpduFactor;
 #endif /* DOT11_N_SUPPORT */
 
-		if (pEntry->bIAmBadAtheros) {
-			pMacTable->fAnyStationBadAtheros = TRUE;
-#ifdef DOT11_N_SUPPORT
-			if (pAd->CommonCfg.IOTestParm.bRTSLongProtOn == FALSE)
-				AsicUpdateProtect(pAd, 8, ALLN_SETPROTECT, FALSE, pMacTable->fAnyStationNonGF);
-#endif /* DOT11_N_SUPPORT */
-		}
-
 		/* detect the station alive status */
 		if ((pAd->ApCfg.MBSSID[pEntry->apidx].StationKeepAliveTime > 0) &&
 			(pEntry->NoDataIdleCount >= pAd->ApCfg.MBSSID[pEntry->apidx].StationKeepAliveTime)) {
@@ -1129,10 +1089,6 @@ VOID MacTableMaintenance(IN PRTMP_ADAPTER pAd) {
 		UAPSD_QueueMaintenance(pAd, pEntry);
 #endif /* UAPSD_SUPPORT */
 
-		/* check if this STA is Ralink-chipset */
-		if (!CLIENT_STATUS_TEST_FLAG(pEntry, fCLIENT_STATUS_RALINK_CHIPSET))
-			pMacTable->fAllStationAsRalink = FALSE;
-
 		/* Check if the port is secured */
 		if (pEntry->PortSecured == WPA_802_1X_PORT_SECURED)
 			fAnyStationPortSecured[pEntry->apidx]++;
@@ -1145,11 +1101,6 @@ VOID MacTableMaintenance(IN PRTMP_ADAPTER pAd) {
 			SendNotifyBWActionFrame(pAd, pEntry->Aid, pEntry->apidx);
 #endif /* DOT11N_DRAFT3 */
 #endif /* DOT11_N_SUPPORT */
-#ifdef WAPI_SUPPORT
-		if (pEntry->WepStatus == Ndis802_11EncryptionSMS4Enabled)
-			pMacTable->fAnyWapiStation = TRUE;
-#endif /* WAPI_SUPPORT */
-
 #if defined(PRE_ANT_SWITCH) || defined(CFO_TRACK)
 		lastClient = i;
 #endif /* defined(PRE_ANT_SWITCH) || defined(CFO_TRACK) */
@@ -1160,6 +1111,14 @@ VOID MacTableMaintenance(IN PRTMP_ADAPTER pAd) {
 			pMacTable->fAllStationGainGoodMCS = FALSE;
 	}
 
+	/* drop the flags other paths forced on since the last round */
+	MacTableAggFlagsUpdate(pAd);
+
+#ifdef DOT11_N_SUPPORT
+	if (pMacTable->fAnyStationBadAtheros && (pAd->CommonCfg.IOTestParm.bRTSLongProtOn == FALSE))
+		AsicUpdateProtect(pAd, 8, ALLN_SETPROTECT, FALSE, pMacTable->fAnyStationNonGF);
+#endif /* DOT11_N_SUPPORT */
+
 #ifdef RT8592
 	// TODO: shiang-6590, fix me after chip fix this issue !!
 	if (0)//IS_RT8592(pAd)) {
@@ -1294,7 +1253,7 @@ unsigned int MacTableAssocStaNumGet(
 	unsigned int i;
 
 
-	for (i = 1; i < MAX_LEN_OF_MAC_TABLE; i++) {
+	for (i = MacTableNextEntry(&pAd->MacTab, 0); i < MAX_LEN_OF_MAC_TABLE; i = MacTableNextEntry(&pAd->MacTab, i)) {
 		MAC_TABLE_ENTRY *pEntry = &pAd->MacTab.Content[i];
 
 		if (!IS_ENTRY_CLIENT(pEntry))
@@ -1450,6 +1409,10 @@ VOID ApLogEvent(
 VOID APUpdateOperationMode(
 	IN PRTMP_ADAPTER pAd)
 {
+#if defined(BCN_SEG_SUPPORT) || defined(PROBE_CACHE_SUPPORT)
+	ADD_HTINFO2 PrevHtInfo2 = pAd->CommonCfg.AddHTInfo.AddHtInfo2;
+#endif /* BCN_SEG_SUPPORT || PROBE_CACHE_SUPPORT */
+
 	pAd->CommonCfg.AddHTInfo.AddHtInfo2.OperaionMode = 0;
 
 	if ((pAd->ApCfg.LastNoneHTOLBCDetectTime + (5 * OS_HZ)) > pAd->Mlme.Now32) { /* non HT BSS exist within 5 sec */
@@ -1470,6 +1433,12 @@ VOID APUpdateOperationMode(
 	}
 
 	pAd->CommonCfg.AddHTInfo.AddHtInfo2.NonGfPresent = pAd->MacTab.fAnyStationNonGF;
+
+#if defined(BCN_SEG_SUPPORT) || defined(PROBE_CACHE_SUPPORT)
+	if ((PrevHtInfo2.OperaionMode != pAd->CommonCfg.AddHTInfo.AddHtInfo2.OperaionMode) ||
+		(PrevHtInfo2.NonGfPresent != pAd->CommonCfg.AddHTInfo.AddHtInfo2.NonGfPresent))
+		APBeaconSegDirty(pAd, -1, BCN_SEG_HT);
+#endif /* BCN_SEG_SUPPORT || PROBE_CACHE_SUPPORT */
 }
 #endif /* DOT11_N_SUPPORT */
 
@@ -1489,12 +1458,15 @@ VOID APUpdateCapabilityAndErpIe(
 	unsigned char	apidx;
 	bool	bUseBGProtection;
 	bool	LegacyBssExist;
+#if defined(BCN_SEG_SUPPORT) || defined(PROBE_CACHE_SUPPORT)
+	unsigned char PrevErpIeContent = pAd->ApCfg.ErpIeContent;
+#endif /* BCN_SEG_SUPPORT || PROBE_CACHE_SUPPORT */
 
 
 	if (WMODE_EQUAL(pAd->CommonCfg.PhyMode, WMODE_B))
 		return;
 
-	for (i = 1; i < MAX_LEN_OF_MAC_TABLE; i++) {
+	for (i = MacTableNextEntry(&pAd->MacTab, 0); i < MAX_LEN_OF_MAC_TABLE; i = MacTableNextEntry(&pAd->MacTab, i)) {
 		PMAC_TABLE_ENTRY pEntry = &pAd->MacTab.Content[i];
 		if (!IS_ENTRY_CLIENT(pEntry) || (pEntry->Sst != SST_ASSOC))
 			continue;
@@ -1562,6 +1534,11 @@ VOID APUpdateCapabilityAndErpIe(
 	if ((pAd->CommonCfg.TxPreamble == Rt802_11PreambleLong) || (ApCheckLongPreambleSTA(pAd) == TRUE))
 		pAd->ApCfg.ErpIeContent |= 0x04;
 
+#if defined(BCN_SEG_SUPPORT) || defined(PROBE_CACHE_SUPPORT)
+	if (pAd->ApCfg.ErpIeContent != PrevErpIeContent)
+		APBeaconSegDirty(pAd, -1, BCN_SEG_ERP);
+#endif /* BCN_SEG_SUPPORT || PROBE_CACHE_SUPPORT */
+
 #ifdef A_BAND_SUPPORT
 	/* Force to use ShortSlotTime at A-band */
 	if (pAd->CommonCfg.Channel > 14)
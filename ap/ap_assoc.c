@@ -359,6 +359,7 @@ static unsigned short update_associated_mac_entry(
 	if (pEntry->AuthMode < Ndis802_11AuthModeWPA)
 		ApLogEvent(pAd, pEntry->Addr, EVENT_ASSOCIATED);
 
+	MacTableAggUpdate(pAd, pEntry);
 	APUpdateCapabilityAndErpIe(pAd);
 #ifdef DOT11_N_SUPPORT
 	APUpdateOperationMode(pAd);
@@ -770,6 +771,9 @@ VOID ap_cmm_peer_assoc_req_action(
 
 	/* 2. qualify this STA's auth_asoc status in the MAC table, decide StatusCode */
 	StatusCode = APBuildAssociation(pAd, pEntry, ie_list, MaxSupportedRate, &Aid);
+#if defined(ASSOC_STORM_SUPPORT) && defined(DBG)
+	AssocStormSimAssoc(pAd, pEntry, StatusCode);
+#endif /* ASSOC_STORM_SUPPORT && DBG */
 
 #ifdef DOT11_VHT_AC
 	if (ie_list->vht_cap_len)
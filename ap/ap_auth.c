@@ -333,6 +333,9 @@ static VOID APPeerAuthReqAtIdleAction(
 			pEntry->Sst = SST_AUTH; /* what if it already in SST_ASSOC ??????? */
                         }
 			APPeerAuthSimpleRspGenAndSend(pAd, pRcvHdr, Alg, Seq + 1, MLME_SUCCESS);
+#if defined(ASSOC_STORM_SUPPORT) && defined(DBG)
+			AssocStormSimAuth(pAd, pEntry);
+#endif /* ASSOC_STORM_SUPPORT && DBG */
 
 		}
 		else
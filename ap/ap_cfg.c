@@ -1120,6 +1120,50 @@ static struct {
 #ifdef MICROWAVE_OVEN_SUPPORT
 	{"MO_FalseCCATh",				Set_MO_FalseCCATh_Proc},
 #endif /* MICROWAVE_OVEN_SUPPORT */
+#ifdef RX_ZERO_COPY_SUPPORT
+	{"RxCopyBreak",					Set_RxCopyBreak_Proc},
+#endif /* RX_ZERO_COPY_SUPPORT */
+#ifdef RX_NAPI_SUPPORT
+	{"RxNapiBudget",				Set_RxNapiBudget_Proc},
+#endif /* RX_NAPI_SUPPORT */
+#ifdef USB_BULK_OUT_SG_SUPPORT
+	{"UsbTxSg",						Set_UsbTxSg_Proc},
+#endif /* USB_BULK_OUT_SG_SUPPORT */
+#ifdef USB_TX_ADAPTIVE_BATCH
+	{"UsbTxBatch",					Set_UsbTxBatch_Proc},
+#endif /* USB_TX_ADAPTIVE_BATCH */
+#ifdef AIRTIME_FAIRNESS_SUPPORT
+	{"AtfEnable",					Set_AtfEnable_Proc},
+	{"AtfQuantum",					Set_AtfQuantum_Proc},
+#endif /* AIRTIME_FAIRNESS_SUPPORT */
+#ifdef TX_AQM_SUPPORT
+	{"AqmEnable",					Set_AqmEnable_Proc},
+	{"AqmTarget",					Set_AqmTarget_Proc},
+	{"AqmInterval",					Set_AqmInterval_Proc},
+#endif /* TX_AQM_SUPPORT */
+#ifdef HDR_TRANS_SUPPORT
+	{"HdrTrans",					Set_HdrTrans_Proc},
+	{"HdrTransSta",					Set_HdrTransSta_Proc},
+	{"HdrTransBench",				Set_HdrTransBench_Proc},
+#endif /* HDR_TRANS_SUPPORT */
+#ifdef BA_HRTIMER_SUPPORT
+	{"BaReorderTimeout",			Set_BaReorderTimeout_Proc},
+#endif /* BA_HRTIMER_SUPPORT */
+#ifdef CACHE_MISS_STAT_SUPPORT
+	{"CacheMissStat",				Set_CacheMissStat_Proc},
+#endif /* CACHE_MISS_STAT_SUPPORT */
+#ifdef REG_DEFER_SUPPORT
+	{"RegDefer",					Set_RegDefer_Proc},
+#endif /* REG_DEFER_SUPPORT */
+#ifdef PHY_SHADOW_SUPPORT
+	{"PhyShadow",					Set_PhyShadow_Proc},
+#endif /* PHY_SHADOW_SUPPORT */
+#ifdef ASSOC_STORM_SUPPORT
+	{"AssocHsMax",					Set_AssocHsMax_Proc},
+#ifdef DBG
+	{"AssocStormSim",				Set_AssocStormSim_Proc},
+#endif /* DBG */
+#endif /* ASSOC_STORM_SUPPORT */
 
 	{NULL,}
 };
@@ -1133,6 +1177,57 @@ static struct {
 	{"stacountinfo",			Show_StaCount_Proc},
 	{"stasecinfo", 			Show_StaSecurityInfo_Proc},	
 	{"descinfo",			Show_DescInfo_Proc},
+#ifdef RTMP_MAC_USB
+	{"rxring",				Show_RxRing_Proc},
+#endif /* RTMP_MAC_USB */
+#ifdef USB_TX_ADAPTIVE_BATCH
+	{"txbatch",				Show_TxBatch_Proc},
+#endif /* USB_TX_ADAPTIVE_BATCH */
+#ifdef AIRTIME_FAIRNESS_SUPPORT
+	{"atfinfo",				Show_AtfStats_Proc},
+#endif /* AIRTIME_FAIRNESS_SUPPORT */
+#ifdef TX_AQM_SUPPORT
+	{"aqminfo",				Show_AqmStats_Proc},
+#endif /* TX_AQM_SUPPORT */
+#ifdef MEM_POOL_SUPPORT
+	{"mempool",				Show_MemPool_Proc},
+#endif /* MEM_POOL_SUPPORT */
+#ifdef HDR_TRANS_SUPPORT
+	{"hdrtrans",			Show_HdrTrans_Proc},
+#endif /* HDR_TRANS_SUPPORT */
+#ifdef BA_HRTIMER_SUPPORT
+	{"bareorder",			Show_BaReorder_Proc},
+#endif /* BA_HRTIMER_SUPPORT */
+#ifdef CACHE_MISS_STAT_SUPPORT
+	{"cachemiss",			Show_CacheMissStat_Proc},
+#endif /* CACHE_MISS_STAT_SUPPORT */
+#ifdef MCU_ASYNC_CMD_SUPPORT
+	{"mcucmd",			Show_McuCmd_Proc},
+#endif /* MCU_ASYNC_CMD_SUPPORT */
+#ifdef REG_DEFER_SUPPORT
+	{"regdefer",			Show_RegDefer_Proc},
+#endif /* REG_DEFER_SUPPORT */
+#ifdef PHY_SHADOW_SUPPORT
+	{"physhadow",			Show_PhyShadow_Proc},
+#endif /* PHY_SHADOW_SUPPORT */
+#ifdef BOOT_PROF_SUPPORT
+	{"bootprof",			Show_BootProf_Proc},
+#endif /* BOOT_PROF_SUPPORT */
+#ifdef BCN_BURST_SUPPORT
+	{"bcnupdate",			Show_BcnUpdate_Proc},
+#endif /* BCN_BURST_SUPPORT */
+#ifdef BCN_SEG_SUPPORT
+	{"bcnseg",			Show_BcnSeg_Proc},
+#endif /* BCN_SEG_SUPPORT */
+#ifdef PROBE_CACHE_SUPPORT
+	{"probecache",			Show_ProbeCache_Proc},
+#endif /* PROBE_CACHE_SUPPORT */
+#ifdef MLME_LANE_SUPPORT
+	{"mlmeq",			Show_MlmeQueue_Proc},
+#endif /* MLME_LANE_SUPPORT */
+#ifdef ASSOC_STORM_SUPPORT
+	{"assocstorm",			Show_AssocStorm_Proc},
+#endif /* ASSOC_STORM_SUPPORT */
 	{"driverinfo", 			Show_DriverInfo_Proc},
 	{"devinfo",			show_devinfo_proc},
 #ifdef WDS_SUPPORT
@@ -1869,6 +1964,7 @@ INT RTMPAPSetInformation(
 				{
 					if (Elem)
 					{
+						MLME_ELEM_MSG_INIT(Elem);
 						pInfo = (MLME_DEAUTH_REQ_STRUCT *) Elem->Msg;
 						Status = copy_from_user(pInfo, wrq->u.data.pointer, wrq->u.data.length);
 
@@ -2822,6 +2918,7 @@ INT RTMPAPSetInformation(
 			os_alloc_mem(NULL, (unsigned char **)&Elem, sizeof(MLME_QUEUE_ELEM));
 			if (Elem)
 			{
+				MLME_ELEM_MSG_INIT(Elem);
 				pInfo = (MLME_DEAUTH_REQ_STRUCT *) Elem->Msg;
 
 				if (wrq->u.data.length != sizeof(struct ieee80211req_mlme))
@@ -4336,6 +4433,10 @@ INT	Set_AP_WmmCapable_Proc(
 	SetCommonHT(pAd);
 #endif /* DOT11_N_SUPPORT */
 
+#if defined(BCN_SEG_SUPPORT) || defined(PROBE_CACHE_SUPPORT)
+	APBeaconSegDirty(pAd, pObj->ioctl_if, BCN_SEG_WMM);
+#endif /* BCN_SEG_SUPPORT || PROBE_CACHE_SUPPORT */
+
 	DBGPRINT(RT_DEBUG_TRACE, ("IF(ra%d) Set_WmmCapable_Proc::(bWmmCapable=%d)\n", 
 		pObj->ioctl_if, pAd->ApCfg.MBSSID[pObj->ioctl_if].bWmmCapable));
 
@@ -6421,8 +6522,10 @@ VOID RTMPIoctlSetIdleTimeout(
 
 	pIdleTime = (PDOT1X_IDLE_TIMEOUT)wrq->u.data.pointer;
 
+	MAC_TABLE_RCU_READ_LOCK();
 	if ((pEntry = MacTableLookup(pAd, pIdleTime->StaAddr)) == NULL)
 	{
+		MAC_TABLE_RCU_READ_UNLOCK();
 		DBGPRINT(RT_DEBUG_ERROR, ("%s : the entry is empty\n", __FUNCTION__));
 		return;
 	}
@@ -6433,6 +6536,7 @@ VOID RTMPIoctlSetIdleTimeout(
 		DBGPRINT(RT_DEBUG_TRACE, ("%s : Update Idle-Timeout(%d) from dot1x daemon\n",
 						__FUNCTION__, pEntry->StaIdleTimeout));
 	}
+	MAC_TABLE_RCU_READ_UNLOCK();
 	
 	return;
 }
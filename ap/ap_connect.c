@@ -108,6 +108,11 @@ VOID APMakeBssBeacon(RTMP_ADAPTER *pAd, INT apidx)
 	if(!BeaconTransmitRequired(pAd, apidx, &pAd->ApCfg.MBSSID[apidx]))
 		return;
 
+#if defined(BCN_SEG_SUPPORT) || defined(PROBE_CACHE_SUPPORT)
+	/* a new head, build the IEs after the TIM again as well */
+	APBeaconSegDirty(pAd, apidx, BCN_SEG_ALL);
+#endif /* BCN_SEG_SUPPORT || PROBE_CACHE_SUPPORT */
+
 	PhyMode = pAd->ApCfg.MBSSID[apidx].PhyMode;
 
 	if (pAd->ApCfg.MBSSID[apidx].bHideSsid)
@@ -235,93 +240,33 @@ VOID APMakeBssBeacon(RTMP_ADAPTER *pAd, INT apidx)
 /*
 	==========================================================================
 	Description:
-		Update the BEACON frame in the shared memory. Because TIM IE is variable
-		length. other IEs after TIM has to shift and total frame length may change
-		for each BEACON period.
-	Output:
-		pAd->ApCfg.MBSSID[apidx].CapabilityInfo
-		pAd->ApCfg.ErpIeContent
+		The IEs after the TIM, from the power constraint to the Broadcom
+		HT IEs, appended at pBeaconFrame + FrameLen.
+	Return:
+		the new frame length
 	==========================================================================
 */
-VOID APUpdateBeaconFrame(RTMP_ADAPTER *pAd, INT apidx)
+static unsigned long APMakeBeaconTail(
+	IN RTMP_ADAPTER *pAd,
+	IN INT apidx,
+	IN unsigned char *pBeaconFrame,
+	IN unsigned long FrameLen)
 {
-	unsigned char *pBeaconFrame = (unsigned char *)pAd->ApCfg.MBSSID[apidx].BeaconBuf;
-	unsigned char *ptr;
-	unsigned long FrameLen = pAd->ApCfg.MBSSID[apidx].TimIELocationInBeacon;
-	unsigned long UpdatePos = pAd->ApCfg.MBSSID[apidx].TimIELocationInBeacon;
+	MULTISSID_STRUCT *pMbss = &pAd->ApCfg.MBSSID[apidx];
+	COMMON_CONFIG *pComCfg = &pAd->CommonCfg;
+	unsigned char PhyMode = pMbss->PhyMode;
 	unsigned char RSNIe = IE_WPA, RSNIe2 = IE_WPA2;
-	unsigned char ID_1B, TimFirst, TimLast, *pTim;
-	MULTISSID_STRUCT *pMbss;
-	COMMON_CONFIG *pComCfg;
-	unsigned char PhyMode;
+	unsigned char *ptr;
 #ifdef WSC_AP_SUPPORT
 	bool bHasWpsIE = FALSE;
 #endif /* ifdef WSC_AP_SUPPORT */
-	unsigned int i;
-	HTTRANSMIT_SETTING BeaconTransmit = {.word = 0}; /* MGMT frame PHY rate setting when operatin at Ht rate. */
 	unsigned long TmpLen = 0;
+#ifdef BCN_SEG_SUPPORT
+	unsigned long TailPos = FrameLen;
 
-	pMbss = &pAd->ApCfg.MBSSID[apidx];
-	pComCfg = &pAd->CommonCfg;
-	PhyMode = pMbss->PhyMode;
-
-	if(!BeaconTransmitRequired(pAd, apidx, pMbss))
-		return;
-
-	/*
-		step 1 - update BEACON's Capability
-	*/
-	ptr = pBeaconFrame + pMbss->CapabilityInfoLocationInBeacon;
-	*ptr = (unsigned char)(pMbss->CapabilityInfo & 0x00ff);
-	*(ptr + 1) = (unsigned char)((pMbss->CapabilityInfo & 0xff00) >> 8);
-
-	/*
-		step 2 - update TIM IE
-		TODO: enlarge TIM bitmap to support up to 64 STAs
-		TODO: re-measure if RT2600 TBTT interrupt happens faster than BEACON sent out time
-	*/
-	ptr = pBeaconFrame + pMbss->TimIELocationInBeacon;
-	*ptr = IE_TIM;
-	*(ptr + 2) = pAd->ApCfg.DtimCount;
-	*(ptr + 3) = pAd->ApCfg.DtimPeriod;
-
-	/* find the smallest AID (PS mode) */
-	TimFirst = 0; /* record first TIM byte != 0x00 */
-	TimLast = 0;  /* record last TIM byte != 0x00 */
-	pTim = pMbss->TimBitmaps;
-
-	for(ID_1B = 0; ID_1B < WLAN_MAX_NUM_OF_TIM; ID_1B++) {
-		/* get the TIM indicating PS packets for 8 stations */
-		unsigned char tim_1B = pTim[ID_1B];
-
-		if (ID_1B == 0)
-			tim_1B &= 0xfe; /* skip bit0 bc/mc */
-
-		if (tim_1B == 0)
-			continue; /* find next 1B */
-
-		if (TimFirst == 0)
-			TimFirst = ID_1B;
-
-		TimLast = ID_1B;
-	}
-
-	/* fill TIM content to beacon buffer */
-	if (TimFirst & 0x01)
-		TimFirst--; /* find the even offset byte */
-
-	*(ptr + 1) = 3 + (TimLast-TimFirst + 1); /* TIM IE length */
-	*(ptr + 4) = TimFirst;
-
-	for(i = TimFirst; i <= TimLast; i++)
-		*(ptr + 5 + i - TimFirst) = pTim[i];
-
-	/* bit0 means backlogged mcast/bcast */
-	if (pAd->ApCfg.DtimCount == 0)
-		*(ptr + 4) |= (pMbss->TimBitmaps[WLAN_CT_TIM_BCMC_OFFSET] & 0x01);
-
-	/* adjust BEACON length according to the new TIM */
-	FrameLen += (2 + *(ptr + 1));
+	pMbss->BcnErpPos = BCN_SEG_NONE;
+	pMbss->BcnQloadPos = BCN_SEG_NONE;
+#endif /* BCN_SEG_SUPPORT */
 
 #ifdef A_BAND_SUPPORT
 	/*
@@ -351,6 +296,9 @@ VOID APUpdateBeaconFrame(RTMP_ADAPTER *pAd, INT apidx)
 		*ptr = IE_ERP;
 		*(ptr + 1) = 1;
 		*(ptr + 2) = pAd->ApCfg.ErpIeContent;
+#ifdef BCN_SEG_SUPPORT
+		pMbss->BcnErpPos = (unsigned short)(FrameLen - TailPos);
+#endif /* BCN_SEG_SUPPORT */
 		FrameLen += 3;
 	}
 
@@ -582,7 +530,12 @@ VOID APUpdateBeaconFrame(RTMP_ADAPTER *pAd, INT apidx)
 
 #ifdef AP_QLOAD_SUPPORT
 	if (pAd->FlgQloadEnable != 0)
+	{
+#ifdef BCN_SEG_SUPPORT
+		pMbss->BcnQloadPos = (unsigned short)(FrameLen - TailPos);
+#endif /* BCN_SEG_SUPPORT */
 		FrameLen += QBSS_LoadElementAppend(pAd, pBeaconFrame+FrameLen);
+	}
 #endif /* AP_QLOAD_SUPPORT */
 
 	/* add Ralink-specific IE here - Byte0.b0=1 for aggregation, Byte0.b1=1 for piggy-back */
@@ -638,6 +591,279 @@ VOID APUpdateBeaconFrame(RTMP_ADAPTER *pAd, INT apidx)
 	}
 #endif /* DOT11_N_SUPPORT */
 
+	return FrameLen;
+}
+
+
+#if defined(BCN_SEG_SUPPORT) || defined(PROBE_CACHE_SUPPORT)
+/*
+	Whoever changes an IE of the beacon marks its BCN_SEG_* here. With
+	BCN_SEG_SUPPORT the IEs after the TIM are kept in pMbss->BcnTail and
+	copied behind the TIM on every beacon update. ERP and QBSS load keep
+	their size and are rewritten in place, anything else rebuilds the
+	whole tail. An IE change that is not marked here stays out of the
+	beacon; DBG builds rebuild every BCN_SEG_REFRESH-th reused tail to
+	catch that. The ProbeRsp cache of the BSS is dropped on any change.
+*/
+VOID APBeaconSegDirty(
+	IN PRTMP_ADAPTER pAd,
+	IN INT apidx,
+	IN unsigned char Seg)
+{
+	INT i;
+
+	/* apidx < 0 for every BSS */
+	for (i = 0; i < pAd->ApCfg.BssidNum; i++)
+	{
+		if ((apidx >= 0) && (apidx != i))
+			continue;
+
+#ifdef BCN_SEG_SUPPORT
+		pAd->ApCfg.MBSSID[i].BcnSegDirty |= Seg;
+#endif /* BCN_SEG_SUPPORT */
+#ifdef PROBE_CACHE_SUPPORT
+		pAd->ApCfg.MBSSID[i].bProbeRspStale = TRUE;
+		pAd->ApCfg.MBSSID[i].ProbeRspGen++;
+#endif /* PROBE_CACHE_SUPPORT */
+	}
+}
+#endif /* BCN_SEG_SUPPORT || PROBE_CACHE_SUPPORT */
+
+
+#ifdef BCN_SEG_SUPPORT
+static VOID APTimRescan(
+	IN MULTISSID_STRUCT *pMbss)
+{
+	INT i;
+
+	pMbss->TimLo = WLAN_MAX_NUM_OF_TIM;
+	pMbss->TimHi = 0;
+	pMbss->bTimRescan = FALSE;
+
+	for (i = 0; i < WLAN_MAX_NUM_OF_TIM; i++)
+	{
+		/* bit0 is bc/mc */
+		if ((pMbss->TimBitmaps[i] & ((i == 0) ? 0xfe : 0xff)) == 0)
+			continue;
+
+		if (pMbss->TimLo == WLAN_MAX_NUM_OF_TIM)
+			pMbss->TimLo = i;
+		pMbss->TimHi = i;
+	}
+}
+
+
+static unsigned long APBeaconTailFill(
+	IN RTMP_ADAPTER *pAd,
+	IN INT apidx,
+	IN unsigned char *pBeaconFrame,
+	IN unsigned long FrameLen)
+{
+	MULTISSID_STRUCT *pMbss = &pAd->ApCfg.MBSSID[apidx];
+	unsigned char *pTail = pMbss->BcnTail;
+	unsigned long NewLen;
+	bool bRebuild;
+
+	bRebuild = ((pMbss->BcnSegDirty & ~BCN_SEG_IN_PLACE) != 0);
+#ifdef A_BAND_SUPPORT
+	/* the channel switch count moves every beacon */
+	if ((pAd->CommonCfg.Channel > 14) &&
+		(pAd->CommonCfg.bIEEE80211H == 1) &&
+		(pAd->Dot11_H.RDMode == RD_SWITCHING_MODE))
+		bRebuild = TRUE;
+#endif /* A_BAND_SUPPORT */
+
+	if (bRebuild)
+	{
+		NewLen = APMakeBeaconTail(pAd, apidx, pBeaconFrame, FrameLen);
+
+		pMbss->BcnTailLen = (unsigned short)(NewLen - FrameLen);
+		NdisMoveMemory(pTail, pBeaconFrame + FrameLen, pMbss->BcnTailLen);
+		pMbss->BcnSegDirty = 0;
+		pMbss->BcnRefresh = 0;
+		pMbss->BcnTailVersion++;
+		pAd->ApCfg.BcnTailBuildCnt++;
+
+		return NewLen;
+	}
+
+	if (pMbss->BcnSegDirty != 0)
+	{
+		if ((pMbss->BcnSegDirty & BCN_SEG_ERP) && (pMbss->BcnErpPos != BCN_SEG_NONE))
+			pTail[pMbss->BcnErpPos + 2] = pAd->ApCfg.ErpIeContent;
+#ifdef AP_QLOAD_SUPPORT
+		if ((pMbss->BcnSegDirty & BCN_SEG_QLOAD) && (pMbss->BcnQloadPos != BCN_SEG_NONE))
+			QBSS_LoadElementAppend(pAd, pTail + pMbss->BcnQloadPos);
+#endif /* AP_QLOAD_SUPPORT */
+
+		pMbss->BcnSegDirty = 0;
+		pMbss->BcnTailVersion++;
+		pAd->ApCfg.BcnSegPatchCnt++;
+	}
+
+#ifdef DBG
+	/* consistency check only, every change must still be marked */
+	if (++pMbss->BcnRefresh >= BCN_SEG_REFRESH)
+	{
+		pMbss->BcnRefresh = 0;
+		NewLen = APMakeBeaconTail(pAd, apidx, pBeaconFrame, FrameLen);
+
+		if (((NewLen - FrameLen) != pMbss->BcnTailLen) ||
+			!NdisEqualMemory(pBeaconFrame + FrameLen, pTail, pMbss->BcnTailLen))
+		{
+			DBGPRINT(RT_DEBUG_ERROR, ("BSS%d: beacon IE changed without APBeaconSegDirty()\n", apidx));
+			pMbss->BcnTailLen = (unsigned short)(NewLen - FrameLen);
+			NdisMoveMemory(pTail, pBeaconFrame + FrameLen, pMbss->BcnTailLen);
+			pMbss->BcnTailVersion++;
+			pAd->ApCfg.BcnTailMismatchCnt++;
+
+			return NewLen;
+		}
+	}
+#endif /* DBG */
+
+	NdisMoveMemory(pBeaconFrame + FrameLen, pTail, pMbss->BcnTailLen);
+	pAd->ApCfg.BcnTailReuseCnt++;
+
+	return FrameLen + pMbss->BcnTailLen;
+}
+
+
+INT Show_BcnSeg_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	INT i;
+
+	DBGPRINT(RT_DEBUG_OFF, ("TailBuilds=%ld, TailReuses=%ld, InPlacePatches=%ld, TimRescans=%ld, Unmarked=%ld\n",
+				pAd->ApCfg.BcnTailBuildCnt, pAd->ApCfg.BcnTailReuseCnt,
+				pAd->ApCfg.BcnSegPatchCnt, pAd->ApCfg.TimRescanCnt,
+				pAd->ApCfg.BcnTailMismatchCnt));
+
+	for (i = 0; i < pAd->ApCfg.BssidNum; i++)
+	{
+		MULTISSID_STRUCT *pMbss = &pAd->ApCfg.MBSSID[i];
+
+		DBGPRINT(RT_DEBUG_OFF, ("BSS%d: TailLen=%d, Version=%u, Dirty=0x%02x, Tim=%d~%d\n",
+					i, pMbss->BcnTailLen, pMbss->BcnTailVersion, pMbss->BcnSegDirty,
+					(pMbss->TimLo == WLAN_MAX_NUM_OF_TIM) ? -1 : pMbss->TimLo,
+					(pMbss->TimLo == WLAN_MAX_NUM_OF_TIM) ? -1 : pMbss->TimHi));
+	}
+
+	return TRUE;
+}
+#endif /* BCN_SEG_SUPPORT */
+
+
+/*
+	==========================================================================
+	Description:
+		Update the BEACON frame in the shared memory. Because TIM IE is variable
+		length. other IEs after TIM has to shift and total frame length may change
+		for each BEACON period.
+	Output:
+		pAd->ApCfg.MBSSID[apidx].CapabilityInfo
+		pAd->ApCfg.ErpIeContent
+	==========================================================================
+*/
+VOID APUpdateBeaconFrame(RTMP_ADAPTER *pAd, INT apidx)
+{
+	unsigned char *pBeaconFrame = (unsigned char *)pAd->ApCfg.MBSSID[apidx].BeaconBuf;
+	unsigned char *ptr;
+	unsigned long FrameLen = pAd->ApCfg.MBSSID[apidx].TimIELocationInBeacon;
+	unsigned long UpdatePos = pAd->ApCfg.MBSSID[apidx].TimIELocationInBeacon;
+	unsigned char TimFirst, TimLast, *pTim;
+#ifndef BCN_SEG_SUPPORT
+	unsigned char ID_1B;
+#endif /* !BCN_SEG_SUPPORT */
+	MULTISSID_STRUCT *pMbss;
+	unsigned int i;
+	HTTRANSMIT_SETTING BeaconTransmit = {.word = 0}; /* MGMT frame PHY rate setting when operatin at Ht rate. */
+
+	pMbss = &pAd->ApCfg.MBSSID[apidx];
+
+	if(!BeaconTransmitRequired(pAd, apidx, pMbss))
+		return;
+
+	/*
+		step 1 - update BEACON's Capability
+	*/
+	ptr = pBeaconFrame + pMbss->CapabilityInfoLocationInBeacon;
+	*ptr = (unsigned char)(pMbss->CapabilityInfo & 0x00ff);
+	*(ptr + 1) = (unsigned char)((pMbss->CapabilityInfo & 0xff00) >> 8);
+
+	/*
+		step 2 - update TIM IE
+		TODO: enlarge TIM bitmap to support up to 64 STAs
+		TODO: re-measure if RT2600 TBTT interrupt happens faster than BEACON sent out time
+	*/
+	ptr = pBeaconFrame + pMbss->TimIELocationInBeacon;
+	*ptr = IE_TIM;
+	*(ptr + 2) = pAd->ApCfg.DtimCount;
+	*(ptr + 3) = pAd->ApCfg.DtimPeriod;
+
+	pTim = pMbss->TimBitmaps;
+
+#ifdef BCN_SEG_SUPPORT
+	/* the bounds follow WLAN_MR_TIM_BIT_SET/CLEAR, rescan only when a bound byte went empty */
+	if (pMbss->bTimRescan)
+	{
+		APTimRescan(pMbss);
+		pAd->ApCfg.TimRescanCnt++;
+	}
+
+	TimFirst = 0;
+	TimLast = 0;
+	if (pMbss->TimLo != WLAN_MAX_NUM_OF_TIM)
+	{
+		TimFirst = pMbss->TimLo;
+		TimLast = pMbss->TimHi;
+	}
+#else
+	/* find the smallest AID (PS mode) */
+	TimFirst = 0; /* record first TIM byte != 0x00 */
+	TimLast = 0;  /* record last TIM byte != 0x00 */
+
+	for(ID_1B = 0; ID_1B < WLAN_MAX_NUM_OF_TIM; ID_1B++) {
+		/* get the TIM indicating PS packets for 8 stations */
+		unsigned char tim_1B = pTim[ID_1B];
+
+		if (ID_1B == 0)
+			tim_1B &= 0xfe; /* skip bit0 bc/mc */
+
+		if (tim_1B == 0)
+			continue; /* find next 1B */
+
+		if (TimFirst == 0)
+			TimFirst = ID_1B;
+
+		TimLast = ID_1B;
+	}
+#endif /* BCN_SEG_SUPPORT */
+
+	/* fill TIM content to beacon buffer */
+	if (TimFirst & 0x01)
+		TimFirst--; /* find the even offset byte */
+
+	*(ptr + 1) = 3 + (TimLast-TimFirst + 1); /* TIM IE length */
+	*(ptr + 4) = TimFirst;
+
+	for(i = TimFirst; i <= TimLast; i++)
+		*(ptr + 5 + i - TimFirst) = pTim[i];
+
+	/* bit0 means backlogged mcast/bcast */
+	if (pAd->ApCfg.DtimCount == 0)
+		*(ptr + 4) |= (pMbss->TimBitmaps[WLAN_CT_TIM_BCMC_OFFSET] & 0x01);
+
+	/* adjust BEACON length according to the new TIM */
+	FrameLen += (2 + *(ptr + 1));
+
+#ifdef BCN_SEG_SUPPORT
+	FrameLen = APBeaconTailFill(pAd, apidx, pBeaconFrame, FrameLen);
+#else
+	FrameLen = APMakeBeaconTail(pAd, apidx, pBeaconFrame, FrameLen);
+#endif /* BCN_SEG_SUPPORT */
+
 	/* step 6. Since FrameLen may change, update TXWI. */
 #ifdef A_BAND_SUPPORT
 	if (pAd->CommonCfg.Channel > 14) {
@@ -829,6 +1055,9 @@ VOID APUpdateAllBeaconFrame(
 				pAd->CommonCfg.AddHTInfo.AddHtInfo.ExtChanOffset,
 				prevBW, prevExtChOffset));
 		pAd->CommonCfg.Bss2040CoexistFlag |= BSS_2040_COEXIST_INFO_NOTIFY;
+#if defined(BCN_SEG_SUPPORT) || defined(PROBE_CACHE_SUPPORT)
+		APBeaconSegDirty(pAd, -1, BCN_SEG_HT);
+#endif /* BCN_SEG_SUPPORT || PROBE_CACHE_SUPPORT */
 	}
 #endif /* DOT11N_DRAFT3 */
 #endif /* DOT11_N_SUPPORT */
@@ -488,7 +488,7 @@ NDIS_STATUS APSendPacket(RTMP_ADAPTER *pAd, PNDIS_PACKET pPacket)
 		NdisGetSystemUpTime(&Now32);
 #endif /* WDS_SUPPORT */
 
-		if (pAd->TxSwQueue[QueIdx].Number >= pAd->TxSwQMaxLen)
+		if (TX_SWQ_PENDING(pAd, QueIdx) >= pAd->TxSwQMaxLen)
         {
 #ifdef BLOCK_NET_IF
 			StopNetIfQueue(pAd, QueIdx, pPacket);
@@ -573,7 +573,7 @@ NDIS_STATUS APSendPacket(RTMP_ADAPTER *pAd, PNDIS_PACKET pPacket)
 #endif /* IGMP_SNOOP_SUPPORT */
 		{
 
-			if (pAd->TxSwQueue[QueIdx].Number >= pAd->TxSwQMaxLen)
+			if (TX_SWQ_PENDING(pAd, QueIdx) >= pAd->TxSwQMaxLen)
 			{
 
 #ifdef BLOCK_NET_IF
@@ -3276,6 +3276,10 @@ NDIS_STATUS APHardTransmit(
 	PQUEUE_ENTRY	pQEntry;
 	PNDIS_PACKET	pPacket;
 	unsigned char apidx;
+#ifdef HDR_TRANS_SUPPORT
+	unsigned long long BenchBegin;
+	unsigned char TransPath;
+#endif /* HDR_TRANS_SUPPORT */
 	
 /*	PQUEUE_HEADER   pQueue; */
 
@@ -3318,15 +3322,30 @@ NDIS_STATUS APHardTransmit(
 	}
 
 
+#ifdef HDR_TRANS_SUPPORT
+	HDR_TRANS_BENCH_BEGIN(pAd, BenchBegin);
+	TransPath = HdrTransTxSelect(pAd, pTxBlk);
+#endif /* HDR_TRANS_SUPPORT */
+
 	switch (pTxBlk->TxFrameType)
 	{
 #ifdef DOT11_N_SUPPORT
 		case TX_AMPDU_FRAME:
+#ifdef HDR_TRANS_SUPPORT
+				if (pTxBlk->NeedTrans)
+					AP_AMPDU_Frame_Tx_Hdr_Trns(pAd, pTxBlk);
+				else
+#endif /* HDR_TRANS_SUPPORT */
 				AP_AMPDU_Frame_Tx(pAd, pTxBlk);
 
 				break;
 #endif /* DOT11_N_SUPPORT */
 		case TX_LEGACY_FRAME:
+#ifdef HDR_TRANS_SUPPORT
+				if (pTxBlk->NeedTrans)
+					AP_Legacy_Frame_Tx_Hdr_Trns(pAd, pTxBlk);
+				else
+#endif /* HDR_TRANS_SUPPORT */
 				AP_Legacy_Frame_Tx(pAd, pTxBlk);
 				break;
 		case TX_MCAST_FRAME:
@@ -3358,6 +3377,10 @@ NDIS_STATUS APHardTransmit(
 			break;
 	}
 
+#ifdef HDR_TRANS_SUPPORT
+	HDR_TRANS_BENCH_END(pAd, HDR_TRANS_BENCH_TX, TransPath, BenchBegin);
+#endif /* HDR_TRANS_SUPPORT */
+
 	return (NDIS_STATUS_SUCCESS);
 	
 }
@@ -4051,6 +4074,10 @@ VOID APHandleRxMgmtFrame(
 	RXWI_STRUC *pRxWI = pRxBlk->pRxWI;
 	PHEADER_802_11 pHeader = pRxBlk->pHeader;
 	PNDIS_PACKET pRxPacket = pRxBlk->pRxPacket;
+#ifdef MLME_LANE_SUPPORT
+	PNDIS_PACKET pHandOff = pRxPacket;
+	bool bQueued = FALSE;
+#endif /* MLME_LANE_SUPPORT */
 
 	do
 	{
@@ -4174,6 +4201,27 @@ VOID APHandleRxMgmtFrame(
 			/* So a management action frame is not trigger frame */
 		}
 
+#ifdef MLME_LANE_SUPPORT
+#ifdef TXBF_SUPPORT
+		/* the sounding feedback below still reads the frame, queue a copy */
+		if (pAd->chipCap.FlgHwTxBfCap)
+			pHandOff = NULL;
+#endif /* TXBF_SUPPORT */
+#ifdef MT7601
+		if ( IS_MT7601(pAd) )
+		{
+			bQueued = REPORT_MGMT_PKT_TO_MLME(pAd, pRxWI->RxWIWirelessCliID, pHeader,
+							pRxWI->RxWIMPDUByteCnt,
+							pRxWI->RxWISNR2, 0,
+							0, 0, pRxWI->RxWISNR1, OPMODE_AP, pHandOff);
+		}
+		else
+#endif /* MT7601 */
+			bQueued = REPORT_MGMT_PKT_TO_MLME(pAd, pRxWI->RxWIWirelessCliID, pHeader,
+							pRxWI->RxWIMPDUByteCnt,
+							pRxWI->RxWIRSSI0, pRxWI->RxWIRSSI1,
+							pRxWI->RxWIRSSI2, 0, 0, OPMODE_AP, pHandOff);
+#else
 #ifdef MT7601
 		if ( IS_MT7601(pAd) )
 		{
@@ -4188,6 +4236,7 @@ VOID APHandleRxMgmtFrame(
 							pRxWI->RxWIMPDUByteCnt,
 							pRxWI->RxWIRSSI0, pRxWI->RxWIRSSI1,
 							pRxWI->RxWIRSSI2, 0, 0, OPMODE_AP);
+#endif /* MLME_LANE_SUPPORT */
 
 #ifdef TXBF_SUPPORT
 		if (pAd->chipCap.FlgHwTxBfCap)
@@ -4213,6 +4262,12 @@ VOID APHandleRxMgmtFrame(
 #endif /* TXBF_SUPPORT */
 	} while (0);
 
+#ifdef MLME_LANE_SUPPORT
+	/* the MLME queue owns the packet now */
+	if (bQueued && (pHandOff != NULL))
+		return;
+#endif /* MLME_LANE_SUPPORT */
+
 	RELEASE_NDIS_PACKET(pAd, pRxPacket, NDIS_STATUS_SUCCESS);
 	return;
 }
@@ -4406,6 +4461,19 @@ VOID APRxEAPOLFrameIndicate(
 	{
 		pTmpBuf = pRxBlk->pData - LENGTH_802_11;
 		NdisMoveMemory(pTmpBuf, pRxBlk->pHeader, LENGTH_802_11);
+#ifdef MLME_LANE_SUPPORT
+		/* queued with the packet, pTmpBuf is inside it */
+#ifdef MT7601
+		if ( IS_MT7601(pAd) )
+		{
+			if (REPORT_MGMT_PKT_TO_MLME(pAd, pRxWI->RxWIWirelessCliID, pTmpBuf, pRxBlk->DataSize + LENGTH_802_11, pRxWI->RxWISNR2, 0, 0, 0, pRxWI->RxWISNR1, OPMODE_AP, pRxBlk->pRxPacket))
+				return;
+		}
+		else
+#endif /* MT7601 */
+		if (REPORT_MGMT_PKT_TO_MLME(pAd, pRxWI->RxWIWirelessCliID, pTmpBuf, pRxBlk->DataSize + LENGTH_802_11, pRxWI->RxWIRSSI0, pRxWI->RxWIRSSI1, pRxWI->RxWIRSSI2, 0, 0, OPMODE_AP, pRxBlk->pRxPacket))
+			return;
+#else
 #ifdef MT7601
 			if ( IS_MT7601(pAd) )
 			{
@@ -4414,6 +4482,7 @@ VOID APRxEAPOLFrameIndicate(
 			else
 #endif /* MT7601 */
 				REPORT_MGMT_FRAME_TO_MLME(pAd, pRxWI->RxWIWirelessCliID, pTmpBuf, pRxBlk->DataSize + LENGTH_802_11, pRxWI->RxWIRSSI0, pRxWI->RxWIRSSI1, pRxWI->RxWIRSSI2, 0, 0, OPMODE_AP);
+#endif /* MLME_LANE_SUPPORT */
 	}
 
 done:
@@ -4904,6 +4973,7 @@ if (0 /*!(pRxInfo->Mcast || pRxInfo->Bcast)*/){
 		if (pAd->CommonCfg.IOTestParm.bRTSLongProtOn == FALSE)
 			RTMP_UPDATE_PROTECT(pAd, 8 , ALLN_SETPROTECT, FALSE, FALSE);
 		pEntry->bIAmBadAtheros = TRUE;
+		MacTableAggUpdate(pAd, pEntry);
 
 	}
 #endif /* DOT11_N_SUPPORT */
@@ -5403,6 +5473,7 @@ if (0 /*!(pRxInfo->Mcast || pRxInfo->Bcast)*/){
 		if (pAd->CommonCfg.IOTestParm.bRTSLongProtOn == FALSE)
 			RTMP_UPDATE_PROTECT(pAd, 8 , ALLN_SETPROTECT, FALSE, FALSE);
 		pEntry->bIAmBadAtheros = TRUE;
+		MacTableAggUpdate(pAd, pEntry);
 
 	}
 #endif /* DOT11_N_SUPPORT */
@@ -5698,6 +5769,10 @@ bool APRxDoneInterruptHandle(RTMP_ADAPTER *pAd)
 #ifdef RLT_MAC
 	RXFCE_INFO *pFceInfo;
 #endif /* RLT_MAC */
+#ifdef HDR_TRANS_SUPPORT
+	unsigned long long BenchBegin;
+	unsigned char TransPath;
+#endif /* HDR_TRANS_SUPPORT */
 
 #ifdef LINUX
 #endif /* LINUX */
@@ -5717,6 +5792,15 @@ bool APRxDoneInterruptHandle(RTMP_ADAPTER *pAd)
 			break;
 		}
 
+#ifdef RX_NAPI_SUPPORT
+		/* poll budget used up, the rest of this buffer waits for the next poll */
+		if (pAd->RxNapiQuota == 0)
+		{
+			bReschedule = TRUE;
+			break;
+		}
+#endif /* RX_NAPI_SUPPORT */
+
 #ifdef UAPSD_SUPPORT
 		UAPSD_TIMING_RECORD_INDEX(RxProcessed);
 #endif /* UAPSD_SUPPORT */
@@ -5735,6 +5819,9 @@ bool APRxDoneInterruptHandle(RTMP_ADAPTER *pAd)
 		pRxPacket = GetPacketFromRxRing(pAd, pRxBlk, &bReschedule, &RxPending);
 		if (pRxPacket == NULL)
 			break;
+#ifdef RX_NAPI_SUPPORT
+		pAd->RxNapiQuota--;
+#endif /* RX_NAPI_SUPPORT */
 
 		/* get rx descriptor and data buffer */
 		pRxD = (RXD_STRUC *)&pRxBlk->hw_rx_info[0];
@@ -5961,6 +6048,13 @@ if (0) {
 #ifdef HDR_TRANS_SUPPORT
 					rxblk.bHdrRxTrans = pRxInfo->ip_sum_err;		/* RXINFO bit 31 */
 
+					/* pRxInfo is gone once the frame is handled */
+					HDR_TRANS_BENCH_BEGIN(pAd, BenchBegin);
+					if (!pRxInfo->U2M)
+						TransPath = HDR_TRANS_PATH_NONE;
+					else
+						TransPath = rxblk.bHdrRxTrans ? HDR_TRANS_PATH_8023 : HDR_TRANS_PATH_80211;
+
 					if ( rxblk.bHdrRxTrans )
 					{
 						rxblk.bHdrVlanTaged = pRxInfo->tcp_sum_err;	/* RXINFO bit 30 */
@@ -5975,6 +6069,9 @@ if (0) {
 #endif	/* HDR_TRANS_SUPPORT */
 
 					APHandleRxDataFrame(pAd, &rxblk);
+#ifdef HDR_TRANS_SUPPORT
+					HDR_TRANS_BENCH_END(pAd, HDR_TRANS_BENCH_RX, TransPath, BenchBegin);
+#endif /* HDR_TRANS_SUPPORT */
 					break;
 
 			case BTYPE_MGMT:
@@ -168,6 +168,10 @@ VOID APMlmePeriodicExec(
 
     /* walk through MAC table, see if switching TX rate is required */
 
+#if defined(ASSOC_STORM_SUPPORT) && defined(DBG)
+	AssocStormPeriodic(pAd);
+#endif /* ASSOC_STORM_SUPPORT && DBG */
+
     /* MAC table maintenance */
 	if (pAd->Mlme.PeriodicRound % MLME_TASK_EXEC_MULTIPLE == 0)
 	{
@@ -680,6 +680,9 @@ VOID QBSS_LoadUpdate(
 		ChanUtilDe <<= 10; /* ms to us */
 
 		pAd->QloadChanUtil = (unsigned char)(ChanUtilNu/ChanUtilDe);
+#if defined(BCN_SEG_SUPPORT) || defined(PROBE_CACHE_SUPPORT)
+		APBeaconSegDirty(pAd, -1, BCN_SEG_QLOAD);
+#endif /* BCN_SEG_SUPPORT || PROBE_CACHE_SUPPORT */
 
 		/* re-accumulate channel busy time */
 		pAd->QloadChanUtilBeaconCnt = 0;
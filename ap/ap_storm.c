@@ -0,0 +1,802 @@
+#ifdef ASSOC_STORM_SUPPORT
+
+#include "rt_config.h"
+
+/*
+	Association storms.
+
+	When a crowd of stations comes back at once, every MacTableInsertEntry()
+	queued two commands to the command thread, the OPEN-NONE attribute
+	and the RX WCID entry, each its own control transfers. And every
+	PSK station got its 4-way handshake started right after the
+	association, all of them at the same time.
+
+	MacTableInsertEntry() and MacTableDeleteEntry() now only mark the WCID
+	in WcidDirtyMap. The first mark queues one CMDTHREAD_FLUSH_WCID_TAB,
+	later marks ride along until the command thread picks it up. The
+	flush writes what the MAC table holds at that time, so a WCID that
+	was deleted and reused in between is written once. Runs of
+	consecutive dirty WCIDs go to the ASIC as AndesBurstWrite(). When the
+	command queue refuses the flush, the WCID gets the per-entry
+	commands of before right away.
+
+	Keys and WCID attributes are written outside the command queue too,
+	AsicAddPairwiseKeyEntry() and AsicUpdateWcidAttributeEntry() first
+	call AssocStormWcidSync() to write a dirty WCID of theirs ahead of
+	them. WcidFlushLock keeps a flush and a key write of the same WCID
+	from running at the same time, and an entry with a pairwise key
+	never gets OPEN-NONE from here.
+
+	EnqueueStartForPSKExec() asks AssocStormHsAdmit() before it starts a
+	handshake. With ApCfg.AssocHsMax handshakes in flight the timer is
+	armed again and the station waits its turn.
+
+	DBG builds have "iwpriv ra0 set AssocStormSim=N". It makes up N
+	stations 02:53:54:00:xx:xx and feeds their Auth and AssocReq frames
+	through the MLME queue like received ones. They sit in the live MAC
+	table and get frames sent to them, so ASSOC_STORM_SIM_RESERVE entries
+	stay free for real stations. "iwpriv ra0 show assocstorm" prints the
+	time until all of them were associated and, on a PSK BSS, until their
+	handshakes were admitted. "set AssocStormSim=0" deletes them again.
+*/
+
+#define WCID_BURST_DW_MAX		64
+
+#define WCID_MAP_TEST(_Map, _Wcid)	((_Map)[(_Wcid) >> 5] & (1 << ((_Wcid) & 0x1f)))
+
+#ifdef DBG
+static const unsigned char StormSimOui[4] = {0x02, 0x53, 0x54, 0x00};
+#endif /* DBG */
+
+
+VOID AssocStormInit(
+	IN PRTMP_ADAPTER pAd)
+{
+	NdisZeroMemory(pAd->WcidDirtyMap, sizeof(pAd->WcidDirtyMap));
+	pAd->bWcidFlushQueued = FALSE;
+
+	RTMP_SEM_EVENT_INIT(&pAd->WcidFlushLock, &pAd->RscSemMemList);
+
+	pAd->ApCfg.AssocHsMax = ASSOC_STORM_HS_MAX;
+#ifdef DBG
+	NdisAllocateSpinLock(pAd, &pAd->ApCfg.StormSim.Lock);
+#endif /* DBG */
+}
+
+
+VOID AssocStormExit(
+	IN PRTMP_ADAPTER pAd)
+{
+#ifdef DBG
+	NdisFreeSpinLock(&pAd->ApCfg.StormSim.Lock);
+#endif /* DBG */
+	RTMP_SEM_EVENT_DESTORY(&pAd->WcidFlushLock);
+}
+
+
+/*
+	Wcid is to be written to the ASIC as the MAC table has it, pEntry
+	for a new entry and NULL for a deleted one. Caller holds MacTabLock.
+*/
+VOID AssocStormWcidMark(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Wcid,
+	IN MAC_TABLE_ENTRY *pEntry)
+{
+	if (Wcid >= MAX_LEN_OF_MAC_TABLE)
+		return;
+
+	pAd->WcidDirtyMap[Wcid >> 5] |= (1 << (Wcid & 0x1f));
+
+	/* rides along with the pending flush */
+	if (pAd->bWcidFlushQueued)
+		return;
+
+	if (RTEnqueueInternalCmd(pAd, CMDTHREAD_FLUSH_WCID_TAB, NULL, 0) == NDIS_STATUS_SUCCESS)
+	{
+		pAd->bWcidFlushQueued = TRUE;
+		return;
+	}
+
+	/* the command queue is full, the per-entry commands as before */
+	pAd->WcidDirtyMap[Wcid >> 5] &= ~(1 << (Wcid & 0x1f));
+
+	if (pEntry)
+	{
+		RTMP_REMOVE_PAIRWISE_KEY_ENTRY(pAd, Wcid);
+		RTMP_STA_ENTRY_ADD(pAd, pEntry);
+	}
+	else
+		RTMP_STA_ENTRY_MAC_RESET(pAd, Wcid);
+}
+
+
+#ifdef DBG
+/* index of a simulated station, -1 for others */
+static INT AssocStormSimIdx(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char *pAddr)
+{
+	ASSOC_STORM_SIM *pSim = &pAd->ApCfg.StormSim;
+	INT Idx;
+
+	if (!pSim->bRunning || !NdisEqualMemory(pAddr, StormSimOui, sizeof(StormSimOui)))
+		return -1;
+
+	Idx = (pAddr[4] << 8) + pAddr[5];
+
+	return (Idx < pSim->Num) ? Idx : -1;
+}
+#endif /* DBG */
+
+
+/* the first WCID of the next run of set bits from Wcid on, *pNum its length */
+static INT AssocStormWcidRun(
+	IN unsigned int *pMap,
+	IN INT Wcid,
+	OUT INT *pNum)
+{
+	INT End;
+
+	while ((Wcid < MAX_LEN_OF_MAC_TABLE) && !WCID_MAP_TEST(pMap, Wcid))
+		Wcid++;
+
+	for (End = Wcid; (End < MAX_LEN_OF_MAC_TABLE) && WCID_MAP_TEST(pMap, End); End++)
+		;
+
+	*pNum = End - Wcid;
+
+	return Wcid;
+}
+
+
+static VOID AssocStormWcidWrite(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned int Offset,
+	IN unsigned int *pData,
+	IN unsigned int Num)
+{
+	unsigned int Max, Cnt, i;
+
+	if (!RTMP_TEST_FLAG(pAd, fRTMP_ADAPTER_MCU_SEND_IN_BAND_CMD))
+	{
+		for (i = 0; i < Num; i++)
+		{
+			RTMP_IO_WRITE32(pAd, Offset + i * 4, pData[i]);
+			pAd->WcidBurstCnt++;
+		}
+		return;
+	}
+
+	/* one in-band packet per call */
+	Max = (pAd->chipCap.InbandPacketMaxLen - 4) / 4;
+	if (Max > WCID_BURST_DW_MAX)
+		Max = WCID_BURST_DW_MAX;
+
+	while (Num > 0)
+	{
+		Cnt = (Num > Max) ? Max : Num;
+
+		AndesBurstWrite(pAd, Offset, pData, Cnt);
+		pAd->WcidBurstCnt++;
+
+		Offset += Cnt * 4;
+		pData += Cnt;
+		Num -= Cnt;
+	}
+}
+
+
+/* the dirty WCIDs, or only Wcid when it is not -1, caller holds WcidFlushLock */
+static VOID AssocStormWcidWriteDirty(
+	IN PRTMP_ADAPTER pAd,
+	IN INT Only)
+{
+	unsigned int Dirty[MAC_TABLE_MAP_WORDS], Used[MAC_TABLE_MAP_WORDS];
+	unsigned int Attr[WCID_BURST_DW_MAX];
+	unsigned int *pBuf = pAd->WcidFlushBuf;
+	WCID_ATTRIBUTE_STRUC WcidAttr;
+	unsigned char *pAddr;
+#ifdef DBG
+	bool bSim = FALSE;
+#endif /* DBG */
+	INT Wcid, Num, i, Cnt;
+
+	NdisZeroMemory(Dirty, sizeof(Dirty));
+
+	NdisAcquireSpinLock(&pAd->MacTabLock);
+
+	if (Only < 0)
+	{
+		for (i = 0; i < MAC_TABLE_MAP_WORDS; i++)
+		{
+			Dirty[i] = pAd->WcidDirtyMap[i];
+			pAd->WcidDirtyMap[i] = 0;
+		}
+		pAd->bWcidFlushQueued = FALSE;
+	}
+	else if (WCID_MAP_TEST(pAd->WcidDirtyMap, Only))
+	{
+		Dirty[Only >> 5] = (1 << (Only & 0x1f));
+		pAd->WcidDirtyMap[Only >> 5] &= ~(1 << (Only & 0x1f));
+	}
+
+	for (i = 0; i < MAC_TABLE_MAP_WORDS; i++)
+		Used[i] = Dirty[i] & pAd->MacTab.OccupiedMap[i];
+
+	/* the address of entries in use, a cleared one for deleted entries */
+	for (Wcid = 0; Wcid < MAX_LEN_OF_MAC_TABLE; Wcid++)
+	{
+		if (!WCID_MAP_TEST(Dirty, Wcid))
+			continue;
+
+		if (!WCID_MAP_TEST(Used, Wcid))
+		{
+			pBuf[Wcid * 2] = 0;
+			pBuf[Wcid * 2 + 1] = 0;
+			continue;
+		}
+
+		/* its key is in, OPEN-NONE would take it away */
+		if (pAd->MacTab.Content[Wcid].PairwiseKey.KeyLen != 0)
+			Used[Wcid >> 5] &= ~(1 << (Wcid & 0x1f));
+
+		pAddr = pAd->MacTab.Content[Wcid].Addr;
+		pBuf[Wcid * 2] = pAddr[0] + (pAddr[1] << 8) + (pAddr[2] << 16) + (pAddr[3] << 24);
+		pBuf[Wcid * 2 + 1] = pAddr[4] + (pAddr[5] << 8);
+
+#ifdef DBG
+		if (AssocStormSimIdx(pAd, pAddr) >= 0)
+			bSim = TRUE;
+#endif /* DBG */
+	}
+
+	NdisReleaseSpinLock(&pAd->MacTabLock);
+
+	/* OPEN-NONE for the entries in use, as AsicRemovePairwiseKeyEntry() did */
+	WcidAttr.word = 0;
+	WcidAttr.field.KeyTab = PAIRWISEKEYTABLE;
+	for (i = 0; i < WCID_BURST_DW_MAX; i++)
+		Attr[i] = WcidAttr.word;
+
+	for (Wcid = AssocStormWcidRun(Used, 0, &Num); Num > 0; Wcid = AssocStormWcidRun(Used, Wcid + Num, &Num))
+	{
+		for (i = 0; i < Num; i += Cnt)
+		{
+			Cnt = ((Num - i) > WCID_BURST_DW_MAX) ? WCID_BURST_DW_MAX : (Num - i);
+			AssocStormWcidWrite(pAd, MAC_WCID_ATTRIBUTE_BASE + (Wcid + i) * HW_WCID_ATTRI_SIZE, Attr, Cnt);
+		}
+	}
+
+	/* then the RX WCID search table */
+	for (Wcid = AssocStormWcidRun(Dirty, 0, &Num); Num > 0; Wcid = AssocStormWcidRun(Dirty, Wcid + Num, &Num))
+	{
+		AssocStormWcidWrite(pAd, MAC_WCID_BASE + Wcid * HW_WCID_ENTRY_SIZE, &pBuf[Wcid * 2], Num * 2);
+		pAd->WcidEntryCnt += Num;
+	}
+
+#ifdef DBG
+	if (bSim)
+	{
+		ASSOC_STORM_SIM *pSim = &pAd->ApCfg.StormSim;
+
+		NdisAcquireSpinLock(&pSim->Lock);
+		if (pSim->bRunning)
+			pSim->WcidUs = RtmpOsGetUsecTime() - pSim->StartUs;
+		NdisReleaseSpinLock(&pSim->Lock);
+	}
+#endif /* DBG */
+}
+
+
+/* CMDTHREAD_FLUSH_WCID_TAB */
+VOID AssocStormWcidFlush(
+	IN PRTMP_ADAPTER pAd)
+{
+	INT SemRet;
+
+	RTMP_SEM_EVENT_WAIT(&pAd->WcidFlushLock, SemRet);
+	if (SemRet != 0)
+	{
+		/* the marks stay, the next one queues a flush again */
+		NdisAcquireSpinLock(&pAd->MacTabLock);
+		pAd->bWcidFlushQueued = FALSE;
+		NdisReleaseSpinLock(&pAd->MacTabLock);
+		return;
+	}
+
+	AssocStormWcidWriteDirty(pAd, -1);
+	pAd->WcidFlushCnt++;
+
+	RTMP_SEM_EVENT_UP(&pAd->WcidFlushLock);
+}
+
+
+/* before a key or attribute write of Wcid, so a later flush cannot undo it */
+VOID AssocStormWcidSync(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Wcid)
+{
+	INT SemRet;
+
+	if (Wcid >= MAX_LEN_OF_MAC_TABLE)
+		return;
+
+	RTMP_SEM_EVENT_WAIT(&pAd->WcidFlushLock, SemRet);
+	if (SemRet != 0)
+		return;
+
+	AssocStormWcidWriteDirty(pAd, Wcid);
+
+	RTMP_SEM_EVENT_UP(&pAd->WcidFlushLock);
+}
+
+
+/* handshakes in flight, not counting pSkip */
+static INT AssocStormHsActive(
+	IN PRTMP_ADAPTER pAd,
+	IN MAC_TABLE_ENTRY *pSkip,
+	IN unsigned long Now)
+{
+	MAC_TABLE_ENTRY *pEntry;
+	INT i, Active = 0;
+
+	for (i = 1; i < MAX_LEN_OF_MAC_TABLE; i++)
+	{
+		pEntry = &pAd->MacTab.Content[i];
+
+		if ((pEntry == pSkip) || !IS_ENTRY_CLIENT(pEntry))
+			continue;
+
+		if ((pEntry->WpaState == AS_PTKSTART) || (pEntry->WpaState == AS_PTKINIT_NEGOTIATING))
+			Active++;
+		/* admitted, EAPOL-Start still in the MLME queue */
+		else if ((pEntry->WpaState < AS_PTKSTART) && (pEntry->HsAdmitTime != 0) &&
+				 RTMP_TIME_BEFORE(Now, pEntry->HsAdmitTime + ASSOC_STORM_HS_GRACE))
+			Active++;
+	}
+
+	return Active;
+}
+
+
+#ifdef DBG
+/* AssocStormHsAdmit() decided on pEntry */
+static VOID AssocStormSimHs(
+	IN PRTMP_ADAPTER pAd,
+	IN MAC_TABLE_ENTRY *pEntry,
+	IN bool bAdmitted)
+{
+	ASSOC_STORM_SIM *pSim = &pAd->ApCfg.StormSim;
+	INT Idx = AssocStormSimIdx(pAd, pEntry->Addr);
+
+	if (Idx < 0)
+		return;
+
+	NdisAcquireSpinLock(&pSim->Lock);
+	if (!bAdmitted)
+		pSim->HsDeferCnt++;
+	else if (pSim->State[Idx] == STORM_SIM_DONE)
+	{
+		pSim->State[Idx] = STORM_SIM_HS;
+		pSim->HsCnt++;
+		pSim->HsUs = RtmpOsGetUsecTime() - pSim->StartUs;
+	}
+	NdisReleaseSpinLock(&pSim->Lock);
+}
+#endif /* DBG */
+
+
+bool AssocStormHsAdmit(
+	IN PRTMP_ADAPTER pAd,
+	IN MAC_TABLE_ENTRY *pEntry)
+{
+	unsigned long Now;
+	INT Active;
+
+	if (pAd->ApCfg.AssocHsMax == 0)
+		return TRUE;
+
+	NdisGetSystemUpTime(&Now);
+	Active = AssocStormHsActive(pAd, pEntry, Now);
+
+	if (Active >= pAd->ApCfg.AssocHsMax)
+	{
+		pAd->ApCfg.AssocHsDeferCnt++;
+#ifdef DBG
+		AssocStormSimHs(pAd, pEntry, FALSE);
+#endif /* DBG */
+		return FALSE;
+	}
+
+#ifdef DBG
+	AssocStormSimHs(pAd, pEntry, TRUE);
+#endif /* DBG */
+	pEntry->HsAdmitTime = Now;
+	if ((Active + 1) > pAd->ApCfg.AssocHsPeak)
+		pAd->ApCfg.AssocHsPeak = Active + 1;
+
+	return TRUE;
+}
+
+
+#ifdef DBG
+static bool AssocStormSimAuthReq(
+	IN PRTMP_ADAPTER pAd,
+	IN INT Idx)
+{
+	MULTISSID_STRUCT *pMbss = &pAd->ApCfg.MBSSID[MAIN_MBSSID];
+	MAC_TABLE_ENTRY *pEntry;
+	HEADER_802_11 Hdr;
+	unsigned char *pFrame = NULL;
+	unsigned short Alg = AUTH_MODE_OPEN, Seq = 1, Status = MLME_SUCCESS;
+	unsigned long FrameLen = 0, Wcid = RESERVED_WCID;
+	bool bQueued;
+
+	if (MlmeAllocateMemory(pAd, &pFrame) != NDIS_STATUS_SUCCESS)
+		return FALSE;
+
+	MgtMacHeaderInit(pAd, &Hdr, SUBTYPE_AUTH, 0, pMbss->Bssid, pMbss->Bssid);
+	NdisMoveMemory(Hdr.Addr2, StormSimOui, sizeof(StormSimOui));
+	Hdr.Addr2[4] = (unsigned char)(Idx >> 8);
+	Hdr.Addr2[5] = (unsigned char)Idx;
+
+	/* a retry, the station already has its entry */
+	pEntry = MacTableLookup(pAd, Hdr.Addr2);
+	if (pEntry)
+		Wcid = pEntry->Aid;
+
+	MakeOutgoingFrame(pFrame, &FrameLen,
+					  sizeof(HEADER_802_11), &Hdr,
+					  2, &Alg,
+					  2, &Seq,
+					  2, &Status,
+					  END_OF_ARGS);
+
+	bQueued = MlmeEnqueueForRecv(pAd, Wcid, 0, 0, 0, 0, 0, 0, FrameLen, pFrame, 0, OPMODE_AP);
+	MlmeFreeMemory(pAd, pFrame);
+
+	return bQueued;
+}
+
+
+static bool AssocStormSimAssocReq(
+	IN PRTMP_ADAPTER pAd,
+	IN MAC_TABLE_ENTRY *pEntry)
+{
+	MULTISSID_STRUCT *pMbss = &pAd->ApCfg.MBSSID[pEntry->apidx];
+	HEADER_802_11 Hdr;
+	unsigned char *pFrame = NULL;
+	unsigned short ListenInterval = 10;
+	unsigned char SsidIe = IE_SSID, SupRateIe = IE_SUPP_RATES, ExtRateIe = IE_EXT_SUPP_RATES;
+	unsigned char RSNIe, RSNIdx = 0;
+	unsigned long FrameLen = 0, TmpLen;
+	bool bQueued;
+
+	if (MlmeAllocateMemory(pAd, &pFrame) != NDIS_STATUS_SUCCESS)
+		return FALSE;
+
+	MgtMacHeaderInit(pAd, &Hdr, SUBTYPE_ASSOC_REQ, 0, pMbss->Bssid, pMbss->Bssid);
+	COPY_MAC_ADDR(Hdr.Addr2, pEntry->Addr);
+
+	MakeOutgoingFrame(pFrame, &FrameLen,
+					  sizeof(HEADER_802_11), &Hdr,
+					  2, &pMbss->CapabilityInfo,
+					  2, &ListenInterval,
+					  1, &SsidIe,
+					  1, &pMbss->SsidLen,
+					  pMbss->SsidLen, pMbss->Ssid,
+					  1, &SupRateIe,
+					  1, &pAd->CommonCfg.SupRateLen,
+					  pAd->CommonCfg.SupRateLen, pAd->CommonCfg.SupRate,
+					  END_OF_ARGS);
+
+	if (pAd->CommonCfg.ExtRateLen)
+	{
+		MakeOutgoingFrame(pFrame + FrameLen, &TmpLen,
+						  1, &ExtRateIe,
+						  1, &pAd->CommonCfg.ExtRateLen,
+						  pAd->CommonCfg.ExtRateLen, pAd->CommonCfg.ExtRate,
+						  END_OF_ARGS);
+		FrameLen += TmpLen;
+	}
+
+	/* the RSN IE of the beacon, WPA2 of the mixed modes */
+	if (pMbss->AuthMode >= Ndis802_11AuthModeWPA)
+	{
+		if ((pMbss->AuthMode == Ndis802_11AuthModeWPA) ||
+			(pMbss->AuthMode == Ndis802_11AuthModeWPAPSK))
+			RSNIe = IE_WPA;
+		else
+			RSNIe = IE_WPA2;
+
+		if ((pMbss->AuthMode == Ndis802_11AuthModeWPA1WPA2) ||
+			(pMbss->AuthMode == Ndis802_11AuthModeWPA1PSKWPA2PSK))
+			RSNIdx = 1;
+
+		MakeOutgoingFrame(pFrame + FrameLen, &TmpLen,
+						  1, &RSNIe,
+						  1, &pMbss->RSNIE_Len[RSNIdx],
+						  pMbss->RSNIE_Len[RSNIdx], pMbss->RSN_IE[RSNIdx],
+						  END_OF_ARGS);
+		FrameLen += TmpLen;
+	}
+
+	bQueued = MlmeEnqueueForRecv(pAd, pEntry->Aid, 0, 0, 0, 0, 0, 0, FrameLen, pFrame, 0, OPMODE_AP);
+	MlmeFreeMemory(pAd, pFrame);
+
+	return bQueued;
+}
+
+
+/* Auth of the simulated stations that are due, as long as the MLME queue takes them */
+static VOID AssocStormSimRun(
+	IN PRTMP_ADAPTER pAd)
+{
+	ASSOC_STORM_SIM *pSim = &pAd->ApCfg.StormSim;
+	unsigned long Now;
+	unsigned char State;
+	INT Idx;
+
+	NdisGetSystemUpTime(&Now);
+
+	for (Idx = 0; Idx < pSim->Num; Idx++)
+	{
+		NdisAcquireSpinLock(&pSim->Lock);
+
+		if (!pSim->bRunning)
+		{
+			NdisReleaseSpinLock(&pSim->Lock);
+			break;
+		}
+
+		State = pSim->State[Idx];
+		if (((State == STORM_SIM_AUTH) || (State == STORM_SIM_ASSOC)) &&
+			RTMP_TIME_AFTER(Now, pSim->Time[Idx] + ASSOC_STORM_SIM_RETRY))
+		{
+			pSim->RetryCnt++;
+			State = STORM_SIM_IDLE;
+		}
+
+		if (State != STORM_SIM_IDLE)
+		{
+			NdisReleaseSpinLock(&pSim->Lock);
+			continue;
+		}
+
+		/* real stations took the room in between */
+		if ((pAd->MacTab.Size + ASSOC_STORM_SIM_RESERVE) >= (MAX_LEN_OF_MAC_TABLE - 1))
+		{
+			NdisReleaseSpinLock(&pSim->Lock);
+			break;
+		}
+
+		pSim->State[Idx] = STORM_SIM_AUTH;
+		pSim->Time[Idx] = Now;
+		NdisReleaseSpinLock(&pSim->Lock);
+
+		if (!AssocStormSimAuthReq(pAd, Idx))
+		{
+			NdisAcquireSpinLock(&pSim->Lock);
+			if (pSim->State[Idx] == STORM_SIM_AUTH)
+				pSim->State[Idx] = STORM_SIM_IDLE;
+			pSim->DropCnt++;
+			NdisReleaseSpinLock(&pSim->Lock);
+			break;
+		}
+	}
+}
+
+
+VOID AssocStormPeriodic(
+	IN PRTMP_ADAPTER pAd)
+{
+	if (pAd->ApCfg.StormSim.bRunning)
+		AssocStormSimRun(pAd);
+}
+
+
+/* after the Auth of pEntry succeeded */
+VOID AssocStormSimAuth(
+	IN PRTMP_ADAPTER pAd,
+	IN MAC_TABLE_ENTRY *pEntry)
+{
+	ASSOC_STORM_SIM *pSim = &pAd->ApCfg.StormSim;
+	INT Idx = AssocStormSimIdx(pAd, pEntry->Addr);
+
+	if (Idx < 0)
+		return;
+
+	NdisAcquireSpinLock(&pSim->Lock);
+	if (pSim->State[Idx] != STORM_SIM_AUTH)
+	{
+		NdisReleaseSpinLock(&pSim->Lock);
+		return;
+	}
+	pSim->State[Idx] = STORM_SIM_ASSOC;
+	NdisGetSystemUpTime(&pSim->Time[Idx]);
+	NdisReleaseSpinLock(&pSim->Lock);
+
+	if (!AssocStormSimAssocReq(pAd, pEntry))
+	{
+		NdisAcquireSpinLock(&pSim->Lock);
+		if (pSim->State[Idx] == STORM_SIM_ASSOC)
+			pSim->State[Idx] = STORM_SIM_IDLE;
+		pSim->DropCnt++;
+		NdisReleaseSpinLock(&pSim->Lock);
+	}
+}
+
+
+/* APBuildAssociation() decided on pEntry */
+VOID AssocStormSimAssoc(
+	IN PRTMP_ADAPTER pAd,
+	IN MAC_TABLE_ENTRY *pEntry,
+	IN unsigned short StatusCode)
+{
+	ASSOC_STORM_SIM *pSim = &pAd->ApCfg.StormSim;
+	INT Idx = AssocStormSimIdx(pAd, pEntry->Addr);
+
+	if (Idx < 0)
+		return;
+
+	NdisAcquireSpinLock(&pSim->Lock);
+	if (pSim->State[Idx] == STORM_SIM_ASSOC)
+	{
+		if (StatusCode == MLME_SUCCESS)
+		{
+			pSim->State[Idx] = STORM_SIM_DONE;
+			pSim->AssocCnt++;
+		}
+		else
+		{
+			pSim->State[Idx] = STORM_SIM_FAIL;
+			pSim->FailCnt++;
+		}
+
+		if ((pSim->AssocCnt + pSim->FailCnt) == pSim->Num)
+		{
+			pSim->AssocUs = RtmpOsGetUsecTime() - pSim->StartUs;
+#if defined(REG_DEFER_SUPPORT) || defined(BOOT_PROF_SUPPORT)
+			pSim->Xfer = pAd->VendorReqCnt - pSim->XferBegin;
+#endif /* REG_DEFER_SUPPORT || BOOT_PROF_SUPPORT */
+			DBGPRINT(RT_DEBUG_TRACE, ("Storm sim: %d of %d stations associated in %u us\n",
+						pSim->AssocCnt, pSim->Num, pSim->AssocUs));
+		}
+	}
+	NdisReleaseSpinLock(&pSim->Lock);
+}
+#endif /* DBG */
+
+
+INT Set_AssocHsMax_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	long Max = simple_strtol(arg, 0, 10);
+
+	if ((Max < 0) || (Max > MAX_LEN_OF_MAC_TABLE))
+		return FALSE;
+
+	pAd->ApCfg.AssocHsMax = (unsigned char)Max;
+	pAd->ApCfg.AssocHsPeak = 0;
+	pAd->ApCfg.AssocHsDeferCnt = 0;
+
+	DBGPRINT(RT_DEBUG_TRACE, ("Set_AssocHsMax_Proc::(AssocHsMax=%d)\n", pAd->ApCfg.AssocHsMax));
+
+	return TRUE;
+}
+
+
+#ifdef DBG
+INT Set_AssocStormSim_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	ASSOC_STORM_SIM *pSim = &pAd->ApCfg.StormSim;
+	MAC_TABLE_ENTRY *pEntry;
+	long Num = simple_strtol(arg, 0, 10);
+	long Room;
+	INT i;
+
+	/* stations of the run before go first */
+	for (i = 1; i < MAX_LEN_OF_MAC_TABLE; i++)
+	{
+		pEntry = &pAd->MacTab.Content[i];
+		if (IS_ENTRY_CLIENT(pEntry) && (AssocStormSimIdx(pAd, pEntry->Addr) >= 0))
+			MacTableDeleteEntry(pAd, pEntry->Aid, pEntry->Addr);
+	}
+
+	NdisAcquireSpinLock(&pSim->Lock);
+	pSim->bRunning = FALSE;
+	NdisReleaseSpinLock(&pSim->Lock);
+
+	if (Num <= 0)
+		return TRUE;
+
+	/* what the real stations leave, less the reserve for more of them */
+	Room = (MAX_LEN_OF_MAC_TABLE - 1) - pAd->MacTab.Size - ASSOC_STORM_SIM_RESERVE;
+	if (Room <= 0)
+	{
+		DBGPRINT(RT_DEBUG_OFF, ("Storm sim: no room in the MAC table\n"));
+		return FALSE;
+	}
+
+	if (Num > Room)
+		Num = Room;
+
+	NdisAcquireSpinLock(&pSim->Lock);
+	pSim->Num = (unsigned short)Num;
+	pSim->AssocCnt = 0;
+	pSim->FailCnt = 0;
+	pSim->AssocUs = 0;
+	pSim->WcidUs = 0;
+	pSim->RetryCnt = 0;
+	pSim->DropCnt = 0;
+	pSim->HsCnt = 0;
+	pSim->HsUs = 0;
+	pSim->HsDeferCnt = 0;
+	NdisZeroMemory(pSim->State, sizeof(pSim->State));
+#if defined(REG_DEFER_SUPPORT) || defined(BOOT_PROF_SUPPORT)
+	pSim->Xfer = 0;
+	pSim->XferBegin = pAd->VendorReqCnt;
+#endif /* REG_DEFER_SUPPORT || BOOT_PROF_SUPPORT */
+	pSim->StartUs = RtmpOsGetUsecTime();
+	pSim->bRunning = TRUE;
+	NdisReleaseSpinLock(&pSim->Lock);
+
+	DBGPRINT(RT_DEBUG_TRACE, ("Set_AssocStormSim_Proc::(AssocStormSim=%d)\n", pSim->Num));
+
+	AssocStormSimRun(pAd);
+
+	return TRUE;
+}
+#endif /* DBG */
+
+
+INT Show_AssocStorm_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+#ifdef DBG
+	ASSOC_STORM_SIM *pSim = &pAd->ApCfg.StormSim;
+#endif /* DBG */
+	unsigned long Now;
+
+	NdisGetSystemUpTime(&Now);
+
+	DBGPRINT(RT_DEBUG_OFF, ("Handshakes: Max=%d, Active=%d, Peak=%d, Deferred=%ld\n",
+				pAd->ApCfg.AssocHsMax, AssocStormHsActive(pAd, NULL, Now),
+				pAd->ApCfg.AssocHsPeak, pAd->ApCfg.AssocHsDeferCnt));
+	DBGPRINT(RT_DEBUG_OFF, ("WCID table: Flush=%ld, Entry=%ld, Write=%ld\n",
+				pAd->WcidFlushCnt, pAd->WcidEntryCnt, pAd->WcidBurstCnt));
+
+#ifdef DBG
+	if (pSim->Num == 0)
+		return TRUE;
+
+	DBGPRINT(RT_DEBUG_OFF, ("Storm sim: Sta=%d, Assoc=%d, Fail=%d, Retry=%ld, Drop=%ld%s\n",
+				pSim->Num, pSim->AssocCnt, pSim->FailCnt, pSim->RetryCnt, pSim->DropCnt,
+				pSim->bRunning ? "" : " (stopped)"));
+
+	if (pSim->AssocUs != 0)
+		DBGPRINT(RT_DEBUG_OFF, ("All associated after %u us, last WCID entry written after %u us\n",
+					pSim->AssocUs, pSim->WcidUs));
+	else
+		DBGPRINT(RT_DEBUG_OFF, ("Running for %u us\n", RtmpOsGetUsecTime() - pSim->StartUs));
+
+#if defined(REG_DEFER_SUPPORT) || defined(BOOT_PROF_SUPPORT)
+	DBGPRINT(RT_DEBUG_OFF, ("Control transfers until all associated: %lu\n", pSim->Xfer));
+#endif /* REG_DEFER_SUPPORT || BOOT_PROF_SUPPORT */
+
+	/* only AP initiated PSK handshakes ask AssocStormHsAdmit() */
+	if ((pSim->HsCnt != 0) || (pSim->HsDeferCnt != 0))
+		DBGPRINT(RT_DEBUG_OFF, ("Handshakes admitted: %d of %d, last after %u us, deferred %ld times\n",
+					pSim->HsCnt, pSim->AssocCnt, pSim->HsUs, pSim->HsDeferCnt));
+#endif /* DBG */
+
+	return TRUE;
+}
+
+#endif /* ASSOC_STORM_SUPPORT */
+
@@ -75,469 +75,694 @@ VOID APSyncStateMachineInit(
 /*
 	==========================================================================
 	Description:
-		Process the received ProbeRequest from clients
-	Parameters:
-		Elem - msg containing the ProbeReq frame
+		Build the ProbeRsp of one BSS to pAddr2 in pOutBuffer
+	Return:
+		the frame length
 	==========================================================================
  */
-VOID APPeerProbeReqAction(
+static unsigned long APMakeProbeRsp(
 	IN PRTMP_ADAPTER pAd,
-	IN MLME_QUEUE_ELEM *Elem)
+	IN INT apidx,
+	IN unsigned char *pAddr2,
+	IN bool bRequestRssi,
+	IN unsigned char *pOutBuffer)
 {
-	unsigned char Addr2[MAC_ADDR_LEN];
-	CHAR Ssid[MAX_LEN_OF_SSID];
-	unsigned char SsidLen;
 	HEADER_802_11 ProbeRspHdr;
-	NDIS_STATUS NStatus;
-	unsigned char * pOutBuffer = NULL;
 	unsigned long FrameLen = 0, TmpLen = 0, TmpLen2 = 0, TmpLen3 = 0;
 	LARGE_INTEGER FakeTimestamp;
-	unsigned char DsLen = 1, ErpIeLen = 1, apidx = 0, PhyMode, SupRateLen, RSNIe = IE_WPA, RSNIe2 = IE_WPA2;
-	bool	bRequestRssi = FALSE;
+	unsigned char DsLen = 1, ErpIeLen = 1, PhyMode, SupRateLen, RSNIe = IE_WPA, RSNIe2 = IE_WPA2;
 
-#ifdef WSC_AP_SUPPORT
-	unsigned char Addr3[MAC_ADDR_LEN];
-	PFRAME_802_11 pFrame = (PFRAME_802_11)Elem->Msg;
+	PhyMode = pAd->ApCfg.MBSSID[apidx].PhyMode;
 
-	COPY_MAC_ADDR(Addr3, pFrame->Hdr.Addr3);
-#endif /* WSC_AP_SUPPORT */
+	MgtMacHeaderInit(pAd, &ProbeRspHdr, SUBTYPE_PROBE_RSP, 0, pAddr2,
+				pAd->ApCfg.MBSSID[apidx].Bssid);
 
-#ifdef WDS_SUPPORT
-	/* if in bridge mode, no need to reply probe req. */
-	if (pAd->WdsTab.Mode == WDS_BRIDGE_MODE)
-		return;
-#endif /* WDS_SUPPORT */
-
-	if (!PeerProbeReqSanity(pAd, Elem->Msg, Elem->MsgLen, Addr2, Ssid, &SsidLen, &bRequestRssi))
-		return;
-
-	for (apidx = 0; apidx < pAd->ApCfg.BssidNum; apidx++) {
+	if ((pAd->ApCfg.MBSSID[apidx].AuthMode == Ndis802_11AuthModeWPA) ||
+		(pAd->ApCfg.MBSSID[apidx].AuthMode == Ndis802_11AuthModeWPAPSK))
 		RSNIe = IE_WPA;
-
-		if ((pAd->ApCfg.MBSSID[apidx].MSSIDDev != NULL) &&
-			!(RTMP_OS_NETDEV_STATE_RUNNING(pAd->ApCfg.MBSSID[apidx].MSSIDDev))) {
-			/* the interface is down, so we can not send probe response */
-			continue;
-		}
-
-		PhyMode = pAd->ApCfg.MBSSID[apidx].PhyMode;
-
-		if (((SsidLen == 0) && (! pAd->ApCfg.MBSSID[apidx].bHideSsid)) ||
-#ifdef WSC_AP_SUPPORT
-		/* buffalo WPS testbed STA send ProbrRequest ssid length = 32 and ssid are not AP , but DA are AP. for WPS test send ProbeResponse */
-			((SsidLen == 32) && MAC_ADDR_EQUAL(Addr3, pAd->ApCfg.MBSSID[apidx].Bssid) && (pAd->ApCfg.MBSSID[apidx].bHideSsid == 0)) ||
-#endif /* WSC_AP_SUPPORT */
-			((SsidLen == pAd->ApCfg.MBSSID[apidx].SsidLen) && NdisEqualMemory(Ssid, pAd->ApCfg.MBSSID[apidx].Ssid, (unsigned long) SsidLen)))
-			;
-		else
-			continue; /* check next BSS */
-
-		/* allocate and send out ProbeRsp frame */
-		NStatus = MlmeAllocateMemory(pAd, &pOutBuffer);
-		if (NStatus != NDIS_STATUS_SUCCESS)
-			return;
-		MgtMacHeaderInit(pAd, &ProbeRspHdr, SUBTYPE_PROBE_RSP, 0, Addr2,
-					pAd->ApCfg.MBSSID[apidx].Bssid);
-
-		if ((pAd->ApCfg.MBSSID[apidx].AuthMode == Ndis802_11AuthModeWPA) ||
-			(pAd->ApCfg.MBSSID[apidx].AuthMode == Ndis802_11AuthModeWPAPSK))
-			RSNIe = IE_WPA;
-		else if ((pAd->ApCfg.MBSSID[apidx].AuthMode == Ndis802_11AuthModeWPA2) ||
-			(pAd->ApCfg.MBSSID[apidx].AuthMode == Ndis802_11AuthModeWPA2PSK))
-			RSNIe = IE_WPA2;
+	else if ((pAd->ApCfg.MBSSID[apidx].AuthMode == Ndis802_11AuthModeWPA2) ||
+		(pAd->ApCfg.MBSSID[apidx].AuthMode == Ndis802_11AuthModeWPA2PSK))
+		RSNIe = IE_WPA2;
 #ifdef WAPI_SUPPORT
-		else if ((pAd->ApCfg.MBSSID[apidx].AuthMode == Ndis802_11AuthModeWAICERT) ||
-			(pAd->ApCfg.MBSSID[apidx].AuthMode == Ndis802_11AuthModeWAIPSK))
-			RSNIe = IE_WAPI;
+	else if ((pAd->ApCfg.MBSSID[apidx].AuthMode == Ndis802_11AuthModeWAICERT) ||
+		(pAd->ApCfg.MBSSID[apidx].AuthMode == Ndis802_11AuthModeWAIPSK))
+		RSNIe = IE_WAPI;
 #endif /* WAPI_SUPPORT */
 
-		{
-			SupRateLen = pAd->CommonCfg.SupRateLen;
-			if (PhyMode == WMODE_B)
-				SupRateLen = 4;
-
-			MakeOutgoingFrame(pOutBuffer, &FrameLen,
-						sizeof(HEADER_802_11), &ProbeRspHdr,
-						TIMESTAMP_LEN, &FakeTimestamp,
-						2, &pAd->CommonCfg.BeaconPeriod,
-						2, &pAd->ApCfg.MBSSID[apidx].CapabilityInfo,
-						1, &SsidIe,
-						1, &pAd->ApCfg.MBSSID[apidx].SsidLen,
-						pAd->ApCfg.MBSSID[apidx].SsidLen, pAd->ApCfg.MBSSID[apidx].Ssid,
-						1, &SupRateIe,
-						1, &SupRateLen,
-						SupRateLen, pAd->CommonCfg.SupRate,
-						1, &DsIe,
-						1, &DsLen,
-						1, &pAd->CommonCfg.Channel,
-						END_OF_ARGS);
-		}
+	{
+		SupRateLen = pAd->CommonCfg.SupRateLen;
+		if (PhyMode == WMODE_B)
+			SupRateLen = 4;
+
+		MakeOutgoingFrame(pOutBuffer, &FrameLen,
+					sizeof(HEADER_802_11), &ProbeRspHdr,
+					TIMESTAMP_LEN, &FakeTimestamp,
+					2, &pAd->CommonCfg.BeaconPeriod,
+					2, &pAd->ApCfg.MBSSID[apidx].CapabilityInfo,
+					1, &SsidIe,
+					1, &pAd->ApCfg.MBSSID[apidx].SsidLen,
+					pAd->ApCfg.MBSSID[apidx].SsidLen, pAd->ApCfg.MBSSID[apidx].Ssid,
+					1, &SupRateIe,
+					1, &SupRateLen,
+					SupRateLen, pAd->CommonCfg.SupRate,
+					1, &DsIe,
+					1, &DsLen,
+					1, &pAd->CommonCfg.Channel,
+					END_OF_ARGS);
+	}
 
-		/* add country IE, power constraint IE */
-		if (pAd->CommonCfg.bCountryFlag) {
-			unsigned char TmpFrame[256];
-			unsigned char CountryIe = IE_COUNTRY;
+	/* add country IE, power constraint IE */
+	if (pAd->CommonCfg.bCountryFlag) {
+		unsigned char TmpFrame[256];
+		unsigned char CountryIe = IE_COUNTRY;
 
 #ifdef A_BAND_SUPPORT
-			/*
-				Only 802.11a APs that comply with 802.11h are required to include
-				 a Power Constrint Element(IE=32) in beacons and probe response frames
-			*/
-			if (pAd->CommonCfg.Channel > 14 && pAd->CommonCfg.bIEEE80211H == TRUE) {
-				/* prepare power constraint IE */
-				MakeOutgoingFrame(pOutBuffer + FrameLen,
-							&TmpLen,
-							3, PowerConstraintIE,
-							END_OF_ARGS);
-				FrameLen += TmpLen;
-			}
+		/*
+			Only 802.11a APs that comply with 802.11h are required to include
+			 a Power Constrint Element(IE=32) in beacons and probe response frames
+		*/
+		if (pAd->CommonCfg.Channel > 14 && pAd->CommonCfg.bIEEE80211H == TRUE) {
+			/* prepare power constraint IE */
+			MakeOutgoingFrame(pOutBuffer + FrameLen,
+						&TmpLen,
+						3, PowerConstraintIE,
+						END_OF_ARGS);
+			FrameLen += TmpLen;
+		}
 #endif /* A_BAND_SUPPORT */
 
-			NdisZeroMemory(TmpFrame, sizeof(TmpFrame));
+		NdisZeroMemory(TmpFrame, sizeof(TmpFrame));
 
-			/* prepare channel information */
+		/* prepare channel information */
 #ifdef EXT_BUILD_CHANNEL_LIST
-			BuildBeaconChList(pAd, TmpFrame, &TmpLen2);
+		BuildBeaconChList(pAd, TmpFrame, &TmpLen2);
 #else
-			unsigned char MaxTxPower = GetCountryMaxTxPwr(pAd, pAd->CommonCfg.Channel);
-			MakeOutgoingFrame(TmpFrame + TmpLen2,
-					&TmpLen,
-					1, &pAd->ChannelList[0].Channel,
-					1, &pAd->ChannelListNum,
-					1, &MaxTxPower,
-					END_OF_ARGS);
-			TmpLen2 += TmpLen;
+		unsigned char MaxTxPower = GetCountryMaxTxPwr(pAd, pAd->CommonCfg.Channel);
+		MakeOutgoingFrame(TmpFrame + TmpLen2,
+				&TmpLen,
+				1, &pAd->ChannelList[0].Channel,
+				1, &pAd->ChannelListNum,
+				1, &MaxTxPower,
+				END_OF_ARGS);
+		TmpLen2 += TmpLen;
 #endif /* EXT_BUILD_CHANNEL_LIST */
 
-			/* need to do the padding bit check, and concatenate it */
-			if ((TmpLen2 % 2) == 0) {
-				TmpLen3 = TmpLen2 + 4;
-				MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
-							1, &CountryIe,
-							1, &TmpLen3,
-							3, pAd->CommonCfg.CountryCode,
-							TmpLen2 + 1, TmpFrame,
-							END_OF_ARGS);
-			} else {
-				TmpLen3 = TmpLen2 + 3;
-				MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
-							1, &CountryIe,
-							1, &TmpLen3,
-							3, pAd->CommonCfg.CountryCode,
-							TmpLen2, TmpFrame,
-							END_OF_ARGS);
-			}
-			FrameLen += TmpLen;
-		} /* Country IE - */
-
-		if (pAd->CommonCfg.ExtRateLen) {
+		/* need to do the padding bit check, and concatenate it */
+		if ((TmpLen2 % 2) == 0) {
+			TmpLen3 = TmpLen2 + 4;
 			MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
-						1, &ExtRateIe,
-						1, &pAd->CommonCfg.ExtRateLen,
-						pAd->CommonCfg.ExtRateLen, pAd->CommonCfg.ExtRate,
+						1, &CountryIe,
+						1, &TmpLen3,
+						3, pAd->CommonCfg.CountryCode,
+						TmpLen2 + 1, TmpFrame,
 						END_OF_ARGS);
-			FrameLen += TmpLen;
-		}
-
-		if (PhyMode != WMODE_B) {
+		} else {
+			TmpLen3 = TmpLen2 + 3;
 			MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
-						1, &ErpIe,
-						1, &ErpIeLen,
-						1, &pAd->ApCfg.ErpIeContent,
+						1, &CountryIe,
+						1, &TmpLen3,
+						3, pAd->CommonCfg.CountryCode,
+						TmpLen2, TmpFrame,
 						END_OF_ARGS);
-			FrameLen += TmpLen;
 		}
+		FrameLen += TmpLen;
+	} /* Country IE - */
+
+	if (pAd->CommonCfg.ExtRateLen) {
+		MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
+					1, &ExtRateIe,
+					1, &pAd->CommonCfg.ExtRateLen,
+					pAd->CommonCfg.ExtRateLen, pAd->CommonCfg.ExtRate,
+					END_OF_ARGS);
+		FrameLen += TmpLen;
+	}
 
-#ifdef A_BAND_SUPPORT
-		/* add Channel switch announcement IE */
-		if ((pAd->CommonCfg.Channel > 14)
-			&& (pAd->CommonCfg.bIEEE80211H == 1)
-			&& (pAd->Dot11_H.RDMode == RD_SWITCHING_MODE)) {
-			unsigned char CSAIe = IE_CHANNEL_SWITCH_ANNOUNCEMENT;
-			unsigned char CSALen = 3;
-			unsigned char CSAMode = 1;
+	if (PhyMode != WMODE_B) {
+		MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
+					1, &ErpIe,
+					1, &ErpIeLen,
+					1, &pAd->ApCfg.ErpIeContent,
+					END_OF_ARGS);
+		FrameLen += TmpLen;
+	}
 
-			MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
-						1, &CSAIe,
-						1, &CSALen,
-						1, &CSAMode,
-						1, &pAd->CommonCfg.Channel,
-						1, &pAd->Dot11_H.CSCount,
-						END_OF_ARGS);
-			FrameLen += TmpLen;
-		}
+#ifdef A_BAND_SUPPORT
+	/* add Channel switch announcement IE */
+	if ((pAd->CommonCfg.Channel > 14)
+		&& (pAd->CommonCfg.bIEEE80211H == 1)
+		&& (pAd->Dot11_H.RDMode == RD_SWITCHING_MODE)) {
+		unsigned char CSAIe = IE_CHANNEL_SWITCH_ANNOUNCEMENT;
+		unsigned char CSALen = 3;
+		unsigned char CSAMode = 1;
+
+		MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
+					1, &CSAIe,
+					1, &CSALen,
+					1, &CSAMode,
+					1, &pAd->CommonCfg.Channel,
+					1, &pAd->Dot11_H.CSCount,
+					END_OF_ARGS);
+		FrameLen += TmpLen;
+	}
 #endif /* A_BAND_SUPPORT */
 
 #ifdef DOT11_N_SUPPORT
-		if (WMODE_CAP_N(PhyMode) &&
-			(pAd->ApCfg.MBSSID[apidx].DesiredHtPhyInfo.bHtEnable)) {
-			unsigned char HtLen, AddHtLen, NewExtLen;
+	if (WMODE_CAP_N(PhyMode) &&
+		(pAd->ApCfg.MBSSID[apidx].DesiredHtPhyInfo.bHtEnable)) {
+		unsigned char HtLen, AddHtLen, NewExtLen;
 
 #ifdef A_BAND_SUPPORT
-			if (pAd->CommonCfg.bExtChannelSwitchAnnouncement && (pAd->CommonCfg.Channel > 14)) {
-				HT_EXT_CHANNEL_SWITCH_ANNOUNCEMENT_IE HtExtChannelSwitchIe;
-
-				build_ext_channel_switch_ie(pAd, &HtExtChannelSwitchIe);
-				MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
-							sizeof(HT_EXT_CHANNEL_SWITCH_ANNOUNCEMENT_IE), &HtExtChannelSwitchIe,
-							END_OF_ARGS);
-				FrameLen += TmpLen;
-			}
-#endif /* A_BAND_SUPPORT */
+		if (pAd->CommonCfg.bExtChannelSwitchAnnouncement && (pAd->CommonCfg.Channel > 14)) {
+			HT_EXT_CHANNEL_SWITCH_ANNOUNCEMENT_IE HtExtChannelSwitchIe;
 
-			HtLen = sizeof(pAd->CommonCfg.HtCapability);
-			AddHtLen = sizeof(pAd->CommonCfg.AddHTInfo);
-			NewExtLen = 1;
-			/* New extension channel offset IE is included in Beacon, Probe Rsp or channel Switch Announcement Frame */
+			build_ext_channel_switch_ie(pAd, &HtExtChannelSwitchIe);
 			MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
-						1, &HtCapIe,
-						1, &HtLen,
-						sizeof(HT_CAPABILITY_IE), &pAd->CommonCfg.HtCapability,
-						1, &AddHtInfoIe,
-						1, &AddHtLen,
-						sizeof(ADD_HT_INFO_IE), &pAd->CommonCfg.AddHTInfo,
+						sizeof(HT_EXT_CHANNEL_SWITCH_ANNOUNCEMENT_IE), &HtExtChannelSwitchIe,
 						END_OF_ARGS);
-#endif /* DOT11_N_SUPPORT */
-
 			FrameLen += TmpLen;
 		}
+#endif /* A_BAND_SUPPORT */
+
+		HtLen = sizeof(pAd->CommonCfg.HtCapability);
+		AddHtLen = sizeof(pAd->CommonCfg.AddHTInfo);
+		NewExtLen = 1;
+		/* New extension channel offset IE is included in Beacon, Probe Rsp or channel Switch Announcement Frame */
+		MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
+					1, &HtCapIe,
+					1, &HtLen,
+					sizeof(HT_CAPABILITY_IE), &pAd->CommonCfg.HtCapability,
+					1, &AddHtInfoIe,
+					1, &AddHtLen,
+					sizeof(ADD_HT_INFO_IE), &pAd->CommonCfg.AddHTInfo,
+					END_OF_ARGS);
+#endif /* DOT11_N_SUPPORT */
+
+		FrameLen += TmpLen;
+	}
 
 #ifdef DOT11_N_SUPPORT
 #ifdef DOT11N_DRAFT3
-	 	/* P802.11n_D3.03, 7.3.2.60 Overlapping BSS Scan Parameters IE */
-	 	if (WMODE_CAP_N(PhyMode) &&
-			(pAd->CommonCfg.Channel <= 14) &&
-			(pAd->ApCfg.MBSSID[apidx].DesiredHtPhyInfo.bHtEnable) &&
-			(pAd->CommonCfg.HtCapability.HtCapInfo.ChannelWidth == 1)) {
-			OVERLAP_BSS_SCAN_IE OverlapScanParam;
-			unsigned char OverlapScanIE, ScanIELen;
-
-			OverlapScanIE = IE_OVERLAPBSS_SCAN_PARM;
-			ScanIELen = 14;
-			OverlapScanParam.ScanPassiveDwell = cpu2le16(pAd->CommonCfg.Dot11OBssScanPassiveDwell);
-			OverlapScanParam.ScanActiveDwell = cpu2le16(pAd->CommonCfg.Dot11OBssScanActiveDwell);
-			OverlapScanParam.TriggerScanInt = cpu2le16(pAd->CommonCfg.Dot11BssWidthTriggerScanInt);
-			OverlapScanParam.PassiveTalPerChannel = cpu2le16(pAd->CommonCfg.Dot11OBssScanPassiveTotalPerChannel);
-			OverlapScanParam.ActiveTalPerChannel = cpu2le16(pAd->CommonCfg.Dot11OBssScanActiveTotalPerChannel);
-			OverlapScanParam.DelayFactor = cpu2le16(pAd->CommonCfg.Dot11BssWidthChanTranDelayFactor);
-			OverlapScanParam.ScanActThre = cpu2le16(pAd->CommonCfg.Dot11OBssScanActivityThre);
-
-			MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
-						1, &OverlapScanIE,
-						1, &ScanIELen,
-						ScanIELen, &OverlapScanParam,
-						END_OF_ARGS);
+ 	/* P802.11n_D3.03, 7.3.2.60 Overlapping BSS Scan Parameters IE */
+ 	if (WMODE_CAP_N(PhyMode) &&
+		(pAd->CommonCfg.Channel <= 14) &&
+		(pAd->ApCfg.MBSSID[apidx].DesiredHtPhyInfo.bHtEnable) &&
+		(pAd->CommonCfg.HtCapability.HtCapInfo.ChannelWidth == 1)) {
+		OVERLAP_BSS_SCAN_IE OverlapScanParam;
+		unsigned char OverlapScanIE, ScanIELen;
+
+		OverlapScanIE = IE_OVERLAPBSS_SCAN_PARM;
+		ScanIELen = 14;
+		OverlapScanParam.ScanPassiveDwell = cpu2le16(pAd->CommonCfg.Dot11OBssScanPassiveDwell);
+		OverlapScanParam.ScanActiveDwell = cpu2le16(pAd->CommonCfg.Dot11OBssScanActiveDwell);
+		OverlapScanParam.TriggerScanInt = cpu2le16(pAd->CommonCfg.Dot11BssWidthTriggerScanInt);
+		OverlapScanParam.PassiveTalPerChannel = cpu2le16(pAd->CommonCfg.Dot11OBssScanPassiveTotalPerChannel);
+		OverlapScanParam.ActiveTalPerChannel = cpu2le16(pAd->CommonCfg.Dot11OBssScanActiveTotalPerChannel);
+		OverlapScanParam.DelayFactor = cpu2le16(pAd->CommonCfg.Dot11BssWidthChanTranDelayFactor);
+		OverlapScanParam.ScanActThre = cpu2le16(pAd->CommonCfg.Dot11OBssScanActivityThre);
+
+		MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
+					1, &OverlapScanIE,
+					1, &ScanIELen,
+					ScanIELen, &OverlapScanParam,
+					END_OF_ARGS);
 
-			FrameLen += TmpLen;
-	 	}
+		FrameLen += TmpLen;
+ 	}
 #endif /* DOT11N_DRAFT3 */
 #endif /* DOT11_N_SUPPORT */
 
-		/* 7.3.2.27 Extended Capabilities IE */
-		{
-			EXT_CAP_INFO_ELEMENT extCapInfo;
-			unsigned char extInfoLen;
-			unsigned long TmpLen, infoPos;
-			unsigned char * pInfo;
-			bool bNeedAppendExtIE = FALSE;
+	/* 7.3.2.27 Extended Capabilities IE */
+	{
+		EXT_CAP_INFO_ELEMENT extCapInfo;
+		unsigned char extInfoLen;
+		unsigned long TmpLen, infoPos;
+		unsigned char * pInfo;
+		bool bNeedAppendExtIE = FALSE;
 
-			extInfoLen = sizeof(EXT_CAP_INFO_ELEMENT);
-			NdisZeroMemory(&extCapInfo, extInfoLen);
+		extInfoLen = sizeof(EXT_CAP_INFO_ELEMENT);
+		NdisZeroMemory(&extCapInfo, extInfoLen);
 
 #ifdef DOT11_N_SUPPORT
 #ifdef DOT11N_DRAFT3
-			/* P802.11n_D1.10, HT Information Exchange Support */
-			if (WMODE_CAP_N(PhyMode) && (pAd->CommonCfg.Channel <= 14) &&
-				(pAd->ApCfg.MBSSID[apidx].DesiredHtPhyInfo.bHtEnable) &&
-				(pAd->CommonCfg.bBssCoexEnable == TRUE)) {
-				extCapInfo.BssCoexistMgmtSupport = 1;
-			}
+		/* P802.11n_D1.10, HT Information Exchange Support */
+		if (WMODE_CAP_N(PhyMode) && (pAd->CommonCfg.Channel <= 14) &&
+			(pAd->ApCfg.MBSSID[apidx].DesiredHtPhyInfo.bHtEnable) &&
+			(pAd->CommonCfg.bBssCoexEnable == TRUE)) {
+			extCapInfo.BssCoexistMgmtSupport = 1;
+		}
 #endif /* DOT11N_DRAFT3 */
 #endif /* DOT11_N_SUPPORT */
 
-			extCapInfo.utf8_ssid = 1;
-
-			pInfo = (unsigned char *)(&extCapInfo);
-			for (infoPos = 0; infoPos < extInfoLen; infoPos++) {
-				if (pInfo[infoPos] != 0) {
-					bNeedAppendExtIE = TRUE;
-					break;
-				}
-			}
+		extCapInfo.utf8_ssid = 1;
 
-			if (bNeedAppendExtIE == TRUE) {
-				MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
-							1, &ExtCapIe,
-							1, &extInfoLen,
-							extInfoLen, &extCapInfo,
-							END_OF_ARGS);
-				FrameLen += TmpLen;
+		pInfo = (unsigned char *)(&extCapInfo);
+		for (infoPos = 0; infoPos < extInfoLen; infoPos++) {
+			if (pInfo[infoPos] != 0) {
+				bNeedAppendExtIE = TRUE;
+				break;
 			}
 		}
 
-		/* Append RSN_IE when WPA OR WPAPSK, */
-		if (pAd->ApCfg.MBSSID[apidx].AuthMode < Ndis802_11AuthModeWPA)
-			; /* enough information */
-		else if ((pAd->ApCfg.MBSSID[apidx].AuthMode == Ndis802_11AuthModeWPA1WPA2) ||
-			(pAd->ApCfg.MBSSID[apidx].AuthMode == Ndis802_11AuthModeWPA1PSKWPA2PSK)) {
+		if (bNeedAppendExtIE == TRUE) {
 			MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
-						1, &RSNIe,
-						1, &pAd->ApCfg.MBSSID[apidx].RSNIE_Len[0],
-						pAd->ApCfg.MBSSID[apidx].RSNIE_Len[0], pAd->ApCfg.MBSSID[apidx].RSN_IE[0],
-						1, &RSNIe2,
-						1, &pAd->ApCfg.MBSSID[apidx].RSNIE_Len[1],
-						pAd->ApCfg.MBSSID[apidx].RSNIE_Len[1], pAd->ApCfg.MBSSID[apidx].RSN_IE[1],
-						END_OF_ARGS);
-			FrameLen += TmpLen;
-		} else {
-			MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
-						1, &RSNIe,
-						1, &pAd->ApCfg.MBSSID[apidx].RSNIE_Len[0],
-						pAd->ApCfg.MBSSID[apidx].RSNIE_Len[0], pAd->ApCfg.MBSSID[apidx].RSN_IE[0],
+						1, &ExtCapIe,
+						1, &extInfoLen,
+						extInfoLen, &extCapInfo,
 						END_OF_ARGS);
 			FrameLen += TmpLen;
 		}
+	}
+
+	/* Append RSN_IE when WPA OR WPAPSK, */
+	if (pAd->ApCfg.MBSSID[apidx].AuthMode < Ndis802_11AuthModeWPA)
+		; /* enough information */
+	else if ((pAd->ApCfg.MBSSID[apidx].AuthMode == Ndis802_11AuthModeWPA1WPA2) ||
+		(pAd->ApCfg.MBSSID[apidx].AuthMode == Ndis802_11AuthModeWPA1PSKWPA2PSK)) {
+		MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
+					1, &RSNIe,
+					1, &pAd->ApCfg.MBSSID[apidx].RSNIE_Len[0],
+					pAd->ApCfg.MBSSID[apidx].RSNIE_Len[0], pAd->ApCfg.MBSSID[apidx].RSN_IE[0],
+					1, &RSNIe2,
+					1, &pAd->ApCfg.MBSSID[apidx].RSNIE_Len[1],
+					pAd->ApCfg.MBSSID[apidx].RSNIE_Len[1], pAd->ApCfg.MBSSID[apidx].RSN_IE[1],
+					END_OF_ARGS);
+		FrameLen += TmpLen;
+	} else {
+		MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
+					1, &RSNIe,
+					1, &pAd->ApCfg.MBSSID[apidx].RSNIE_Len[0],
+					pAd->ApCfg.MBSSID[apidx].RSNIE_Len[0], pAd->ApCfg.MBSSID[apidx].RSN_IE[0],
+					END_OF_ARGS);
+		FrameLen += TmpLen;
+	}
 
-		/* add WMM IE here */
-		if (pAd->ApCfg.MBSSID[apidx].bWmmCapable) {
-			unsigned char i;
-			unsigned char WmeParmIe[26] = {IE_VENDOR_SPECIFIC, 24, 0x00, 0x50, 0xf2, 0x02, 0x01, 0x01, 0, 0};
-			WmeParmIe[8] = pAd->ApCfg.BssEdcaParm.EdcaUpdateCount & 0x0f;
+	/* add WMM IE here */
+	if (pAd->ApCfg.MBSSID[apidx].bWmmCapable) {
+		unsigned char i;
+		unsigned char WmeParmIe[26] = {IE_VENDOR_SPECIFIC, 24, 0x00, 0x50, 0xf2, 0x02, 0x01, 0x01, 0, 0};
+		WmeParmIe[8] = pAd->ApCfg.BssEdcaParm.EdcaUpdateCount & 0x0f;
 #ifdef UAPSD_SUPPORT
-			UAPSD_MR_IE_FILL(WmeParmIe[8], &pAd->ApCfg.MBSSID[apidx].UapsdInfo);
+		UAPSD_MR_IE_FILL(WmeParmIe[8], &pAd->ApCfg.MBSSID[apidx].UapsdInfo);
 #endif /* UAPSD_SUPPORT */
-			for (i = QID_AC_BE; i <= QID_AC_VO; i++) {
-				WmeParmIe[10 + (i * 4)] = (i << 5) +						/* b5-6 is ACI */
-							((unsigned char)pAd->ApCfg.BssEdcaParm.bACM[i] << 4) +		/* b4 is ACM */
-							(pAd->ApCfg.BssEdcaParm.Aifsn[i] & 0x0f);		/* b0-3 is AIFSN */
-				WmeParmIe[11 + (i * 4)] = (pAd->ApCfg.BssEdcaParm.Cwmax[i] << 4) +		/* b5-8 is CWMAX */
-							(pAd->ApCfg.BssEdcaParm.Cwmin[i] & 0x0f);		/* b0-3 is CWMIN */
-				WmeParmIe[12 + (i * 4)] = (unsigned char)(pAd->ApCfg.BssEdcaParm.Txop[i] & 0xff);	/* low byte of TXOP */
-				WmeParmIe[13 + (i * 4)] = (unsigned char)(pAd->ApCfg.BssEdcaParm.Txop[i] >> 8);		/* high byte of TXOP */
-			}
-
-			MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
-						26, WmeParmIe,
-						END_OF_ARGS);
-			FrameLen += TmpLen;
+		for (i = QID_AC_BE; i <= QID_AC_VO; i++) {
+			WmeParmIe[10 + (i * 4)] = (i << 5) +						/* b5-6 is ACI */
+						((unsigned char)pAd->ApCfg.BssEdcaParm.bACM[i] << 4) +		/* b4 is ACM */
+						(pAd->ApCfg.BssEdcaParm.Aifsn[i] & 0x0f);		/* b0-3 is AIFSN */
+			WmeParmIe[11 + (i * 4)] = (pAd->ApCfg.BssEdcaParm.Cwmax[i] << 4) +		/* b5-8 is CWMAX */
+						(pAd->ApCfg.BssEdcaParm.Cwmin[i] & 0x0f);		/* b0-3 is CWMIN */
+			WmeParmIe[12 + (i * 4)] = (unsigned char)(pAd->ApCfg.BssEdcaParm.Txop[i] & 0xff);	/* low byte of TXOP */
+			WmeParmIe[13 + (i * 4)] = (unsigned char)(pAd->ApCfg.BssEdcaParm.Txop[i] >> 8);		/* high byte of TXOP */
 		}
 
+		MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
+					26, WmeParmIe,
+					END_OF_ARGS);
+		FrameLen += TmpLen;
+	}
+
 #ifdef AP_QLOAD_SUPPORT
-		if (pAd->FlgQloadEnable != 0)
-			FrameLen += QBSS_LoadElementAppend(pAd, pOutBuffer + FrameLen);
+	if (pAd->FlgQloadEnable != 0)
+		FrameLen += QBSS_LoadElementAppend(pAd, pOutBuffer + FrameLen);
 #endif /* AP_QLOAD_SUPPORT */
 
-		/*
-			add Ralink-specific IE here - Byte0.b0=1 for aggregation, Byte0.b1=1 for piggy-back
-			Byte0.b3=1 for rssi-feedback
-		 */
-		{
-			unsigned char RalinkSpecificIe[9] = {IE_VENDOR_SPECIFIC, 7, 0x00, 0x0c, 0x43, 0x00, 0x00, 0x00, 0x00};
-
-			if (pAd->CommonCfg.bAggregationCapable)
-				RalinkSpecificIe[5] |= 0x1;
-			if (pAd->CommonCfg.bPiggyBackCapable)
-				RalinkSpecificIe[5] |= 0x2;
+	/*
+		add Ralink-specific IE here - Byte0.b0=1 for aggregation, Byte0.b1=1 for piggy-back
+		Byte0.b3=1 for rssi-feedback
+	 */
+	{
+		unsigned char RalinkSpecificIe[9] = {IE_VENDOR_SPECIFIC, 7, 0x00, 0x0c, 0x43, 0x00, 0x00, 0x00, 0x00};
+
+		if (pAd->CommonCfg.bAggregationCapable)
+			RalinkSpecificIe[5] |= 0x1;
+		if (pAd->CommonCfg.bPiggyBackCapable)
+			RalinkSpecificIe[5] |= 0x2;
 #ifdef DOT11_N_SUPPORT
-			if (pAd->CommonCfg.bRdg)
-				RalinkSpecificIe[5] |= 0x4;
+		if (pAd->CommonCfg.bRdg)
+			RalinkSpecificIe[5] |= 0x4;
 #endif /* DOT11_N_SUPPORT */
 
 #ifdef RSSI_FEEDBACK
-			if (bRequestRssi == TRUE) {
-				MAC_TABLE_ENTRY *pEntry = NULL;
+		if (bRequestRssi == TRUE) {
+			MAC_TABLE_ENTRY *pEntry = NULL;
 
-				DBGPRINT(RT_DEBUG_ERROR, ("SYNC - Send PROBE_RSP to %02x:%02x:%02x:%02x:%02x:%02x...\n",
-							PRINT_MAC(Addr2)));
+			DBGPRINT(RT_DEBUG_ERROR, ("SYNC - Send PROBE_RSP to %02x:%02x:%02x:%02x:%02x:%02x...\n",
+						PRINT_MAC(pAddr2)));
 
-				RalinkSpecificIe[5] |= 0x8;
-				pEntry = MacTableLookup(pAd, Addr2);
+			RalinkSpecificIe[5] |= 0x8;
+			pEntry = MacTableLookup(pAd, pAddr2);
 
-				if (pEntry != NULL) {
-					RalinkSpecificIe[6] = (unsigned char)pEntry->RssiSample.AvgRssi0;
-					RalinkSpecificIe[7] = (unsigned char)pEntry->RssiSample.AvgRssi1;
-					RalinkSpecificIe[8] = (unsigned char)pEntry->RssiSample.AvgRssi2;
-				}
+			if (pEntry != NULL) {
+				RalinkSpecificIe[6] = (unsigned char)pEntry->RssiSample.AvgRssi0;
+				RalinkSpecificIe[7] = (unsigned char)pEntry->RssiSample.AvgRssi1;
+				RalinkSpecificIe[8] = (unsigned char)pEntry->RssiSample.AvgRssi2;
 			}
+		}
 #endif /* RSSI_FEEDBACK */
+		MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
+					9, RalinkSpecificIe,
+					END_OF_ARGS);
+		FrameLen += TmpLen;
+	}
+
+#ifdef DOT11_N_SUPPORT
+	if (WMODE_CAP_N(PhyMode) &&
+		(pAd->ApCfg.MBSSID[apidx].DesiredHtPhyInfo.bHtEnable)) {
+		unsigned char HtLen, AddHtLen;/*, NewExtLen; */
+		HtLen = sizeof(pAd->CommonCfg.HtCapability);
+		AddHtLen = sizeof(pAd->CommonCfg.AddHTInfo);
+
+		if (pAd->bBroadComHT == TRUE) {
+			unsigned char epigram_ie_len;
+			unsigned char BROADCOM_HTC[4] = {0x0, 0x90, 0x4c, 0x33};
+			unsigned char BROADCOM_AHTINFO[4] = {0x0, 0x90, 0x4c, 0x34};
+
+			epigram_ie_len = HtLen + 4;
 			MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
-						9, RalinkSpecificIe,
+						1, &WpaIe,
+						1, &epigram_ie_len,
+						4, &BROADCOM_HTC[0],
+						HtLen, &pAd->CommonCfg.HtCapability,
 						END_OF_ARGS);
 			FrameLen += TmpLen;
-		}
 
-#ifdef DOT11_N_SUPPORT
-		if (WMODE_CAP_N(PhyMode) &&
-			(pAd->ApCfg.MBSSID[apidx].DesiredHtPhyInfo.bHtEnable)) {
-			unsigned char HtLen, AddHtLen;/*, NewExtLen; */
-			HtLen = sizeof(pAd->CommonCfg.HtCapability);
-			AddHtLen = sizeof(pAd->CommonCfg.AddHTInfo);
-
-			if (pAd->bBroadComHT == TRUE) {
-				unsigned char epigram_ie_len;
-				unsigned char BROADCOM_HTC[4] = {0x0, 0x90, 0x4c, 0x33};
-				unsigned char BROADCOM_AHTINFO[4] = {0x0, 0x90, 0x4c, 0x34};
-
-				epigram_ie_len = HtLen + 4;
-				MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
-							1, &WpaIe,
-							1, &epigram_ie_len,
-							4, &BROADCOM_HTC[0],
-							HtLen, &pAd->CommonCfg.HtCapability,
-							END_OF_ARGS);
-				FrameLen += TmpLen;
-
-				epigram_ie_len = AddHtLen + 4;
-				MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
-							1, &WpaIe,
-							1, &epigram_ie_len,
-							4, &BROADCOM_AHTINFO[0],
-							AddHtLen, &pAd->CommonCfg.AddHTInfo,
-							END_OF_ARGS);
-				FrameLen += TmpLen;
-			}
+			epigram_ie_len = AddHtLen + 4;
+			MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
+						1, &WpaIe,
+						1, &epigram_ie_len,
+						4, &BROADCOM_AHTINFO[0],
+						AddHtLen, &pAd->CommonCfg.AddHTInfo,
+						END_OF_ARGS);
+			FrameLen += TmpLen;
 		}
+	}
 #endif /* DOT11_N_SUPPORT */
 
 #ifdef DOT11_VHT_AC
-		if (WMODE_CAP_AC(PhyMode) &&
-			(pAd->CommonCfg.Channel > 14))
-			FrameLen += build_vht_ies(pAd, (unsigned char *)(pOutBuffer + FrameLen), SUBTYPE_PROBE_RSP);
+	if (WMODE_CAP_AC(PhyMode) &&
+		(pAd->CommonCfg.Channel > 14))
+		FrameLen += build_vht_ies(pAd, (unsigned char *)(pOutBuffer + FrameLen), SUBTYPE_PROBE_RSP);
 #endif /* DOT11_VHT_AC */
 
 #ifdef WSC_AP_SUPPORT
-		/* for windows 7 logo test */
-		if ((pAd->ApCfg.MBSSID[apidx].WscControl.WscConfMode != WSC_DISABLE) &&
+	/* for windows 7 logo test */
+	if ((pAd->ApCfg.MBSSID[apidx].WscControl.WscConfMode != WSC_DISABLE) &&
 #ifdef DOT1X_SUPPORT
-			(pAd->ApCfg.MBSSID[apidx].IEEE8021X == FALSE) &&
+		(pAd->ApCfg.MBSSID[apidx].IEEE8021X == FALSE) &&
 #endif /* DOT1X_SUPPORT */
-			(pAd->ApCfg.MBSSID[apidx].WepStatus == Ndis802_11WEPEnabled)) {
-			/*
-				Non-WPS Windows XP and Vista PCs are unable to determine if a WEP enalbed network is static key based
-				or 802.1X based. If the legacy station gets an EAP-Rquest/Identity from the AP, it assume the WEP
-				network is 802.1X enabled & will prompt the user for 802.1X credentials. If the legacy station doesn't
-				receive anything after sending an EAPOL-Start, it will assume the WEP network is static key based and
-				prompt user for the WEP key. <<from "WPS and Static Key WEP Networks">>
-				A WPS enabled AP should include this IE in the beacon when the AP is hosting a static WEP key network.
-				The IE would be 7 bytes long with the Extended Capability field set to 0 (all bits zero)
-				http://msdn.microsoft.com/library/default.asp?url=/library/en-us/randz/protocol/securing_public_wi-fi_hotspots.asp
-			*/
-			unsigned char PROVISION_SERVICE_IE[7] = {0xDD, 0x05, 0x00, 0x50, 0xF2, 0x05, 0x00};
-			MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
-						7, PROVISION_SERVICE_IE,
-						END_OF_ARGS);
-			FrameLen += TmpLen;
+		(pAd->ApCfg.MBSSID[apidx].WepStatus == Ndis802_11WEPEnabled)) {
+		/*
+			Non-WPS Windows XP and Vista PCs are unable to determine if a WEP enalbed network is static key based
+			or 802.1X based. If the legacy station gets an EAP-Rquest/Identity from the AP, it assume the WEP
+			network is 802.1X enabled & will prompt the user for 802.1X credentials. If the legacy station doesn't
+			receive anything after sending an EAPOL-Start, it will assume the WEP network is static key based and
+			prompt user for the WEP key. <<from "WPS and Static Key WEP Networks">>
+			A WPS enabled AP should include this IE in the beacon when the AP is hosting a static WEP key network.
+			The IE would be 7 bytes long with the Extended Capability field set to 0 (all bits zero)
+			http://msdn.microsoft.com/library/default.asp?url=/library/en-us/randz/protocol/securing_public_wi-fi_hotspots.asp
+		*/
+		unsigned char PROVISION_SERVICE_IE[7] = {0xDD, 0x05, 0x00, 0x50, 0xF2, 0x05, 0x00};
+		MakeOutgoingFrame(pOutBuffer + FrameLen, &TmpLen,
+					7, PROVISION_SERVICE_IE,
+					END_OF_ARGS);
+		FrameLen += TmpLen;
+	}
+
+	/* add Simple Config Information Element */
+	if ((pAd->ApCfg.MBSSID[apidx].WscControl.WscConfMode > WSC_DISABLE) && (pAd->ApCfg.MBSSID[apidx].WscIEProbeResp.ValueLen)) {
+		unsigned long WscTmpLen = 0;
+		MakeOutgoingFrame(pOutBuffer + FrameLen, &WscTmpLen,
+					pAd->ApCfg.MBSSID[apidx].WscIEProbeResp.ValueLen, pAd->ApCfg.MBSSID[apidx].WscIEProbeResp.Value,
+					END_OF_ARGS);
+		FrameLen += WscTmpLen;
+	}
+#endif /* WSC_AP_SUPPORT */
+
+	return FrameLen;
+}
+
+
+#ifdef PROBE_CACHE_SUPPORT
+/*
+	A crowd of scanning phones sends a flood of mostly wildcard ProbeReq.
+	APProbeReqSuppress() drops a ProbeReq before any BSS is looked at when
+	its station sent more than PROBE_RATE_MAX of them in PROBE_RATE_WINDOW,
+	or when it repeats the wildcard ProbeReq it sent within
+	PROBE_DUP_WINDOW. Stations share a slot of pAd->ApCfg.ProbeSrcTab by
+	a hash of their address, a new station simply takes the slot over.
+
+	The answer of every BSS is kept in pMbss->pProbeRspCache and sent
+	again with only Addr1 changed, the sequence number is given when it
+	is transmitted. APBeaconSegDirty() drops the cache with anything that
+	changes the beacon, and it is rebuilt after PROBE_CACHE_AGE for
+	changes nobody marked, such as the QBSS load station count. A frame
+	built while APBeaconSegDirty() ran is sent but not kept, its
+	ProbeRspGen tells.
+*/
+static unsigned int APProbeReqSum(
+	IN unsigned char *pIe,
+	IN unsigned long Len)
+{
+	unsigned int Sum = Len;
+
+	while (Len-- > 0)
+		Sum = ((Sum << 5) | (Sum >> 27)) ^ *pIe++;
+
+	return Sum;
+}
+
+
+static bool APProbeReqSuppress(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char *pAddr2,
+	IN unsigned char SsidLen,
+	IN VOID *pMsg,
+	IN unsigned long MsgLen)
+{
+	PROBE_SRC_ENTRY *pSrc;
+	unsigned long Now;
+	unsigned int Sum;
+
+	NdisGetSystemUpTime(&Now);
+
+	pSrc = &pAd->ApCfg.ProbeSrcTab[(pAddr2[3] ^ pAddr2[4] ^ pAddr2[5]) & (PROBE_SRC_TAB_SIZE - 1)];
+	if (!MAC_ADDR_EQUAL(pSrc->Addr, pAddr2))
+	{
+		NdisZeroMemory(pSrc, sizeof(PROBE_SRC_ENTRY));
+		COPY_MAC_ADDR(pSrc->Addr, pAddr2);
+		pSrc->WinStart = Now;
+	}
+
+	if ((SsidLen == 0) && (MsgLen > LENGTH_802_11))
+	{
+		Sum = APProbeReqSum((unsigned char *)pMsg + LENGTH_802_11, MsgLen - LENGTH_802_11);
+
+		if ((pSrc->LastWildcard != 0) && (Sum == pSrc->WildcardSum) &&
+			RTMP_TIME_BEFORE(Now, pSrc->LastWildcard + PROBE_DUP_WINDOW))
+		{
+			pAd->ApCfg.ProbeDupDropCnt++;
+			return TRUE;
 		}
 
-		/* add Simple Config Information Element */
-		if ((pAd->ApCfg.MBSSID[apidx].WscControl.WscConfMode > WSC_DISABLE) && (pAd->ApCfg.MBSSID[apidx].WscIEProbeResp.ValueLen)) {
-			unsigned long WscTmpLen = 0;
-			MakeOutgoingFrame(pOutBuffer + FrameLen, &WscTmpLen,
-						pAd->ApCfg.MBSSID[apidx].WscIEProbeResp.ValueLen, pAd->ApCfg.MBSSID[apidx].WscIEProbeResp.Value,
-						END_OF_ARGS);
-			FrameLen += WscTmpLen;
+		pSrc->WildcardSum = Sum;
+		pSrc->LastWildcard = Now;
+	}
+
+	if (RTMP_TIME_AFTER(Now, pSrc->WinStart + PROBE_RATE_WINDOW))
+	{
+		pSrc->WinStart = Now;
+		pSrc->Count = 0;
+	}
+
+	if (pSrc->Count >= PROBE_RATE_MAX)
+	{
+		pAd->ApCfg.ProbeRateDropCnt++;
+		return TRUE;
+	}
+
+	pSrc->Count++;
+
+	return FALSE;
+}
+
+
+static unsigned long APProbeRspCacheFill(
+	IN PRTMP_ADAPTER pAd,
+	IN INT apidx,
+	IN unsigned char *pAddr2,
+	IN bool bRequestRssi,
+	IN unsigned char *pOutBuffer)
+{
+	MULTISSID_STRUCT *pMbss = &pAd->ApCfg.MBSSID[apidx];
+	unsigned long FrameLen, Now;
+	unsigned int Gen;
+	bool bCacheable = TRUE;
+
+	NdisGetSystemUpTime(&Now);
+
+#ifdef RSSI_FEEDBACK
+	/* carries the RSSI of the asking station */
+	if (bRequestRssi == TRUE)
+		bCacheable = FALSE;
+#endif /* RSSI_FEEDBACK */
+#ifdef A_BAND_SUPPORT
+	/* the channel switch count moves */
+	if ((pAd->CommonCfg.Channel > 14) &&
+		(pAd->CommonCfg.bIEEE80211H == 1) &&
+		(pAd->Dot11_H.RDMode == RD_SWITCHING_MODE))
+		bCacheable = FALSE;
+#endif /* A_BAND_SUPPORT */
+
+	if (bCacheable && (pMbss->ProbeRspCacheLen != 0) && !pMbss->bProbeRspStale &&
+		RTMP_TIME_BEFORE(Now, pMbss->ProbeRspCacheTime + PROBE_CACHE_AGE))
+	{
+		NdisMoveMemory(pOutBuffer, pMbss->pProbeRspCache, pMbss->ProbeRspCacheLen);
+		COPY_MAC_ADDR(((PHEADER_802_11)pOutBuffer)->Addr1, pAddr2);
+		pAd->ApCfg.ProbeCacheHitCnt++;
+
+		return pMbss->ProbeRspCacheLen;
+	}
+
+	pAd->ApCfg.ProbeCacheMissCnt++;
+	Gen = pMbss->ProbeRspGen;
+	FrameLen = APMakeProbeRsp(pAd, apidx, pAddr2, bRequestRssi, pOutBuffer);
+
+	if (!bCacheable || (FrameLen > MGMT_DMA_BUFFER_SIZE))
+		return FrameLen;
+
+	/* the beacon changed under APMakeProbeRsp(), the frame may be half old */
+	if (pMbss->ProbeRspGen != Gen)
+		return FrameLen;
+
+	if (pMbss->pProbeRspCache == NULL)
+	{
+		os_alloc_mem(pAd, &pMbss->pProbeRspCache, MGMT_DMA_BUFFER_SIZE);
+		if (pMbss->pProbeRspCache == NULL)
+			return FrameLen;
+	}
+
+	NdisMoveMemory(pMbss->pProbeRspCache, pOutBuffer, FrameLen);
+	pMbss->ProbeRspCacheLen = FrameLen;
+	pMbss->ProbeRspCacheTime = Now;
+	pMbss->bProbeRspStale = FALSE;
+
+	return FrameLen;
+}
+
+
+VOID APProbeRspCacheFree(
+	IN PRTMP_ADAPTER pAd)
+{
+	INT i;
+
+	for (i = 0; i < HW_BEACON_MAX_NUM; i++)
+	{
+		MULTISSID_STRUCT *pMbss = &pAd->ApCfg.MBSSID[i];
+
+		if (pMbss->pProbeRspCache != NULL)
+			os_free_mem(pAd, pMbss->pProbeRspCache);
+		pMbss->pProbeRspCache = NULL;
+		pMbss->ProbeRspCacheLen = 0;
+	}
+}
+
+
+INT Show_ProbeCache_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	unsigned long Now;
+	INT i;
+
+	NdisGetSystemUpTime(&Now);
+
+	DBGPRINT(RT_DEBUG_OFF, ("CacheHit=%ld, CacheMiss=%ld, RateDrop=%ld, DupDrop=%ld\n",
+				pAd->ApCfg.ProbeCacheHitCnt, pAd->ApCfg.ProbeCacheMissCnt,
+				pAd->ApCfg.ProbeRateDropCnt, pAd->ApCfg.ProbeDupDropCnt));
+
+	for (i = 0; i < pAd->ApCfg.BssidNum; i++)
+	{
+		MULTISSID_STRUCT *pMbss = &pAd->ApCfg.MBSSID[i];
+
+		DBGPRINT(RT_DEBUG_OFF, ("BSS%d: Len=%ld, Age=%ld ms, Stale=%d\n",
+					i, pMbss->ProbeRspCacheLen,
+					(pMbss->ProbeRspCacheLen != 0) ? ((Now - pMbss->ProbeRspCacheTime) * 1000 / OS_HZ) : 0,
+					pMbss->bProbeRspStale));
+	}
+
+	return TRUE;
+}
+#endif /* PROBE_CACHE_SUPPORT */
+
+
+/*
+	==========================================================================
+	Description:
+		Process the received ProbeRequest from clients
+	Parameters:
+		Elem - msg containing the ProbeReq frame
+	==========================================================================
+ */
+VOID APPeerProbeReqAction(
+	IN PRTMP_ADAPTER pAd,
+	IN MLME_QUEUE_ELEM *Elem)
+{
+	unsigned char Addr2[MAC_ADDR_LEN];
+	CHAR Ssid[MAX_LEN_OF_SSID];
+	unsigned char SsidLen;
+	NDIS_STATUS NStatus;
+	unsigned char * pOutBuffer = NULL;
+	unsigned long FrameLen = 0;
+	unsigned char apidx = 0;
+	bool	bRequestRssi = FALSE;
+
+#ifdef WSC_AP_SUPPORT
+	unsigned char Addr3[MAC_ADDR_LEN];
+	PFRAME_802_11 pFrame = (PFRAME_802_11)Elem->Msg;
+
+	COPY_MAC_ADDR(Addr3, pFrame->Hdr.Addr3);
+#endif /* WSC_AP_SUPPORT */
+
+#ifdef WDS_SUPPORT
+	/* if in bridge mode, no need to reply probe req. */
+	if (pAd->WdsTab.Mode == WDS_BRIDGE_MODE)
+		return;
+#endif /* WDS_SUPPORT */
+
+	if (!PeerProbeReqSanity(pAd, Elem->Msg, Elem->MsgLen, Addr2, Ssid, &SsidLen, &bRequestRssi))
+		return;
+
+#ifdef PROBE_CACHE_SUPPORT
+	if (APProbeReqSuppress(pAd, Addr2, SsidLen, Elem->Msg, Elem->MsgLen))
+		return;
+#endif /* PROBE_CACHE_SUPPORT */
+
+	for (apidx = 0; apidx < pAd->ApCfg.BssidNum; apidx++) {
+		if ((pAd->ApCfg.MBSSID[apidx].MSSIDDev != NULL) &&
+			!(RTMP_OS_NETDEV_STATE_RUNNING(pAd->ApCfg.MBSSID[apidx].MSSIDDev))) {
+			/* the interface is down, so we can not send probe response */
+			continue;
 		}
+
+		if (((SsidLen == 0) && (! pAd->ApCfg.MBSSID[apidx].bHideSsid)) ||
+#ifdef WSC_AP_SUPPORT
+		/* buffalo WPS testbed STA send ProbrRequest ssid length = 32 and ssid are not AP , but DA are AP. for WPS test send ProbeResponse */
+			((SsidLen == 32) && MAC_ADDR_EQUAL(Addr3, pAd->ApCfg.MBSSID[apidx].Bssid) && (pAd->ApCfg.MBSSID[apidx].bHideSsid == 0)) ||
 #endif /* WSC_AP_SUPPORT */
+			((SsidLen == pAd->ApCfg.MBSSID[apidx].SsidLen) && NdisEqualMemory(Ssid, pAd->ApCfg.MBSSID[apidx].Ssid, (unsigned long) SsidLen)))
+			;
+		else
+			continue; /* check next BSS */
+
+		/* allocate and send out ProbeRsp frame */
+		NStatus = MlmeAllocateMemory(pAd, &pOutBuffer);
+		if (NStatus != NDIS_STATUS_SUCCESS)
+			return;
+
+#ifdef PROBE_CACHE_SUPPORT
+		FrameLen = APProbeRspCacheFill(pAd, apidx, Addr2, bRequestRssi, pOutBuffer);
+#else
+		FrameLen = APMakeProbeRsp(pAd, apidx, Addr2, bRequestRssi, pOutBuffer);
+#endif /* PROBE_CACHE_SUPPORT */
 
 #ifdef DOT11_N_SUPPORT
 		/* 802.11n 11.1.3.2.2 active scanning. sending probe response with MCS rate is */
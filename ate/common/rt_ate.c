@@ -1917,7 +1917,7 @@ static NDIS_STATUS ATESTOP(
 	for (ring_index = 0; ring_index < (RX_RING_SIZE); ring_index++)
 	{
 		PRX_CONTEXT  pRxContext = &(pAd->RxContext[ring_index]);
-		NdisZeroMemory(pRxContext->TransferBuffer, MAX_RXBULK_SIZE);
+		NdisZeroMemory(pRxContext->TransferBuffer, pAd->RxBulkSize);
 
 		pRxContext->pAd	= pAd;
 		pRxContext->pIrp = NULL;
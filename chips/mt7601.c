@@ -75,7 +75,7 @@ static RTMP_REG_PAIR	MT7601_MACRegTable[] = {
 	{TX_SW_CFG2,		0x0},			// 20120822 Gary
 
 #ifdef HDR_TRANS_SUPPORT
-	{HEADER_TRANS_CTRL_REG, 0x2},
+	{HEADER_TRANS_CTRL_REG, HT_TX_ENABLE | HT_RX_ENABLE},	/* TX is chosen per frame by the TXINFO 802.11 bit */
 #else
 	{HEADER_TRANS_CTRL_REG, 0x0},
 #endif /* HDR_TRANS_SUPPORT */
@@ -986,6 +986,9 @@ Note:
 */
 static VOID NICInitMT7601RFRegisters(RTMP_ADAPTER *pAd)
 {
+#ifdef BOOT_PROF_SUPPORT
+	unsigned int CalBegin;
+#endif /* BOOT_PROF_SUPPORT */
 
 	DBGPRINT(RT_DEBUG_TRACE, ("%s\n", __FUNCTION__));
 
@@ -1001,7 +1004,13 @@ static VOID NICInitMT7601RFRegisters(RTMP_ADAPTER *pAd)
 
 	AndesRFRandomWritePair(pAd, MT7601_RF_VGA_RegTb, MT7601_RF_VGA_RegTb_Size);
 
+#ifdef BOOT_PROF_SUPPORT
+	BOOT_PROF_STEP_BEGIN(CalBegin);
+#endif /* BOOT_PROF_SUPPORT */
 	MT7601_INIT_CAL(pAd);
+#ifdef BOOT_PROF_SUPPORT
+	BootProfStepEnd(pAd, BOOT_PROF_INIT_CAL, CalBegin);
+#endif /* BOOT_PROF_SUPPORT */
 
 
 }
@@ -1162,6 +1171,10 @@ static VOID MT7601_ChipSwitchChannel(
 	CHAR SkuBasePwr;
 	CHAR ChannelPwrAdj;
 #endif /* SINGLE_SKU_V2 */
+#ifdef MCU_ASYNC_CMD_SUPPORT
+	unsigned long SwitchCmdBase;
+	unsigned int SwitchBegin;
+#endif /* MCU_ASYNC_CMD_SUPPORT */
 
 	RTMP_CHIP_CAP *pChipCap = &pAd->chipCap;
 	
@@ -1223,6 +1236,12 @@ static VOID MT7601_ChipSwitchChannel(
 	}
 #endif /* RTMP_MAC_USB */
 
+#ifdef MCU_ASYNC_CMD_SUPPORT
+	SwitchBegin = RtmpOsGetUsecTime();
+	SwitchCmdBase = pAd->MCUCtrl.CmdCnt;
+	AndesBatchBegin(pAd);
+#endif /* MCU_ASYNC_CMD_SUPPORT */
+
 #if 0
 	for (index = 0; index < NUM_OF_MT7601_CHNL; index++)
 	{
@@ -1340,6 +1359,13 @@ static VOID MT7601_ChipSwitchChannel(
 	}
 	RTMP_IO_WRITE32(pAd, TX_PWR_CFG_0, pAd->Tx20MPwrCfgGBand[0]);
 
+#ifdef MCU_ASYNC_CMD_SUPPORT
+	AndesBatchEnd(pAd);
+	pAd->MCUCtrl.SwitchChCnt++;
+	pAd->MCUCtrl.SwitchChCmds = pAd->MCUCtrl.CmdCnt - SwitchCmdBase;
+	pAd->MCUCtrl.SwitchChCmdTotal += pAd->MCUCtrl.SwitchChCmds;
+	pAd->MCUCtrl.SwitchChUsec = RtmpOsGetUsecTime() - SwitchBegin;
+#endif /* MCU_ASYNC_CMD_SUPPORT */
 
 #ifdef RTMP_MAC_USB
 	if (IS_USB_INF(pAd))
@@ -2110,22 +2136,34 @@ VOID MT7601AsicTemperatureCompensation(
 	if (CurrentTemper < -50) { // ( 20 - 25 ) * 10 = -50
 		if (pAd->chipCap.bPllLockProtect == FALSE) {
 			pAd->chipCap.bPllLockProtect = TRUE;
+#ifdef PHY_SHADOW_SUPPORT
+			PhyShadowRfModify(pAd, RF_BANK4, RF_R04, 0xFF, 0x06);
+			PhyShadowRfModify(pAd, RF_BANK4, RF_R10, 0x30, 0x00);
+			PhyShadowCommit(pAd);
+#else
 			rlt_rf_write(pAd, RF_BANK4, RF_R04, 0x06);
 
 			rlt_rf_read(pAd, RF_BANK4, RF_R10, &RfReg);
 			RfReg = RfReg & ~0x30;
 			rlt_rf_write(pAd, RF_BANK4, RF_R10, RfReg);
+#endif /* PHY_SHADOW_SUPPORT */
 
 			DBGPRINT(RT_DEBUG_TRACE, ("%s::Enable PLL Lock Protect.\n", __FUNCTION__));
 		}
 	} else if (CurrentTemper > 50) { // ( 30 - 25 ) * 10 = 50
 		if (pAd->chipCap.bPllLockProtect == TRUE) {
 			pAd->chipCap.bPllLockProtect = FALSE;
+#ifdef PHY_SHADOW_SUPPORT
+			PhyShadowRfModify(pAd, RF_BANK4, RF_R04, 0xFF, 0x00);
+			PhyShadowRfModify(pAd, RF_BANK4, RF_R10, 0x30, 0x10);
+			PhyShadowCommit(pAd);
+#else
 			rlt_rf_write(pAd, RF_BANK4, RF_R04, 0x0);
 
 			rlt_rf_read(pAd, RF_BANK4, RF_R10, &RfReg);
 			RfReg = (RfReg & ~0x30) | 0x10;
 			rlt_rf_write(pAd, RF_BANK4, RF_R10, RfReg);
+#endif /* PHY_SHADOW_SUPPORT */
 
 			DBGPRINT(RT_DEBUG_TRACE, ("%s::Disable PLL Lock Protect.\n", __FUNCTION__));
 		}
@@ -3138,9 +3176,11 @@ VOID MT7601_Init(RTMP_ADAPTER *pAd)
 #ifdef HDR_TRANS_SUPPORT
 	if (1) {
 		//unsigned int RegVal;
+		unsigned int Wcid;
 
-		/* enable TX/RX Header Translation */
-		RTMP_IO_WRITE32(pAd, HT_RX_WCID_EN_BASE , 0xFF);	/* all RX WCID enable */
+		/* RX Header Translation is enabled per WCID, see HdrTransEntrySet */
+		for (Wcid = 0; Wcid < MAX_LEN_OF_MAC_TABLE; Wcid += HT_RX_WCID_OFFSET)
+			HdrTransRxWcidWrite(pAd, (unsigned char)Wcid);
 
 		/* black list - skip EAP-888e/DLS-890d */
 		RTMP_IO_WRITE32(pAd, HT_RX_BL_BASE, 0x888e890d);
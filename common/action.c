@@ -891,6 +891,7 @@ VOID PeerHTAction(
 				pEntry->MmpsMode = MMPS_DYNAMIC;
 
 			DBGPRINT(RT_DEBUG_TRACE,("Aid(%d) MIMO PS = %d\n", Elem->Wcid, pEntry->MmpsMode));
+			MacTableAggUpdate(pAd, pEntry);
 			/* rt2860c : add something for smps change.*/
 			break;
  
@@ -17,6 +17,10 @@
 #define RESET_RCV_SEQ		(0xFFFF)
 
 static void ba_mpdu_blk_free(PRTMP_ADAPTER pAd, struct reordering_mpdu *mpdu_blk);
+#ifdef BA_HRTIMER_SUPPORT
+static bool ba_flush_due_clear(PRTMP_ADAPTER pAd, unsigned short Idx);
+static VOID ba_flush_reordering_expired_mpdus(PRTMP_ADAPTER pAd, PBA_REC_ENTRY pBAEntry);
+#endif /* BA_HRTIMER_SUPPORT */
 
 
 BA_ORI_ENTRY *BATableAllocOriEntry(
@@ -43,8 +47,30 @@ VOID BARecSessionIdleTimeout(
 BUILD_TIMER_FUNCTION(BAOriSessionSetupTimeout);
 BUILD_TIMER_FUNCTION(BARecSessionIdleTimeout);
 
+#ifdef BA_HRTIMER_SUPPORT
+static inline VOID ba_reorder_hold_record(
+	IN PRTMP_ADAPTER pAd,
+	IN struct reordering_mpdu *mpdu_blk)
+{
+	unsigned int Hold = RtmpOsGetUsecTime() - mpdu_blk->RxTime;
+	INT Bucket = 0;
+
+	Hold >>= 8;
+	while ((Hold != 0) && (Bucket < BA_HOLD_BUCKET - 1))
+	{
+		Hold >>= 1;
+		Bucket++;
+	}
+	pAd->BaHoldHist[Bucket]++;
+}
+
+#define ANNOUNCE_REORDERING_PACKET(_pAd, _mpdu_blk)	\
+			ba_reorder_hold_record(_pAd, _mpdu_blk);	\
+			Announce_Reordering_Packet(_pAd, _mpdu_blk);
+#else
 #define ANNOUNCE_REORDERING_PACKET(_pAd, _mpdu_blk)	\
 			Announce_Reordering_Packet(_pAd, _mpdu_blk);
+#endif /* BA_HRTIMER_SUPPORT */
 
 VOID BA_MaxWinSizeReasign(
 	IN PRTMP_ADAPTER	pAd,
@@ -134,34 +160,25 @@ void Announce_Reordering_Packet(IN PRTMP_ADAPTER			pAd,
 	}
 }
 
+#define BA_REORDER_SLOT_BUSY(_list, _slot)	\
+			((_list)->bitmap[(_slot) >> 5] & (1 << ((_slot) & 0x1f)))
+
 /*
- * Insert a reordering mpdu into sorted linked list by sequence no.
+ * Put a reordering mpdu into the slot of its sequence no.
+ * Returns FALSE if the slot is taken, by the same frame or by a stale one.
  */
 bool ba_reordering_mpdu_insertsorted(struct reordering_list *list, struct reordering_mpdu *mpdu)
 {
+	unsigned int slot = BA_REORDER_SLOT(mpdu->Sequence);
 
-	struct reordering_mpdu **ppScan = &list->next;
-
-	while (*ppScan != NULL)
+	if (BA_REORDER_SLOT_BUSY(list, slot))
 	{
-		if (SEQ_SMALLER((*ppScan)->Sequence, mpdu->Sequence, MAXSEQ))
-		{
-			ppScan = &(*ppScan)->next;          
-		}
-		else if ((*ppScan)->Sequence == mpdu->Sequence)
-		{
-			/* give up this duplicated frame */
-			return(FALSE);         
-		}
-		else
-		{
-			/* find position */
-			break;
-		}
+		/* give up this duplicated frame */
+		return(FALSE);
 	}
 
-	mpdu->next = *ppScan;
-	*ppScan = mpdu;
+	list->slot[slot] = mpdu;
+	list->bitmap[slot >> 5] |= (1 << (slot & 0x1f));
 	list->qlen++;
 	return TRUE;
 }
@@ -170,7 +187,7 @@ bool ba_reordering_mpdu_insertsorted(struct reordering_list *list, struct reorde
 /*
  * caller lock critical section if necessary
  */
-static inline void ba_enqueue(struct reordering_list *list, struct reordering_mpdu *mpdu_blk)
+static inline void ba_enqueue(struct reordering_freelist *list, struct reordering_mpdu *mpdu_blk)
 {
 	list->qlen++;
 	mpdu_blk->next = list->next;
@@ -180,7 +197,7 @@ static inline void ba_enqueue(struct reordering_list *list, struct reordering_mp
 /*
  * caller lock critical section if necessary
  */
-static inline struct reordering_mpdu * ba_dequeue(struct reordering_list *list)
+static inline struct reordering_mpdu * ba_dequeue(struct reordering_freelist *list)
 {
 	struct reordering_mpdu *mpdu_blk = NULL;
 
@@ -200,18 +217,48 @@ static inline struct reordering_mpdu * ba_dequeue(struct reordering_list *list)
 }
 
 
-static inline struct reordering_mpdu  *ba_reordering_mpdu_dequeue(struct reordering_list *list)
+/*
+ * take the mpdu out of a slot, NULL if the slot is empty
+ */
+static inline struct reordering_mpdu  *ba_reordering_mpdu_dequeue(struct reordering_list *list, unsigned int slot)
 {
-	return(ba_dequeue(list));
+	struct reordering_mpdu *mpdu_blk;
+
+	if (!BA_REORDER_SLOT_BUSY(list, slot))
+		return NULL;
+
+	mpdu_blk = list->slot[slot];
+	list->slot[slot] = NULL;
+	list->bitmap[slot >> 5] &= ~(1 << (slot & 0x1f));
+	list->qlen--;
+	return mpdu_blk;
 }
 
 
-static inline struct reordering_mpdu  *ba_reordering_mpdu_probe(struct reordering_list *list)
-	{
-	ASSERT(list);
+/*
+ * the mpdu carrying Sequence, if it has been received
+ */
+static inline struct reordering_mpdu  *ba_reordering_mpdu_probe(struct reordering_list *list, unsigned short Sequence)
+{
+	unsigned int slot = BA_REORDER_SLOT(Sequence);
 
-		return(list->next);
-	}
+	if (BA_REORDER_SLOT_BUSY(list, slot) && (list->slot[slot]->Sequence == Sequence))
+		return list->slot[slot];
+
+	return NULL;
+}
+
+
+/*
+ * first sequence no. that can be buffered, everything up to LastIndSeq is gone
+ */
+static inline unsigned short ba_reordering_window_start(PBA_REC_ENTRY pBAEntry)
+{
+	if (pBAEntry->LastIndSeq == RESET_RCV_SEQ)
+		return 0;
+
+	return (pBAEntry->LastIndSeq + 1) & MAXSEQ;
+}
 
 
 /* 
@@ -223,6 +270,7 @@ void ba_reordering_resource_release(PRTMP_ADAPTER pAd)
 	PBA_REC_ENTRY   pBAEntry;
 	struct reordering_mpdu *mpdu_blk;
 	int i;
+	unsigned int slot;
 
 	Tab = &pAd->BATable;
 
@@ -233,8 +281,15 @@ void ba_reordering_resource_release(PRTMP_ADAPTER pAd)
 		pBAEntry = &Tab->BARecEntry[i];
 		if (pBAEntry->REC_BA_Status != Recipient_NONE)
 		{
-			while ((mpdu_blk = ba_reordering_mpdu_dequeue(&pBAEntry->list)))
+#ifdef BA_HRTIMER_SUPPORT
+			RtmpOsHrTimerCancel(&pBAEntry->FlushTimer);
+#endif /* BA_HRTIMER_SUPPORT */
+			for (slot = 0; (slot < BA_REORDER_SLOT_NUM) && (pBAEntry->list.qlen > 0); slot++)
 			{
+				mpdu_blk = ba_reordering_mpdu_dequeue(&pBAEntry->list, slot);
+				if (mpdu_blk == NULL)
+					continue;
+
 				ASSERT(mpdu_blk->pPacket);
 				RELEASE_NDIS_PACKET(pAd, mpdu_blk->pPacket, NDIS_STATUS_FAILURE);
 				ba_mpdu_blk_free(pAd, mpdu_blk);
@@ -260,7 +315,7 @@ bool ba_reordering_resource_init(PRTMP_ADAPTER pAd, int num)
 	int     i;
 	unsigned char *  mem;
 	struct reordering_mpdu *mpdu_blk;
-	struct reordering_list *freelist;
+	struct reordering_freelist *freelist;
 
 	/* allocate spinlock */
 	NdisAllocateSpinLock(pAd, &pAd->mpdu_blk_pool.lock);
@@ -335,25 +390,26 @@ static unsigned short ba_indicate_reordering_mpdus_in_order(
 {
 	struct reordering_mpdu *mpdu_blk;
 	unsigned short  LastIndSeq = RESET_RCV_SEQ;
+	unsigned short  NextSeq;
 
 	NdisAcquireSpinLock(&pBAEntry->RxReRingLock);
 
-	while ((mpdu_blk = ba_reordering_mpdu_probe(&pBAEntry->list)))
-		{
-			/* find in-order frame */
-		if (!SEQ_STEPONE(mpdu_blk->Sequence, StartSeq, MAXSEQ))
-			{
-				break;
-			}
-			/* dequeue in-order frame from reodering list */
-			mpdu_blk = ba_reordering_mpdu_dequeue(&pBAEntry->list);
-			/* pass this frame up */
+	/* walk the occupied slots following StartSeq until the first hole */
+	while (pBAEntry->list.qlen > 0)
+	{
+		NextSeq = (StartSeq + 1) & MAXSEQ;
+		if (ba_reordering_mpdu_probe(&pBAEntry->list, NextSeq) == NULL)
+			break;
+
+		/* dequeue in-order frame from reodering list */
+		mpdu_blk = ba_reordering_mpdu_dequeue(&pBAEntry->list, BA_REORDER_SLOT(NextSeq));
+		/* pass this frame up */
 		ANNOUNCE_REORDERING_PACKET(pAd, mpdu_blk);
 		/* move to next sequence */
-			StartSeq = mpdu_blk->Sequence;
+		StartSeq = NextSeq;
 		LastIndSeq = StartSeq;
 		/* free mpdu_blk */
-			ba_mpdu_blk_free(pAd, mpdu_blk);
+		ba_mpdu_blk_free(pAd, mpdu_blk);
 	}
 
 	NdisReleaseSpinLock(&pBAEntry->RxReRingLock);
@@ -368,24 +424,28 @@ static void ba_indicate_reordering_mpdus_le_seq(
 											   IN unsigned short           Sequence)
 {
 	struct reordering_mpdu *mpdu_blk;
+	unsigned short Seq;
+	unsigned int i;
 
 	NdisAcquireSpinLock(&pBAEntry->RxReRingLock);
-	while ((mpdu_blk = ba_reordering_mpdu_probe(&pBAEntry->list)))
-		{
-			/* find in-order frame */
-		if ((mpdu_blk->Sequence == Sequence) || SEQ_SMALLER(mpdu_blk->Sequence, Sequence, MAXSEQ))
+
+	/* buffered frames all lie within BA_REORDER_SLOT_NUM after LastIndSeq */
+	Seq = ba_reordering_window_start(pBAEntry);
+	for (i = 0; (i < BA_REORDER_SLOT_NUM) && (pBAEntry->list.qlen > 0); i++)
+	{
+		if ((Seq != Sequence) && !SEQ_SMALLER(Seq, Sequence, MAXSEQ))
+			break;
+
+		mpdu_blk = ba_reordering_mpdu_dequeue(&pBAEntry->list, BA_REORDER_SLOT(Seq));
+		if (mpdu_blk != NULL)
 		{
-			/* dequeue in-order frame from reodering list */
-			mpdu_blk = ba_reordering_mpdu_dequeue(&pBAEntry->list);
 			/* pass this frame up */
 			ANNOUNCE_REORDERING_PACKET(pAd, mpdu_blk);
 			/* free mpdu_blk */
 			ba_mpdu_blk_free(pAd, mpdu_blk);            
 		}
-		else
-			{
-				break;
-			}
+
+		Seq = (Seq + 1) & MAXSEQ;
 	}
 	NdisReleaseSpinLock(&pBAEntry->RxReRingLock);   
 }
@@ -396,19 +456,23 @@ static void ba_refresh_reordering_mpdus(
 									   PBA_REC_ENTRY       pBAEntry)
 {
 	struct reordering_mpdu *mpdu_blk;
+	unsigned int slot, i;
 
 	NdisAcquireSpinLock(&pBAEntry->RxReRingLock);
 
-			/* dequeue in-order frame from reodering list */
-	while ((mpdu_blk = ba_reordering_mpdu_dequeue(&pBAEntry->list)))
+	/* pass every buffered frame up in sequence order */
+	slot = BA_REORDER_SLOT(ba_reordering_window_start(pBAEntry));
+	for (i = 0; (i < BA_REORDER_SLOT_NUM) && (pBAEntry->list.qlen > 0); i++)
 	{
-			/* pass this frame up */
+		mpdu_blk = ba_reordering_mpdu_dequeue(&pBAEntry->list, slot);
+		slot = BA_REORDER_SLOT(slot + 1);
+		if (mpdu_blk == NULL)
+			continue;
+
 		ANNOUNCE_REORDERING_PACKET(pAd, mpdu_blk);
 
 		pBAEntry->LastIndSeq = mpdu_blk->Sequence;
-			ba_mpdu_blk_free(pAd, mpdu_blk);
-			
-		/* update last indicated sequence */                    
+		ba_mpdu_blk_free(pAd, mpdu_blk);
 	}
 	ASSERT(pBAEntry->list.qlen == 0);
 	pBAEntry->LastIndSeq = RESET_RCV_SEQ;
@@ -920,6 +984,7 @@ VOID BAOriSessionTearDown(
 			{
 				NdisZeroMemory(&DelbaReq, sizeof(DelbaReq));
 				NdisZeroMemory(Elem, sizeof(MLME_QUEUE_ELEM));
+				MLME_ELEM_MSG_INIT(Elem);
 			
 				COPY_MAC_ADDR(DelbaReq.Addr, pAd->MacTab.Content[Wcid].Addr);
 				DelbaReq.Wcid = Wcid;
@@ -955,6 +1020,7 @@ VOID BAOriSessionTearDown(
 		{
 			NdisZeroMemory(&DelbaReq, sizeof(DelbaReq));
 			NdisZeroMemory(Elem, sizeof(MLME_QUEUE_ELEM));
+			MLME_ELEM_MSG_INIT(Elem);
 		
 			COPY_MAC_ADDR(DelbaReq.Addr, pAd->MacTab.Content[Wcid].Addr);
 			DelbaReq.Wcid = Wcid;
@@ -1027,6 +1093,7 @@ VOID BARecSessionTearDown(
 			{
 				NdisZeroMemory(&DelbaReq, sizeof(DelbaReq));
 				NdisZeroMemory(Elem, sizeof(MLME_QUEUE_ELEM));
+				MLME_ELEM_MSG_INIT(Elem);
 			
 				COPY_MAC_ADDR(DelbaReq.Addr, pAd->MacTab.Content[Wcid].Addr);
 				DelbaReq.Wcid = Wcid;
@@ -1725,6 +1792,9 @@ static VOID ba_enqueue_reordering_packet(
 		RTMP_SET_PACKET_IF(pRxBlk->pRxPacket, FromWhichBSSID);
 
 		mpdu_blk->pPacket = pRxBlk->pRxPacket;
+#ifdef BA_HRTIMER_SUPPORT
+		mpdu_blk->RxTime = RtmpOsGetUsecTime();
+#endif /* BA_HRTIMER_SUPPORT */
 
 		if (ba_reordering_mpdu_insertsorted(&pBAEntry->list, mpdu_blk) == FALSE)
 		{
@@ -1732,6 +1802,13 @@ static VOID ba_enqueue_reordering_packet(
 			RELEASE_NDIS_PACKET(pAd, pRxBlk->pRxPacket, NDIS_STATUS_SUCCESS);                     
 			ba_mpdu_blk_free(pAd, mpdu_blk);
 		}
+#ifdef BA_HRTIMER_SUPPORT
+		else if (!RtmpOsHrTimerPending(&pBAEntry->FlushTimer))
+		{
+			/* an armed timer belongs to an older frame and re-arms itself */
+			RtmpOsHrTimerStart(&pBAEntry->FlushTimer, pAd->BaReorderTimeout);
+		}
+#endif /* BA_HRTIMER_SUPPORT */
 
 		ASSERT((0<= pBAEntry->list.qlen)  && (pBAEntry->list.qlen <= pBAEntry->BAWinSize));
 		NdisReleaseSpinLock(&pBAEntry->RxReRingLock);
@@ -1795,6 +1872,9 @@ static VOID ba_enqueue_reordering_packet_hdr_trns(
 
 
 		mpdu_blk->pPacket = pRxBlk->pRxPacket;
+#ifdef BA_HRTIMER_SUPPORT
+		mpdu_blk->RxTime = RtmpOsGetUsecTime();
+#endif /* BA_HRTIMER_SUPPORT */
 
 		if (ba_reordering_mpdu_insertsorted(&pBAEntry->list, mpdu_blk) == FALSE)
 		{
@@ -1802,6 +1882,13 @@ static VOID ba_enqueue_reordering_packet_hdr_trns(
 			RELEASE_NDIS_PACKET(pAd, pRxBlk->pRxPacket, NDIS_STATUS_SUCCESS);                     
 			ba_mpdu_blk_free(pAd, mpdu_blk);
 		}
+#ifdef BA_HRTIMER_SUPPORT
+		else if (!RtmpOsHrTimerPending(&pBAEntry->FlushTimer))
+		{
+			/* an armed timer belongs to an older frame and re-arms itself */
+			RtmpOsHrTimerStart(&pBAEntry->FlushTimer, pAd->BaReorderTimeout);
+		}
+#endif /* BA_HRTIMER_SUPPORT */
 
 		ASSERT((0<= pBAEntry->list.qlen)  && (pBAEntry->list.qlen <= pBAEntry->BAWinSize));
 		NdisReleaseSpinLock(&pBAEntry->RxReRingLock);
@@ -1904,7 +1991,13 @@ VOID Indicate_AMPDU_Packet(
 	pBAEntry->rcvSeq = Sequence;
 
 
+#ifdef BA_HRTIMER_SUPPORT
+	/* the hold timer only marks the session, LastIndSeq is moved here */
+	if (ba_flush_due_clear(pAd, Idx))
+		ba_flush_reordering_expired_mpdus(pAd, pBAEntry);
+#else
 	ba_flush_reordering_timeout_mpdus(pAd, pBAEntry, Now32);
+#endif /* BA_HRTIMER_SUPPORT */
 	pBAEntry->LastIndSeqAtTimer = Now32;
 
 	
@@ -1912,7 +2005,7 @@ VOID Indicate_AMPDU_Packet(
 	/* */
 	if (pBAEntry->LastIndSeq == RESET_RCV_SEQ)
 	{
-		ASSERT((pBAEntry->list.qlen == 0) && (pBAEntry->list.next == NULL));
+		ASSERT(pBAEntry->list.qlen == 0);
 
 		/* reset rcv sequence of BA session */
 		pBAEntry->LastIndSeq = Sequence;
@@ -1986,6 +2079,12 @@ VOID Indicate_AMPDU_Packet(
 			pBAEntry->LastIndSeq = TmpSeq;
 		}
 	}
+
+#ifdef BA_HRTIMER_SUPPORT
+	/* nothing left to wait for */
+	if (pBAEntry->list.qlen == 0)
+		RtmpOsHrTimerTryCancel(&pBAEntry->FlushTimer);
+#endif /* BA_HRTIMER_SUPPORT */
 }
 
 
@@ -2050,14 +2149,20 @@ VOID Indicate_AMPDU_Packet_Hdr_Trns(
 	pBAEntry->rcvSeq = Sequence;
 
 
+#ifdef BA_HRTIMER_SUPPORT
+	/* the hold timer only marks the session, LastIndSeq is moved here */
+	if (ba_flush_due_clear(pAd, Idx))
+		ba_flush_reordering_expired_mpdus(pAd, pBAEntry);
+#else
 	ba_flush_reordering_timeout_mpdus(pAd, pBAEntry, Now32);
+#endif /* BA_HRTIMER_SUPPORT */
 	pBAEntry->LastIndSeqAtTimer = Now32;
 
 	/* Reset Last Indicate Sequence*/
 	/* */
 	if (pBAEntry->LastIndSeq == RESET_RCV_SEQ)
 	{
-		ASSERT((pBAEntry->list.qlen == 0) && (pBAEntry->list.next == NULL));
+		ASSERT(pBAEntry->list.qlen == 0);
 
 		/* reset rcv sequence of BA session */
 		pBAEntry->LastIndSeq = Sequence;
@@ -2127,6 +2232,12 @@ VOID Indicate_AMPDU_Packet_Hdr_Trns(
 			pBAEntry->LastIndSeq = TmpSeq;
 		}
 	}
+
+#ifdef BA_HRTIMER_SUPPORT
+	/* nothing left to wait for */
+	if (pBAEntry->list.qlen == 0)
+		RtmpOsHrTimerTryCancel(&pBAEntry->FlushTimer);
+#endif /* BA_HRTIMER_SUPPORT */
 }
 #endif /* HDR_TRANS_SUPPORT */
 
@@ -2158,5 +2269,217 @@ VOID BaReOrderingBufferMaintain(
         }
     }
 }
+
+#ifdef BA_HRTIMER_SUPPORT
+/*
+ * Hold timer of a reorder session, called in hard irq context. It only
+ * marks the session due and kicks the RX path: LastIndSeq and the reorder
+ * buffer are moved by the RX path alone, which flushes a due session
+ * before its next frame or from BaReorderTimeoutFlush.
+ */
+VOID BaReorderTimerExpire(
+	IN VOID *pData)
+{
+	PBA_REC_ENTRY pBAEntry = (PBA_REC_ENTRY)pData;
+	PRTMP_ADAPTER pAd = (PRTMP_ADAPTER)pBAEntry->pAdapter;
+	unsigned int Idx = (unsigned int)(pBAEntry - &pAd->BATable.BARecEntry[0]);
+	unsigned long IrqFlags;
+#ifndef RX_NAPI_SUPPORT
+	POS_COOKIE pObj = (POS_COOKIE) pAd->OS_Cookie;
+#endif /* !RX_NAPI_SUPPORT */
+
+	RTMP_IRQ_LOCK(&pAd->BaFlushLock, IrqFlags);
+	pAd->BaFlushDue[Idx >> 5] |= (1 << (Idx & 0x1f));
+	RTMP_IRQ_UNLOCK(&pAd->BaFlushLock, IrqFlags);
+
+#ifdef RX_NAPI_SUPPORT
+	RtmpOsRxNapiSchedule(pAd);
+#else
+	RTMP_OS_TASKLET_SCHE(&pObj->rx_done_task);
+#endif /* RX_NAPI_SUPPORT */
+}
+
+
+static bool ba_flush_due_clear(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned short Idx)
+{
+	unsigned int Bit = (1 << (Idx & 0x1f));
+	unsigned long IrqFlags;
+	bool bDue;
+
+	if ((pAd->BaFlushDue[Idx >> 5] & Bit) == 0)
+		return FALSE;
+
+	RTMP_IRQ_LOCK(&pAd->BaFlushLock, IrqFlags);
+	bDue = (pAd->BaFlushDue[Idx >> 5] & Bit) ? TRUE : FALSE;
+	pAd->BaFlushDue[Idx >> 5] &= ~Bit;
+	RTMP_IRQ_UNLOCK(&pAd->BaFlushLock, IrqFlags);
+
+	return bDue;
+}
+
+
+/*
+ * Give up on the holes in front of every frame that waited BaReorderTimeout,
+ * then re-arm the timer for the oldest frame still buffered.
+ */
+static VOID ba_flush_reordering_expired_mpdus(
+	IN PRTMP_ADAPTER pAd,
+	IN PBA_REC_ENTRY pBAEntry)
+{
+	struct reordering_mpdu *mpdu_blk;
+	unsigned int Now, Age, MaxAge = 0;
+	unsigned short Seq, FlushSeq = RESET_RCV_SEQ;
+	int i, Found = 0;
+
+	if (pBAEntry->list.qlen == 0)
+		return;
+
+	Now = RtmpOsGetUsecTime();
+
+	NdisAcquireSpinLock(&pBAEntry->RxReRingLock);
+	Seq = ba_reordering_window_start(pBAEntry);
+	for (i = 0; (i < BA_REORDER_SLOT_NUM) && (Found < pBAEntry->list.qlen); i++)
+	{
+		mpdu_blk = ba_reordering_mpdu_probe(&pBAEntry->list, Seq);
+		if (mpdu_blk != NULL)
+		{
+			Found++;
+			Age = Now - mpdu_blk->RxTime;
+			if (Age >= pAd->BaReorderTimeout)
+			{
+				/* everything up to here goes, only later frames set the next deadline */
+				FlushSeq = Seq;
+				MaxAge = 0;
+			}
+			else if (Age > MaxAge)
+				MaxAge = Age;
+		}
+		Seq = (Seq + 1) & MAXSEQ;
+	}
+	NdisReleaseSpinLock(&pBAEntry->RxReRingLock);
+
+	if (FlushSeq != RESET_RCV_SEQ)
+	{
+		ba_indicate_reordering_mpdus_le_seq(pAd, pBAEntry, FlushSeq);
+		pBAEntry->LastIndSeq = FlushSeq;
+
+		/* indicate in-order mpdus*/
+		Seq = ba_indicate_reordering_mpdus_in_order(pAd, pBAEntry, FlushSeq);
+		if (Seq != RESET_RCV_SEQ)
+			pBAEntry->LastIndSeq = Seq;
+
+		pAd->BaTimeoutFlush++;
+		if (pBAEntry->Wcid < MAX_LEN_OF_MAC_TABLE)
+			pAd->MacTab.Content[pBAEntry->Wcid].BaTimeoutFlush++;
+
+		DBGPRINT(RT_DEBUG_INFO, ("%s: Wcid=%d, TID=%d, flush to %x, %d left\n",
+				__FUNCTION__, pBAEntry->Wcid, pBAEntry->TID,
+				pBAEntry->LastIndSeq, pBAEntry->list.qlen));
+	}
+
+	if (pBAEntry->list.qlen > 0)
+		RtmpOsHrTimerStart(&pBAEntry->FlushTimer, pAd->BaReorderTimeout - MaxAge);
+}
+
+
+/* Flush the sessions whose hold timer fired, called from the RX path */
+VOID BaReorderTimeoutFlush(
+	IN PRTMP_ADAPTER pAd)
+{
+	PBA_REC_ENTRY pBAEntry;
+	unsigned int Due[(MAX_LEN_OF_BA_REC_TABLE + 31) / 32];
+	unsigned long IrqFlags;
+	int i, Word, Bit;
+	bool bAny = FALSE;
+
+	for (Word = 0; Word < (MAX_LEN_OF_BA_REC_TABLE + 31) / 32; Word++)
+	{
+		if (pAd->BaFlushDue[Word] != 0)
+			bAny = TRUE;
+	}
+	if (bAny == FALSE)
+		return;
+
+	RTMP_IRQ_LOCK(&pAd->BaFlushLock, IrqFlags);
+	NdisMoveMemory(Due, pAd->BaFlushDue, sizeof(Due));
+	NdisZeroMemory(pAd->BaFlushDue, sizeof(pAd->BaFlushDue));
+	RTMP_IRQ_UNLOCK(&pAd->BaFlushLock, IrqFlags);
+
+	for (Word = 0; Word < (MAX_LEN_OF_BA_REC_TABLE + 31) / 32; Word++)
+	{
+		for (Bit = 0; (Bit < 32) && (Due[Word] != 0); Bit++)
+		{
+			if ((Due[Word] & (1 << Bit)) == 0)
+				continue;
+			Due[Word] &= ~(1 << Bit);
+
+			/* reserve idx 0 to identify BAWcidArray[TID] as empty*/
+			i = (Word << 5) + Bit;
+			pBAEntry = &pAd->BATable.BARecEntry[i];
+			if ((i == 0) || (pBAEntry->REC_BA_Status != Recipient_Accept))
+				continue;
+
+			ba_flush_reordering_expired_mpdus(pAd, pBAEntry);
+		}
+	}
+}
+
+
+/*
+    ==========================================================================
+    Description:
+        Set how long a buffered frame waits for a missing one, in usec
+    Return:
+        TRUE if all parameters are OK, FALSE otherwise
+    ==========================================================================
+*/
+INT Set_BaReorderTimeout_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	long Timeout;
+
+	Timeout = simple_strtol(arg, 0, 10);
+	if ((Timeout < 1000) || (Timeout > 1000000))
+		return FALSE;
+
+	pAd->BaReorderTimeout = (unsigned int)Timeout;
+
+	DBGPRINT(RT_DEBUG_TRACE, ("Set_BaReorderTimeout_Proc::(BaReorderTimeout=%d)\n", pAd->BaReorderTimeout));
+
+	return TRUE;
+}
+
+
+INT Show_BaReorder_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	PMAC_TABLE_ENTRY pEntry;
+	INT i;
+
+	DBGPRINT(RT_DEBUG_OFF, ("BaReorder: Timeout=%dus, TimeoutFlush=%ld\n",
+				pAd->BaReorderTimeout, pAd->BaTimeoutFlush));
+
+	DBGPRINT(RT_DEBUG_OFF, ("hold:"));
+	for (i = 0; i < BA_HOLD_BUCKET; i++)
+		DBGPRINT(RT_DEBUG_OFF, (" <%d=%ld", 256 << i, pAd->BaHoldHist[i]));
+	DBGPRINT(RT_DEBUG_OFF, ("\n"));
+
+	for (i = 1; i < MAX_LEN_OF_MAC_TABLE; i++)
+	{
+		pEntry = &pAd->MacTab.Content[i];
+		if (!IS_ENTRY_CLIENT(pEntry) || (pEntry->BaTimeoutFlush == 0))
+			continue;
+
+		DBGPRINT(RT_DEBUG_OFF, ("%02x:%02x:%02x:%02x:%02x:%02x TimeoutFlush=%ld\n",
+					PRINT_MAC(pEntry->Addr), pEntry->BaTimeoutFlush));
+	}
+
+	return TRUE;
+}
+#endif /* BA_HRTIMER_SUPPORT */
 #endif /* DOT11_N_SUPPORT */
 
@@ -0,0 +1,829 @@
+#ifdef TX_AQM_SUPPORT
+
+#include "rt_config.h"
+#include "ipv6.h"
+#include "aqm.h"
+
+/*
+	Active queue management on the software TX queues.
+
+	APSendPacket() still puts frames on TxSwQueue, stamped with the time
+	they were queued. When RTMPDeQueuePacket needs more frames,
+	AQMDequeueBatch spreads whatever has piled up in TxSwQueue over
+	AQM_FLOW_NUM flow queues per AC, hashed on the station and the IP
+	5-tuple, and serves the flows by deficit round robin with new flows
+	first, so a short DNS or VoIP flow is not stuck behind a bulk
+	download. Each flow runs the CoDel drop law on the time its head
+	frame has waited.
+
+	TxSwQMaxLen stays the limit on everything queued for an AC; when it
+	is reached the head frame of the longest flow is dropped instead of
+	the new one. With AIRTIME_FAIRNESS_SUPPORT the station queues replace
+	the flow queues and run CoDel themselves.
+
+	Management, multicast and non-client frames skip the flows through
+	AqmBypassQ. Everything here is protected by irq_lock.
+*/
+
+#define AQM_LOCK(_pAd, _bIntContext, _IrqFlags)			\
+			do {										\
+				if (_bIntContext == FALSE)				\
+					RTMP_IRQ_LOCK(&(_pAd)->irq_lock, _IrqFlags);	\
+			} while(0)
+
+#define AQM_UNLOCK(_pAd, _bIntContext, _IrqFlags)			\
+			do {										\
+				if (_bIntContext == FALSE)				\
+					RTMP_IRQ_UNLOCK(&(_pAd)->irq_lock, _IrqFlags);	\
+			} while(0)
+
+#define AQM_TIME_AFTER_EQ(_a, _b)	((INT)((_a) - (_b)) >= 0)
+
+
+VOID AQMInit(
+	IN PRTMP_ADAPTER pAd)
+{
+	PAQM_FLOW pFlow;
+	unsigned char QueIdx;
+	INT i;
+
+	for (QueIdx = 0; QueIdx < NUM_OF_TX_RING; QueIdx++)
+	{
+		InitializeQueueHeader(&pAd->AqmBypassQ[QueIdx]);
+		for (i = 0; i < AQM_FLOW_NUM; i++)
+		{
+			pFlow = &pAd->AqmFlow[QueIdx][i];
+			InitializeQueueHeader(&pFlow->Queue);
+			NdisZeroMemory(&pFlow->CoDel, sizeof(CODEL_VARS));
+			pFlow->Deficit = 0;
+			pFlow->Next = -1;
+			pFlow->List = AQM_LIST_NONE;
+		}
+		pAd->AqmNewFlows[QueIdx].Head = pAd->AqmNewFlows[QueIdx].Tail = -1;
+		pAd->AqmOldFlows[QueIdx].Head = pAd->AqmOldFlows[QueIdx].Tail = -1;
+		pAd->AqmQueued[QueIdx] = 0;
+		pAd->AqmCoDelDrops[QueIdx] = 0;
+		pAd->AqmOverLimitDrops[QueIdx] = 0;
+	}
+	NdisZeroMemory(pAd->AqmSojournHist, sizeof(pAd->AqmSojournHist));
+
+	pAd->bAqmEnable = TRUE;
+	pAd->AqmTarget = AQM_DEFAULT_TARGET;
+	pAd->AqmInterval = AQM_DEFAULT_INTERVAL;
+	pAd->AqmQuantum = AQM_DEFAULT_QUANTUM;
+}
+
+
+static inline VOID AQMListAddTail(
+	IN PAQM_FLOW pFlows,
+	IN PAQM_FLOW_LIST pList,
+	IN unsigned char ListId,
+	IN short Idx)
+{
+	pFlows[Idx].Next = -1;
+	pFlows[Idx].List = ListId;
+	if (pList->Tail >= 0)
+		pFlows[pList->Tail].Next = Idx;
+	else
+		pList->Head = Idx;
+	pList->Tail = Idx;
+}
+
+
+static inline VOID AQMListRemoveHead(
+	IN PAQM_FLOW pFlows,
+	IN PAQM_FLOW_LIST pList)
+{
+	short Idx = pList->Head;
+
+	pList->Head = pFlows[Idx].Next;
+	if (pList->Head < 0)
+		pList->Tail = -1;
+	pFlows[Idx].Next = -1;
+	pFlows[Idx].List = AQM_LIST_NONE;
+}
+
+
+static inline unsigned int AQMHashBytes(
+	IN unsigned int Hash,
+	IN unsigned char *pData,
+	IN INT Len)
+{
+	INT i;
+
+	/* FNV-1a */
+	for (i = 0; i < Len; i++)
+		Hash = (Hash ^ pData[i]) * 16777619U;
+
+	return Hash;
+}
+
+
+/* Hash of the destination, the IP addresses and protocol and the TCP/UDP ports */
+static unsigned int AQMFlowHash(
+	IN PNDIS_PACKET pPacket)
+{
+	unsigned char *pData = GET_OS_PKT_DATAPTR(pPacket);
+	unsigned long Len = GET_OS_PKT_LEN(pPacket);
+	unsigned char *pL3, *pL4 = NULL;
+	unsigned short EtherType;
+	unsigned char Proto = 0;
+	unsigned int Hash = 2166136261U;
+	INT L3Len, IpHdrLen;
+
+	if (Len < LENGTH_802_3)
+		return RTMP_GET_PACKET_WCID(pPacket);
+
+	Hash = AQMHashBytes(Hash, pData, MAC_ADDR_LEN);
+
+	EtherType = (pData[12] << 8) | pData[13];
+	pL3 = pData + LENGTH_802_3;
+	if ((EtherType == ETH_P_8021Q) && (Len >= LENGTH_802_3 + 4))
+	{
+		EtherType = (pData[16] << 8) | pData[17];
+		pL3 += 4;
+	}
+	L3Len = (INT)(Len - (pL3 - pData));
+
+	if ((EtherType == ETH_P_IP) && (L3Len >= 20))
+	{
+		Proto = pL3[9];
+		Hash = AQMHashBytes(Hash, pL3 + 12, 8);
+		IpHdrLen = (pL3[0] & 0x0f) << 2;
+		/* only the first fragment carries the ports */
+		if ((((pL3[6] & 0x3f) | pL3[7]) == 0) && (L3Len >= IpHdrLen + 4))
+			pL4 = pL3 + IpHdrLen;
+	}
+	else if ((EtherType == ETH_P_IPV6) && (L3Len >= 40))
+	{
+		Proto = pL3[6];
+		Hash = AQMHashBytes(Hash, pL3 + 8, 32);
+		if (L3Len >= 44)
+			pL4 = pL3 + 40;
+	}
+	else
+		Hash = AQMHashBytes(Hash, pData + MAC_ADDR_LEN, MAC_ADDR_LEN + 2);
+
+	Hash = AQMHashBytes(Hash, &Proto, 1);
+	if (pL4 && ((Proto == IPV6_NEXT_HEADER_TCP) || (Proto == IPV6_NEXT_HEADER_UDP)))
+		Hash = AQMHashBytes(Hash, pL4, 4);
+
+	return Hash;
+}
+
+
+static unsigned int AQMSqrt(
+	IN unsigned int Val)
+{
+	unsigned int Root = 0, Bit = 1U << 30;
+
+	while (Bit > Val)
+		Bit >>= 2;
+
+	while (Bit != 0)
+	{
+		if (Val >= Root + Bit)
+		{
+			Val -= Root + Bit;
+			Root = (Root >> 1) + Bit;
+		}
+		else
+			Root >>= 1;
+		Bit >>= 2;
+	}
+
+	return Root;
+}
+
+
+/* next drop comes interval / sqrt(count) after t */
+static inline unsigned int AQMControlLaw(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned int Time,
+	IN unsigned int Count)
+{
+	return Time + pAd->AqmInterval / AQMSqrt(Count);
+}
+
+
+static inline VOID AQMSojournRecord(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char QueIdx,
+	IN unsigned int Sojourn)
+{
+	INT Bucket = 0;
+
+	Sojourn >>= 7;
+	while ((Sojourn != 0) && (Bucket < AQM_SOJOURN_BUCKET - 1))
+	{
+		Sojourn >>= 1;
+		Bucket++;
+	}
+	pAd->AqmSojournHist[QueIdx][Bucket]++;
+}
+
+
+static bool AQMShouldDrop(
+	IN PRTMP_ADAPTER pAd,
+	IN PCODEL_VARS pVars,
+	IN PQUEUE_ENTRY pQEntry,
+	IN PQUEUE_HEADER pQueue,
+	IN unsigned int Now)
+{
+	unsigned int Sojourn;
+
+	Sojourn = Now - RTMP_GET_PACKET_ENQ_TIME(QUEUE_ENTRY_TO_PACKET(pQEntry));
+
+	/* a queue down to its last frame is not a standing queue */
+	if ((Sojourn < pAd->AqmTarget) || (pQueue->Head == NULL))
+	{
+		pVars->FirstAboveTime = 0;
+		return FALSE;
+	}
+
+	if (pVars->FirstAboveTime == 0)
+	{
+		pVars->FirstAboveTime = (Now + pAd->AqmInterval) | 1;
+		return FALSE;
+	}
+
+	return AQM_TIME_AFTER_EQ(Now, pVars->FirstAboveTime);
+}
+
+
+/*
+	========================================================================
+
+	Routine Description:
+		Take the head frame off a queue through the CoDel drop law.
+
+	Arguments:
+		pAd			Pointer to our adapter
+		QueIdx		AC the queue belongs to, for the counters
+		pQueue		queue to take the frame from
+		pVars		CoDel state of that queue
+		Now			RtmpOsGetUsecTime()
+		pDropQueue	receives the dropped frames, to be freed once
+					irq_lock is released
+
+	Return Value:
+		frame to send, NULL if the queue ran empty
+
+	Note:
+		Called with irq_lock held.
+
+	========================================================================
+*/
+PQUEUE_ENTRY AQMCoDelDequeue(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char QueIdx,
+	IN PQUEUE_HEADER pQueue,
+	IN PCODEL_VARS pVars,
+	IN unsigned int Now,
+	OUT PQUEUE_HEADER pDropQueue)
+{
+	PQUEUE_ENTRY pQEntry;
+	unsigned int Delta;
+	bool bDrop;
+
+	if (pQueue->Head == NULL)
+	{
+		pVars->bDropping = FALSE;
+		return NULL;
+	}
+
+	pQEntry = RemoveHeadQueue(pQueue);
+	if (pAd->bAqmEnable == FALSE)
+	{
+		AQMSojournRecord(pAd, QueIdx, Now - RTMP_GET_PACKET_ENQ_TIME(QUEUE_ENTRY_TO_PACKET(pQEntry)));
+		return pQEntry;
+	}
+
+	bDrop = AQMShouldDrop(pAd, pVars, pQEntry, pQueue, Now);
+	if (pVars->bDropping)
+	{
+		if (!bDrop)
+			pVars->bDropping = FALSE;
+
+		while (pVars->bDropping && AQM_TIME_AFTER_EQ(Now, pVars->DropNext))
+		{
+			InsertTailQueue(pDropQueue, pQEntry);
+			pAd->AqmCoDelDrops[QueIdx]++;
+			pVars->Count++;
+
+			if (pQueue->Head == NULL)
+			{
+				pVars->bDropping = FALSE;
+				return NULL;
+			}
+
+			pQEntry = RemoveHeadQueue(pQueue);
+			if (!AQMShouldDrop(pAd, pVars, pQEntry, pQueue, Now))
+				pVars->bDropping = FALSE;
+			else
+				pVars->DropNext = AQMControlLaw(pAd, pVars->DropNext, pVars->Count);
+		}
+	}
+	else if (bDrop)
+	{
+		InsertTailQueue(pDropQueue, pQEntry);
+		pAd->AqmCoDelDrops[QueIdx]++;
+
+		pQEntry = NULL;
+		if (pQueue->Head != NULL)
+		{
+			pQEntry = RemoveHeadQueue(pQueue);
+		}
+		pVars->bDropping = TRUE;
+
+		/* start close to the drop rate of the last dropping state if it ended recently */
+		Delta = pVars->Count - pVars->LastCount;
+		if ((Delta > 1) && !AQM_TIME_AFTER_EQ(Now, pVars->DropNext + 16 * pAd->AqmInterval))
+			pVars->Count = Delta;
+		else
+			pVars->Count = 1;
+		pVars->LastCount = pVars->Count;
+		pVars->DropNext = AQMControlLaw(pAd, Now, pVars->Count);
+	}
+
+	if (pQEntry != NULL)
+		AQMSojournRecord(pAd, QueIdx, Now - RTMP_GET_PACKET_ENQ_TIME(QUEUE_ENTRY_TO_PACKET(pQEntry)));
+
+	return pQEntry;
+}
+
+
+/* drop the head frame of the longest flow, FALSE if every flow is empty */
+static bool AQMDropLongest(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char QueIdx,
+	OUT PQUEUE_HEADER pDropQueue)
+{
+	PQUEUE_HEADER pLongest = NULL;
+	PQUEUE_ENTRY pQEntry;
+	INT i;
+
+	for (i = 0; i < AQM_FLOW_NUM; i++)
+	{
+		if ((pLongest == NULL) || (pAd->AqmFlow[QueIdx][i].Queue.Number > pLongest->Number))
+			pLongest = &pAd->AqmFlow[QueIdx][i].Queue;
+	}
+
+	if ((pLongest == NULL) || (pLongest->Head == NULL))
+		return FALSE;
+
+	pQEntry = RemoveHeadQueue(pLongest);
+	InsertTailQueue(pDropQueue, pQEntry);
+	pAd->AqmQueued[QueIdx]--;
+	pAd->AqmOverLimitDrops[QueIdx]++;
+
+	return TRUE;
+}
+
+
+/* Move everything in TxSwQueue to the bypass queue or the flow it hashes to */
+static VOID AQMClassify(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char QueIdx,
+	OUT PQUEUE_HEADER pDropQueue)
+{
+	PQUEUE_ENTRY pQEntry;
+	PNDIS_PACKET pPacket;
+	PAQM_FLOW pFlow;
+	unsigned char Wcid;
+	short Idx;
+
+	while (pAd->TxSwQueue[QueIdx].Head != NULL)
+	{
+		pQEntry = RemoveHeadQueue(&pAd->TxSwQueue[QueIdx]);
+		pPacket = QUEUE_ENTRY_TO_PACKET(pQEntry);
+		Wcid = RTMP_GET_PACKET_WCID(pPacket);
+
+		if ((RTMP_GET_PACKET_MGMT_PKT(pPacket) == 1)
+			|| (Wcid >= MAX_LEN_OF_MAC_TABLE)
+			|| !IS_ENTRY_CLIENT(&pAd->MacTab.Content[Wcid]))
+		{
+			InsertTailQueue(&pAd->AqmBypassQ[QueIdx], pQEntry);
+			pAd->AqmQueued[QueIdx]++;
+			continue;
+		}
+
+		if (pAd->AqmQueued[QueIdx] >= pAd->TxSwQMaxLen)
+			AQMDropLongest(pAd, QueIdx, pDropQueue);
+
+		Idx = (short)(AQMFlowHash(pPacket) % AQM_FLOW_NUM);
+		pFlow = &pAd->AqmFlow[QueIdx][Idx];
+		InsertTailQueue(&pFlow->Queue, pQEntry);
+		pAd->AqmQueued[QueIdx]++;
+
+		if (pFlow->List == AQM_LIST_NONE)
+		{
+			pFlow->Deficit = pAd->AqmQuantum;
+			AQMListAddTail(pAd->AqmFlow[QueIdx], &pAd->AqmNewFlows[QueIdx], AQM_LIST_NEW, Idx);
+		}
+	}
+}
+
+
+/*
+	========================================================================
+
+	Routine Description:
+		Pick the next batch of frames for an AC from the bypass queue or
+		the flow whose turn it is.
+
+	Arguments:
+		pAd			Pointer to our adapter
+		QueIdx		AC to dequeue
+		pBatch		empty queue which receives the frames
+		bClassify	move new frames from TxSwQueue to the flows first,
+					FALSE only drains what the flows already hold
+		pDropQueue	receives the dropped frames, to be freed once
+					irq_lock is released
+
+	Return Value:
+		Queue the frames were taken from, to be given back to
+		AQMRequeueBatchLocked() with what is left of the batch. NULL if
+		there is nothing to send.
+
+	Note:
+		Called with irq_lock held.
+
+	========================================================================
+*/
+PQUEUE_HEADER AQMDequeueBatchLocked(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char QueIdx,
+	OUT PQUEUE_HEADER pBatch,
+	IN bool bClassify,
+	OUT PQUEUE_HEADER pDropQueue)
+{
+	PAQM_FLOW pFlows = pAd->AqmFlow[QueIdx];
+	PAQM_FLOW_LIST pNewFlows = &pAd->AqmNewFlows[QueIdx];
+	PAQM_FLOW_LIST pOldFlows = &pAd->AqmOldFlows[QueIdx];
+	PAQM_FLOW_LIST pList;
+	PAQM_FLOW pFlow;
+	PQUEUE_ENTRY pQEntry;
+	unsigned long Before;
+	unsigned int Now;
+	short Idx;
+
+	InitializeQueueHeader(pBatch);
+
+	if (bClassify)
+	{
+		/* AQM off and nothing left in the flows, serve TxSwQueue as is */
+		if ((pAd->bAqmEnable == FALSE) && (pAd->AqmQueued[QueIdx] == 0))
+		{
+			DequeueHeadBatch(&pAd->TxSwQueue[QueIdx], pBatch, TX_DEQUEUE_BATCH_NUM);
+			return &pAd->TxSwQueue[QueIdx];
+		}
+
+		AQMClassify(pAd, QueIdx, pDropQueue);
+	}
+
+	if (pAd->AqmBypassQ[QueIdx].Head != NULL)
+	{
+		DequeueHeadBatch(&pAd->AqmBypassQ[QueIdx], pBatch, TX_DEQUEUE_BATCH_NUM);
+		pAd->AqmQueued[QueIdx] -= pBatch->Number;
+		return &pAd->AqmBypassQ[QueIdx];
+	}
+
+	Now = RtmpOsGetUsecTime();
+
+	while (1)
+	{
+		if (pNewFlows->Head >= 0)
+			pList = pNewFlows;
+		else if (pOldFlows->Head >= 0)
+			pList = pOldFlows;
+		else
+			return NULL;
+
+		Idx = pList->Head;
+		pFlow = &pFlows[Idx];
+
+		if (pFlow->Deficit <= 0)
+		{
+			pFlow->Deficit += pAd->AqmQuantum;
+			AQMListRemoveHead(pFlows, pList);
+			AQMListAddTail(pFlows, pOldFlows, AQM_LIST_OLD, Idx);
+			continue;
+		}
+
+		Before = pFlow->Queue.Number;
+		while ((pBatch->Number < TX_DEQUEUE_BATCH_NUM) && (pFlow->Deficit > 0))
+		{
+			pQEntry = AQMCoDelDequeue(pAd, QueIdx, &pFlow->Queue, &pFlow->CoDel, Now, pDropQueue);
+			if (pQEntry == NULL)
+				break;
+
+			pFlow->Deficit -= (INT)GET_OS_PKT_LEN(QUEUE_ENTRY_TO_PACKET(pQEntry));
+			InsertTailQueue(pBatch, pQEntry);
+		}
+		pAd->AqmQueued[QueIdx] -= Before - pFlow->Queue.Number;
+
+		if (pFlow->Queue.Head == NULL)
+		{
+			/* an emptied new flow goes behind the old ones so it can't jump the queue again right away */
+			AQMListRemoveHead(pFlows, pList);
+			if ((pList == pNewFlows) && (pOldFlows->Head >= 0))
+				AQMListAddTail(pFlows, pOldFlows, AQM_LIST_OLD, Idx);
+		}
+
+		if (pBatch->Number > 0)
+			return &pFlow->Queue;
+	}
+}
+
+
+/*
+	Put what is left of a batch back in front of the queue it came from.
+	FALSE if pSrcQueue is not one of ours.
+*/
+bool AQMRequeueBatchLocked(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char QueIdx,
+	IN PQUEUE_HEADER pSrcQueue,
+	IN PQUEUE_HEADER pBatch)
+{
+	PAQM_FLOW pFlow = (PAQM_FLOW)pSrcQueue;
+	PQUEUE_ENTRY pQEntry;
+
+	if (pSrcQueue == &pAd->TxSwQueue[QueIdx])
+	{
+		RequeueHeadBatch(pSrcQueue, pBatch);
+		return TRUE;
+	}
+
+	if (pSrcQueue == &pAd->AqmBypassQ[QueIdx])
+	{
+		pAd->AqmQueued[QueIdx] += pBatch->Number;
+		RequeueHeadBatch(pSrcQueue, pBatch);
+		return TRUE;
+	}
+
+	/* Queue is the first member of AQM_FLOW */
+	if ((pFlow < &pAd->AqmFlow[QueIdx][0]) || (pFlow >= &pAd->AqmFlow[QueIdx][AQM_FLOW_NUM]))
+		return FALSE;
+
+	for (pQEntry = pBatch->Head; pQEntry != NULL; pQEntry = pQEntry->Next)
+		pFlow->Deficit += (INT)GET_OS_PKT_LEN(QUEUE_ENTRY_TO_PACKET(pQEntry));
+
+	pAd->AqmQueued[QueIdx] += pBatch->Number;
+	RequeueHeadBatch(&pFlow->Queue, pBatch);
+
+	if (pFlow->List == AQM_LIST_NONE)
+		AQMListAddTail(pAd->AqmFlow[QueIdx], &pAd->AqmNewFlows[QueIdx], AQM_LIST_NEW,
+						(short)(pFlow - &pAd->AqmFlow[QueIdx][0]));
+
+	return TRUE;
+}
+
+
+/*
+	Pick the next batch of frames for an AC. Takes the place of
+	DequeueHeadBatch() on TxSwQueue in RTMPDeQueuePacket().
+*/
+PQUEUE_HEADER AQMDequeueBatch(
+	IN PRTMP_ADAPTER pAd,
+	IN bool bIntContext,
+	IN unsigned char QueIdx,
+	OUT PQUEUE_HEADER pBatch)
+{
+	PQUEUE_HEADER pSrcQueue;
+	QUEUE_HEADER DropQueue;
+	PQUEUE_ENTRY pQEntry;
+	unsigned long IrqFlags = 0;
+
+	InitializeQueueHeader(&DropQueue);
+
+	AQM_LOCK(pAd, bIntContext, IrqFlags);
+	pSrcQueue = AQMDequeueBatchLocked(pAd, QueIdx, pBatch, TRUE, &DropQueue);
+	AQM_UNLOCK(pAd, bIntContext, IrqFlags);
+
+	while (DropQueue.Head != NULL)
+	{
+		pQEntry = RemoveHeadQueue(&DropQueue);
+		RELEASE_NDIS_PACKET(pAd, QUEUE_ENTRY_TO_PACKET(pQEntry), NDIS_STATUS_FAILURE);
+	}
+
+	return pSrcQueue;
+}
+
+
+VOID AQMRequeueBatch(
+	IN PRTMP_ADAPTER pAd,
+	IN bool bIntContext,
+	IN unsigned char QueIdx,
+	IN PQUEUE_HEADER pSrcQueue,
+	IN PQUEUE_HEADER pBatch)
+{
+	unsigned long IrqFlags = 0;
+
+	if ((pBatch->Head == NULL) || (pSrcQueue == NULL))
+		return;
+
+	AQM_LOCK(pAd, bIntContext, IrqFlags);
+	AQMRequeueBatchLocked(pAd, QueIdx, pSrcQueue, pBatch);
+	AQM_UNLOCK(pAd, bIntContext, IrqFlags);
+}
+
+
+/* Bring the flows of an AC back under TxSwQMaxLen, called with irq_lock held */
+VOID AQMTrim(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char QueIdx,
+	OUT PQUEUE_HEADER pDropQueue)
+{
+	while (pAd->AqmQueued[QueIdx] > pAd->TxSwQMaxLen)
+	{
+		if (!AQMDropLongest(pAd, QueIdx, pDropQueue))
+			break;
+	}
+}
+
+
+VOID AQMCleanupAll(
+	IN PRTMP_ADAPTER pAd)
+{
+	QUEUE_HEADER FreeQueue;
+	PQUEUE_ENTRY pQEntry;
+	PAQM_FLOW pFlow;
+	unsigned char QueIdx;
+	unsigned long IrqFlags;
+	INT i;
+
+	InitializeQueueHeader(&FreeQueue);
+
+	RTMP_IRQ_LOCK(&pAd->irq_lock, IrqFlags);
+	for (QueIdx = 0; QueIdx < NUM_OF_TX_RING; QueIdx++)
+	{
+		while (pAd->AqmBypassQ[QueIdx].Head != NULL)
+		{
+			pQEntry = RemoveHeadQueue(&pAd->AqmBypassQ[QueIdx]);
+			InsertTailQueue(&FreeQueue, pQEntry);
+		}
+
+		for (i = 0; i < AQM_FLOW_NUM; i++)
+		{
+			pFlow = &pAd->AqmFlow[QueIdx][i];
+			while (pFlow->Queue.Head != NULL)
+			{
+				pQEntry = RemoveHeadQueue(&pFlow->Queue);
+				InsertTailQueue(&FreeQueue, pQEntry);
+			}
+			NdisZeroMemory(&pFlow->CoDel, sizeof(CODEL_VARS));
+			pFlow->Next = -1;
+			pFlow->List = AQM_LIST_NONE;
+		}
+		pAd->AqmNewFlows[QueIdx].Head = pAd->AqmNewFlows[QueIdx].Tail = -1;
+		pAd->AqmOldFlows[QueIdx].Head = pAd->AqmOldFlows[QueIdx].Tail = -1;
+		pAd->AqmQueued[QueIdx] = 0;
+	}
+	RTMP_IRQ_UNLOCK(&pAd->irq_lock, IrqFlags);
+
+	while (FreeQueue.Head != NULL)
+	{
+		pQEntry = RemoveHeadQueue(&FreeQueue);
+		RELEASE_NDIS_PACKET(pAd, QUEUE_ENTRY_TO_PACKET(pQEntry), NDIS_STATUS_FAILURE);
+	}
+}
+
+
+/*
+    ==========================================================================
+    Description:
+        Turn the CoDel drop law on or off. Frames keep going through the
+        flow queues until the flows have drained.
+    Return:
+        TRUE if all parameters are OK, FALSE otherwise
+    ==========================================================================
+*/
+INT Set_AqmEnable_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	pAd->bAqmEnable = (simple_strtol(arg, 0, 10) != 0) ? TRUE : FALSE;
+
+	DBGPRINT(RT_DEBUG_TRACE, ("Set_AqmEnable_Proc::(bAqmEnable=%d)\n", pAd->bAqmEnable));
+
+	return TRUE;
+}
+
+
+/*
+    ==========================================================================
+    Description:
+        Set the CoDel target, in usec
+    Return:
+        TRUE if all parameters are OK, FALSE otherwise
+    ==========================================================================
+*/
+INT Set_AqmTarget_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	long Target;
+
+	Target = simple_strtol(arg, 0, 10);
+	if ((Target <= 0) || (Target >= (long)pAd->AqmInterval))
+		return FALSE;
+
+	pAd->AqmTarget = (unsigned int)Target;
+
+	DBGPRINT(RT_DEBUG_TRACE, ("Set_AqmTarget_Proc::(AqmTarget=%d)\n", pAd->AqmTarget));
+
+	return TRUE;
+}
+
+
+/*
+    ==========================================================================
+    Description:
+        Set the CoDel interval, in usec
+    Return:
+        TRUE if all parameters are OK, FALSE otherwise
+    ==========================================================================
+*/
+INT Set_AqmInterval_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	long Interval;
+
+	Interval = simple_strtol(arg, 0, 10);
+	if ((Interval <= (long)pAd->AqmTarget) || (Interval > 10000000))
+		return FALSE;
+
+	pAd->AqmInterval = (unsigned int)Interval;
+
+	DBGPRINT(RT_DEBUG_TRACE, ("Set_AqmInterval_Proc::(AqmInterval=%d)\n", pAd->AqmInterval));
+
+	return TRUE;
+}
+
+
+/* upper bound, in usec, of the sojourn time Percent % of the frames stayed under */
+static unsigned int AQMSojournPercentile(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char QueIdx,
+	IN unsigned int Percent)
+{
+	unsigned long Total = 0, Sum = 0, Goal;
+	INT i;
+
+	for (i = 0; i < AQM_SOJOURN_BUCKET; i++)
+		Total += pAd->AqmSojournHist[QueIdx][i];
+
+	if (Total == 0)
+		return 0;
+
+	Goal = (Total * Percent + 99) / 100;
+	for (i = 0; i < AQM_SOJOURN_BUCKET; i++)
+	{
+		Sum += pAd->AqmSojournHist[QueIdx][i];
+		if (Sum >= Goal)
+			break;
+	}
+
+	return (128 << i);
+}
+
+
+INT Show_AqmStats_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	static char *AcName[] = {"BE", "BK", "VI", "VO", "HCCA"};
+	unsigned char QueIdx;
+	INT i;
+
+	DBGPRINT(RT_DEBUG_OFF, ("Aqm: Enable=%d, Target=%dus, Interval=%dus, Quantum=%d, Limit=%d\n",
+				pAd->bAqmEnable, pAd->AqmTarget, pAd->AqmInterval,
+				pAd->AqmQuantum, pAd->TxSwQMaxLen));
+
+	DBGPRINT(RT_DEBUG_OFF, ("%-6s%-10s%-12s%-12s%-10s%-10s%-10s\n",
+				"AC", "Queued", "CoDelDrop", "LimitDrop", "p50(us)", "p90(us)", "p99(us)"));
+	for (QueIdx = 0; QueIdx < NUM_OF_TX_RING; QueIdx++)
+	{
+		DBGPRINT(RT_DEBUG_OFF, ("%-6s%-10ld%-12ld%-12ld%-10d%-10d%-10d\n",
+					AcName[QueIdx], pAd->AqmQueued[QueIdx],
+					pAd->AqmCoDelDrops[QueIdx], pAd->AqmOverLimitDrops[QueIdx],
+					AQMSojournPercentile(pAd, QueIdx, 50),
+					AQMSojournPercentile(pAd, QueIdx, 90),
+					AQMSojournPercentile(pAd, QueIdx, 99)));
+	}
+
+	for (QueIdx = 0; QueIdx < NUM_OF_TX_RING; QueIdx++)
+	{
+		DBGPRINT(RT_DEBUG_OFF, ("%s sojourn:", AcName[QueIdx]));
+		for (i = 0; i < AQM_SOJOURN_BUCKET; i++)
+			DBGPRINT(RT_DEBUG_OFF, (" <%d=%ld", 128 << i, pAd->AqmSojournHist[QueIdx][i]));
+		DBGPRINT(RT_DEBUG_OFF, ("\n"));
+	}
+
+	return TRUE;
+}
+
+#endif /* TX_AQM_SUPPORT */
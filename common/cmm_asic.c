@@ -75,6 +75,10 @@ VOID 	AsicUpdateProtect(
 	}
 #endif /* DOT11_N_SUPPORT */
 
+#ifdef REG_DEFER_SUPPORT
+	RegDeferBegin(pAd);
+#endif /* REG_DEFER_SUPPORT */
+
 	/* Config ASIC RTS threshold register*/
 	RTMP_IO_READ32(pAd, TX_RTS_CFG, &MacReg);
 	MacReg &= 0xFF0000FF;
@@ -391,6 +395,10 @@ VOID 	AsicUpdateProtect(
 			RTMP_IO_WRITE32(pAd, offset + i*4, Protect[i]);
 		}
 	}
+
+#ifdef REG_DEFER_SUPPORT
+	RegDeferEnd(pAd);
+#endif /* REG_DEFER_SUPPORT */
 }
 
 
@@ -1186,6 +1194,9 @@ VOID AsicSetEdcaParm(
 	Ac1Cfg.word = 0;
 	Ac2Cfg.word = 0;
 	Ac3Cfg.word = 0;
+#ifdef REG_DEFER_SUPPORT
+	RegDeferBegin(pAd);
+#endif /* REG_DEFER_SUPPORT */
 	if ((pEdcaParm == NULL) || (pEdcaParm->bValid == FALSE))
 	{
 		DBGPRINT(RT_DEBUG_TRACE,("AsicSetEdcaParm\n"));
@@ -1433,6 +1444,10 @@ VOID AsicSetEdcaParm(
 
 	}
 
+#ifdef REG_DEFER_SUPPORT
+	RegDeferEnd(pAd);
+#endif /* REG_DEFER_SUPPORT */
+
 	pAd->CommonCfg.RestoreBurstMode = Ac0Cfg.word;
 }
 
@@ -1685,6 +1700,10 @@ VOID	AsicUpdateWcidAttributeEntry(
 		return;
 	}
 
+#ifdef ASSOC_STORM_SUPPORT
+	AssocStormWcidSync(pAd, Wcid);
+#endif /* ASSOC_STORM_SUPPORT */
+
 	/* Update the pairwise key security mode.
 	   Use bit10 and bit3~1 to indicate the pairwise cipher mode */	
 	WCIDAttri.field.PairKeyModeExt = ((CipherAlg & 0x08) >> 3);
@@ -1741,6 +1760,10 @@ VOID AsicAddPairwiseKeyEntry(
 	unsigned char		CipherAlg = pCipherKey->CipherAlg;
 #endif /* DBG */
 
+#ifdef ASSOC_STORM_SUPPORT
+	AssocStormWcidSync(pAd, WCID);
+#endif /* ASSOC_STORM_SUPPORT */
+
 	/* EKEY*/
 	offset = PAIRWISE_KEY_TABLE_BASE + (WCID * HW_KEY_ENTRY_SIZE);
 #ifdef RTMP_MAC_USB
@@ -0,0 +1,539 @@
+#ifdef AIRTIME_FAIRNESS_SUPPORT
+
+#include "rt_config.h"
+#include "atf.h"
+
+/*
+	Airtime fairness.
+
+	Frames still go into TxSwQueue on the send path. When RTMPDeQueuePacket
+	needs more frames, ATFDequeueBatch sorts whatever has piled up in
+	TxSwQueue into one queue per associated station, then picks the next
+	batch by deficit round robin: every station in the ring earns
+	AtfQuantum usec per round and is charged the estimated airtime of each
+	frame it sends, so a slow station gets the same share of the medium as
+	a fast one instead of the same number of frames.
+
+	Management, multicast and non-client frames skip the scheduler through
+	AtfBypassQ. Everything here is protected by irq_lock.
+*/
+
+#define ATF_LOCK(_pAd, _bIntContext, _IrqFlags)			\
+			do {										\
+				if (_bIntContext == FALSE)				\
+					RTMP_IRQ_LOCK(&(_pAd)->irq_lock, _IrqFlags);	\
+			} while(0)
+
+#define ATF_UNLOCK(_pAd, _bIntContext, _IrqFlags)			\
+			do {										\
+				if (_bIntContext == FALSE)				\
+					RTMP_IRQ_UNLOCK(&(_pAd)->irq_lock, _IrqFlags);	\
+			} while(0)
+
+
+VOID ATFInit(
+	IN PRTMP_ADAPTER pAd)
+{
+	unsigned char QueIdx;
+
+	for (QueIdx = 0; QueIdx < NUM_OF_TX_RING; QueIdx++)
+	{
+		InitializeQueueHeader(&pAd->AtfBypassQ[QueIdx]);
+		pAd->AtfRingHead[QueIdx] = 0;
+		pAd->AtfRingNum[QueIdx] = 0;
+		pAd->AtfQueued[QueIdx] = 0;
+	}
+	NdisZeroMemory(pAd->AtfInRing, sizeof(pAd->AtfInRing));
+
+	pAd->bAtfEnable = TRUE;
+	pAd->AtfQuantum = ATF_DEFAULT_QUANTUM;
+}
+
+
+/* usec the frame will keep the medium busy at the rate rate control picked for this station */
+static unsigned int ATFFrameAirtime(
+	IN PRTMP_ADAPTER pAd,
+	IN PMAC_TABLE_ENTRY pEntry,
+	IN unsigned long Len)
+{
+	HTTRANSMIT_SETTING PhyMode = pEntry->HTPhyMode;
+	unsigned int Rate;
+
+	if (PhyMode.field.MODE == MODE_CCK)
+		return RTMPCalcDuration(pAd, (unsigned char)(RATE_1 + (PhyMode.field.MCS & 0x3)), Len);
+
+	if (PhyMode.field.MODE == MODE_OFDM)
+		return RTMPCalcDuration(pAd, (unsigned char)(RATE_6 + (PhyMode.field.MCS & 0x7)), Len);
+
+	/*
+		HT frames mostly go out in A-MPDUs, so the preamble is left out
+		and only the payload is charged.
+	*/
+	RtmpDrvMaxRateGet(pAd, PhyMode.field.MODE, PhyMode.field.ShortGI,
+						PhyMode.field.BW, PhyMode.field.MCS, &Rate);
+	Rate /= 500000;
+	if (Rate == 0)
+		Rate = 1;
+
+	return (unsigned int)((Len << 4) / Rate);
+}
+
+
+static inline VOID ATFRingAdd(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char QueIdx,
+	IN unsigned char Wcid)
+{
+	unsigned short Tail;
+
+	if (pAd->AtfInRing[QueIdx][Wcid])
+		return;
+
+	Tail = (pAd->AtfRingHead[QueIdx] + pAd->AtfRingNum[QueIdx]) % MAX_LEN_OF_MAC_TABLE;
+	pAd->AtfRing[QueIdx][Tail] = Wcid;
+	pAd->AtfRingNum[QueIdx]++;
+	pAd->AtfInRing[QueIdx][Wcid] = TRUE;
+}
+
+
+static inline VOID ATFRingRemoveHead(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char QueIdx)
+{
+	pAd->AtfInRing[QueIdx][pAd->AtfRing[QueIdx][pAd->AtfRingHead[QueIdx]]] = FALSE;
+	pAd->AtfRingHead[QueIdx] = (pAd->AtfRingHead[QueIdx] + 1) % MAX_LEN_OF_MAC_TABLE;
+	pAd->AtfRingNum[QueIdx]--;
+}
+
+
+static inline VOID ATFRingRotate(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char QueIdx)
+{
+	unsigned char Wcid = pAd->AtfRing[QueIdx][pAd->AtfRingHead[QueIdx]];
+
+	ATFRingRemoveHead(pAd, QueIdx);
+	ATFRingAdd(pAd, QueIdx, Wcid);
+}
+
+
+/*
+	Move everything in TxSwQueue to the bypass queue or the queue of the
+	station it is for. Frames over the per-station limit are put on
+	pDropQueue to be freed once irq_lock is released.
+*/
+static VOID ATFClassify(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char QueIdx,
+	OUT PQUEUE_HEADER pDropQueue)
+{
+	PQUEUE_ENTRY pQEntry;
+	PNDIS_PACKET pPacket;
+	PMAC_TABLE_ENTRY pEntry;
+	unsigned char Wcid;
+
+	while (pAd->TxSwQueue[QueIdx].Head != NULL)
+	{
+		pQEntry = RemoveHeadQueue(&pAd->TxSwQueue[QueIdx]);
+		pPacket = QUEUE_ENTRY_TO_PACKET(pQEntry);
+		Wcid = RTMP_GET_PACKET_WCID(pPacket);
+
+		if ((RTMP_GET_PACKET_MGMT_PKT(pPacket) == 1)
+			|| (Wcid >= MAX_LEN_OF_MAC_TABLE)
+			|| !IS_ENTRY_CLIENT(&pAd->MacTab.Content[Wcid]))
+		{
+			InsertTailQueue(&pAd->AtfBypassQ[QueIdx], pQEntry);
+			pAd->AtfQueued[QueIdx]++;
+			continue;
+		}
+
+		pEntry = &pAd->MacTab.Content[Wcid];
+		if (pEntry->AtfTxQ[QueIdx].Number >= pAd->TxSwQMaxLen)
+		{
+			pEntry->AtfDrops++;
+			InsertTailQueue(pDropQueue, pQEntry);
+			continue;
+		}
+
+		InsertTailQueue(&pEntry->AtfTxQ[QueIdx], pQEntry);
+		pAd->AtfQueued[QueIdx]++;
+		ATFRingAdd(pAd, QueIdx, Wcid);
+	}
+}
+
+
+/* Deficit round robin over the stations with frames queued, called with irq_lock held */
+static PQUEUE_HEADER ATFSchedule(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char QueIdx,
+	OUT PQUEUE_HEADER pBatch,
+	OUT PQUEUE_HEADER pDropQueue)
+{
+	PQUEUE_HEADER pSrcQueue = NULL;
+	PQUEUE_ENTRY pQEntry;
+	PMAC_TABLE_ENTRY pEntry;
+	unsigned char Wcid;
+	unsigned int Airtime;
+	unsigned long Before;
+#ifdef TX_AQM_SUPPORT
+	unsigned long Dropped;
+	unsigned int Now = RtmpOsGetUsecTime();
+#endif /* TX_AQM_SUPPORT */
+
+	ATFClassify(pAd, QueIdx, pDropQueue);
+
+	if (pAd->AtfBypassQ[QueIdx].Head != NULL)
+	{
+		pSrcQueue = &pAd->AtfBypassQ[QueIdx];
+		DequeueHeadBatch(pSrcQueue, pBatch, TX_DEQUEUE_BATCH_NUM);
+		pAd->AtfQueued[QueIdx] -= pBatch->Number;
+		return pSrcQueue;
+	}
+
+	while ((pSrcQueue == NULL) && (pAd->AtfRingNum[QueIdx] > 0))
+	{
+		Wcid = pAd->AtfRing[QueIdx][pAd->AtfRingHead[QueIdx]];
+		pEntry = &pAd->MacTab.Content[Wcid];
+
+		if (pEntry->AtfTxQ[QueIdx].Head == NULL)
+		{
+			pEntry->AtfDeficit[QueIdx] = 0;
+			ATFRingRemoveHead(pAd, QueIdx);
+			continue;
+		}
+
+		if (pAd->bAtfEnable && (pEntry->AtfDeficit[QueIdx] <= 0))
+		{
+			pEntry->AtfDeficit[QueIdx] += (INT)pAd->AtfQuantum;
+			ATFRingRotate(pAd, QueIdx);
+			continue;
+		}
+
+		pSrcQueue = &pEntry->AtfTxQ[QueIdx];
+		Before = pSrcQueue->Number;
+#ifdef TX_AQM_SUPPORT
+		Dropped = pDropQueue->Number;
+#endif /* TX_AQM_SUPPORT */
+		while ((pBatch->Number < TX_DEQUEUE_BATCH_NUM) && (pSrcQueue->Head != NULL))
+		{
+#ifdef TX_AQM_SUPPORT
+			pQEntry = AQMCoDelDequeue(pAd, QueIdx, pSrcQueue, &pEntry->AtfCoDel[QueIdx], Now, pDropQueue);
+			if (pQEntry == NULL)
+				break;
+#else
+			pQEntry = RemoveHeadQueue(pSrcQueue);
+#endif /* TX_AQM_SUPPORT */
+			Airtime = ATFFrameAirtime(pAd, pEntry,
+									GET_OS_PKT_LEN(QUEUE_ENTRY_TO_PACKET(pQEntry)));
+			pEntry->AtfDeficit[QueIdx] -= (INT)Airtime;
+			pEntry->AtfAirtime += Airtime;
+			pEntry->AtfTxFrames++;
+			InsertTailQueue(pBatch, pQEntry);
+
+			if (pAd->bAtfEnable && (pEntry->AtfDeficit[QueIdx] <= 0))
+				break;
+		}
+		pAd->AtfQueued[QueIdx] -= Before - pSrcQueue->Number;
+#ifdef TX_AQM_SUPPORT
+		pEntry->AtfDrops += pDropQueue->Number - Dropped;
+#endif /* TX_AQM_SUPPORT */
+
+		/* a station which still has quota stays at the head for the next batch */
+		if (pSrcQueue->Head == NULL)
+		{
+			pEntry->AtfDeficit[QueIdx] = 0;
+			ATFRingRemoveHead(pAd, QueIdx);
+		}
+		else if (pEntry->AtfDeficit[QueIdx] <= 0)
+			ATFRingRotate(pAd, QueIdx);
+
+		/* CoDel may have dropped every frame it looked at */
+		if (pBatch->Number == 0)
+			pSrcQueue = NULL;
+	}
+
+	return pSrcQueue;
+}
+
+
+/*
+	========================================================================
+
+	Routine Description:
+		Pick the next batch of frames for an AC. Takes the place of
+		DequeueHeadBatch() on TxSwQueue in RTMPDeQueuePacket().
+
+	Arguments:
+		pAd			Pointer to our adapter
+		bIntContext	irq_lock is already held by the caller
+		QueIdx		AC to dequeue
+		pBatch		empty queue which receives the frames
+
+	Return Value:
+		Queue the frames were taken from, to be given back to
+		ATFRequeueBatch() with what is left of the batch. NULL if there
+		is nothing to send.
+
+	========================================================================
+*/
+PQUEUE_HEADER ATFDequeueBatch(
+	IN PRTMP_ADAPTER pAd,
+	IN bool bIntContext,
+	IN unsigned char QueIdx,
+	OUT PQUEUE_HEADER pBatch)
+{
+	PQUEUE_HEADER pSrcQueue = NULL;
+	QUEUE_HEADER DropQueue;
+	PQUEUE_ENTRY pQEntry;
+	unsigned long IrqFlags = 0;
+
+	InitializeQueueHeader(pBatch);
+	InitializeQueueHeader(&DropQueue);
+
+	ATF_LOCK(pAd, bIntContext, IrqFlags);
+
+	if ((pAd->bAtfEnable == FALSE) && (pAd->AtfQueued[QueIdx] == 0))
+	{
+		/* scheduler off and nothing left in its queues, serve TxSwQueue as is */
+#ifdef TX_AQM_SUPPORT
+		pSrcQueue = AQMDequeueBatchLocked(pAd, QueIdx, pBatch, TRUE, &DropQueue);
+#else
+		DequeueHeadBatch(&pAd->TxSwQueue[QueIdx], pBatch, TX_DEQUEUE_BATCH_NUM);
+		pSrcQueue = &pAd->TxSwQueue[QueIdx];
+#endif /* TX_AQM_SUPPORT */
+	}
+	else
+	{
+#ifdef TX_AQM_SUPPORT
+		/* frames the AQM flows still hold from before the scheduler was turned on */
+		if (pAd->AqmQueued[QueIdx] > 0)
+			pSrcQueue = AQMDequeueBatchLocked(pAd, QueIdx, pBatch, FALSE, &DropQueue);
+		if (pSrcQueue == NULL)
+#endif /* TX_AQM_SUPPORT */
+		pSrcQueue = ATFSchedule(pAd, QueIdx, pBatch, &DropQueue);
+	}
+
+	ATF_UNLOCK(pAd, bIntContext, IrqFlags);
+
+	while (DropQueue.Head != NULL)
+	{
+		pQEntry = RemoveHeadQueue(&DropQueue);
+		RELEASE_NDIS_PACKET(pAd, QUEUE_ENTRY_TO_PACKET(pQEntry), NDIS_STATUS_FAILURE);
+	}
+
+	return pSrcQueue;
+}
+
+
+/*
+	Put what is left of a batch back in front of the queue it came from
+	and give the station back the airtime it was charged for it.
+*/
+VOID ATFRequeueBatch(
+	IN PRTMP_ADAPTER pAd,
+	IN bool bIntContext,
+	IN unsigned char QueIdx,
+	IN PQUEUE_HEADER pSrcQueue,
+	IN PQUEUE_HEADER pBatch)
+{
+	PQUEUE_ENTRY pQEntry;
+	PMAC_TABLE_ENTRY pEntry;
+	unsigned char Wcid;
+	unsigned int Airtime;
+	unsigned long IrqFlags = 0;
+
+	if ((pBatch->Head == NULL) || (pSrcQueue == NULL))
+		return;
+
+	ATF_LOCK(pAd, bIntContext, IrqFlags);
+
+#ifdef TX_AQM_SUPPORT
+	if (AQMRequeueBatchLocked(pAd, QueIdx, pSrcQueue, pBatch))
+	{
+		ATF_UNLOCK(pAd, bIntContext, IrqFlags);
+		return;
+	}
+#endif /* TX_AQM_SUPPORT */
+
+	if (pSrcQueue == &pAd->TxSwQueue[QueIdx])
+	{
+		RequeueHeadBatch(pSrcQueue, pBatch);
+		ATF_UNLOCK(pAd, bIntContext, IrqFlags);
+		return;
+	}
+
+	pAd->AtfQueued[QueIdx] += pBatch->Number;
+
+	if (pSrcQueue != &pAd->AtfBypassQ[QueIdx])
+	{
+		Wcid = RTMP_GET_PACKET_WCID(QUEUE_ENTRY_TO_PACKET(pBatch->Head));
+		pEntry = &pAd->MacTab.Content[Wcid];
+
+		if (IS_ENTRY_CLIENT(pEntry))
+		{
+			for (pQEntry = pBatch->Head; pQEntry != NULL; pQEntry = pQEntry->Next)
+			{
+				Airtime = ATFFrameAirtime(pAd, pEntry,
+										GET_OS_PKT_LEN(QUEUE_ENTRY_TO_PACKET(pQEntry)));
+				pEntry->AtfDeficit[QueIdx] += (INT)Airtime;
+				pEntry->AtfAirtime -= (pEntry->AtfAirtime > Airtime) ? Airtime : pEntry->AtfAirtime;
+				pEntry->AtfTxFrames--;
+			}
+			ATFRingAdd(pAd, QueIdx, Wcid);
+		}
+		else
+		{
+			/* the station left while its frames were out, ATFCleanupEntry already ran */
+			pSrcQueue = &pAd->AtfBypassQ[QueIdx];
+		}
+	}
+
+	RequeueHeadBatch(pSrcQueue, pBatch);
+
+	ATF_UNLOCK(pAd, bIntContext, IrqFlags);
+}
+
+
+/* Free the frames a leaving station still has queued */
+VOID ATFCleanupEntry(
+	IN PRTMP_ADAPTER pAd,
+	IN PMAC_TABLE_ENTRY pEntry)
+{
+	QUEUE_HEADER FreeQueue;
+	PQUEUE_ENTRY pQEntry;
+	unsigned char QueIdx;
+	unsigned long IrqFlags;
+
+	InitializeQueueHeader(&FreeQueue);
+
+	RTMP_IRQ_LOCK(&pAd->irq_lock, IrqFlags);
+	for (QueIdx = 0; QueIdx < NUM_OF_TX_RING; QueIdx++)
+	{
+		pAd->AtfQueued[QueIdx] -= pEntry->AtfTxQ[QueIdx].Number;
+		while (pEntry->AtfTxQ[QueIdx].Head != NULL)
+		{
+			pQEntry = RemoveHeadQueue(&pEntry->AtfTxQ[QueIdx]);
+			InsertTailQueue(&FreeQueue, pQEntry);
+		}
+		pEntry->AtfDeficit[QueIdx] = 0;
+	}
+	RTMP_IRQ_UNLOCK(&pAd->irq_lock, IrqFlags);
+
+	/* the wcid is dropped from the ring the next time the scheduler finds its queue empty */
+	while (FreeQueue.Head != NULL)
+	{
+		pQEntry = RemoveHeadQueue(&FreeQueue);
+		RELEASE_NDIS_PACKET(pAd, QUEUE_ENTRY_TO_PACKET(pQEntry), NDIS_STATUS_FAILURE);
+	}
+}
+
+
+/* Free the frames in the bypass queues, the station queues are emptied by ATFCleanupEntry */
+VOID ATFCleanupAll(
+	IN PRTMP_ADAPTER pAd)
+{
+	QUEUE_HEADER FreeQueue;
+	PQUEUE_ENTRY pQEntry;
+	unsigned char QueIdx;
+	unsigned long IrqFlags;
+
+	InitializeQueueHeader(&FreeQueue);
+
+	RTMP_IRQ_LOCK(&pAd->irq_lock, IrqFlags);
+	for (QueIdx = 0; QueIdx < NUM_OF_TX_RING; QueIdx++)
+	{
+		pAd->AtfQueued[QueIdx] -= pAd->AtfBypassQ[QueIdx].Number;
+		while (pAd->AtfBypassQ[QueIdx].Head != NULL)
+		{
+			pQEntry = RemoveHeadQueue(&pAd->AtfBypassQ[QueIdx]);
+			InsertTailQueue(&FreeQueue, pQEntry);
+		}
+	}
+	RTMP_IRQ_UNLOCK(&pAd->irq_lock, IrqFlags);
+
+	while (FreeQueue.Head != NULL)
+	{
+		pQEntry = RemoveHeadQueue(&FreeQueue);
+		RELEASE_NDIS_PACKET(pAd, QUEUE_ENTRY_TO_PACKET(pQEntry), NDIS_STATUS_FAILURE);
+	}
+}
+
+
+/*
+    ==========================================================================
+    Description:
+        Turn the airtime scheduler on or off. Frames it still holds are
+        sent before TxSwQueue is served directly again.
+    Return:
+        TRUE if all parameters are OK, FALSE otherwise
+    ==========================================================================
+*/
+INT Set_AtfEnable_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	pAd->bAtfEnable = (simple_strtol(arg, 0, 10) != 0) ? TRUE : FALSE;
+
+	DBGPRINT(RT_DEBUG_TRACE, ("Set_AtfEnable_Proc::(bAtfEnable=%d)\n", pAd->bAtfEnable));
+
+	return TRUE;
+}
+
+
+/*
+    ==========================================================================
+    Description:
+        Set the airtime, in usec, each station earns per scheduler round
+    Return:
+        TRUE if all parameters are OK, FALSE otherwise
+    ==========================================================================
+*/
+INT Set_AtfQuantum_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	long Quantum;
+
+	Quantum = simple_strtol(arg, 0, 10);
+	if ((Quantum < ATF_MIN_QUANTUM) || (Quantum > ATF_MAX_QUANTUM))
+		return FALSE;
+
+	pAd->AtfQuantum = (unsigned int)Quantum;
+
+	DBGPRINT(RT_DEBUG_TRACE, ("Set_AtfQuantum_Proc::(AtfQuantum=%d)\n", pAd->AtfQuantum));
+
+	return TRUE;
+}
+
+
+INT Show_AtfStats_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	PMAC_TABLE_ENTRY pEntry;
+	INT i;
+
+	DBGPRINT(RT_DEBUG_OFF, ("Atf: Enable=%d, Quantum=%dus, Queued(BE/BK/VI/VO)=%ld/%ld/%ld/%ld\n",
+				pAd->bAtfEnable, pAd->AtfQuantum,
+				pAd->AtfQueued[QID_AC_BE], pAd->AtfQueued[QID_AC_BK],
+				pAd->AtfQueued[QID_AC_VI], pAd->AtfQueued[QID_AC_VO]));
+
+	DBGPRINT(RT_DEBUG_OFF, ("%-19s%-6s%-6s%-14s%-12s%-10s%-20s\n",
+				"MAC", "AID", "MCS", "Airtime(us)", "TxFrames", "Drops", "Backlog(BE/BK/VI/VO)"));
+	for (i = 1; i < MAX_LEN_OF_MAC_TABLE; i++)
+	{
+		pEntry = &pAd->MacTab.Content[i];
+		if (!IS_ENTRY_CLIENT(pEntry))
+			continue;
+
+		DBGPRINT(RT_DEBUG_OFF, ("%02X:%02X:%02X:%02X:%02X:%02X  %-6d%-6d%-14llu%-12ld%-10ld%ld/%ld/%ld/%ld\n",
+					PRINT_MAC(pEntry->Addr), pEntry->Aid, pEntry->HTPhyMode.field.MCS,
+					pEntry->AtfAirtime, pEntry->AtfTxFrames, pEntry->AtfDrops,
+					pEntry->AtfTxQ[QID_AC_BE].Number, pEntry->AtfTxQ[QID_AC_BK].Number,
+					pEntry->AtfTxQ[QID_AC_VI].Number, pEntry->AtfTxQ[QID_AC_VO].Number));
+	}
+
+	return TRUE;
+}
+
+#endif /* AIRTIME_FAIRNESS_SUPPORT */
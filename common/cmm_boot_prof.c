@@ -0,0 +1,169 @@
+#ifdef BOOT_PROF_SUPPORT
+
+#include "rt_config.h"
+
+/*
+	Interface up profiler.
+
+	rt28xx_init() calls BootProfStart() first and BootProfMark() at the
+	end of every stage, RTMPDrvOpen() marks the last one. A mark keeps
+	the microseconds since the start and the USB control transfers
+	(pAd->VendorReqCnt) since the start, so each stage costs the
+	difference to the stage before it. Steps within a stage are timed
+	on their own with BOOT_PROF_STEP_BEGIN() and BootProfStepEnd() and
+	listed under it, with a "." in front so they do not add to the total.
+
+	The table of the last interface up is in
+	/sys/kernel/debug/<interface>/boot_prof and "iwpriv ra0 show
+	bootprof". tools/bootprof_diff.sh compares two saved copies.
+*/
+
+static const char *BootProfName[BOOT_PROF_STAGE_NUM] = {
+	"chip_on", "firmware", "task_init", "mac_init", "profile", "eeprom",
+	"phy_init", "channel", "auto_ch", "ap_startup", "drv_open"
+};
+
+static const struct {
+	char *pName;
+	enum BOOT_PROF_STAGE Stage;
+} BootProfStep[BOOT_PROF_STEP_NUM] = {
+	{".fw_ilm",		BOOT_PROF_FIRMWARE},
+	{".fw_dlm",		BOOT_PROF_FIRMWARE},
+	{".fw_ready",	BOOT_PROF_FIRMWARE},
+	{".init_cal",	BOOT_PROF_PHY_INIT},
+};
+
+
+VOID BootProfStart(
+	IN PRTMP_ADAPTER pAd)
+{
+	pAd->BootProfRun++;
+	pAd->BootProfMarked = 0;
+	pAd->BootProfStepMarked = 0;
+	pAd->bBootProfFwSkipped = FALSE;
+	NdisZeroMemory(pAd->BootProfUsec, sizeof(pAd->BootProfUsec));
+	NdisZeroMemory(pAd->BootProfXfer, sizeof(pAd->BootProfXfer));
+	NdisZeroMemory(pAd->BootProfStepUsec, sizeof(pAd->BootProfStepUsec));
+
+	pAd->BootProfXferBegin = pAd->VendorReqCnt;
+	pAd->BootProfBegin = RtmpOsGetUsecTime();
+}
+
+
+VOID BootProfMark(
+	IN PRTMP_ADAPTER pAd,
+	IN enum BOOT_PROF_STAGE Stage)
+{
+	pAd->BootProfUsec[Stage] = RtmpOsGetUsecTime() - pAd->BootProfBegin;
+	pAd->BootProfXfer[Stage] = pAd->VendorReqCnt - pAd->BootProfXferBegin;
+	pAd->BootProfMarked |= (1 << Stage);
+
+	if (Stage == BOOT_PROF_DRV_OPEN)
+		DBGPRINT(RT_DEBUG_TRACE, ("Interface up: %u us, %lu control transfers\n",
+					pAd->BootProfUsec[Stage], pAd->BootProfXfer[Stage]));
+}
+
+
+VOID BootProfStepEnd(
+	IN PRTMP_ADAPTER pAd,
+	IN enum BOOT_PROF_STEP Step,
+	IN unsigned int Begin)
+{
+	pAd->BootProfStepUsec[Step] = RtmpOsGetUsecTime() - Begin;
+	pAd->BootProfStepMarked |= (1 << Step);
+}
+
+
+/* to the seq_file of the debugfs file, or to the console when pSeq is NULL */
+static VOID BootProfLine(
+	IN VOID *pSeq,
+	IN char *pLine)
+{
+	if (pSeq != NULL)
+		RtmpOsSeqPrintf(pSeq, "%s", pLine);
+	else
+		DBGPRINT(RT_DEBUG_OFF, ("%s", pLine));
+}
+
+
+static VOID BootProfPrint(
+	IN PRTMP_ADAPTER pAd,
+	IN VOID *pSeq)
+{
+	char Line[96];
+	unsigned int PrevUsec = 0;
+	unsigned long PrevXfer = 0;
+	INT Stage, Step;
+
+	snprintf(Line, sizeof(Line), "# run %u\n", pAd->BootProfRun);
+	BootProfLine(pSeq, Line);
+	if (pAd->bBootProfFwSkipped)
+		BootProfLine(pSeq, "# firmware already running, not loaded\n");
+	snprintf(Line, sizeof(Line), "%-12s %9s %10s %10s\n", "# stage", "end_us", "stage_us", "ctrl_xfer");
+	BootProfLine(pSeq, Line);
+
+	for (Stage = 0; Stage < BOOT_PROF_STAGE_NUM; Stage++)
+	{
+		/* stages after a failure, or not built in */
+		if ((pAd->BootProfMarked & (1 << Stage)) == 0)
+		{
+			snprintf(Line, sizeof(Line), "%-12s %9s %10s %10s\n", BootProfName[Stage], "-", "-", "-");
+			BootProfLine(pSeq, Line);
+			continue;
+		}
+
+		snprintf(Line, sizeof(Line), "%-12s %9u %10u %10lu\n", BootProfName[Stage],
+				pAd->BootProfUsec[Stage], pAd->BootProfUsec[Stage] - PrevUsec,
+				pAd->BootProfXfer[Stage] - PrevXfer);
+		BootProfLine(pSeq, Line);
+
+		PrevUsec = pAd->BootProfUsec[Stage];
+		PrevXfer = pAd->BootProfXfer[Stage];
+
+		for (Step = 0; Step < BOOT_PROF_STEP_NUM; Step++)
+		{
+			if ((BootProfStep[Step].Stage != Stage) ||
+				((pAd->BootProfStepMarked & (1 << Step)) == 0))
+				continue;
+
+			snprintf(Line, sizeof(Line), "%-12s %9s %10u %10s\n", BootProfStep[Step].pName,
+					"-", pAd->BootProfStepUsec[Step], "-");
+			BootProfLine(pSeq, Line);
+		}
+	}
+}
+
+
+static INT BootProfDebugfsShow(
+	IN VOID *pSeq,
+	IN VOID *pData)
+{
+	BootProfPrint((PRTMP_ADAPTER)pData, pSeq);
+
+	return 0;
+}
+
+
+/* called once pAd->pDebugfsDir exists, on the first open */
+VOID BootProfDebugfsInit(
+	IN PRTMP_ADAPTER pAd)
+{
+	if (pAd->pDebugfsDir == NULL)
+		return;
+
+	if (!RtmpOsDebugfsFileCreate(pAd->pDebugfsDir, "boot_prof", BootProfDebugfsShow, pAd))
+		DBGPRINT(RT_DEBUG_ERROR, ("BootProfDebugfsInit::no boot_prof file\n"));
+}
+
+
+INT Show_BootProf_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	BootProfPrint(pAd, NULL);
+
+	return TRUE;
+}
+
+#endif /* BOOT_PROF_SUPPORT */
+
@@ -0,0 +1,112 @@
+#ifdef CACHE_MISS_STAT_SUPPORT
+
+#include "rt_config.h"
+
+/*
+	Cache miss measurement.
+
+	"iwpriv ra0 set CacheMissStat=1" starts a kernel-mode hardware cache
+	miss counter on every CPU, "CacheMissStat=0" or "show cachemiss"
+	divides the misses since then by the frames received (RxCount) and
+	kicked out (KickTxCount) over the same window.
+
+	The counters see the whole CPU, not only this driver. For comparing
+	two builds, pin the USB interrupt to one CPU, keep the rest of the
+	system idle and run the same traffic for the same time.
+*/
+
+static VOID CacheMissStatReport(
+	IN PRTMP_ADAPTER pAd)
+{
+	unsigned long long Misses;
+	unsigned long Now, Packets, Rx, Tx, PerPkt;
+
+	Misses = RtmpOsCacheMissRead(pAd->pCacheMissCounter) - pAd->CacheMissBase;
+	NdisGetSystemUpTime(&Now);
+	Rx = pAd->RalinkCounters.RxCount - pAd->CacheMissRxBase;
+	Tx = pAd->RalinkCounters.KickTxCount - pAd->CacheMissTxBase;
+
+	/* scale both down to 32 bits, 64-bit division is not available everywhere */
+	Packets = Rx + Tx;
+	while (Misses >> 32)
+	{
+		Misses >>= 1;
+		Packets >>= 1;
+	}
+	PerPkt = (Packets != 0) ? ((unsigned long)Misses * 10 / Packets) : 0;
+
+	DBGPRINT(RT_DEBUG_OFF, ("CacheMiss: %ldms, Rx=%ld, Tx=%ld, Misses/Pkt=%ld.%ld\n",
+				(Now - pAd->CacheMissStartTime) * 1000 / OS_HZ,
+				Rx, Tx, PerPkt / 10, PerPkt % 10));
+}
+
+
+VOID CacheMissStatStop(
+	IN PRTMP_ADAPTER pAd)
+{
+	if (pAd->pCacheMissCounter == NULL)
+		return;
+
+	RtmpOsCacheMissStop(pAd->pCacheMissCounter);
+	pAd->pCacheMissCounter = NULL;
+}
+
+
+INT Set_CacheMissStat_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	if (simple_strtol(arg, 0, 10) != 0)
+	{
+		CacheMissStatStop(pAd);
+
+		pAd->pCacheMissCounter = RtmpOsCacheMissStart();
+		if (pAd->pCacheMissCounter == NULL)
+		{
+			DBGPRINT(RT_DEBUG_ERROR, ("Set_CacheMissStat_Proc::no cache miss counter\n"));
+			return FALSE;
+		}
+
+		pAd->CacheMissRxBase = pAd->RalinkCounters.RxCount;
+		pAd->CacheMissTxBase = pAd->RalinkCounters.KickTxCount;
+		NdisGetSystemUpTime(&pAd->CacheMissStartTime);
+		pAd->CacheMissBase = RtmpOsCacheMissRead(pAd->pCacheMissCounter);
+	}
+	else if (pAd->pCacheMissCounter != NULL)
+	{
+		CacheMissStatReport(pAd);
+		CacheMissStatStop(pAd);
+	}
+
+	DBGPRINT(RT_DEBUG_TRACE, ("Set_CacheMissStat_Proc::(Running=%d)\n",
+				(pAd->pCacheMissCounter != NULL)));
+
+	return TRUE;
+}
+
+
+INT Show_CacheMissStat_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	MAC_TABLE_ENTRY *pEntry = &pAd->MacTab.Content[0];
+
+	/* the per-packet fields end with pNext, see MAC_TABLE_ENTRY */
+	DBGPRINT(RT_DEBUG_OFF, ("MacEntry=%d bytes, HotFields=%d bytes, HotLookup=%d bytes\n",
+				(INT)sizeof(MAC_TABLE_ENTRY),
+				(INT)((unsigned char *)(&pEntry->pNext + 1) - (unsigned char *)pEntry),
+				(INT)sizeof(pAd->MacTab.Hot)));
+
+	if (pAd->pCacheMissCounter == NULL)
+	{
+		DBGPRINT(RT_DEBUG_OFF, ("CacheMiss: not running, set CacheMissStat=1 first\n"));
+		return TRUE;
+	}
+
+	CacheMissStatReport(pAd);
+
+	return TRUE;
+}
+
+#endif /* CACHE_MISS_STAT_SUPPORT */
+
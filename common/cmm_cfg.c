@@ -958,6 +958,20 @@ INT RTMP_COM_IoctlHandle(
 				pAd->BulkInEpAddr[i] = pConfig->BulkInEpAddr[i];
 
 			pAd->config = pConfig->pConfig;
+
+			/* keep one buffer free for parsing while the others are in flight */
+			if ((pConfig->RxUrbNum < 1) || (pConfig->RxUrbNum > RX_RING_SIZE - 1))
+				pAd->RxUrbNum = (RX_URB_NUM_DEFAULT < RX_RING_SIZE) ? RX_URB_NUM_DEFAULT : 1;
+			else
+				pAd->RxUrbNum = pConfig->RxUrbNum;
+
+			if ((pConfig->RxBulkAgg < RXBULKAGGRE_SIZE_MIN) || (pConfig->RxBulkAgg > RXBULKAGGRE_SIZE_MAX))
+				pAd->RxBulkSize = MAX_RXBULK_SIZE;
+			else
+				pAd->RxBulkSize = LOCAL_TXBUF_SIZE * pConfig->RxBulkAgg;
+
+			DBGPRINT(RT_DEBUG_TRACE, ("%s(): RxUrbNum=%d, RxBulkSize=%ld\n",
+						__FUNCTION__, pAd->RxUrbNum, pAd->RxBulkSize));
 		}
 			break;
 
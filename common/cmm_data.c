@@ -1157,6 +1157,106 @@ bool CanDoAggregateTransmit(
 }
 
 
+/*
+	Clear a TX_BLK for the next frame. Only the front of HeaderBuf is
+	cleared: TXINFO and TXWI are filled field by field, and the 802.11
+	header builders leave the QoS/HTC fields and the alignment padding
+	alone. That is TXINFO + the largest TXWI (24) + a 4-address QoS
+	header with HTC (36) + 3 bytes of padding, rounded up. The AMSDU
+	subheader and LLC/SNAP after it are always written whole.
+*/
+#define TX_BLK_HDR_CLEAR_LEN	72
+
+static inline VOID RTMPResetTxBlk(
+	IN TX_BLK *pTxBlk)
+{
+	unsigned char *pHdr, *pTail;
+
+#ifdef VENDOR_FEATURE1_SUPPORT
+	pHdr = (unsigned char *)&pTxBlk->HeaderBuffer[0];
+	pTail = pHdr + sizeof(pTxBlk->HeaderBuffer);
+#else
+	pHdr = &pTxBlk->HeaderBuf[0];
+	pTail = pHdr + sizeof(pTxBlk->HeaderBuf);
+#endif /* VENDOR_FEATURE1_SUPPORT */
+
+	NdisZeroMemory((unsigned char *)pTxBlk, pHdr - (unsigned char *)pTxBlk);
+	NdisZeroMemory(pHdr, TX_BLK_HDR_CLEAR_LEN);
+	NdisZeroMemory(pTail, sizeof(TX_BLK) - (pTail - (unsigned char *)pTxBlk));
+}
+
+
+/*
+	A station is being deleted. Its frames already in a dequeue batch
+	missed the queue cleanup, so have the dequeuer drop them. Marks are
+	cleared whenever a new batch is taken; every frame in it was queued
+	after the cleanup.
+*/
+VOID RTMPTxBatchWcidStale(
+	IN RTMP_ADAPTER *pAd,
+	IN unsigned char Wcid)
+{
+	unsigned char QueIdx;
+	unsigned long IrqFlags;
+
+	if (Wcid >= MAX_LEN_OF_MAC_TABLE)
+		return;
+
+	RTMP_IRQ_LOCK(&pAd->irq_lock, IrqFlags);
+	for (QueIdx = 0; QueIdx < NUM_OF_TX_RING; QueIdx++)
+	{
+		pAd->TxSwQBatchStale[QueIdx][Wcid >> 5] |= (1 << (Wcid & 0x1f));
+		pAd->bTxSwQBatchStale[QueIdx] = TRUE;
+	}
+	RTMP_IRQ_UNLOCK(&pAd->irq_lock, IrqFlags);
+}
+
+
+static inline bool RTMPTxBatchFrameStale(
+	IN RTMP_ADAPTER *pAd,
+	IN unsigned char QueIdx,
+	IN PNDIS_PACKET pPacket)
+{
+	unsigned char Wcid;
+
+	if (pAd->bTxSwQBatchStale[QueIdx] == FALSE)
+		return FALSE;
+	if (RTMP_GET_PACKET_MGMT_PKT(pPacket) == 1)
+		return FALSE;
+
+	Wcid = RTMP_GET_PACKET_WCID(pPacket);
+	if ((Wcid == MCAST_WCID) || (Wcid >= MAX_LEN_OF_MAC_TABLE))
+		return FALSE;
+
+	return (pAd->TxSwQBatchStale[QueIdx][Wcid >> 5] & (1 << (Wcid & 0x1f))) ? TRUE : FALSE;
+}
+
+
+/* Free the stale frames left in a batch before it goes back to its queue */
+static VOID RTMPTxBatchDropStale(
+	IN RTMP_ADAPTER *pAd,
+	IN unsigned char QueIdx,
+	IN PQUEUE_HEADER pBatch)
+{
+	QUEUE_HEADER Keep;
+	PQUEUE_ENTRY pQEntry;
+
+	if (pAd->bTxSwQBatchStale[QueIdx] == FALSE)
+		return;
+
+	InitializeQueueHeader(&Keep);
+	while (pBatch->Head != NULL)
+	{
+		pQEntry = RemoveHeadQueue(pBatch);
+		if (RTMPTxBatchFrameStale(pAd, QueIdx, QUEUE_ENTRY_TO_PACKET(pQEntry)))
+			RELEASE_NDIS_PACKET(pAd, QUEUE_ENTRY_TO_PACKET(pQEntry), NDIS_STATUS_FAILURE);
+		else
+			InsertTailQueue(&Keep, pQEntry);
+	}
+	*pBatch = Keep;
+}
+
+
 /*
 	========================================================================
 
@@ -1190,11 +1290,16 @@ VOID RTMPDeQueuePacket(
 	NDIS_STATUS Status = NDIS_STATUS_SUCCESS;
 	unsigned char Count=0;
 	PQUEUE_HEADER   pQueue;
+	QUEUE_HEADER	TxBatch;
 	unsigned long FreeNumber[NUM_OF_TX_RING];
 	unsigned char QueIdx, sQIdx, eQIdx;
 	unsigned long	IrqFlags = 0;
 	bool hasTxDesc = FALSE;
 	TX_BLK TxBlk, *pTxBlk;
+	INT Budget = Max_Tx_Packets;
+#if defined(AIRTIME_FAIRNESS_SUPPORT) || defined(TX_AQM_SUPPORT)
+	PQUEUE_HEADER pTxBatchSrc = NULL;
+#endif /* defined(AIRTIME_FAIRNESS_SUPPORT) || defined(TX_AQM_SUPPORT) */
 
 #ifdef DBG_DIAGNOSE
 	bool			firstRound;
@@ -1214,9 +1319,15 @@ VOID RTMPDeQueuePacket(
 	else
 		sQIdx = eQIdx = QIdx;
 
+	InitializeQueueHeader(&TxBatch);
+	pQueue = &TxBatch;
+
 	for (QueIdx=sQIdx; QueIdx <= eQIdx; QueIdx++)
 	{
 		Count = 0;
+#ifdef USB_TX_ADAPTIVE_BATCH
+		Budget = RTUSBTxBatchBudget(pAd, QueIdx, Max_Tx_Packets);
+#endif /* USB_TX_ADAPTIVE_BATCH */
 
 		RTMP_START_DEQUEUE(pAd, QueIdx, IrqFlags);
 
@@ -1236,6 +1347,20 @@ VOID RTMPDeQueuePacket(
 										fRTMP_ADAPTER_NIC_NOT_EXIST
 			))))
 			{
+				RTMPTxBatchDropStale(pAd, QueIdx, &TxBatch);
+#if defined(AIRTIME_FAIRNESS_SUPPORT)
+				ATFRequeueBatch(pAd, bIntContext, QueIdx, pTxBatchSrc, &TxBatch);
+#elif defined(TX_AQM_SUPPORT)
+				AQMRequeueBatch(pAd, bIntContext, QueIdx, pTxBatchSrc, &TxBatch);
+#else
+				if (TxBatch.Head != NULL)
+				{
+					DEQUEUE_LOCK(&pAd->irq_lock, bIntContext, IrqFlags);
+					RequeueHeadBatch(&pAd->TxSwQueue[QueIdx], &TxBatch);
+					DEQUEUE_UNLOCK(&pAd->irq_lock, bIntContext, IrqFlags);
+				}
+#endif /* defined(AIRTIME_FAIRNESS_SUPPORT) */
+				pAd->TxSwQBatch[QueIdx] = 0;
 				RTMP_STOP_DEQUEUE(pAd, QueIdx, IrqFlags);
 				return;
 			}
@@ -1244,21 +1369,53 @@ VOID RTMPDeQueuePacket(
 				break;
 #endif /* CONFIG_MULTI_CHANNEL */
 
-			if (Count >= Max_Tx_Packets)
+			if (Count >= Budget)
 				break;
 
-			DEQUEUE_LOCK(&pAd->irq_lock, bIntContext, IrqFlags);
+			/*
+				Take frames off TxSwQueue a batch at a time, so irq_lock is
+				held once per batch instead of for every frame. Frames left
+				over are put back in front of TxSwQueue when we stop.
+				With airtime fairness the batch comes from the station
+				whose turn it is and goes back to that station's queue,
+				with AQM it comes from the flow whose turn it is.
+				The frames held here still count against TxSwQMaxLen.
+			*/
+			if (TxBatch.Head == NULL)
+			{
+				if (pAd->bTxSwQBatchStale[QueIdx])
+				{
+					DEQUEUE_LOCK(&pAd->irq_lock, bIntContext, IrqFlags);
+					NdisZeroMemory(pAd->TxSwQBatchStale[QueIdx], sizeof(pAd->TxSwQBatchStale[QueIdx]));
+					pAd->bTxSwQBatchStale[QueIdx] = FALSE;
+					DEQUEUE_UNLOCK(&pAd->irq_lock, bIntContext, IrqFlags);
+				}
+#if defined(AIRTIME_FAIRNESS_SUPPORT)
+				pTxBatchSrc = ATFDequeueBatch(pAd, bIntContext, QueIdx, &TxBatch);
+#elif defined(TX_AQM_SUPPORT)
+				pTxBatchSrc = AQMDequeueBatch(pAd, bIntContext, QueIdx, &TxBatch);
+#else
+				DEQUEUE_LOCK(&pAd->irq_lock, bIntContext, IrqFlags);
+				DequeueHeadBatch(&pAd->TxSwQueue[QueIdx], &TxBatch, TX_DEQUEUE_BATCH_NUM);
+				DEQUEUE_UNLOCK(&pAd->irq_lock, bIntContext, IrqFlags);
+#endif /* AIRTIME_FAIRNESS_SUPPORT */
+			}
+			pAd->TxSwQBatch[QueIdx] = TxBatch.Number;
 
 			/* probe the Queue Head*/
-			pQueue = &pAd->TxSwQueue[QueIdx];
 			if ((pEntry = pQueue->Head) == NULL)
-			{
-				DEQUEUE_UNLOCK(&pAd->irq_lock, bIntContext, IrqFlags);
 				break;
+
+			/* the station left after this frame was taken off its queue */
+			if (RTMPTxBatchFrameStale(pAd, QueIdx, QUEUE_ENTRY_TO_PACKET(pEntry)))
+			{
+				pEntry = RemoveHeadQueue(pQueue);
+				RELEASE_NDIS_PACKET(pAd, QUEUE_ENTRY_TO_PACKET(pEntry), NDIS_STATUS_FAILURE);
+				continue;
 			}
 
 			pTxBlk = &TxBlk;
-			NdisZeroMemory((unsigned char *)pTxBlk, sizeof(TX_BLK));
+			RTMPResetTxBlk(pTxBlk);
 			pTxBlk->QueIdx = QueIdx;
 
 #ifdef VENDOR_FEATURE1_SUPPORT
@@ -1283,7 +1440,6 @@ VOID RTMPDeQueuePacket(
 					RELEASE_NDIS_PACKET(pAd, pPacket, NDIS_STATUS_FAILURE);
 				}
 
-				DEQUEUE_UNLOCK(&pAd->irq_lock, bIntContext, IrqFlags);
 				Count++;
 				continue;
 			}
@@ -1310,7 +1466,6 @@ VOID RTMPDeQueuePacket(
 					{
 						pEntry = RemoveHeadQueue(pQueue);
 						RELEASE_NDIS_PACKET(pAd, pPacket, NDIS_STATUS_FAILURE);
-						DEQUEUE_UNLOCK(&pAd->irq_lock, bIntContext, IrqFlags);
 						continue;
 					}
 					else
@@ -1345,7 +1500,6 @@ VOID RTMPDeQueuePacket(
 					{
 						pEntry = RemoveHeadQueue(pQueue);
 					RELEASE_NDIS_PACKET(pAd, pPacket, NDIS_STATUS_FAILURE);
-						DEQUEUE_UNLOCK(&pAd->irq_lock, bIntContext, IrqFlags);
 						continue;
 					}
 					else
@@ -1359,9 +1513,6 @@ VOID RTMPDeQueuePacket(
 			if (!hasTxDesc)
 			{
 				pAd->PrivateInfo.TxRingFullCnt++;
-
-				DEQUEUE_UNLOCK(&pAd->irq_lock, bIntContext, IrqFlags);
-				
 				break;
 			}
 
@@ -1379,7 +1530,6 @@ VOID RTMPDeQueuePacket(
 				if (NEED_QUEUE_BACK_FOR_AGG(pAd, QueIdx, FreeNumber[QueIdx], pTxBlk->TxFrameType))
 				{
 					InsertHeadQueue(pQueue, PACKET_TO_QUEUE_ENTRY(pPacket));
-					DEQUEUE_UNLOCK(&pAd->irq_lock, bIntContext, IrqFlags);
 					break;
 				}
 			}
@@ -1391,7 +1541,6 @@ VOID RTMPDeQueuePacket(
 				if (NEED_QUEUE_BACK_FOR_AGG(pAd, QueIdx, FreeNumber[QueIdx], pTxBlk->TxFrameType))
 				{
 					InsertHeadQueue(pQueue, PACKET_TO_QUEUE_ENTRY(pPacket));
-					DEQUEUE_UNLOCK(&pAd->irq_lock, bIntContext, IrqFlags);
 					break;
 				}
 
@@ -1422,11 +1571,10 @@ VOID RTMPDeQueuePacket(
 					pTxBlk->TxFrameType = TX_LEGACY_FRAME;
 			}
 
-#ifdef RTMP_MAC_USB
-			DEQUEUE_UNLOCK(&pAd->irq_lock, bIntContext, IrqFlags);
-#endif /* RTMP_MAC_USB */
-					
 			Count += pTxBlk->TxPacketList.Number;
+#ifdef USB_TX_ADAPTIVE_BATCH
+			RTUSBTxBatchFrameWritten(pAd, QueIdx, pTxBlk->TotalFrameLen / pTxBlk->TxPacketList.Number);
+#endif /* USB_TX_ADAPTIVE_BATCH */
 
 				/* Do HardTransmit now.*/
 #ifdef CONFIG_AP_SUPPORT
@@ -1437,6 +1585,21 @@ VOID RTMPDeQueuePacket(
 
 		}
 
+		RTMPTxBatchDropStale(pAd, QueIdx, &TxBatch);
+#if defined(AIRTIME_FAIRNESS_SUPPORT)
+		ATFRequeueBatch(pAd, bIntContext, QueIdx, pTxBatchSrc, &TxBatch);
+#elif defined(TX_AQM_SUPPORT)
+		AQMRequeueBatch(pAd, bIntContext, QueIdx, pTxBatchSrc, &TxBatch);
+#else
+		if (TxBatch.Head != NULL)
+		{
+			DEQUEUE_LOCK(&pAd->irq_lock, bIntContext, IrqFlags);
+			RequeueHeadBatch(&pAd->TxSwQueue[QueIdx], &TxBatch);
+			DEQUEUE_UNLOCK(&pAd->irq_lock, bIntContext, IrqFlags);
+		}
+#endif /* AIRTIME_FAIRNESS_SUPPORT */
+		pAd->TxSwQBatch[QueIdx] = 0;
+
 		RTMP_STOP_DEQUEUE(pAd, QueIdx, IrqFlags);
 
 #ifdef RTMP_MAC_USB
@@ -1449,7 +1612,7 @@ VOID RTMPDeQueuePacket(
 		
 #ifdef BLOCK_NET_IF
 		if ((pAd->blockQueueTab[QueIdx].SwTxQueueBlockFlag == TRUE)
-			&& (pAd->TxSwQueue[QueIdx].Number < 1))
+			&& (TX_SWQ_PENDING(pAd, QueIdx) < 1))
 		{
 			releaseNetIf(&pAd->blockQueueTab[QueIdx]);
 		}
@@ -2231,6 +2394,7 @@ if (0) {
 
 #ifdef RTMP_MAC_USB
 #ifdef DOT11_N_SUPPORT
+#ifndef BA_HRTIMER_SUPPORT
 	if (pAd->CommonCfg.bDisableReordering == 0)
 	{
 		PBA_REC_ENTRY		pBAEntry;
@@ -2261,6 +2425,7 @@ if (0) {
 			}
 		}
 	}
+#endif /* BA_HRTIMER_SUPPORT */
 #endif /* DOT11_N_SUPPORT */
 #endif /* RTMP_MAC_USB */
 
@@ -2336,6 +2501,7 @@ if (0) {
 
 #ifdef RTMP_MAC_USB
 #ifdef DOT11_N_SUPPORT
+#ifndef BA_HRTIMER_SUPPORT
 	if (pAd->CommonCfg.bDisableReordering == 0)
 	{
 		PBA_REC_ENTRY		pBAEntry;
@@ -2366,6 +2532,7 @@ if (0) {
 			}
 		}
 	}
+#endif /* BA_HRTIMER_SUPPORT */
 #endif /* DOT11_N_SUPPORT */
 #endif /* RTMP_MAC_USB */
 
@@ -2944,7 +3111,11 @@ bool CmdRspEventCallbackHandle(PRTMP_ADAPTER pAd, unsigned char * pRspBuffer)
 				else
 				{
 					DlListDel(&CmdRspEvent->List);
+#ifdef MEM_POOL_SUPPORT
+					McuRspEventFree(pAd, CmdRspEvent);
+#else
 					os_free_mem(NULL, CmdRspEvent);
+#endif /* MEM_POOL_SUPPORT */
 				}
 
 				break;
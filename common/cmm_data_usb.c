@@ -95,6 +95,20 @@ NDIS_STATUS	RTUSBFreeDescRequest(
 }
 
 
+#ifdef USB_TX_ADAPTIVE_BATCH
+/* bytes written into the ring behind the URB in flight, called with TxContextQueueLock held */
+static inline unsigned long RTUSBTxBatchStaged(
+	IN HT_TX_CONTEXT *pHTTXContext)
+{
+	if (pHTTXContext->CurWritePosition >= pHTTXContext->ENextBulkOutPosition)
+		return pHTTXContext->CurWritePosition - pHTTXContext->ENextBulkOutPosition;
+
+	/* the writer went back to the start of the ring */
+	return pHTTXContext->CurWritePosition;
+}
+#endif /* USB_TX_ADAPTIVE_BATCH */
+
+
 bool	RTUSBNeedQueueBackForAgg(RTMP_ADAPTER *pAd, unsigned char BulkOutPipeId)
 {
 	HT_TX_CONTEXT *pHTTXContext;
@@ -105,6 +119,23 @@ bool	RTUSBNeedQueueBackForAgg(RTMP_ADAPTER *pAd, unsigned char BulkOutPipeId)
 	pHTTXContext = &pAd->TxContext[BulkOutPipeId];
 	
 	RTMP_IRQ_LOCK(&pAd->TxContextQueueLock[BulkOutPipeId], IrqFlags);
+#ifdef USB_TX_ADAPTIVE_BATCH
+	if (pAd->bTxBatchAdaptive)
+	{
+		/*
+			While a URB is out the ring can't be sent anyway, so once it
+			holds enough for the next URB keep the rest in TxSwQueue where
+			it can still be aggregated. An idle pipe never holds frames.
+		*/
+		if ((pHTTXContext->IRPPending == TRUE)
+			&& (RTUSBTxBatchStaged(pHTTXContext) >= TX_BATCH_TARGET(&pAd->TxBatchCtrl[BulkOutPipeId])))
+		{
+			pAd->TxBatchCtrl[BulkOutPipeId].Holds++;
+			needQueBack = TRUE;
+		}
+	}
+	else
+#endif /* USB_TX_ADAPTIVE_BATCH */
 	if ((pHTTXContext->IRPPending == TRUE)  /*&& (pAd->TxSwQueue[BulkOutPipeId].Number == 0) */)
 	{
 		if ((pHTTXContext->CurWritePosition < pHTTXContext->ENextBulkOutPosition) && 
@@ -125,6 +156,119 @@ bool	RTUSBNeedQueueBackForAgg(RTMP_ADAPTER *pAd, unsigned char BulkOutPipeId)
 }
 
 
+#ifdef USB_TX_ADAPTIVE_BATCH
+/*
+	========================================================================
+
+	Routine	Description:
+		Number of frames RTMPDeQueuePacket() may write into the HT TX ring
+		of a pipe in one pass. It covers one bulk-out worth of frames,
+		i.e. what arrived during the last URBs in flight, bounded by the
+		free space of the ring. Under load the URBs go out full, on an
+		idle link the budget stays at the default and the frames are
+		kicked out right away.
+
+	Arguments:
+		pAd				Pointer to our adapter
+		BulkOutPipeId	AC of the pipe
+		DefaultBudget	budget asked for by the caller, the lower bound
+
+	Return Value:
+		frame budget
+
+	========================================================================
+*/
+INT RTUSBTxBatchBudget(
+	IN RTMP_ADAPTER *pAd,
+	IN unsigned char BulkOutPipeId,
+	IN INT DefaultBudget)
+{
+	HT_TX_CONTEXT *pHTTXContext;
+	TX_BATCH_CTRL *pCtrl;
+	unsigned long IrqFlags, Room, Target;
+	INT Budget;
+
+	if ((pAd->bTxBatchAdaptive == FALSE) || (BulkOutPipeId >= NUM_OF_TX_RING))
+		return DefaultBudget;
+
+	pHTTXContext = &pAd->TxContext[BulkOutPipeId];
+	pCtrl = &pAd->TxBatchCtrl[BulkOutPipeId];
+	Target = TX_BATCH_TARGET(pCtrl);
+
+	RTMP_IRQ_LOCK(&pAd->TxContextQueueLock[BulkOutPipeId], IrqFlags);
+	if (pHTTXContext->CurWritePosition >= pHTTXContext->NextBulkOutPosition)
+		Room = MAX_TXBULK_LIMIT - pHTTXContext->CurWritePosition + pHTTXContext->NextBulkOutPosition;
+	else
+		Room = pHTTXContext->NextBulkOutPosition - pHTTXContext->CurWritePosition;
+	RTMP_IRQ_UNLOCK(&pAd->TxContextQueueLock[BulkOutPipeId], IrqFlags);
+
+	if (Room > Target)
+		Room = Target;
+
+	/* RTMP_HAS_ENOUGH_FREE_DESC still checks every frame, this is only an estimate */
+	Budget = (INT)(Room / (pCtrl->FrameLenAvg + TX_BATCH_FRAME_OVERHEAD));
+	if (Budget < DefaultBudget)
+		Budget = DefaultBudget;
+	else if (Budget > TX_BATCH_MAX_FRAMES)
+		Budget = TX_BATCH_MAX_FRAMES;
+
+	pCtrl->Budget = Budget;
+
+	return Budget;
+}
+
+
+VOID RTUSBTxBatchFrameWritten(
+	IN RTMP_ADAPTER *pAd,
+	IN unsigned char BulkOutPipeId,
+	IN unsigned int FrameLen)
+{
+	TX_BATCH_CTRL *pCtrl = &pAd->TxBatchCtrl[BulkOutPipeId];
+
+	pCtrl->FrameLenAvg = pCtrl->FrameLenAvg - (pCtrl->FrameLenAvg >> 3) + (FrameLen >> 3);
+}
+
+
+/* Account a data bulk-out, from the HT TX ring or a scatter-gather URB */
+VOID RTUSBTxBatchUrbSubmit(
+	IN RTMP_ADAPTER *pAd,
+	IN unsigned char BulkOutPipeId,
+	IN unsigned long BulkSize)
+{
+	TX_BATCH_CTRL *pCtrl = &pAd->TxBatchCtrl[BulkOutPipeId];
+	unsigned long Bucket;
+
+	Bucket = BulkSize >> 12;
+	if (Bucket >= TX_BATCH_URB_BUCKET)
+		Bucket = TX_BATCH_URB_BUCKET - 1;
+
+	pCtrl->UrbCount++;
+	pCtrl->UrbBytes += BulkSize;
+	pCtrl->UrbHist[Bucket]++;
+}
+
+
+/*
+	An HT TX ring URB completed. Everything written into the ring since it
+	was submitted is what the next bulk-out should carry.
+*/
+VOID RTUSBTxBatchUrbComplete(
+	IN RTMP_ADAPTER *pAd,
+	IN unsigned char BulkOutPipeId)
+{
+	HT_TX_CONTEXT *pHTTXContext = &pAd->TxContext[BulkOutPipeId];
+	TX_BATCH_CTRL *pCtrl = &pAd->TxBatchCtrl[BulkOutPipeId];
+	unsigned long IrqFlags, Staged;
+
+	RTMP_IRQ_LOCK(&pAd->TxContextQueueLock[BulkOutPipeId], IrqFlags);
+	Staged = RTUSBTxBatchStaged(pHTTXContext);
+	RTMP_IRQ_UNLOCK(&pAd->TxContextQueueLock[BulkOutPipeId], IrqFlags);
+
+	pCtrl->StagedAvg = pCtrl->StagedAvg - (pCtrl->StagedAvg >> 3) + (unsigned int)(Staged >> 3);
+}
+#endif /* USB_TX_ADAPTIVE_BATCH */
+
+
 /*
 	========================================================================
 	
@@ -546,19 +690,6 @@ unsigned short RtmpUSB_WriteSingleTxResource(
 		pTxInfo = (TXINFO_STRUC *)buf;
 		pTxWI= (TXWI_STRUC *)&buf[TXINFO_SIZE];
 
-#ifndef USB_BULK_BUF_ALIGMENT
-		/* Reserve space for 8 bytes padding.*/
-		if ((pHTTXContext->ENextBulkOutPosition == pHTTXContext->CurWritePosition))
-		{
-			pHTTXContext->ENextBulkOutPosition += 8;
-			pHTTXContext->CurWritePosition += 8;
-			fillOffset += 8;
-		}
-#endif /* USB_BULK_BUF_ALIGMENT */
-		pHTTXContext->CurWriteRealPos = pHTTXContext->CurWritePosition;
-
-		pWirelessPacket = &pHTTXContext->TransferBuffer->field.WirelessPacket[fillOffset];
-
 		/* Build our URB for USBD */
 		hdr_len = TXWISize + TSO_SIZE + pTxBlk->MpduHeaderLen + pTxBlk->HdrPadLen;
 		hdr_copy_len = TXINFO_SIZE + hdr_len;
@@ -585,6 +716,29 @@ unsigned short RtmpUSB_WriteSingleTxResource(
 		rlt_usb_write_txinfo(pAd, pTxInfo, (unsigned short)(dma_len), FALSE, FIFO_EDCA, FALSE /*NextValid*/,  FALSE, 1);
 #endif /* HDR_TRANS_SUPPORT */
 
+#ifdef USB_BULK_OUT_SG_SUPPORT
+		/* Nothing waits in the ring, send the payload straight from the skb */
+		if (RTUSBBulkOutSgPacket(pAd, pHTTXContext, pTxBlk, hdr_copy_len, padding))
+		{
+			pHTTXContext->bCurWriting = FALSE;
+			RTMP_IRQ_UNLOCK(&pAd->TxContextQueueLock[QueIdx], IrqFlags);
+			return(Status);
+		}
+#endif /* USB_BULK_OUT_SG_SUPPORT */
+
+#ifndef USB_BULK_BUF_ALIGMENT
+		/* Reserve space for 8 bytes padding.*/
+		if ((pHTTXContext->ENextBulkOutPosition == pHTTXContext->CurWritePosition))
+		{
+			pHTTXContext->ENextBulkOutPosition += 8;
+			pHTTXContext->CurWritePosition += 8;
+			fillOffset += 8;
+		}
+#endif /* USB_BULK_BUF_ALIGMENT */
+		pHTTXContext->CurWriteRealPos = pHTTXContext->CurWritePosition;
+
+		pWirelessPacket = &pHTTXContext->TransferBuffer->field.WirelessPacket[fillOffset];
+
 
 #ifndef USB_BULK_BUF_ALIGMENT
 		if ((pHTTXContext->CurWritePosition + 3906 + pTxBlk->Priv) > MAX_TXBULK_LIMIT)
@@ -1261,16 +1415,45 @@ if (0) {
 	RTMPWIEndianChange(pAd, pData, TYPE_RXWI);
 #endif /* RT_BIG_ENDIAN */
 
-	/* allocate a rx packet*/
-	pNetPkt = RTMP_AllocateFragPacketBuffer(pAd, ThisFrameLen);
-	if (pNetPkt == NULL)
+#ifdef RX_ZERO_COPY_SUPPORT
+	if (ThisFrameLen >= pAd->RxCopyBreak)
 	{
-		DBGPRINT(RT_DEBUG_ERROR,("%s():Cannot Allocate sk buffer for this Bulk-In buffer!\n", __FUNCTION__));
-		goto label_null;
+		/*
+			Hand the frame up as a clone of the bulk-in buffer, the buffer is
+			released when the last frame referring to it is freed.
+		*/
+		OS_PKT_CLONE(pAd, pRxContext->pRxBufPkt, pNetPkt, MEM_ALLOC_FLAG);
+		if (pNetPkt == NULL)
+		{
+			DBGPRINT(RT_DEBUG_ERROR,("%s():Cannot clone sk buffer for this Bulk-In buffer!\n", __FUNCTION__));
+			goto label_null;
+		}
+
+		RTMP_OS_PKT_INIT(pNetPkt, get_netdev_from_bssid(pAd, BSS0), pData, ThisFrameLen);
+		RTMP_SET_PACKET_SOURCE(pNetPkt, PKTSRC_NDIS);
+		pAd->RxZcBytesRef += ThisFrameLen;
 	}
+	else
+#endif /* RX_ZERO_COPY_SUPPORT */
+	{
+		/* allocate a rx packet*/
+#ifdef MEM_POOL_SUPPORT
+		pNetPkt = RTMP_AllocateRxPacketBuffer(pAd, ThisFrameLen);
+#else
+		pNetPkt = RTMP_AllocateFragPacketBuffer(pAd, ThisFrameLen);
+#endif /* MEM_POOL_SUPPORT */
+		if (pNetPkt == NULL)
+		{
+			DBGPRINT(RT_DEBUG_ERROR,("%s():Cannot Allocate sk buffer for this Bulk-In buffer!\n", __FUNCTION__));
+			goto label_null;
+		}
 
-	/* copy the rx packet*/
-	RTMP_USB_PKT_COPY(get_netdev_from_bssid(pAd, BSS0), pNetPkt, ThisFrameLen, pData);
+		/* copy the rx packet*/
+		RTMP_USB_PKT_COPY(get_netdev_from_bssid(pAd, BSS0), pNetPkt, ThisFrameLen, pData);
+#ifdef RX_ZERO_COPY_SUPPORT
+		pAd->RxZcBytesCopied += ThisFrameLen;
+#endif /* RX_ZERO_COPY_SUPPORT */
+	}
 
 #ifdef RT_BIG_ENDIAN
 	RTMPDescriptorEndianChange((unsigned char *)pRxInfo, TYPE_RXINFO);
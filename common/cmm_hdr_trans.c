@@ -0,0 +1,350 @@
+#ifdef HDR_TRANS_SUPPORT
+
+#include "rt_config.h"
+#include "hdr_trans.h"
+
+/*
+	Header translation.
+
+	The MAC can convert between 802.3 and 802.11 headers by itself. On RX
+	it does so for the WCIDs set in HT_RX_WCID_EN, and the frame arrives at
+	APHandleRxDataFrame_Hdr_Trns already carrying an 802.3 header. On TX a
+	frame whose TXINFO is not marked 802.11 is sent with a 4-byte WIFI_INFO
+	in place of the 802.11 header, which the AP_xxx_Frame_Tx_Hdr_Trns
+	paths build.
+
+	Each station has its own HdrTransMode. While it is on, unicast data to
+	and from the station takes the translated paths. EAPOL/WAI, software
+	encrypted and 802.3 length-field frames keep the 802.11 path.
+
+	With HdrTransBench on, APHardTransmit and APRxPacket count the time
+	in nanoseconds each unicast data frame costs on either path. The counters are
+	statistics only and are updated without a lock.
+*/
+
+VOID HdrTransInit(
+	IN PRTMP_ADAPTER pAd)
+{
+	pAd->HdrTransDefault = HDR_TRANS_MODE_OFF;
+	pAd->bHdrTransBench = FALSE;
+	NdisZeroMemory(pAd->HdrTransRxWcidMap, sizeof(pAd->HdrTransRxWcidMap));
+	NdisZeroMemory(pAd->HdrTransBench, sizeof(pAd->HdrTransBench));
+}
+
+
+/*
+	========================================================================
+	Routine Description:
+		Switch a station between the translated and the 802.11 data path.
+		RX is switched through the station's bit in HT_RX_WCID_EN, TX per
+		frame by HdrTransTxSelect.
+
+	Note:
+		Called with MacTabLock held.
+	========================================================================
+*/
+VOID HdrTransEntrySet(
+	IN PRTMP_ADAPTER pAd,
+	IN PMAC_TABLE_ENTRY pEntry,
+	IN unsigned char Mode)
+{
+	unsigned char Wcid = (unsigned char)pEntry->Aid;
+	unsigned int *pMap, Bit, OldMap;
+
+	pEntry->HdrTransMode = Mode;
+
+	if (Wcid >= MAX_LEN_OF_MAC_TABLE)
+		return;
+
+	pMap = &pAd->HdrTransRxWcidMap[Wcid / HT_RX_WCID_OFFSET];
+	Bit = 1 << (Wcid % HT_RX_WCID_OFFSET);
+	OldMap = *pMap;
+
+	if ((Mode == HDR_TRANS_MODE_ON) && IS_ENTRY_CLIENT(pEntry))
+		*pMap |= Bit;
+	else
+		*pMap &= ~Bit;
+
+	if (*pMap == OldMap)
+		return;
+
+#ifdef RTMP_MAC_USB
+	RTEnqueueInternalCmd(pAd, CMDTHREAD_SET_HDR_TRANS_WCID, &Wcid, sizeof(unsigned char));
+#else
+	HdrTransRxWcidWrite(pAd, Wcid);
+#endif /* RTMP_MAC_USB */
+}
+
+
+/* write the HT_RX_WCID_EN register holding Wcid from its shadow */
+VOID HdrTransRxWcidWrite(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Wcid)
+{
+	unsigned int Idx = Wcid / HT_RX_WCID_OFFSET;
+
+	RTMP_IO_WRITE32(pAd, HT_RX_WCID_EN_BASE + Idx * 4, pAd->HdrTransRxWcidMap[Idx]);
+}
+
+
+/*
+	========================================================================
+	Routine Description:
+		Decide whether the MAC translates the header of the frame at the
+		head of pTxBlk, and set pTxBlk->NeedTrans accordingly.
+
+	Return Value:
+		HDR_TRANS_PATH_8023		the frame goes out as 802.3
+		HDR_TRANS_PATH_80211	unicast client data sent as 802.11
+		HDR_TRANS_PATH_NONE		anything else
+	========================================================================
+*/
+unsigned char HdrTransTxSelect(
+	IN PRTMP_ADAPTER pAd,
+	IN TX_BLK *pTxBlk)
+{
+	PNDIS_PACKET pPacket = pTxBlk->pPacket;
+	MAC_TABLE_ENTRY *pEntry;
+	unsigned char Wcid, Path, *pSrcBuf;
+	bool bTrans;
+
+	pTxBlk->NeedTrans = FALSE;
+
+	if ((pTxBlk->TxFrameType != TX_LEGACY_FRAME)
+#ifdef DOT11_N_SUPPORT
+		&& (pTxBlk->TxFrameType != TX_AMPDU_FRAME)
+#endif /* DOT11_N_SUPPORT */
+		)
+		return HDR_TRANS_PATH_NONE;
+
+	Wcid = RTMP_GET_PACKET_WCID(pPacket);
+	if (!VALID_WCID(Wcid))
+		return HDR_TRANS_PATH_NONE;
+
+	pEntry = &pAd->MacTab.Content[Wcid];
+	pSrcBuf = GET_OS_PKT_DATAPTR(pPacket);
+	if (!IS_ENTRY_CLIENT(pEntry) || (pSrcBuf[0] & 0x01))
+		return HDR_TRANS_PATH_NONE;
+
+	bTrans = FALSE;
+	if ((pEntry->HdrTransMode == HDR_TRANS_MODE_ON)
+		&& (GET_OS_PKT_LEN(pPacket) > LENGTH_802_3)
+		&& (((pSrcBuf[12] << 8) | pSrcBuf[13]) >= 0x0600)
+		&& !RTMP_GET_PACKET_EAPOL(pPacket)
+#ifdef WAPI_SUPPORT
+		&& !RTMP_GET_PACKET_WAI(pPacket)
+#endif /* WAPI_SUPPORT */
+#ifdef SOFT_ENCRYPT
+		&& !CLIENT_STATUS_TEST_FLAG(pEntry, fCLIENT_STATUS_SOFTWARE_ENCRYPT)
+#endif /* SOFT_ENCRYPT */
+		)
+		bTrans = TRUE;
+
+	/* the AMPDU paths cache the TXWI and header of the last frame, which differ between the two */
+	if (pEntry->bHdrTransCached != bTrans)
+	{
+		pEntry->isCached = FALSE;
+		pEntry->bHdrTransCached = bTrans;
+	}
+
+	if (bTrans)
+	{
+		pTxBlk->NeedTrans = TRUE;
+		pEntry->HdrTransTxFrames++;
+		Path = HDR_TRANS_PATH_8023;
+	}
+	else
+		Path = HDR_TRANS_PATH_80211;
+
+	return Path;
+}
+
+
+VOID HdrTransBenchAdd(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Dir,
+	IN unsigned char Path,
+	IN unsigned long long Nsec)
+{
+	HDR_TRANS_BENCH *pBench = &pAd->HdrTransBench[Dir][Path - 1];
+	unsigned long Ns = (unsigned long)Nsec;
+
+	pBench->Nsec += Nsec;
+	pBench->Packets++;
+	if ((pBench->MinNsec == 0) || (Ns < pBench->MinNsec))
+		pBench->MinNsec = Ns;
+	if (Ns > pBench->MaxNsec)
+		pBench->MaxNsec = Ns;
+}
+
+
+/*
+    ==========================================================================
+    Description:
+        Set the header translation mode of every station, including those
+        joining later. 0: 802.11 path, 1: translated by the MAC
+    Return:
+        TRUE if all parameters are OK, FALSE otherwise
+    ==========================================================================
+*/
+INT Set_HdrTrans_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	PMAC_TABLE_ENTRY pEntry;
+	INT i;
+
+	pAd->HdrTransDefault = (simple_strtol(arg, 0, 10) != 0) ? HDR_TRANS_MODE_ON : HDR_TRANS_MODE_OFF;
+
+	NdisAcquireSpinLock(&pAd->MacTabLock);
+	for (i = 1; i < MAX_LEN_OF_MAC_TABLE; i++)
+	{
+		pEntry = &pAd->MacTab.Content[i];
+		if (IS_ENTRY_CLIENT(pEntry))
+			HdrTransEntrySet(pAd, pEntry, pAd->HdrTransDefault);
+	}
+	NdisReleaseSpinLock(&pAd->MacTabLock);
+
+	DBGPRINT(RT_DEBUG_TRACE, ("Set_HdrTrans_Proc::(HdrTransDefault=%d)\n", pAd->HdrTransDefault));
+
+	return TRUE;
+}
+
+
+/*
+    ==========================================================================
+    Description:
+        Set the header translation mode of one station
+        iwpriv ra0 set HdrTransSta=00:11:22:33:44:55-1
+    Return:
+        TRUE if all parameters are OK, FALSE otherwise
+    ==========================================================================
+*/
+INT Set_HdrTransSta_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	unsigned char macAddr[MAC_ADDR_LEN], Mode;
+	char * value;
+	INT i;
+	MAC_TABLE_ENTRY *pEntry;
+
+	/* Mac address acceptable format 01:02:03:04:05:06 length 17, then -mode */
+	if ((strlen(arg) != 19) || (arg[17] != '-'))
+		return FALSE;
+
+	Mode = (arg[18] != '0') ? HDR_TRANS_MODE_ON : HDR_TRANS_MODE_OFF;
+	arg[17] = '\0';
+
+	for (i=0, value = rstrtok(arg,":"); value; value = rstrtok(NULL,":"))
+	{
+		if((strlen(value) != 2) || (!isxdigit(*value)) || (!isxdigit(*(value+1))) )
+			return FALSE;  /*Invalid */
+
+		AtoH(value, &macAddr[i++], 1);
+	}
+
+	MAC_TABLE_RCU_READ_LOCK();
+	pEntry = MacTableLookup(pAd, macAddr);
+	if ((pEntry == NULL) || !IS_ENTRY_CLIENT(pEntry))
+	{
+		MAC_TABLE_RCU_READ_UNLOCK();
+		return FALSE;
+	}
+
+	NdisAcquireSpinLock(&pAd->MacTabLock);
+	HdrTransEntrySet(pAd, pEntry, Mode);
+	NdisReleaseSpinLock(&pAd->MacTabLock);
+	MAC_TABLE_RCU_READ_UNLOCK();
+
+	DBGPRINT(RT_DEBUG_TRACE, ("Set_HdrTransSta_Proc::(%02x:%02x:%02x:%02x:%02x:%02x HdrTransMode=%d)\n",
+				PRINT_MAC(macAddr), Mode));
+
+	return TRUE;
+}
+
+
+/*
+    ==========================================================================
+    Description:
+        1 clears the per-packet cycle counters and starts counting,
+        0 stops counting and keeps the results for "show hdrtrans"
+    Return:
+        TRUE if all parameters are OK, FALSE otherwise
+    ==========================================================================
+*/
+INT Set_HdrTransBench_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	if (simple_strtol(arg, 0, 10) != 0)
+	{
+		pAd->bHdrTransBench = FALSE;
+		NdisZeroMemory(pAd->HdrTransBench, sizeof(pAd->HdrTransBench));
+		pAd->bHdrTransBench = TRUE;
+	}
+	else
+		pAd->bHdrTransBench = FALSE;
+
+	DBGPRINT(RT_DEBUG_TRACE, ("Set_HdrTransBench_Proc::(bHdrTransBench=%d)\n", pAd->bHdrTransBench));
+
+	return TRUE;
+}
+
+
+INT Show_HdrTrans_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	static char *PathName[2][HDR_TRANS_PATH_NUM] = {
+		{"TX 802.11", "TX 802.3"},
+		{"RX 802.11", "RX 802.3"}};
+	HDR_TRANS_BENCH *pBench;
+	PMAC_TABLE_ENTRY pEntry;
+	unsigned long long Nsec;
+	unsigned long Packets, Avg;
+	INT Dir, Path, i;
+
+	DBGPRINT(RT_DEBUG_OFF, ("HdrTrans: Default=%d, Bench=%d, RxWcidEn=%08x\n",
+				pAd->HdrTransDefault, pAd->bHdrTransBench, pAd->HdrTransRxWcidMap[0]));
+
+	DBGPRINT(RT_DEBUG_OFF, ("%-12s%-12s%-14s%-12s%-12s\n",
+				"Path", "Packets", "ns/Pkt", "Min", "Max"));
+	for (Dir = 0; Dir < 2; Dir++)
+	{
+		for (Path = 0; Path < HDR_TRANS_PATH_NUM; Path++)
+		{
+			pBench = &pAd->HdrTransBench[Dir][Path];
+
+			/* scale both down to 32 bits, 64-bit division is not available everywhere */
+			Nsec = pBench->Nsec;
+			Packets = pBench->Packets;
+			while (Nsec >> 32)
+			{
+				Nsec >>= 1;
+				Packets >>= 1;
+			}
+			Avg = (Packets != 0) ? ((unsigned long)Nsec / Packets) : 0;
+
+			DBGPRINT(RT_DEBUG_OFF, ("%-12s%-12ld%-14ld%-12ld%-12ld\n",
+						PathName[Dir][Path], pBench->Packets, Avg,
+						pBench->MinNsec, pBench->MaxNsec));
+		}
+	}
+
+	DBGPRINT(RT_DEBUG_OFF, ("\n%-19s%-6s%-6s%-12s\n", "MAC", "AID", "Mode", "TxTrans"));
+	for (i = 1; i < MAX_LEN_OF_MAC_TABLE; i++)
+	{
+		pEntry = &pAd->MacTab.Content[i];
+		if (!IS_ENTRY_CLIENT(pEntry))
+			continue;
+
+		DBGPRINT(RT_DEBUG_OFF, ("%02X:%02X:%02X:%02X:%02X:%02X  %-6d%-6d%-12ld\n",
+					PRINT_MAC(pEntry->Addr), pEntry->Aid, pEntry->HdrTransMode,
+					pEntry->HdrTransTxFrames));
+	}
+
+	return TRUE;
+}
+
+#endif /* HDR_TRANS_SUPPORT */
@@ -1253,9 +1253,220 @@ INT	Show_DescInfo_Proc(
 	IN	PRTMP_ADAPTER	pAd,
 	IN	char *			arg)
 {
+#ifdef RTMP_MAC_USB
+	DBGPRINT(RT_DEBUG_OFF, ("BulkIn: Req=%ld, Complete=%ld, Fail=%ld, PendingRx=%d, BIIdx=%d, BIRIdx=%d\n",
+				pAd->BulkInReq, pAd->BulkInComplete, pAd->BulkInCompleteFail,
+				pAd->PendingRx, pAd->NextRxBulkInIndex, pAd->NextRxBulkInReadIndex));
+#ifdef RX_ZERO_COPY_SUPPORT
+	DBGPRINT(RT_DEBUG_OFF, ("RxZeroCopy: CopyBreak=%d, BytesCopied=%llu, BytesByRef=%llu, BufRenew=%ld, BufRenewFail=%ld, BufRecycle=%ld\n",
+				pAd->RxCopyBreak, pAd->RxZcBytesCopied, pAd->RxZcBytesRef,
+				pAd->RxZcBufRenew, pAd->RxZcBufRenewFail, pAd->RxZcBufRecycle));
+#endif /* RX_ZERO_COPY_SUPPORT */
+#ifdef RX_NAPI_SUPPORT
+	DBGPRINT(RT_DEBUG_OFF, ("RxNapi: Budget=%d, Poll=%ld, Frames=%ld, BudgetFull=%ld\n",
+				pAd->RxNapiBudget, pAd->RxNapiPoll, pAd->RxNapiFrames,
+				pAd->RxNapiBudgetFull));
+#endif /* RX_NAPI_SUPPORT */
+#ifdef USB_BULK_OUT_SG_SUPPORT
+	DBGPRINT(RT_DEBUG_OFF, ("TxSg: Support=%d, Enable=%d, Frames=%ld, Busy=%ld, Fail=%ld\n",
+				pAd->bUsbTxSg, pAd->bUsbTxSgEnable, pAd->TxSgFrames,
+				pAd->TxSgBusy, pAd->TxSgFail));
+#endif /* USB_BULK_OUT_SG_SUPPORT */
+#endif /* RTMP_MAC_USB */
+
+	return TRUE;
+}
+
+
+#ifdef RTMP_MAC_USB
+/*
+    ==========================================================================
+    Description:
+        Show the bulk-in pipeline configuration and the RX ring occupancy
+        histograms, sampled at every bulk-in completion
+    Return:
+        TRUE
+    ==========================================================================
+*/
+INT	Show_RxRing_Proc(
+	IN	PRTMP_ADAPTER	pAd,
+	IN	char *			arg)
+{
+	INT i;
+
+	DBGPRINT(RT_DEBUG_OFF, ("RxRing: Size=%d, BulkSize=%ld, MaxUrb=%d, TargetUrb=%d, TargetUp=%ld, TargetDown=%ld\n",
+				RX_RING_SIZE, pAd->RxBulkSize, pAd->CommonCfg.NumOfBulkInIRP,
+				pAd->RxUrbTarget, pAd->RxUrbTargetUp, pAd->RxUrbTargetDown));
+
+	DBGPRINT(RT_DEBUG_OFF, ("%-8s%-12s%-12s\n", "Depth", "InFlight", "Readable"));
+	for (i = 0; i <= RX_RING_SIZE; i++)
+	{
+		DBGPRINT(RT_DEBUG_OFF, ("%-8d%-12ld%-12ld\n",
+					i, pAd->RxUrbInFlightHist[i], pAd->RxRingReadableHist[i]));
+	}
+
+	DBGPRINT(RT_DEBUG_OFF, ("Bulk-in fill:"));
+	for (i = 0; i < RX_BULK_FILL_BUCKET; i++)
+	{
+		DBGPRINT(RT_DEBUG_OFF, (" <%d%%=%ld", (i + 1) * 100 / RX_BULK_FILL_BUCKET,
+					pAd->RxBulkFillHist[i]));
+	}
+	DBGPRINT(RT_DEBUG_OFF, ("\n"));
+
+	return TRUE;
+}
+#endif /* RTMP_MAC_USB */
+
+
+#ifdef RX_ZERO_COPY_SUPPORT
+/*
+    ==========================================================================
+    Description:
+        Set the frame length below which received frames are copied out of
+        the bulk-in buffer instead of being handed up by reference
+    Return:
+        TRUE if all parameters are OK, FALSE otherwise
+    ==========================================================================
+*/
+INT	Set_RxCopyBreak_Proc(
+	IN	PRTMP_ADAPTER	pAd,
+	IN	char *			arg)
+{
+	long CopyBreak;
+
+	CopyBreak = simple_strtol(arg, 0, 10);
+	if ((CopyBreak < 0) || (CopyBreak > pAd->RxBulkSize))
+		return FALSE;
+
+	pAd->RxCopyBreak = (unsigned int)CopyBreak;
+
+	DBGPRINT(RT_DEBUG_TRACE, ("Set_RxCopyBreak_Proc::(RxCopyBreak=%d)\n", pAd->RxCopyBreak));
+
+	return TRUE;
+}
+#endif /* RX_ZERO_COPY_SUPPORT */
+
+#ifdef RX_NAPI_SUPPORT
+/*
+    ==========================================================================
+    Description:
+        Set the max number of received frames parsed in one NAPI poll
+    Return:
+        TRUE if all parameters are OK, FALSE otherwise
+    ==========================================================================
+*/
+INT	Set_RxNapiBudget_Proc(
+	IN	PRTMP_ADAPTER	pAd,
+	IN	char *			arg)
+{
+	long Budget;
+
+	Budget = simple_strtol(arg, 0, 10);
+	if ((Budget < 1) || (Budget > RX_NAPI_WEIGHT))
+		return FALSE;
+
+	pAd->RxNapiBudget = (unsigned int)Budget;
+
+	DBGPRINT(RT_DEBUG_TRACE, ("Set_RxNapiBudget_Proc::(RxNapiBudget=%d)\n", pAd->RxNapiBudget));
+
+	return TRUE;
+}
+#endif /* RX_NAPI_SUPPORT */
+
+#ifdef USB_BULK_OUT_SG_SUPPORT
+/*
+    ==========================================================================
+    Description:
+        Enable or disable sending single frames straight from the skb
+        through a scatter-gather bulk-out instead of copying them into
+        the HT TX ring
+    Return:
+        TRUE if all parameters are OK, FALSE otherwise
+    ==========================================================================
+*/
+INT	Set_UsbTxSg_Proc(
+	IN	PRTMP_ADAPTER	pAd,
+	IN	char *			arg)
+{
+	pAd->bUsbTxSgEnable = (simple_strtol(arg, 0, 10) != 0) ? TRUE : FALSE;
+
+	DBGPRINT(RT_DEBUG_TRACE, ("Set_UsbTxSg_Proc::(bUsbTxSgEnable=%d, bUsbTxSg=%d)\n",
+				pAd->bUsbTxSgEnable, pAd->bUsbTxSg));
+
+	return TRUE;
+}
+#endif /* USB_BULK_OUT_SG_SUPPORT */
+
+#ifdef USB_TX_ADAPTIVE_BATCH
+/*
+    ==========================================================================
+    Description:
+        Enable or disable sizing the TX dequeue budget and the aggregation
+        hold-back from the bulk-out completions. Disabled, the fixed
+        MAX_TX_PROCESS budget and the MAX_AGGREGATION_SIZE hold-back apply
+    Return:
+        TRUE if all parameters are OK, FALSE otherwise
+    ==========================================================================
+*/
+INT	Set_UsbTxBatch_Proc(
+	IN	PRTMP_ADAPTER	pAd,
+	IN	char *			arg)
+{
+	pAd->bTxBatchAdaptive = (simple_strtol(arg, 0, 10) != 0) ? TRUE : FALSE;
+
+	DBGPRINT(RT_DEBUG_TRACE, ("Set_UsbTxBatch_Proc::(bTxBatchAdaptive=%d)\n",
+				pAd->bTxBatchAdaptive));
+
+	return TRUE;
+}
+
+
+/*
+    ==========================================================================
+    Description:
+        Show the adaptive TX batching state of each bulk-out pipe and the
+        bytes carried per data URB
+    Return:
+        TRUE
+    ==========================================================================
+*/
+INT	Show_TxBatch_Proc(
+	IN	PRTMP_ADAPTER	pAd,
+	IN	char *			arg)
+{
+	TX_BATCH_CTRL *pCtrl;
+	INT QueIdx, i;
+
+	DBGPRINT(RT_DEBUG_OFF, ("TxBatch: Adaptive=%d\n", pAd->bTxBatchAdaptive));
+	DBGPRINT(RT_DEBUG_OFF, ("%-4s%-8s%-8s%-10s%-10s%-12s%-10s\n",
+				"AC", "Budget", "Target", "FrameLen", "Holds", "Urbs", "Bytes/Urb"));
+	for (QueIdx = 0; QueIdx < NUM_OF_TX_RING; QueIdx++)
+	{
+		pCtrl = &pAd->TxBatchCtrl[QueIdx];
+		DBGPRINT(RT_DEBUG_OFF, ("%-4d%-8d%-8ld%-10d%-10ld%-12ld%-10ld\n",
+					QueIdx, pCtrl->Budget, (unsigned long)TX_BATCH_TARGET(pCtrl),
+					pCtrl->FrameLenAvg, pCtrl->Holds, pCtrl->UrbCount,
+					(pCtrl->UrbCount > 0) ? (unsigned long)(pCtrl->UrbBytes / pCtrl->UrbCount) : 0));
+	}
+
+	DBGPRINT(RT_DEBUG_OFF, ("Bytes per URB:\n"));
+	for (QueIdx = 0; QueIdx < NUM_OF_TX_RING; QueIdx++)
+	{
+		pCtrl = &pAd->TxBatchCtrl[QueIdx];
+		DBGPRINT(RT_DEBUG_OFF, ("AC%d:", QueIdx));
+		for (i = 0; i < TX_BATCH_URB_BUCKET; i++)
+		{
+			if (i == TX_BATCH_URB_BUCKET - 1)
+				DBGPRINT(RT_DEBUG_OFF, (" >=%dK=%ld", i * 4, pCtrl->UrbHist[i]));
+			else
+				DBGPRINT(RT_DEBUG_OFF, (" <%dK=%ld", (i + 1) * 4, pCtrl->UrbHist[i]));
+		}
+		DBGPRINT(RT_DEBUG_OFF, ("\n"));
+	}
 
 	return TRUE;
 }
+#endif /* USB_TX_ADAPTIVE_BATCH */
 
 /*
     ==========================================================================
@@ -1286,6 +1497,12 @@ INT	Set_ResetStatCounter_Proc(
 	NdisZeroMemory(&pAd->Counters8023, sizeof(COUNTER_802_3));
 	NdisZeroMemory(&pAd->RalinkCounters, sizeof(COUNTER_RALINK));
 
+#ifdef RTMP_MAC_USB
+	NdisZeroMemory(pAd->RxUrbInFlightHist, sizeof(pAd->RxUrbInFlightHist));
+	NdisZeroMemory(pAd->RxRingReadableHist, sizeof(pAd->RxRingReadableHist));
+	NdisZeroMemory(pAd->RxBulkFillHist, sizeof(pAd->RxBulkFillHist));
+#endif /* RTMP_MAC_USB */
+
 #ifdef CONFIG_AP_SUPPORT
 #endif /* CONFIG_AP_SUPPORT */
 
@@ -2433,12 +2650,14 @@ INT	Set_BASetup_Proc(
 		DBGPRINT(RT_DEBUG_OFF, ("\n%02x:%02x:%02x:%02x:%02x:%02x-%02x\n", 
 								mac[0], mac[1], mac[2], mac[3], mac[4], mac[5], tid));
 
+		MAC_TABLE_RCU_READ_LOCK();
 	    pEntry = MacTableLookup(pAd, (unsigned char *) mac);
 
     	if (pEntry) {
         	DBGPRINT(RT_DEBUG_OFF, ("\nSetup BA Session: Tid = %d\n", tid));
 	        BAOriSessionSetUp(pAd, pEntry, tid, 0, 100, TRUE);
     	}
+		MAC_TABLE_RCU_READ_UNLOCK();
 
 		return TRUE;
 	}
@@ -2513,12 +2732,14 @@ INT	Set_BAOriTearDown_Proc(
 	    DBGPRINT(RT_DEBUG_OFF, ("\n%02x:%02x:%02x:%02x:%02x:%02x-%02x", 
 								mac[0], mac[1], mac[2], mac[3], mac[4], mac[5], tid));
 
+		MAC_TABLE_RCU_READ_LOCK();
 	    pEntry = MacTableLookup(pAd, (unsigned char *) mac);
 
 	    if (pEntry) {
 	        DBGPRINT(RT_DEBUG_OFF, ("\nTear down Ori BA Session: Tid = %d\n", tid));
 	        BAOriSessionTearDown(pAd, pEntry->Aid, tid, FALSE, TRUE);
 	    }
+		MAC_TABLE_RCU_READ_UNLOCK();
 
 		return TRUE;
 	}
@@ -2567,12 +2788,14 @@ INT	Set_BARecTearDown_Proc(
 		DBGPRINT(RT_DEBUG_OFF, ("\n%02x:%02x:%02x:%02x:%02x:%02x-%02x", 
 								mac[0], mac[1], mac[2], mac[3], mac[4], mac[5], tid));
 
+		MAC_TABLE_RCU_READ_LOCK();
 		pEntry = MacTableLookup(pAd, (unsigned char *) mac);
 
 		if (pEntry) {
 		    DBGPRINT(RT_DEBUG_OFF, ("\nTear down Rec BA Session: Tid = %d\n", tid));
 		    BARecSessionTearDown(pAd, pEntry->Aid, tid, FALSE);
 		}
+		MAC_TABLE_RCU_READ_UNLOCK();
 
 		return TRUE;
 	}
@@ -70,6 +70,254 @@ static NDIS_STATUS RTMPFreeUsbBulkBufStruct(
 }
 
 
+#ifdef USB_BULK_OUT_SG_SUPPORT
+static VOID RTMPFreeUsbTxSg(
+	IN RTMP_ADAPTER *pAd)
+{
+	TX_SG_SLOT *pSlot;
+	INT acidx, i;
+
+	pAd->bUsbTxSg = FALSE;
+
+	for (acidx = 0; acidx < NUM_OF_TX_RING; acidx++)
+	{
+		for (i = 0; i < TX_SG_SLOT_NUM; i++)
+		{
+			pSlot = &pAd->TxSgSlot[acidx][i];
+
+			if (pSlot->pUrb) {
+				RTUSB_UNLINK_URB(pSlot->pUrb);
+				RTUSB_FREE_URB(pSlot->pUrb);
+				pSlot->pUrb = NULL;
+			}
+
+			if (pSlot->pPacket) {
+				RELEASE_NDIS_PACKET(pAd, pSlot->pPacket, NDIS_STATUS_FAILURE);
+				pSlot->pPacket = NULL;
+			}
+			pSlot->InUse = FALSE;
+
+			RtmpOsUsbSgTableFree(pSlot->pSgTable);
+			pSlot->pSgTable = NULL;
+
+			if (pSlot->HdrBuf) {
+				os_free_mem(pAd, pSlot->HdrBuf);
+				pSlot->HdrBuf = NULL;
+			}
+		}
+	}
+}
+
+
+/*
+	Allocate the per-pipe slots used to bulk-out single frames straight from
+	the skb. Without them, or when the host controller can't gather buffers
+	of any length, every frame keeps being copied into the HT TX ring.
+*/
+static VOID RTMPAllocUsbTxSg(
+	IN RTMP_ADAPTER *pAd)
+{
+	POS_COOKIE pObj = (POS_COOKIE) pAd->OS_Cookie;
+	TX_SG_SLOT *pSlot;
+	INT acidx, i;
+
+	NdisZeroMemory(pAd->TxSgSlot, sizeof(pAd->TxSgSlot));
+	pAd->bUsbTxSg = FALSE;
+
+	if (!RtmpOsUsbSgSupport(pObj->pUsb_Dev))
+	{
+		DBGPRINT(RT_DEBUG_TRACE, ("Host controller can't gather unaligned bulk-out buffers, TX frames are copied\n"));
+		return;
+	}
+
+	for (acidx = 0; acidx < NUM_OF_TX_RING; acidx++)
+	{
+		for (i = 0; i < TX_SG_SLOT_NUM; i++)
+		{
+			pSlot = &pAd->TxSgSlot[acidx][i];
+
+			pSlot->pUrb = RTUSB_ALLOC_URB(0);
+			pSlot->pSgTable = RtmpOsUsbSgTableAlloc(TX_SG_ENTRY_NUM);
+			os_alloc_mem(pAd, &pSlot->HdrBuf, TX_SG_HDR_SIZE + 8);
+			if ((pSlot->pUrb == NULL) || (pSlot->pSgTable == NULL) || (pSlot->HdrBuf == NULL))
+			{
+				DBGPRINT(RT_DEBUG_ERROR, ("<-- ERROR in Alloc TX SG slot, TX frames are copied\n"));
+				RTMPFreeUsbTxSg(pAd);
+				return;
+			}
+			NdisZeroMemory(pSlot->HdrBuf, TX_SG_HDR_SIZE + 8);
+		}
+	}
+
+	pAd->bUsbTxSg = TRUE;
+}
+#endif /* USB_BULK_OUT_SG_SUPPORT */
+
+
+#ifdef RX_ZERO_COPY_SUPPORT
+/*
+========================================================================
+Routine Description:
+	Allocate the URB and the bulk-in buffer of a RX context. The buffer
+	is the data area of a packet so that the frames inside it can be
+	handed to the upper layer as clones instead of copies.
+
+Arguments:
+	pAd					Pointer to our adapter
+	pRxContext			the RX context
+
+Return Value:
+	NDIS_STATUS_SUCCESS
+	NDIS_STATUS_RESOURCES
+
+Note:
+	The URB must use streaming DMA mapping on this buffer.
+========================================================================
+*/
+static NDIS_STATUS RTMPAllocRxZcBuf(
+	IN RTMP_ADAPTER *pAd,
+	IN RX_CONTEXT *pRxContext)
+{
+	pRxContext->pUrb = RTUSB_ALLOC_URB(0);
+	if (pRxContext->pUrb == NULL)
+	{
+		DBGPRINT(RT_DEBUG_ERROR, ("<-- ERROR in Alloc urb struct for RxContext !\n"));
+		return NDIS_STATUS_RESOURCES;
+	}
+
+	pRxContext->pRxBufPkt = RTMP_AllocateFragPacketBuffer(pAd, pAd->RxBulkSize);
+	if (pRxContext->pRxBufPkt == NULL)
+	{
+		DBGPRINT(RT_DEBUG_ERROR, ("<-- ERROR in Alloc Bulk buffer for RxContext!\n"));
+		return NDIS_STATUS_RESOURCES;
+	}
+
+	pRxContext->TransferBuffer = GET_OS_PKT_DATAPTR(pRxContext->pRxBufPkt);
+	pRxContext->data_dma = 0;
+
+	return NDIS_STATUS_SUCCESS;
+}
+
+
+static VOID RTMPFreeRxZcBuf(
+	IN RTMP_ADAPTER *pAd,
+	IN RX_CONTEXT *pRxContext)
+{
+	if (pRxContext->pUrb != NULL)
+	{
+		RTUSB_UNLINK_URB(pRxContext->pUrb);
+		RTUSB_FREE_URB(pRxContext->pUrb);
+		pRxContext->pUrb = NULL;
+	}
+
+	/* frames still queued in the stack keep their own reference on the data */
+	if (pRxContext->pRxBufPkt != NULL)
+	{
+		RELEASE_NDIS_PACKET(pAd, pRxContext->pRxBufPkt, NDIS_STATUS_SUCCESS);
+		pRxContext->pRxBufPkt = NULL;
+	}
+	pRxContext->TransferBuffer = NULL;
+}
+
+
+/*
+========================================================================
+Routine Description:
+	Make sure the bulk-in buffer of a RX context is not shared with any
+	frame handed up by GetPacketFromRxRing() before the hardware writes
+	into it again. A shared buffer is parked in RxZcSpare and replaced
+	by a parked one whose frames have all been freed meanwhile, or by a
+	new one. With no room left to park, the last frame referring to the
+	shared buffer frees it.
+
+Arguments:
+	pAd					Pointer to our adapter
+	pRxContext			the RX context
+
+Return Value:
+	TRUE				the buffer can be submitted
+	FALSE				no memory for a new buffer
+
+Note:
+	Call it before the buffer is touched, not with BulkInLock held.
+========================================================================
+*/
+bool RTMPRxZcBufRenew(
+	IN RTMP_ADAPTER *pAd,
+	IN RX_CONTEXT *pRxContext)
+{
+	PNDIS_PACKET pOldPkt = pRxContext->pRxBufPkt, pNewPkt = NULL;
+	unsigned long IrqFlags;
+	INT i;
+
+	if (!OS_PKT_CLONED(pOldPkt))
+		return TRUE;
+
+	RTMP_IRQ_LOCK(&pAd->BulkInLock, IrqFlags);
+	for (i = 0; i < RX_ZC_SPARE_NUM; i++)
+	{
+		if ((pAd->RxZcSpare[i] != NULL) && !OS_PKT_CLONED(pAd->RxZcSpare[i]))
+		{
+			pNewPkt = pAd->RxZcSpare[i];
+			pAd->RxZcSpare[i] = pOldPkt;
+			pOldPkt = NULL;
+			pAd->RxZcBufRecycle++;
+			break;
+		}
+	}
+	RTMP_IRQ_UNLOCK(&pAd->BulkInLock, IrqFlags);
+
+	if (pNewPkt == NULL)
+	{
+		pNewPkt = RTMP_AllocateFragPacketBuffer(pAd, pAd->RxBulkSize);
+		if (pNewPkt == NULL)
+		{
+			pAd->RxZcBufRenewFail++;
+			return FALSE;
+		}
+		pAd->RxZcBufRenew++;
+
+		RTMP_IRQ_LOCK(&pAd->BulkInLock, IrqFlags);
+		for (i = 0; i < RX_ZC_SPARE_NUM; i++)
+		{
+			if (pAd->RxZcSpare[i] == NULL)
+			{
+				pAd->RxZcSpare[i] = pOldPkt;
+				pOldPkt = NULL;
+				break;
+			}
+		}
+		RTMP_IRQ_UNLOCK(&pAd->BulkInLock, IrqFlags);
+
+		if (pOldPkt != NULL)
+			RELEASE_NDIS_PACKET(pAd, pOldPkt, NDIS_STATUS_SUCCESS);
+	}
+
+	pRxContext->pRxBufPkt = pNewPkt;
+	pRxContext->TransferBuffer = GET_OS_PKT_DATAPTR(pNewPkt);
+
+	return TRUE;
+}
+
+
+VOID RTMPFreeRxZcSpare(
+	IN RTMP_ADAPTER *pAd)
+{
+	INT i;
+
+	/* frames still queued in the stack keep their own reference on the data */
+	for (i = 0; i < RX_ZC_SPARE_NUM; i++)
+	{
+		if (pAd->RxZcSpare[i] != NULL)
+		{
+			RELEASE_NDIS_PACKET(pAd, pAd->RxZcSpare[i], NDIS_STATUS_SUCCESS);
+			pAd->RxZcSpare[i] = NULL;
+		}
+	}
+}
+#endif /* RX_ZERO_COPY_SUPPORT */
+
+
 #ifdef RESOURCE_PRE_ALLOC
 VOID RTMPResetTxRxRingMemory(
 	IN RTMP_ADAPTER * pAd)
@@ -210,13 +458,20 @@ VOID	RTMPFreeTxRxRingMemory(
 	for(i=0; i<(RX_RING_SIZE); i++)
 	{
 		PRX_CONTEXT  pRxContext = &(pAd->RxContext[i]);
+#ifdef RX_ZERO_COPY_SUPPORT
+		RTMPFreeRxZcBuf(pAd, pRxContext);
+#else
 		if (pRxContext)
 			RTMPFreeUsbBulkBufStruct(pAd,
 							&pRxContext->pUrb,
 							(unsigned char * *)&pRxContext->TransferBuffer,
-							MAX_RXBULK_SIZE,
+							pAd->RxBulkSize,
 							pRxContext->data_dma);
+#endif /* RX_ZERO_COPY_SUPPORT */
 	}
+#ifdef RX_ZERO_COPY_SUPPORT
+	RTMPFreeRxZcSpare(pAd);
+#endif /* RX_ZERO_COPY_SUPPORT */
 
 	/* Command Response */
 	RTMPFreeUsbBulkBufStruct(pAd,
@@ -279,6 +534,9 @@ VOID	RTMPFreeTxRxRingMemory(
 										sizeof(HTTX_BUFFER),
 										pHTTXContext->data_dma);
 	}
+#ifdef USB_BULK_OUT_SG_SUPPORT
+	RTMPFreeUsbTxSg(pAd);
+#endif /* USB_BULK_OUT_SG_SUPPORT */
 
 	if (pAd->FragFrame.pFragPacket)
 		RELEASE_NDIS_PACKET(pAd, pAd->FragFrame.pFragPacket, NDIS_STATUS_SUCCESS);
@@ -319,7 +577,13 @@ NDIS_STATUS	NICInitRecv(
 	pAd->PendingRx = 0;
 	pAd->NextRxBulkInReadIndex 	= 0;	/* Next Rx Read index*/
 	pAd->NextRxBulkInIndex		= 0 ; /*RX_RING_SIZE -1;  Rx Bulk pointer*/
+	pAd->NextRxBulkInSubmitIndex	= 0;
 	pAd->NextRxBulkInPosition 	= 0;
+	pAd->bRxBulkInSubmit		= FALSE;
+	/* start with one bulk-in in flight, RTUSBBulkRxStat() raises it under load */
+	pAd->RxUrbTarget			= 1;
+	pAd->RxUrbAdaptCnt			= 0;
+	pAd->RxUrbAdaptFull			= 0;
 
 	for (i = 0; i < (RX_RING_SIZE); i++)
 	{
@@ -328,7 +592,12 @@ NDIS_STATUS	NICInitRecv(
 		ASSERT((pRxContext->TransferBuffer != NULL));
 		ASSERT((pRxContext->pUrb != NULL));
 
-		NdisZeroMemory(pRxContext->TransferBuffer, MAX_RXBULK_SIZE);
+#ifdef RX_ZERO_COPY_SUPPORT
+		/* frames of the last session may still sit in socket queues */
+		if (RTMPRxZcBufRenew(pAd, pRxContext) == FALSE)
+			return NDIS_STATUS_RESOURCES;
+#endif /* RX_ZERO_COPY_SUPPORT */
+		NdisZeroMemory(pRxContext->TransferBuffer, pAd->RxBulkSize);
 
 		pRxContext->pAd	= pAd;
 		pRxContext->pIrp = NULL;
@@ -336,6 +605,7 @@ NDIS_STATUS	NICInitRecv(
 		pRxContext->IRPPending = FALSE;
 		pRxContext->Readable	= FALSE;
 		pRxContext->bRxHandling = FALSE;
+		pRxContext->bRxUrbDone = FALSE;
 		pRxContext->BulkInOffset = 0;
 	}
 
@@ -562,6 +832,9 @@ NDIS_STATUS	RTMPAllocTxRxRingMemory(
 		if (Status != NDIS_STATUS_SUCCESS)
 			goto err;
 	}
+#ifdef USB_BULK_OUT_SG_SUPPORT
+	RTMPAllocUsbTxSg(pAd);
+#endif /* USB_BULK_OUT_SG_SUPPORT */
 
 	/* MGMT_RING_SIZE*/
 
@@ -607,12 +880,16 @@ NDIS_STATUS	RTMPAllocTxRxRingMemory(
 		PRX_CONTEXT  pRxContext = &(pAd->RxContext[i]);
 
 		/*Allocate URB*/
+#ifdef RX_ZERO_COPY_SUPPORT
+		Status = RTMPAllocRxZcBuf(pAd, pRxContext);
+#else
 		Status = RTMPAllocUsbBulkBufStruct(pAd,
 							&pRxContext->pUrb,
 							(void * *)&pRxContext->TransferBuffer,
-							MAX_RXBULK_SIZE,
+							pAd->RxBulkSize,
 							&pRxContext->data_dma,
 							"RxContext");
+#endif /* RX_ZERO_COPY_SUPPORT */
 		if (Status != NDIS_STATUS_SUCCESS)
 			goto err;
 	}
@@ -720,12 +997,23 @@ NDIS_STATUS	NICInitRecv(
 	pAd->PendingRx = 0;
 	pAd->NextRxBulkInReadIndex 	= 0;	/* Next Rx Read index*/
 	pAd->NextRxBulkInIndex		= 0 ; /*RX_RING_SIZE -1;  Rx Bulk pointer*/
+	pAd->NextRxBulkInSubmitIndex	= 0;
 	pAd->NextRxBulkInPosition 	= 0;
+	pAd->bRxBulkInSubmit		= FALSE;
+	/* start with one bulk-in in flight, RTUSBBulkRxStat() raises it under load */
+	pAd->RxUrbTarget			= 1;
+	pAd->RxUrbAdaptCnt			= 0;
+	pAd->RxUrbAdaptFull			= 0;
 
 	for (i = 0; i < (RX_RING_SIZE); i++)
 	{
 		PRX_CONTEXT  pRxContext = &(pAd->RxContext[i]);
 
+#ifdef RX_ZERO_COPY_SUPPORT
+		Status = RTMPAllocRxZcBuf(pAd, pRxContext);
+		if (Status != NDIS_STATUS_SUCCESS)
+			goto out1;
+#else
 		/*Allocate URB*/
 		pRxContext->pUrb = RTUSB_ALLOC_URB(0);
 		if (pRxContext->pUrb == NULL)
@@ -735,14 +1023,15 @@ NDIS_STATUS	NICInitRecv(
 		}
 
 		/* Allocate transfer buffer*/
-		pRxContext->TransferBuffer = RTUSB_URB_ALLOC_BUFFER(pObj->pUsb_Dev, MAX_RXBULK_SIZE, &pRxContext->data_dma);
+		pRxContext->TransferBuffer = RTUSB_URB_ALLOC_BUFFER(pObj->pUsb_Dev, pAd->RxBulkSize, &pRxContext->data_dma);
 		if (pRxContext->TransferBuffer == NULL)
 		{
 			Status = NDIS_STATUS_RESOURCES;
 			goto out1;
 		}
+#endif /* RX_ZERO_COPY_SUPPORT */
 
-		NdisZeroMemory(pRxContext->TransferBuffer, MAX_RXBULK_SIZE);
+		NdisZeroMemory(pRxContext->TransferBuffer, pAd->RxBulkSize);
 
 		pRxContext->pAd	= pAd;
 		pRxContext->pIrp = NULL;
@@ -751,6 +1040,7 @@ NDIS_STATUS	NICInitRecv(
 		pRxContext->Readable	= FALSE;
 		/*pRxContext->ReorderInUse = FALSE;*/
 		pRxContext->bRxHandling = FALSE;
+		pRxContext->bRxUrbDone = FALSE;
 		pRxContext->BulkInOffset = 0;
 	}
 
@@ -767,9 +1057,12 @@ out1:
 	{
 		PRX_CONTEXT  pRxContext = &(pAd->RxContext[i]);
 
+#ifdef RX_ZERO_COPY_SUPPORT
+		RTMPFreeRxZcBuf(pAd, pRxContext);
+#else
 		if (NULL != pRxContext->TransferBuffer)
 		{
-			RTUSB_URB_FREE_BUFFER(pObj->pUsb_Dev, MAX_RXBULK_SIZE,
+			RTUSB_URB_FREE_BUFFER(pObj->pUsb_Dev, pAd->RxBulkSize,
 								pRxContext->TransferBuffer, pRxContext->data_dma);
 			pRxContext->TransferBuffer = NULL;
 		}
@@ -780,6 +1073,7 @@ out1:
 			RTUSB_FREE_URB(pRxContext->pUrb);
 			pRxContext->pUrb = NULL;
 		}
+#endif /* RX_ZERO_COPY_SUPPORT */
 	}
 
 	return Status;
@@ -859,6 +1153,9 @@ NDIS_STATUS	NICInitTransmit(
 		pHTTXContext->bCopySavePad = FALSE;
 		pAd->BulkOutPending[acidx] = FALSE;
 	}
+#ifdef USB_BULK_OUT_SG_SUPPORT
+	RTMPAllocUsbTxSg(pAd);
+#endif /* USB_BULK_OUT_SG_SUPPORT */
 
 	/* MGMT Ring*/
 
@@ -1115,13 +1412,20 @@ VOID	RTMPFreeTxRxRingMemory(
 	/* Free all resources for the RxRing buffer queue.*/
 	for (i = 0; i < RX_RING_SIZE; i++) {
 		PRX_CONTEXT  pRxContext = &(pAd->RxContext[i]);
+#ifdef RX_ZERO_COPY_SUPPORT
+		RTMPFreeRxZcBuf(pAd, pRxContext);
+#else
 		if (pRxContext)
 			RTMPFreeUsbBulkBufStruct(pAd,
 										&pRxContext->pUrb,
 										(unsigned char * *)&pRxContext->TransferBuffer,
-										MAX_RXBULK_SIZE,
+										pAd->RxBulkSize,
 										pRxContext->data_dma);
+#endif /* RX_ZERO_COPY_SUPPORT */
 	}
+#ifdef RX_ZERO_COPY_SUPPORT
+	RTMPFreeRxZcSpare(pAd);
+#endif /* RX_ZERO_COPY_SUPPORT */
 
 	if (pCmdRspEventContext) {
 		RTMPFreeUsbBulkBufStruct(pAd,
@@ -1183,6 +1487,9 @@ VOID	RTMPFreeTxRxRingMemory(
 							sizeof(HTTX_BUFFER),
 							pHTTXContext->data_dma);
 	}
+#ifdef USB_BULK_OUT_SG_SUPPORT
+	RTMPFreeUsbTxSg(pAd);
+#endif /* USB_BULK_OUT_SG_SUPPORT */
 
 	/* Free fragement frame buffer*/
 	if (pAd->FragFrame.pFragPacket)
@@ -1332,6 +1639,118 @@ VOID RT28XXDMAEnable(
   *
   ********************************************************************/
 
+#ifdef BCN_BURST_SUPPORT
+/*
+	Beacon memory is written as AndesBurstWrite(), one MCU command per
+	run of changed dwords, instead of one vendor request per changed
+	halfword. Runs no more than BCN_BURST_GAP bytes apart are merged,
+	a few unchanged bytes cost less than one more command. Without the
+	in-band MCU command path the runs go out in 2-byte writes.
+*/
+#define BCN_BURST_GAP		16
+#define BCN_BURST_DW_MAX	64
+
+static VOID BcnBurstWrite(
+	IN RTMP_ADAPTER *pAd,
+	IN unsigned short Offset,
+	IN unsigned char *pData,
+	IN unsigned int Len)
+{
+	BEACON_SYNC_STRUCT *pBeaconSync = pAd->CommonCfg.pBeaconSync;
+	unsigned int Data[BCN_BURST_DW_MAX];
+	unsigned int Max, Num, i;
+
+	pBeaconSync->WriteBytes += Len;
+
+	if (!RTMP_TEST_FLAG(pAd, fRTMP_ADAPTER_MCU_SEND_IN_BAND_CMD))
+	{
+		for (i = 0; i < Len; i += 2)
+		{
+			RTMP_CHIP_UPDATE_BEACON(pAd, Offset + i, pData[i] + (pData[i + 1] << 8), 2);
+			pBeaconSync->UsbXferCnt++;
+		}
+		return;
+	}
+
+	/* one in-band packet per call */
+	Max = (pAd->chipCap.InbandPacketMaxLen - 4) / 4;
+	if (Max > BCN_BURST_DW_MAX)
+		Max = BCN_BURST_DW_MAX;
+
+	while (Len > 0)
+	{
+		Num = ((Len / 4) > Max) ? Max : (Len / 4);
+
+		for (i = 0; i < Num; i++, pData += 4)
+			Data[i] = pData[0] + (pData[1] << 8) + (pData[2] << 16) + (pData[3] << 24);
+
+		AndesBurstWrite(pAd, Offset, Data, Num);
+		pBeaconSync->UsbXferCnt++;
+
+		Offset += Num * 4;
+		Len -= Num * 4;
+	}
+}
+
+
+/* Len is a multiple of 4, pSync is brought up to date with pNew */
+static VOID BcnBurstDiffWrite(
+	IN RTMP_ADAPTER *pAd,
+	IN unsigned short Offset,
+	IN unsigned char *pSync,
+	IN unsigned char *pNew,
+	IN unsigned int Len)
+{
+	unsigned int i, Start = 0, End = 0;
+	bool bRun = FALSE;
+
+	for (i = 0; i < Len; i += 4)
+	{
+		if (NdisEqualMemory(pSync + i, pNew + i, 4))
+			continue;
+
+		if (bRun && ((i - End) > BCN_BURST_GAP))
+		{
+			BcnBurstWrite(pAd, Offset + Start, pNew + Start, End - Start);
+			bRun = FALSE;
+		}
+
+		if (!bRun)
+		{
+			Start = i;
+			bRun = TRUE;
+		}
+		End = i + 4;
+	}
+
+	if (bRun)
+		BcnBurstWrite(pAd, Offset + Start, pNew + Start, End - Start);
+
+	NdisMoveMemory(pSync, pNew, Len);
+}
+
+
+INT Show_BcnUpdate_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	BEACON_SYNC_STRUCT *pBeaconSync = pAd->CommonCfg.pBeaconSync;
+	unsigned long PerUpdate;
+
+	if (pBeaconSync == NULL)
+		return TRUE;
+
+	PerUpdate = (pBeaconSync->UpdateCnt != 0) ?
+				(pBeaconSync->UsbXferCnt * 10 / pBeaconSync->UpdateCnt) : 0;
+
+	DBGPRINT(RT_DEBUG_OFF, ("BeaconUpdates=%ld, UsbXfers=%ld (%ld.%ld per update), Bytes=%ld\n",
+				pBeaconSync->UpdateCnt, pBeaconSync->UsbXferCnt,
+				PerUpdate / 10, PerUpdate % 10, pBeaconSync->WriteBytes));
+
+	return TRUE;
+}
+#endif /* BCN_BURST_SUPPORT */
+
 /*
 ========================================================================
 Routine Description:
@@ -1387,9 +1806,14 @@ VOID RT28xx_UpdateBeaconToAsic(
 	{
 		/* when the ra interface is down, do not send its beacon frame */
 		/* clear all zero */
+#ifdef BCN_BURST_SUPPORT
+		NdisZeroMemory(pBeaconSync->BeaconTxWI[bcn_idx], TXWISize);
+		BcnBurstWrite(pAd, pAd->BeaconOffset[bcn_idx], pBeaconSync->BeaconTxWI[bcn_idx], TXWISize);
+#else
 		for(i=0; i < TXWISize; i+=4) {
 			RTMP_CHIP_UPDATE_BEACON(pAd, pAd->BeaconOffset[bcn_idx] + i, 0x00, 4);
 		}
+#endif /* BCN_BURST_SUPPORT */
 
 		pBeaconSync->BeaconBitMap &= (~(BEACON_BITMAP_MASK & (1 << bcn_idx)));
 		NdisZeroMemory(pBeaconSync->BeaconTxWI[bcn_idx], TXWISize);
@@ -1406,20 +1830,36 @@ VOID RT28xx_UpdateBeaconToAsic(
 			NdisMoveMemory(pBeaconSync->BeaconTxWI[bcn_idx], &pAd->BeaconTxWI, TXWISize);
 		}
 
+#ifdef BCN_BURST_SUPPORT
+		pBeaconSync->UpdateCnt++;
+#endif /* BCN_BURST_SUPPORT */
+
 		if ((pBeaconSync->BeaconBitMap & (1 << bcn_idx)) != (1 << bcn_idx))
 		{
+#ifdef BCN_BURST_SUPPORT
+			BcnBurstWrite(pAd, pAd->BeaconOffset[bcn_idx], ptr, TXWISize);
+#else
 			for (i=0; i < TXWISize; i+=4)
 			{
 				longValue =  *ptr + (*(ptr+1)<<8) + (*(ptr+2)<<16) + (*(ptr+3)<<24);
 				RTMP_CHIP_UPDATE_BEACON(pAd, pAd->BeaconOffset[bcn_idx] + i, longValue, 4);
 				ptr += 4;
 			}
+#endif /* BCN_BURST_SUPPORT */
 		}
 
 		ptr = pBeaconSync->BeaconBuf[bcn_idx];
+#ifdef BCN_BURST_SUPPORT
+		/* whole dwords for the burst writes */
+		padding = (4 - (FrameLen & 0x03)) & 0x03;
+#else
 		padding = (FrameLen & 0x01);
+#endif /* BCN_BURST_SUPPORT */
 		NdisZeroMemory((unsigned char *)(pBeaconFrame + FrameLen), padding);
 		FrameLen += padding;
+#ifdef BCN_BURST_SUPPORT
+		BcnBurstDiffWrite(pAd, pAd->BeaconOffset[bcn_idx] + TXWISize, ptr, pBeaconFrame, FrameLen);
+#else
 		for (i = 0 ; i < FrameLen /*HW_BEACON_OFFSET*/; i += 2)
 		{
 			if (NdisEqualMemory(ptr, pBeaconFrame, 2) == FALSE)
@@ -1431,6 +1871,7 @@ VOID RT28xx_UpdateBeaconToAsic(
 			ptr +=2;
 			pBeaconFrame += 2;
 		}
+#endif /* BCN_BURST_SUPPORT */
 
 
 		pBeaconSync->BeaconBitMap |= (1 << bcn_idx);
@@ -1905,6 +2346,15 @@ VOID RT28xxUsbAsicRadioOn(RTMP_ADAPTER *pAd)
 #endif /* USB_SUPPORT_SELECTIVE_SUSPEND */
 #endif /* CONFIG_PM */
 
+#ifdef REG_DEFER_SUPPORT
+	/* the MAC may have lost its registers while the radio was off */
+	RegShadowReset(pAd);
+#endif /* REG_DEFER_SUPPORT */
+
+#ifdef PHY_SHADOW_SUPPORT
+	PhyShadowReset(pAd);
+#endif /* PHY_SHADOW_SUPPORT */
+
 	/* make some traffic to invoke EvtDeviceD0Entry callback function*/
 
 	RTUSBReadMACRegister(pAd,0x1000,&MACValue);
@@ -0,0 +1,99 @@
+#ifdef MEM_POOL_SUPPORT
+
+#include "rt_config.h"
+
+/*
+	Object pools for the buffers the driver allocates all the time: skbs
+	for received frames, MLME frame buffers and MCU command buffers and
+	response events. They are reserved when the adapter is allocated, so a
+	long running system with fragmented memory does not fail them, and
+	hand out from per-CPU caches. See RtmpOsPoolCreate().
+*/
+
+
+VOID MemPoolInit(
+	IN PRTMP_ADAPTER pAd)
+{
+	pAd->pRxSkbPool = RtmpOsPoolCreate("rxskb", MEM_POOL_RX_SKB_SIZE, MEM_POOL_RX_SKB_NUM, TRUE);
+	pAd->pMlmePool = RtmpOsPoolCreate("mlme", MGMT_DMA_BUFFER_SIZE, MEM_POOL_MLME_NUM, FALSE);
+	pAd->pMcuCmdPool = RtmpOsPoolCreate("mcucmd", MEM_POOL_MCU_CMD_SIZE, MEM_POOL_MCU_CMD_NUM, FALSE);
+	pAd->pMcuRspPool = RtmpOsPoolCreate("mcursp", sizeof(struct CMD_RSP_EVENT), MEM_POOL_MCU_RSP_NUM, FALSE);
+
+	/* a pool which could not be created leaves its users on the general allocator */
+	if ((pAd->pRxSkbPool == NULL) || (pAd->pMlmePool == NULL)
+		|| (pAd->pMcuCmdPool == NULL) || (pAd->pMcuRspPool == NULL))
+		DBGPRINT(RT_DEBUG_ERROR, ("%s: some object pools are not available\n", __FUNCTION__));
+}
+
+
+/* Called when the adapter is freed, after every pool object was given back */
+VOID MemPoolExit(
+	IN PRTMP_ADAPTER pAd)
+{
+	RtmpOsPoolDestroy(pAd->pRxSkbPool);
+	RtmpOsPoolDestroy(pAd->pMlmePool);
+	RtmpOsPoolDestroy(pAd->pMcuCmdPool);
+	RtmpOsPoolDestroy(pAd->pMcuRspPool);
+
+	pAd->pRxSkbPool = NULL;
+	pAd->pMlmePool = NULL;
+	pAd->pMcuCmdPool = NULL;
+	pAd->pMcuRspPool = NULL;
+}
+
+
+/* MlmeAllocateMemory() */
+NDIS_STATUS MlmePoolAllocate(
+	IN PRTMP_ADAPTER pAd,
+	OUT unsigned char **ppVA)
+{
+	*ppVA = (unsigned char *)RtmpOsMemPoolAlloc(pAd->pMlmePool, MGMT_DMA_BUFFER_SIZE);
+
+	return (*ppVA != NULL) ? NDIS_STATUS_SUCCESS : NDIS_STATUS_FAILURE;
+}
+
+
+/* MlmeFreeMemory(), memory which did not come from the pool is kfree'd */
+VOID MlmePoolFree(
+	IN PRTMP_ADAPTER pAd,
+	IN VOID *pVA)
+{
+	ASSERT(pVA);
+	RtmpOsMemPoolFree(pAd->pMlmePool, pVA);
+}
+
+
+/*
+    ==========================================================================
+    Description:
+        Show the use of the object pools
+    Return:
+        TRUE
+    ==========================================================================
+*/
+INT Show_MemPool_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	VOID *pPools[] = {pAd->pRxSkbPool, pAd->pMlmePool, pAd->pMcuCmdPool, pAd->pMcuRspPool};
+	RTMP_OS_POOL_STATS Stats;
+	INT i;
+
+	DBGPRINT(RT_DEBUG_OFF, ("%-8s%-8s%-6s%-6s%-7s%-7s%-12s%-12s%-10s%-6s%-8s\n",
+				"Pool", "Size", "Num", "Free", "InUse", "HighW", "Alloc", "Hit", "Fallback", "Fail", "Refill"));
+	for (i = 0; i < (INT)(sizeof(pPools) / sizeof(pPools[0])); i++)
+	{
+		if (pPools[i] == NULL)
+			continue;
+
+		RtmpOsPoolStatsGet(pPools[i], &Stats);
+		DBGPRINT(RT_DEBUG_OFF, ("%-8s%-8d%-6d%-6d%-7d%-7d%-12ld%-12ld%-10ld%-6ld%-8ld\n",
+					Stats.Name, Stats.ObjSize, Stats.ObjNum, Stats.Free, Stats.InUse,
+					Stats.HighWater, Stats.Alloc, Stats.Hit, Stats.Fallback, Stats.Fail,
+					Stats.Refill));
+	}
+
+	return TRUE;
+}
+#endif /* MEM_POOL_SUPPORT */
+
@@ -0,0 +1,382 @@
+#ifdef REG_DEFER_SUPPORT
+
+#include "rt_config.h"
+
+/*
+	Deferred MAC register writes and a read-through register shadow.
+
+	Every RTMP_IO_WRITE32() is two vendor requests and every
+	RTMP_IO_READ32() one. Between RegDeferBegin() and RegDeferEnd() the
+	MAC register writes of the calling task are queued in pAd->RegDefer
+	instead, and go to the MCU as AndesBurstWrite() for runs of
+	consecutive registers and AndesRandomWritePair() for the rest, in
+	the order they were written. Anything the queued writes must precede
+	flushes the queue first: a vendor request (RTUSB_VendorRequest()),
+	an MCU command (AsicSendCmdToAndes()), the queue running full and
+	RegDeferEnd(). Writes of other tasks are not held back.
+
+	Registers in RegShadowTable are only ever changed by the driver, so
+	after one read or write their value is answered from pAd->RegShadow.
+	The shadow is dropped whenever the MAC may have been reset. Writers
+	update it after the write has been issued. RegShadowLock covers the
+	values and the valid mask, which the command, MLME and ioctl threads
+	all change. A read only fills the shadow if RegShadowGen shows no
+	update since it started, else a value read before a concurrent
+	write could be stored after it.
+*/
+
+static const unsigned short RegShadowTable[] = {
+	WMM_AIFSN_CFG, WMM_CWMIN_CFG, WMM_CWMAX_CFG, WMM_TXOP0_CFG, WMM_TXOP1_CFG,
+	MAX_LEN_CFG, XIFS_TIME_CFG, BKOFF_SLOT_CFG, BCN_TIME_CFG,
+	EDCA_AC0_CFG, EDCA_AC1_CFG, EDCA_AC2_CFG, EDCA_AC3_CFG,
+	TX_BAND_CFG, TX_RTS_CFG, TX_TIMEOUT_CFG, TX_RTY_CFG, TX_LINK_CFG,
+	CCK_PROT_CFG, OFDM_PROT_CFG, MM20_PROT_CFG, MM40_PROT_CFG, GF20_PROT_CFG, GF40_PROT_CFG,
+	TX_PROT_CFG6, TX_PROT_CFG7, TX_PROT_CFG8,
+	AUTO_RSP_CFG, LEGACY_BASIC_RATE, HT_BASIC_RATE,
+};	/* no more than REG_SHADOW_NUM entries */
+
+#define REG_SHADOW_TABLE_SIZE	(sizeof(RegShadowTable) / sizeof(RegShadowTable[0]))
+
+
+static INT RegShadowIndex(
+	IN unsigned int Offset)
+{
+	INT i;
+
+	for (i = 0; i < REG_SHADOW_TABLE_SIZE; i++)
+	{
+		if (RegShadowTable[i] == Offset)
+			return i;
+	}
+
+	return -1;
+}
+
+
+VOID RegShadowReset(
+	IN PRTMP_ADAPTER pAd)
+{
+	NdisAcquireSpinLock(&pAd->RegShadowLock);
+	pAd->RegShadowValid = 0;
+	pAd->RegShadowGen++;
+	NdisReleaseSpinLock(&pAd->RegShadowLock);
+}
+
+
+bool RegShadowRead(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned short Offset,
+	OUT unsigned int *pValue)
+{
+	INT Idx;
+	bool bHit;
+
+	if (!pAd->bRegDefer)
+		return FALSE;
+
+	Idx = RegShadowIndex(Offset);
+	if (Idx < 0)
+		return FALSE;
+
+	NdisAcquireSpinLock(&pAd->RegShadowLock);
+	bHit = (pAd->RegShadowValid & (1 << Idx)) ? TRUE : FALSE;
+	if (bHit)
+	{
+		*pValue = pAd->RegShadow[Idx];
+		pAd->RegShadowHitCnt++;
+	}
+	else
+		pAd->RegShadowMissCnt++;
+	NdisReleaseSpinLock(&pAd->RegShadowLock);
+
+	return bHit;
+}
+
+
+VOID RegShadowWrite(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned int Offset,
+	IN unsigned int Value)
+{
+	INT Idx;
+
+	if (!pAd->bRegDefer)
+		return;
+
+	Idx = RegShadowIndex(Offset);
+	if (Idx < 0)
+		return;
+
+	NdisAcquireSpinLock(&pAd->RegShadowLock);
+	pAd->RegShadow[Idx] = Value;
+	pAd->RegShadowValid |= (1 << Idx);
+	pAd->RegShadowGen++;
+	NdisReleaseSpinLock(&pAd->RegShadowLock);
+}
+
+
+/* take before reading a register from the MAC, for RegShadowFill() */
+unsigned int RegShadowGenGet(
+	IN PRTMP_ADAPTER pAd)
+{
+	unsigned int Gen;
+
+	NdisAcquireSpinLock(&pAd->RegShadowLock);
+	Gen = pAd->RegShadowGen;
+	NdisReleaseSpinLock(&pAd->RegShadowLock);
+
+	return Gen;
+}
+
+
+/* store a value read from the MAC, unless the shadow changed while reading it */
+VOID RegShadowFill(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned short Offset,
+	IN unsigned int Value,
+	IN unsigned int Gen)
+{
+	INT Idx;
+
+	if (!pAd->bRegDefer)
+		return;
+
+	Idx = RegShadowIndex(Offset);
+	if (Idx < 0)
+		return;
+
+	NdisAcquireSpinLock(&pAd->RegShadowLock);
+	if (pAd->RegShadowGen == Gen)
+	{
+		pAd->RegShadow[Idx] = Value;
+		pAd->RegShadowValid |= (1 << Idx);
+	}
+	NdisReleaseSpinLock(&pAd->RegShadowLock);
+}
+
+
+/* after partial writes, drop the shadow of every register they touch */
+VOID RegShadowInvalidate(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned int Offset,
+	IN unsigned int Len)
+{
+	INT i;
+
+	NdisAcquireSpinLock(&pAd->RegShadowLock);
+	for (i = 0; i < REG_SHADOW_TABLE_SIZE; i++)
+	{
+		if ((RegShadowTable[i] + 4 > Offset) && (RegShadowTable[i] < Offset + Len))
+			pAd->RegShadowValid &= ~(1 << i);
+	}
+
+	/* also fences reads that started before the write */
+	pAd->RegShadowGen++;
+	NdisReleaseSpinLock(&pAd->RegShadowLock);
+}
+
+
+/* called by the owner only, pRegDeferOwner keeps everybody else out of the queue */
+static VOID RegDeferFlush(
+	IN PRTMP_ADAPTER pAd)
+{
+	RTMP_REG_PAIR *pPair = pAd->RegDefer;
+	unsigned int Data[REG_DEFER_MAX];
+	unsigned int Num = pAd->RegDeferNum, Start = 0, i = 0, Run, k;
+
+	/* the MCU commands below must not flush again */
+	pAd->bRegDeferFlushing = TRUE;
+
+	while (i < Num)
+	{
+		for (Run = 1; (i + Run) < Num; Run++)
+		{
+			if (pPair[i + Run].Register != pPair[i].Register + Run * 4)
+				break;
+		}
+
+		/* two consecutive registers already take less space as a burst */
+		if (Run < 2)
+		{
+			i++;
+			continue;
+		}
+
+		if (i > Start)
+		{
+			AndesRandomWritePair(pAd, &pPair[Start], i - Start);
+			pAd->RegDeferCmdCnt++;
+		}
+
+		for (k = 0; k < Run; k++)
+			Data[k] = pPair[i + k].Value;
+
+		AndesBurstWrite(pAd, pPair[i].Register, Data, Run);
+		pAd->RegDeferCmdCnt++;
+
+		i += Run;
+		Start = i;
+	}
+
+	if (Num > Start)
+	{
+		AndesRandomWritePair(pAd, &pPair[Start], Num - Start);
+		pAd->RegDeferCmdCnt++;
+	}
+
+	pAd->RegDeferNum = 0;
+	pAd->bRegDeferFlushing = FALSE;
+}
+
+
+bool RegDeferWrite(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned short Offset,
+	IN unsigned int Value)
+{
+	if (!pAd->bRegDefer || (pAd->RegDeferDepth == 0) || pAd->bRegDeferFlushing)
+		return FALSE;
+
+	if (pAd->pRegDeferOwner != RtmpOsCurrentTask())
+		return FALSE;
+
+	/* the USB and PBF blocks below the MAC registers stay on vendor requests */
+	if ((Offset < MAC_CSR0) ||
+		!RTMP_TEST_FLAG(pAd, fRTMP_ADAPTER_MCU_SEND_IN_BAND_CMD))
+		return FALSE;
+
+	if (pAd->RegDeferNum == REG_DEFER_MAX)
+		RegDeferFlush(pAd);
+
+	pAd->RegDefer[pAd->RegDeferNum].Register = Offset;
+	pAd->RegDefer[pAd->RegDeferNum].Value = Value;
+	pAd->RegDeferNum++;
+	pAd->RegDeferWriteCnt++;
+
+	RegShadowWrite(pAd, Offset, Value);
+
+	return TRUE;
+}
+
+
+VOID RegDeferSync(
+	IN PRTMP_ADAPTER pAd)
+{
+	if ((pAd->RegDeferNum == 0) || pAd->bRegDeferFlushing)
+		return;
+
+	if (pAd->pRegDeferOwner != RtmpOsCurrentTask())
+		return;
+
+	RegDeferFlush(pAd);
+}
+
+
+/*
+	Windows nest within one task. A second task gets no window of its own
+	while the first one is open, its writes simply go out directly.
+*/
+VOID RegDeferBegin(
+	IN PRTMP_ADAPTER pAd)
+{
+	VOID *pTask = RtmpOsCurrentTask();
+
+	if (!pAd->bRegDefer)
+		return;
+
+	NdisAcquireSpinLock(&pAd->RegDeferLock);
+	if (pAd->pRegDeferOwner == NULL)
+	{
+		pAd->pRegDeferOwner = pTask;
+		pAd->RegDeferDepth = 1;
+	}
+	else if (pAd->pRegDeferOwner == pTask)
+		pAd->RegDeferDepth++;
+	NdisReleaseSpinLock(&pAd->RegDeferLock);
+}
+
+
+VOID RegDeferEnd(
+	IN PRTMP_ADAPTER pAd)
+{
+	if (pAd->pRegDeferOwner != RtmpOsCurrentTask())
+		return;
+
+	if (--pAd->RegDeferDepth > 0)
+		return;
+
+	RegDeferFlush(pAd);
+
+	NdisAcquireSpinLock(&pAd->RegDeferLock);
+	pAd->pRegDeferOwner = NULL;
+	NdisReleaseSpinLock(&pAd->RegDeferLock);
+}
+
+
+VOID RegDeferInit(
+	IN PRTMP_ADAPTER pAd)
+{
+	NdisAllocateSpinLock(pAd, &pAd->RegDeferLock);
+	NdisAllocateSpinLock(pAd, &pAd->RegShadowLock);
+	pAd->pRegDeferOwner = NULL;
+	pAd->RegDeferDepth = 0;
+	pAd->RegDeferNum = 0;
+	pAd->bRegDeferFlushing = FALSE;
+	pAd->RegShadowValid = 0;
+	pAd->RegShadowGen = 0;
+	pAd->bRegDefer = TRUE;
+}
+
+
+VOID RegDeferExit(
+	IN PRTMP_ADAPTER pAd)
+{
+	pAd->bRegDefer = FALSE;
+	NdisFreeSpinLock(&pAd->RegDeferLock);
+	NdisFreeSpinLock(&pAd->RegShadowLock);
+}
+
+
+INT Set_RegDefer_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	/* an open window still flushes what it has queued */
+	pAd->bRegDefer = (simple_strtol(arg, 0, 10) != 0);
+	RegShadowReset(pAd);
+
+	pAd->VendorReqCnt = 0;
+	pAd->RegDeferWriteCnt = 0;
+	pAd->RegDeferCmdCnt = 0;
+	pAd->RegShadowHitCnt = 0;
+	pAd->RegShadowMissCnt = 0;
+
+	DBGPRINT(RT_DEBUG_TRACE, ("Set_RegDefer_Proc::(RegDefer=%d)\n", pAd->bRegDefer));
+
+	return TRUE;
+}
+
+
+INT Show_RegDefer_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	INT i, Valid = 0;
+
+	for (i = 0; i < REG_SHADOW_TABLE_SIZE; i++)
+	{
+		if (pAd->RegShadowValid & (1 << i))
+			Valid++;
+	}
+
+	DBGPRINT(RT_DEBUG_OFF, ("RegDefer=%d, VendorReq=%ld\n", pAd->bRegDefer, pAd->VendorReqCnt));
+	DBGPRINT(RT_DEBUG_OFF, ("DeferredWrites=%ld, McuCmds=%ld\n",
+				pAd->RegDeferWriteCnt, pAd->RegDeferCmdCnt));
+	DBGPRINT(RT_DEBUG_OFF, ("Shadow: %d/%d valid, Hit=%ld, Miss=%ld\n",
+				Valid, (INT)REG_SHADOW_TABLE_SIZE, pAd->RegShadowHitCnt, pAd->RegShadowMissCnt));
+
+	return TRUE;
+}
+
+#endif /* REG_DEFER_SUPPORT */
+
@@ -59,6 +59,11 @@ VOID TxSwQDepthAdjust(IN RTMP_ADAPTER *pAd, IN unsigned int qLen)
 	INT qIdx;
 	QUEUE_HEADER *pTxQ, *pEntry;
 	PNDIS_PACKET pPacket;
+#ifdef TX_AQM_SUPPORT
+	QUEUE_HEADER DropQueue;
+
+	InitializeQueueHeader(&DropQueue);
+#endif /* TX_AQM_SUPPORT */
 	
 	RTMP_IRQ_LOCK(&pAd->irq_lock, IrqFlags);
 	pAd->TxSwQMaxLen = qLen;
@@ -76,8 +81,20 @@ VOID TxSwQDepthAdjust(IN RTMP_ADAPTER *pAd, IN unsigned int qLen)
 			else
 				break;
 		}
+#ifdef TX_AQM_SUPPORT
+		/* the flow queues hold most of the backlog once AQM is in use */
+		AQMTrim(pAd, qIdx, &DropQueue);
+#endif /* TX_AQM_SUPPORT */
 	}
 	RTMP_IRQ_UNLOCK(&pAd->irq_lock, IrqFlags);
+
+#ifdef TX_AQM_SUPPORT
+	while (DropQueue.Head != NULL)
+	{
+		pEntry = RemoveHeadQueue(&DropQueue);
+		RELEASE_NDIS_PACKET(pAd, QUEUE_ENTRY_TO_PACKET(pEntry), NDIS_STATUS_FAILURE);
+	}
+#endif /* TX_AQM_SUPPORT */
 	
 	DBGPRINT(RT_DEBUG_OFF, ("%s():Set TxSwQMaxLen as %d\n", 
 			__FUNCTION__, pAd->TxSwQMaxLen));
@@ -1743,6 +1743,14 @@ VOID EnqueueStartForPSKExec(
 		switch (pEntry->EnqueueEapolStartTimerRunning)
 		{
 			case EAPOL_START_PSK:								
+#ifdef ASSOC_STORM_SUPPORT
+				/* too many handshakes running, keep the timer armed and ask again */
+				if (!AssocStormHsAdmit(pAd, pEntry))
+				{
+					RTMPSetTimer(&pEntry->EnqueueStartForPSKTimer, ASSOC_STORM_HS_RETRY);
+					return;
+				}
+#endif /* ASSOC_STORM_SUPPORT */
 				DBGPRINT(RT_DEBUG_TRACE, ("Enqueue EAPoL-Start-PSK for sta(%02x:%02x:%02x:%02x:%02x:%02x) \n", PRINT_MAC(pEntry->Addr)));
 
 				MlmeEnqueue(pAd, WPA_STATE_MACHINE, MT2_EAPOLStart, 6, &pEntry->Addr, 0);
@@ -2843,6 +2851,10 @@ VOID RTMPMakeRSNIE(
 		{
 			/* Sanity check for apidx */
 			MBSS_MR_APIDX_SANITY_CHECK(pAd, apidx);
+#if defined(BCN_SEG_SUPPORT) || defined(PROBE_CACHE_SUPPORT)
+			/* also when the BSS goes open, its RSN IEs leave the beacon */
+			APBeaconSegDirty(pAd, apidx, BCN_SEG_SEC);
+#endif /* BCN_SEG_SUPPORT || PROBE_CACHE_SUPPORT */
 #ifdef HOSTAPD_SUPPORT
 			if(pAd->ApCfg.MBSSID[apidx].Hostapd)
 				return;
@@ -1145,7 +1145,7 @@ NDIS_STATUS IgmpPktClone(
 			else
 			{
 				/* insert the pkt to TxSwQueue. */
-				if (pAd->TxSwQueue[QueIdx].Number >= pAd->TxSwQMaxLen)
+				if (TX_SWQ_PENDING(pAd, QueIdx) >= pAd->TxSwQMaxLen)
 				{
 #ifdef BLOCK_NET_IF
 					StopNetIfQueue(pAd, QueIdx, pSkbClone);
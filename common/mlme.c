@@ -321,8 +321,12 @@ VOID MlmeHandler(RTMP_ADAPTER *pAd)
 			{
 				DBGPRINT_RAW(RT_DEBUG_TRACE, ("!!! reset MLME state machine !!!\n"));
 				MlmeRestartStateMachine(pAd);
+#ifdef MLME_LANE_SUPPORT
+				MlmeElemFree(pAd, Elem);
+#else
 				Elem->Occupied = FALSE;
 				Elem->MsgLen = 0;
+#endif /* MLME_LANE_SUPPORT */
 				continue;
 			}
 #endif /* RTMP_MAC_USB */
@@ -394,7 +398,16 @@ VOID MlmeHandler(RTMP_ADAPTER *pAd)
 					if (pAd->pWscElme)
 					{
 						RTMP_SEM_LOCK(&pAd->WscElmeLock);
+#ifdef MLME_LANE_SUPPORT
+						/* the message goes along, Elem is freed below */
+						NdisMoveMemory(pAd->pWscElme, Elem, MLME_ELEM_HDR_LEN);
+						MLME_ELEM_MSG_INIT(pAd->pWscElme);
+						NdisMoveMemory(pAd->pWscElme->Msg, Elem->Msg, Elem->MsgLen);
+						pAd->pWscElme->pMsgPkt = NULL;
+						pAd->pWscElme->pNext = NULL;
+#else
 						NdisMoveMemory(pAd->pWscElme, Elem, sizeof(MLME_QUEUE_ELEM));
+#endif /* MLME_LANE_SUPPORT */
 						RTMP_SEM_UNLOCK(&pAd->WscElmeLock);
 /*#ifdef KTHREAD_SUPPORT*/
 /*						WAKE_UP(&(pAd->wscTask));*/
@@ -413,8 +426,12 @@ VOID MlmeHandler(RTMP_ADAPTER *pAd)
 			} /* end of switch*/
 
 			/* free MLME element*/
+#ifdef MLME_LANE_SUPPORT
+			MlmeElemFree(pAd, Elem);
+#else
 			Elem->Occupied = FALSE;
 			Elem->MsgLen = 0;
+#endif /* MLME_LANE_SUPPORT */
 
 		}
 		else {
@@ -517,6 +534,9 @@ VOID MlmeHalt(
 
 	RTMPusecDelay(5000);    /*  5 msec to gurantee Ant Diversity timer canceled*/
 
+#ifdef MLME_LANE_SUPPORT
+	MlmeQueueFlush(pAd, &pAd->Mlme.Queue);
+#endif /* MLME_LANE_SUPPORT */
 	MlmeQueueDestroy(&pAd->Mlme.Queue);
 	NdisFreeSpinLock(&pAd->Mlme.TaskLock);
 
@@ -1649,10 +1669,18 @@ VOID BATableInit(
 	Tab->numAsRecipient = 0;
 	Tab->numDoneOriginator = 0;
 	NdisAllocateSpinLock(pAd, &pAd->BATabLock);
+#ifdef BA_HRTIMER_SUPPORT
+	NdisAllocateSpinLock(pAd, &pAd->BaFlushLock);
+	NdisZeroMemory(pAd->BaFlushDue, sizeof(pAd->BaFlushDue));
+#endif /* BA_HRTIMER_SUPPORT */
 	for (i = 0; i < MAX_LEN_OF_BA_REC_TABLE; i++) 
 	{
 		Tab->BARecEntry[i].REC_BA_Status = Recipient_NONE;
 		NdisAllocateSpinLock(pAd, &(Tab->BARecEntry[i].RxReRingLock));
+#ifdef BA_HRTIMER_SUPPORT
+		Tab->BARecEntry[i].pAdapter = pAd;
+		RtmpOsHrTimerInit(&Tab->BARecEntry[i].FlushTimer, BaReorderTimerExpire, &Tab->BARecEntry[i]);
+#endif /* BA_HRTIMER_SUPPORT */
 	}
 	for (i = 0; i < MAX_LEN_OF_BA_ORI_TABLE; i++) 
 	{
@@ -1667,9 +1695,15 @@ VOID BATableExit(
 	
 	for(i=0; i<MAX_LEN_OF_BA_REC_TABLE; i++)
 	{
+#ifdef BA_HRTIMER_SUPPORT
+		RtmpOsHrTimerCancel(&pAd->BATable.BARecEntry[i].FlushTimer);
+#endif /* BA_HRTIMER_SUPPORT */
 		NdisFreeSpinLock(&pAd->BATable.BARecEntry[i].RxReRingLock);
 	}
 	NdisFreeSpinLock(&pAd->BATabLock);
+#ifdef BA_HRTIMER_SUPPORT
+	NdisFreeSpinLock(&pAd->BaFlushLock);
+#endif /* BA_HRTIMER_SUPPORT */
 }
 #endif /* DOT11_N_SUPPORT */
 
@@ -2732,11 +2766,19 @@ NDIS_STATUS MlmeQueueInit(
 	IN PRTMP_ADAPTER pAd,
 	IN MLME_QUEUE *Queue) 
 {
+#ifndef MLME_LANE_SUPPORT
 	INT i;
+#endif /* !MLME_LANE_SUPPORT */
 
 	NdisAllocateSpinLock(pAd, &Queue->Lock);
 
 	Queue->Num	= 0;
+#ifdef MLME_LANE_SUPPORT
+	NdisZeroMemory(Queue->Lane, sizeof(Queue->Lane));
+	Queue->Lane[MLME_LANE_CMD].Max = MLME_LANE_CMD_MAX;
+	Queue->Lane[MLME_LANE_CONN].Max = MLME_LANE_CONN_MAX;
+	Queue->Lane[MLME_LANE_SCAN].Max = MLME_LANE_SCAN_MAX;
+#else
 	Queue->Head = 0;
 	Queue->Tail = 0;
 
@@ -2746,10 +2788,161 @@ NDIS_STATUS MlmeQueueInit(
 		Queue->Entry[i].MsgLen = 0;
 		NdisZeroMemory(Queue->Entry[i].Msg, MGMT_DMA_BUFFER_SIZE);
 	}
+#endif /* MLME_LANE_SUPPORT */
 
 	return NDIS_STATUS_SUCCESS;
 }
 
+#ifdef MLME_LANE_SUPPORT
+/*
+	Lane queue.
+
+	Every message gets an element of its own, linked into one of three
+	lanes that MlmeDequeue() serves in order: the driver's own messages
+	(MLME_LANE_CMD), then the frames of the connection state machines
+	(MLME_LANE_CONN), then scan and probe frames (MLME_LANE_SCAN). A
+	ProbeReq flood so fills only its own lane and cannot hold back an
+	association, and each lane counts what it drops.
+
+	A message is copied into an element just large enough for it. A
+	received frame handed over with its packet (MlmeEnqueueForRecvPkt())
+	is not copied at all, the element points into the packet and
+	MlmeElemFree() releases the packet after the state machine ran.
+*/
+static unsigned long MlmeLaneOf(
+	IN unsigned long Machine)
+{
+	switch (Machine)
+	{
+#ifdef CONFIG_AP_SUPPORT
+		case AP_SYNC_STATE_MACHINE:
+#ifdef APCLI_SUPPORT
+		case APCLI_SYNC_STATE_MACHINE:
+#endif /* APCLI_SUPPORT */
+			return MLME_LANE_SCAN;
+#endif /* CONFIG_AP_SUPPORT */
+
+		default:
+			return MLME_LANE_CONN;
+	}
+}
+
+
+static MLME_QUEUE_ELEM *MlmeElemAlloc(
+	IN PRTMP_ADAPTER pAd,
+	IN MLME_QUEUE *Queue,
+	IN unsigned long Lane,
+	IN unsigned long MsgLen,
+	IN PNDIS_PACKET pPkt)
+{
+	MLME_LANE *pLane = &Queue->Lane[Lane];
+	MLME_QUEUE_ELEM *Elem = NULL;
+
+	/* not locked, MlmeElemLink() checks again */
+	if (pLane->Num < pLane->Max)
+		os_alloc_mem(pAd, (unsigned char **)&Elem, MLME_ELEM_HDR_LEN + ((pPkt == NULL) ? MsgLen : 0));
+
+	if (Elem == NULL)
+	{
+		NdisAcquireSpinLock(&(Queue->Lock));
+		pLane->DropCnt++;
+		NdisReleaseSpinLock(&(Queue->Lock));
+		return NULL;
+	}
+
+	NdisZeroMemory(Elem, MLME_ELEM_HDR_LEN);
+	Elem->Lane = Lane;
+	MLME_ELEM_MSG_INIT(Elem);
+
+	return Elem;
+}
+
+
+/* FALSE and Elem freed when the lane filled up meanwhile, Elem->pMsgPkt stays with the caller */
+static bool MlmeElemLink(
+	IN PRTMP_ADAPTER pAd,
+	IN MLME_QUEUE *Queue,
+	IN MLME_QUEUE_ELEM *Elem)
+{
+	MLME_LANE *pLane = &Queue->Lane[Elem->Lane];
+
+	NdisAcquireSpinLock(&(Queue->Lock));
+	if (pLane->Num >= pLane->Max)
+	{
+		pLane->DropCnt++;
+		NdisReleaseSpinLock(&(Queue->Lock));
+		os_free_mem(pAd, Elem);
+		return FALSE;
+	}
+
+	Elem->Occupied = TRUE;
+	Elem->pNext = NULL;
+	if (pLane->pTail != NULL)
+		pLane->pTail->pNext = Elem;
+	else
+		pLane->pHead = Elem;
+	pLane->pTail = Elem;
+
+	pLane->Num++;
+	pLane->EnqCnt++;
+	if (pLane->Num > pLane->PeakNum)
+		pLane->PeakNum = pLane->Num;
+	Queue->Num++;
+	NdisReleaseSpinLock(&(Queue->Lock));
+
+	return TRUE;
+}
+
+
+/* after MlmeDequeue() and the state machine */
+VOID MlmeElemFree(
+	IN PRTMP_ADAPTER pAd,
+	IN MLME_QUEUE_ELEM *Elem)
+{
+	if (Elem->pMsgPkt != NULL)
+		RELEASE_NDIS_PACKET(pAd, Elem->pMsgPkt, NDIS_STATUS_SUCCESS);
+
+	os_free_mem(pAd, Elem);
+}
+
+
+/* drop whatever is still queued, before MlmeQueueDestroy() */
+VOID MlmeQueueFlush(
+	IN PRTMP_ADAPTER pAd,
+	IN MLME_QUEUE *Queue)
+{
+	MLME_QUEUE_ELEM *Elem;
+
+	while (!MlmeQueueEmpty(Queue))
+	{
+		if (MlmeDequeue(Queue, &Elem))
+			MlmeElemFree(pAd, Elem);
+	}
+}
+
+
+INT Show_MlmeQueue_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	static const char *LaneName[MLME_LANE_NUM] = {"cmd", "conn", "scan"};
+	MLME_QUEUE *Queue = &pAd->Mlme.Queue;
+	MLME_LANE *pLane;
+	INT i;
+
+	DBGPRINT(RT_DEBUG_OFF, ("MLME queue: %lu queued\n", Queue->Num));
+	DBGPRINT(RT_DEBUG_OFF, ("%-6s %6s %6s %6s %10s %10s\n", "lane", "num", "max", "peak", "enqueued", "dropped"));
+	for (i = 0; i < MLME_LANE_NUM; i++)
+	{
+		pLane = &Queue->Lane[i];
+		DBGPRINT(RT_DEBUG_OFF, ("%-6s %6lu %6lu %6lu %10lu %10lu\n", LaneName[i],
+					pLane->Num, pLane->Max, pLane->PeakNum, pLane->EnqCnt, pLane->DropCnt));
+	}
+
+	return TRUE;
+}
+#endif /* MLME_LANE_SUPPORT */
+
 /*! \brief	 Enqueue a message for other threads, if they want to send messages to MLME thread
  *	\param	*Queue	  The MLME Queue
  *	\param	 Machine  The State Machine Id
@@ -2773,7 +2966,11 @@ bool MlmeEnqueue(
 	IN VOID *Msg,
 	IN unsigned long Priv) 
 {
+#ifdef MLME_LANE_SUPPORT
+	MLME_QUEUE_ELEM *Elem;
+#else
 	INT Tail;
+#endif /* MLME_LANE_SUPPORT */
 	MLME_QUEUE	*Queue = (MLME_QUEUE *)&pAd->Mlme.Queue;
 
 	/* Do nothing if the driver is starting halt state.*/
@@ -2791,6 +2988,24 @@ bool MlmeEnqueue(
 		return FALSE;
 	}
 	
+#ifdef MLME_LANE_SUPPORT
+	Elem = MlmeElemAlloc(pAd, Queue, MLME_LANE_CMD, MsgLen, NULL);
+	if (Elem == NULL)
+		return FALSE;
+
+	Elem->Wcid = RESERVED_WCID;
+	Elem->Machine = Machine;
+	Elem->MsgType = MsgType;
+	Elem->MsgLen  = MsgLen;
+	Elem->Priv = Priv;
+
+	if (Msg != NULL)
+	{
+		NdisMoveMemory(Elem->Msg, Msg, MsgLen);
+	}
+
+	return MlmeElemLink(pAd, Queue, Elem);
+#else
 	if (MlmeQueueFull(Queue, 1)) 
 	{
 		return FALSE;
@@ -2819,6 +3034,7 @@ bool MlmeEnqueue(
 		
 	NdisReleaseSpinLock(&(Queue->Lock));
 	return TRUE;
+#endif /* MLME_LANE_SUPPORT */
 }
 
 /*! \brief	 This function is used when Recv gets a MLME message
@@ -2835,6 +3051,7 @@ bool MlmeEnqueue(
  IRQL = DISPATCH_LEVEL
  
  */
+#ifdef MLME_LANE_SUPPORT
 bool MlmeEnqueueForRecv(
 	IN	PRTMP_ADAPTER	pAd, 
 	IN unsigned long Wcid, 
@@ -2849,10 +3066,57 @@ bool MlmeEnqueueForRecv(
 	IN unsigned char Signal,
 	IN unsigned char OpMode)
 {
-	INT 		 Tail, Machine = 0xff;
+	return MlmeEnqueueForRecvPkt(pAd, Wcid, TimeStampHigh, TimeStampLow, Rssi0, Rssi1, Rssi2,
+					AntSel, MsgLen, Msg, Signal, OpMode, NULL);
+}
+
+/*! \brief	 MlmeEnqueueForRecv() without the copy
+ *	\param	 pPkt			 The packet holding Msg, or NULL to copy Msg
+ *	\return  TRUE if queued, the queue then owns pPkt and releases it
+ *		 after the state machine; FALSE leaves pPkt with the caller
+ 
+ IRQL = DISPATCH_LEVEL
+ 
+ */
+bool MlmeEnqueueForRecvPkt(
+	IN	PRTMP_ADAPTER	pAd, 
+	IN unsigned long Wcid, 
+	IN unsigned long TimeStampHigh, 
+	IN unsigned long TimeStampLow,
+	IN unsigned char Rssi0, 
+	IN unsigned char Rssi1, 
+	IN unsigned char Rssi2, 
+	IN unsigned char AntSel, 
+	IN unsigned long MsgLen, 
+	IN VOID *Msg,
+	IN unsigned char Signal,
+	IN unsigned char OpMode,
+	IN PNDIS_PACKET pPkt)
+#else
+bool MlmeEnqueueForRecv(
+	IN	PRTMP_ADAPTER	pAd, 
+	IN unsigned long Wcid, 
+	IN unsigned long TimeStampHigh, 
+	IN unsigned long TimeStampLow,
+	IN unsigned char Rssi0, 
+	IN unsigned char Rssi1, 
+	IN unsigned char Rssi2, 
+	IN unsigned char AntSel, 
+	IN unsigned long MsgLen, 
+	IN VOID *Msg,
+	IN unsigned char Signal,
+	IN unsigned char OpMode)
+#endif /* MLME_LANE_SUPPORT */
+{
+	INT 		 Machine = 0xff;
 	PFRAME_802_11 pFrame = (PFRAME_802_11)Msg;
 	INT		 MsgType = 0x0;
 	MLME_QUEUE	*Queue = (MLME_QUEUE *)&pAd->Mlme.Queue;
+#ifdef MLME_LANE_SUPPORT
+	MLME_QUEUE_ELEM *Elem;
+#else
+	INT 		 Tail;
+#endif /* MLME_LANE_SUPPORT */
 
 #ifdef RALINK_ATE			
 	/* Nothing to do in ATE mode */
@@ -2875,10 +3139,12 @@ bool MlmeEnqueueForRecv(
 		return FALSE;
 	}
 
+#ifndef MLME_LANE_SUPPORT
 	if (MlmeQueueFull(Queue, 0)) 
 	{
 		return FALSE;
 	}
+#endif /* !MLME_LANE_SUPPORT */
 
 #ifdef CONFIG_AP_SUPPORT
 	IF_DEV_CONFIG_OPMODE_ON_AP(pAd)
@@ -2933,6 +3199,40 @@ bool MlmeEnqueueForRecv(
 
 	/* OK, we got all the informations, it is time to put things into queue*/
 
+#ifdef MLME_LANE_SUPPORT
+	Elem = MlmeElemAlloc(pAd, Queue, MlmeLaneOf(Machine), MsgLen, pPkt);
+	if (Elem == NULL)
+		return FALSE;
+
+	Elem->Machine = Machine;
+	Elem->MsgType = MsgType;
+	Elem->MsgLen  = MsgLen;
+	Elem->TimeStamp.u.LowPart = TimeStampLow;
+	Elem->TimeStamp.u.HighPart = TimeStampHigh;
+	Elem->Rssi0 = Rssi0;
+	Elem->Rssi1 = Rssi1;
+	Elem->Rssi2 = Rssi2;
+	Elem->AntSel = AntSel;
+	Elem->Signal = Signal;
+	Elem->Wcid = (unsigned char)Wcid;
+	Elem->OpMode = (unsigned long)OpMode;
+	Elem->Priv = 0;
+
+	Elem->Channel = pAd->LatchRfRegs.Channel;
+
+	if (pPkt != NULL)
+	{
+		Elem->Msg = (unsigned char *)Msg;
+		Elem->pMsgPkt = pPkt;
+	}
+	else if (Msg != NULL)
+	{
+		NdisMoveMemory(Elem->Msg, Msg, MsgLen);
+	}
+
+	if (!MlmeElemLink(pAd, Queue, Elem))
+		return FALSE;
+#else
 	NdisAcquireSpinLock(&(Queue->Lock));
 	Tail = Queue->Tail;
 	Queue->Tail++;
@@ -2964,6 +3264,7 @@ bool MlmeEnqueueForRecv(
 	}
 
 	NdisReleaseSpinLock(&(Queue->Lock));	
+#endif /* MLME_LANE_SUPPORT */
 	RTMP_MLME_HANDLER(pAd);
 
 	return TRUE;
@@ -2991,7 +3292,11 @@ bool MlmeEnqueueForWsc(
 	IN unsigned long MsgLen, 
 	IN VOID *Msg) 
 {
+#ifdef MLME_LANE_SUPPORT
+	MLME_QUEUE_ELEM *Elem;
+#else
     INT Tail;
+#endif /* MLME_LANE_SUPPORT */
     /*unsigned long			IrqFlags;*/
 	MLME_QUEUE	*Queue = (MLME_QUEUE *)&pAd->Mlme.Queue;
 
@@ -3008,6 +3313,22 @@ bool MlmeEnqueueForWsc(
 		return FALSE;
 	}
 	
+#ifdef MLME_LANE_SUPPORT
+	Elem = MlmeElemAlloc(pAd, Queue, MLME_LANE_CMD, MsgLen, NULL);
+	if (Elem == NULL)
+		return FALSE;
+
+	Elem->Machine = Machine;
+	Elem->MsgType = MsgType;
+	Elem->MsgLen  = MsgLen;
+	Elem->TimeStamp.u.LowPart = eventID;
+	Elem->TimeStamp.u.HighPart = senderID;
+	if (Msg != NULL)
+		NdisMoveMemory(Elem->Msg, Msg, MsgLen);
+
+	if (!MlmeElemLink(pAd, Queue, Elem))
+		return FALSE;
+#else
     if (MlmeQueueFull(Queue, 1)) 
     {
         
@@ -3034,6 +3355,7 @@ bool MlmeEnqueueForWsc(
         NdisMoveMemory(Queue->Entry[Tail].Msg, Msg, MsgLen);
 
     NdisReleaseSpinLock(&(Queue->Lock));
+#endif /* MLME_LANE_SUPPORT */
 
 	DBGPRINT(RT_DEBUG_TRACE, ("<----- MlmeEnqueueForWsc\n"));
 	
@@ -3055,6 +3377,29 @@ bool MlmeDequeue(
 	IN MLME_QUEUE *Queue, 
 	OUT MLME_QUEUE_ELEM **Elem) 
 {
+#ifdef MLME_LANE_SUPPORT
+	MLME_LANE *pLane;
+	INT i;
+
+	*Elem = NULL;
+	NdisAcquireSpinLock(&(Queue->Lock));
+	for (i = 0; i < MLME_LANE_NUM; i++)
+	{
+		pLane = &Queue->Lane[i];
+		if (pLane->pHead == NULL)
+			continue;
+
+		*Elem = pLane->pHead;
+		pLane->pHead = (*Elem)->pNext;
+		if (pLane->pHead == NULL)
+			pLane->pTail = NULL;
+		pLane->Num--;
+		Queue->Num--;
+		break;
+	}
+	NdisReleaseSpinLock(&(Queue->Lock));
+	return (*Elem != NULL);
+#else
 	NdisAcquireSpinLock(&(Queue->Lock));
 	*Elem = &(Queue->Entry[Queue->Head]);    
 	Queue->Num--;
@@ -3065,6 +3410,7 @@ bool MlmeDequeue(
 	}
 	NdisReleaseSpinLock(&(Queue->Lock));
 	return TRUE;
+#endif /* MLME_LANE_SUPPORT */
 }
 
 /* IRQL = DISPATCH_LEVEL*/
@@ -3119,6 +3465,7 @@ bool MlmeQueueEmpty(
  IRQL = DISPATCH_LEVEL
 
  */
+#ifndef MLME_LANE_SUPPORT
 bool MlmeQueueFull(
 	IN MLME_QUEUE *Queue,
 	IN unsigned char SendId) 
@@ -3134,6 +3481,7 @@ bool MlmeQueueFull(
 
 	return Ans;
 }
+#endif /* !MLME_LANE_SUPPORT */
 
 /*! \brief	 The destructor of MLME Queue
  *	\param 
@@ -3150,8 +3498,10 @@ VOID MlmeQueueDestroy(
 {
 	NdisAcquireSpinLock(&(pQueue->Lock));
 	pQueue->Num  = 0;
+#ifndef MLME_LANE_SUPPORT
 	pQueue->Head = 0;
 	pQueue->Tail = 0;
+#endif /* !MLME_LANE_SUPPORT */
 	NdisReleaseSpinLock(&(pQueue->Lock));
 	NdisFreeSpinLock(&(pQueue->Lock));
 }
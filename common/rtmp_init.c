@@ -281,6 +281,18 @@ NDIS_STATUS	RTMPAllocAdapterBlock(
 
 		NdisAllocateSpinLock(pAd, &TimerSemLock);
 
+#ifdef MEM_POOL_SUPPORT
+		MemPoolInit(pAd);
+#endif /* MEM_POOL_SUPPORT */
+
+#ifdef REG_DEFER_SUPPORT
+		RegDeferInit(pAd);
+#endif /* REG_DEFER_SUPPORT */
+
+#ifdef PHY_SHADOW_SUPPORT
+		PhyShadowInit(pAd);
+#endif /* PHY_SHADOW_SUPPORT */
+
 #ifdef RALINK_ATE
 #ifdef RTMP_MAC_USB
 		RTMP_OS_ATMOIC_INIT(&pAd->BulkOutRemained, &pAd->RscAtomicMemList);
@@ -1278,6 +1290,14 @@ NDIS_STATUS	NICInitializeAsic(
 
 	DBGPRINT(RT_DEBUG_TRACE, ("--> NICInitializeAsic\n"));
 
+#ifdef REG_DEFER_SUPPORT
+	RegShadowReset(pAd);
+#endif /* REG_DEFER_SUPPORT */
+
+#ifdef PHY_SHADOW_SUPPORT
+	PhyShadowReset(pAd);
+#endif /* PHY_SHADOW_SUPPORT */
+
 #ifdef RTMP_MAC_USB
 	/* Make sure MAC gets ready after NICLoadFirmware().*/
 
@@ -1319,7 +1339,7 @@ NDIS_STATUS	NICInitializeAsic(
 		UsbCfg.field.RxBulkAggEn = 1;
 
 	/* for last packet, PBF might use more than limited, so minus 2 to prevent from error */
-	UsbCfg.field.RxBulkAggLmt = (MAX_RXBULK_SIZE /1024)-3;
+	UsbCfg.field.RxBulkAggLmt = (pAd->RxBulkSize /1024)-3;
 	UsbCfg.field.RxBulkAggTOut = 0x80;
 
 	UsbCfg.field.RxBulkEn = 1;
@@ -1347,6 +1367,11 @@ NDIS_STATUS	NICInitializeAsic(
 #endif /* RLT_MAC */
 #endif /* RTMP_MAC_USB */
 
+#ifdef REG_DEFER_SUPPORT
+	/* the MCU takes commands from here on */
+	RegDeferBegin(pAd);
+#endif /* REG_DEFER_SUPPORT */
+
 #if defined(RTMP_MAC_USB) && defined(RLT_MAC)
 
 	AndesRandomWritePair(pAd, MACRegTable, NUM_MAC_REG_PARMS);
@@ -1373,7 +1398,12 @@ NDIS_STATUS	NICInitializeAsic(
 		RTMP_IO_READ32(pAd, MAC_STATUS_CFG, &MACValue);
 
 		if (RTMP_TEST_FLAG(pAd, fRTMP_ADAPTER_NIC_NOT_EXIST))
+		{
+#ifdef REG_DEFER_SUPPORT
+			RegDeferEnd(pAd);
+#endif /* REG_DEFER_SUPPORT */
 			return NDIS_STATUS_FAILURE;
+		}
 
 		if ((MACValue & 0x03) == 0)	/* if BB.RF is stable*/
 			break;
@@ -1545,6 +1575,10 @@ NDIS_STATUS	NICInitializeAsic(
 	}
 #endif /* RT3290 */
 
+#ifdef REG_DEFER_SUPPORT
+	RegDeferEnd(pAd);
+#endif /* REG_DEFER_SUPPORT */
+
 	DBGPRINT(RT_DEBUG_TRACE, ("<-- NICInitializeAsic\n"));
 	return NDIS_STATUS_SUCCESS;
 }
@@ -2332,6 +2366,9 @@ VOID UserCfgExit(
 	BATableExit(pAd);
 #endif /* DOT11_N_SUPPORT */
 
+#ifdef ASSOC_STORM_SUPPORT
+	AssocStormExit(pAd);
+#endif /* ASSOC_STORM_SUPPORT */
 
 	NdisFreeSpinLock(&pAd->MacTabLock);
 }
@@ -2384,6 +2421,42 @@ VOID UserCfgInit(RTMP_ADAPTER *pAd)
 	pAd->BulkInReq = 0;
 	pAd->BulkInComplete = 0;
 	pAd->BulkInCompleteFail = 0;
+	pAd->RxUrbTargetUp = 0;
+	pAd->RxUrbTargetDown = 0;
+	NdisZeroMemory(pAd->RxUrbInFlightHist, sizeof(pAd->RxUrbInFlightHist));
+	NdisZeroMemory(pAd->RxRingReadableHist, sizeof(pAd->RxRingReadableHist));
+	NdisZeroMemory(pAd->RxBulkFillHist, sizeof(pAd->RxBulkFillHist));
+#ifdef RX_ZERO_COPY_SUPPORT
+	pAd->RxCopyBreak = RX_ZC_COPY_BREAK;
+	pAd->RxZcBytesCopied = 0;
+	pAd->RxZcBytesRef = 0;
+	pAd->RxZcBufRenew = 0;
+	pAd->RxZcBufRenewFail = 0;
+	pAd->RxZcBufRecycle = 0;
+#endif /* RX_ZERO_COPY_SUPPORT */
+#ifdef RX_NAPI_SUPPORT
+	pAd->RxNapiBudget = RX_NAPI_WEIGHT;
+	pAd->RxNapiQuota = 0;
+	pAd->RxNapiPoll = 0;
+	pAd->RxNapiFrames = 0;
+	pAd->RxNapiBudgetFull = 0;
+#endif /* RX_NAPI_SUPPORT */
+#ifdef USB_BULK_OUT_SG_SUPPORT
+	pAd->bUsbTxSgEnable = TRUE;
+	pAd->TxSgFrames = 0;
+	pAd->TxSgBusy = 0;
+	pAd->TxSgFail = 0;
+#endif /* USB_BULK_OUT_SG_SUPPORT */
+#ifdef USB_TX_ADAPTIVE_BATCH
+	pAd->bTxBatchAdaptive = TRUE;
+	NdisZeroMemory(pAd->TxBatchCtrl, sizeof(pAd->TxBatchCtrl));
+	for (i = 0; i < NUM_OF_TX_RING; i++)
+	{
+		pAd->TxBatchCtrl[i].FrameLenAvg = 1514;
+		pAd->TxBatchCtrl[i].StagedAvg = MAX_AGGREGATION_SIZE;
+		pAd->TxBatchCtrl[i].Budget = MAX_TX_PROCESS;
+	}
+#endif /* USB_TX_ADAPTIVE_BATCH */
 
 	/*pAd->QuickTimerP = 100;*/
 	/*pAd->TurnAggrBulkInCount = 0;*/
@@ -2527,6 +2600,9 @@ VOID UserCfgInit(RTMP_ADAPTER *pAd)
 
 	pAd->CommonCfg.BACapability.field.AutoBA = FALSE;	
 	BATableInit(pAd, &pAd->BATable);
+#ifdef BA_HRTIMER_SUPPORT
+	pAd->BaReorderTimeout = BA_REORDER_TIMEOUT_DEFAULT;
+#endif /* BA_HRTIMER_SUPPORT */
 
 	pAd->CommonCfg.bExtChannelSwitchAnnouncement = 1;
 	pAd->CommonCfg.bHTProtect = 1;
@@ -2614,6 +2690,15 @@ VOID UserCfgInit(RTMP_ADAPTER *pAd)
 
 	/* Tx Sw queue length setting */
 	pAd->TxSwQMaxLen = MAX_PACKETS_IN_QUEUE;
+#ifdef AIRTIME_FAIRNESS_SUPPORT
+	ATFInit(pAd);
+#endif /* AIRTIME_FAIRNESS_SUPPORT */
+#ifdef TX_AQM_SUPPORT
+	AQMInit(pAd);
+#endif /* TX_AQM_SUPPORT */
+#ifdef HDR_TRANS_SUPPORT
+	HdrTransInit(pAd);
+#endif /* HDR_TRANS_SUPPORT */
 	
 	pAd->CommonCfg.bRalinkBurstMode = FALSE;
 
@@ -2766,6 +2851,12 @@ VOID UserCfgInit(RTMP_ADAPTER *pAd)
 
 			for(i = 0; i < WLAN_MAX_NUM_OF_TIM; i++)
 	        		pAd->ApCfg.MBSSID[j].TimBitmaps[i] = 0;
+#ifdef BCN_SEG_SUPPORT
+			pAd->ApCfg.MBSSID[j].TimLo = WLAN_MAX_NUM_OF_TIM;
+			pAd->ApCfg.MBSSID[j].TimHi = 0;
+			pAd->ApCfg.MBSSID[j].bTimRescan = FALSE;
+			pAd->ApCfg.MBSSID[j].BcnSegDirty = BCN_SEG_ALL;
+#endif /* BCN_SEG_SUPPORT */
 		}
 		pAd->ApCfg.DtimCount  = 0;
 		pAd->ApCfg.DtimPeriod = DEFAULT_DTIM_PERIOD;
@@ -2867,6 +2958,9 @@ VOID UserCfgInit(RTMP_ADAPTER *pAd)
 	NdisZeroMemory(&pAd->MacTab, sizeof(MAC_TABLE));
 	InitializeQueueHeader(&pAd->MacTab.McastPsQueue);
 	NdisAllocateSpinLock(pAd, &pAd->MacTabLock);
+#ifdef ASSOC_STORM_SUPPORT
+	AssocStormInit(pAd);
+#endif /* ASSOC_STORM_SUPPORT */
 
 	/*RTMPInitTimer(pAd, &pAd->RECBATimer, RECBATimerTimeout, pAd, TRUE);*/
 	/*RTMPSetTimer(&pAd->RECBATimer, REORDER_EXEC_INTV);*/
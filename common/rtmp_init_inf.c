@@ -117,6 +117,10 @@ int rt28xx_init(VOID *pAdSrc, char * pDefaultMac, char * pHostName)
 	if (pAd == NULL)
 		return FALSE;
 
+#ifdef BOOT_PROF_SUPPORT
+	BootProfStart(pAd);
+#endif /* BOOT_PROF_SUPPORT */
+
 // TODO: shiang-6590, fix me, we need a better place for this function call
 #ifdef RT6570
 	if (pAd->WlanFunCtrl.field.WLAN_EN == 0)
@@ -209,6 +213,9 @@ int rt28xx_init(VOID *pAdSrc, char * pDefaultMac, char * pHostName)
 		goto err1;
 	}
 
+#ifdef BOOT_PROF_SUPPORT
+	BootProfMark(pAd, BOOT_PROF_CHIP_ON);
+#endif /* BOOT_PROF_SUPPORT */
 
 	/* Disable DMA*/
 	RT28XXDMADisable(pAd);
@@ -227,6 +234,10 @@ int rt28xx_init(VOID *pAdSrc, char * pDefaultMac, char * pHostName)
 		goto err1;
 	}
 
+#ifdef BOOT_PROF_SUPPORT
+	BootProfMark(pAd, BOOT_PROF_FIRMWARE);
+#endif /* BOOT_PROF_SUPPORT */
+
 	/* Disable interrupts here which is as soon as possible*/
 	/* This statement should never be true. We might consider to remove it later*/
 
@@ -297,6 +308,10 @@ int rt28xx_init(VOID *pAdSrc, char * pDefaultMac, char * pHostName)
 		goto err6;
 	}
 
+#ifdef BOOT_PROF_SUPPORT
+	BootProfMark(pAd, BOOT_PROF_TASK_INIT);
+#endif /* BOOT_PROF_SUPPORT */
+
 	/* Init the hardware, we need to init asic before read registry, otherwise mac register will be reset*/
 
 	Status = NICInitializeAdapter(pAd, TRUE);
@@ -307,6 +322,10 @@ int rt28xx_init(VOID *pAdSrc, char * pDefaultMac, char * pHostName)
 		goto err6;
 	}
 
+#ifdef BOOT_PROF_SUPPORT
+	BootProfMark(pAd, BOOT_PROF_MAC_INIT);
+#endif /* BOOT_PROF_SUPPORT */
+
 #ifdef CONFIG_AP_SUPPORT
 	IF_DEV_CONFIG_OPMODE_ON_AP(pAd)
 	{
@@ -326,11 +345,15 @@ int rt28xx_init(VOID *pAdSrc, char * pDefaultMac, char * pHostName)
 		goto err6;
 	}
 
+#ifdef BOOT_PROF_SUPPORT
+	BootProfMark(pAd, BOOT_PROF_PROFILE);
+#endif /* BOOT_PROF_SUPPORT */
+
 #ifdef RTMP_MAC_USB
-	pAd->CommonCfg.bMultipleIRP = FALSE;
+	pAd->CommonCfg.bMultipleIRP = (pAd->RxUrbNum > 1) ? TRUE : FALSE;
 
 	if (pAd->CommonCfg.bMultipleIRP)
-		pAd->CommonCfg.NumOfBulkInIRP = RX_RING_SIZE;
+		pAd->CommonCfg.NumOfBulkInIRP = pAd->RxUrbNum;
 	else
 		pAd->CommonCfg.NumOfBulkInIRP = 1;
 #endif /* RTMP_MAC_USB */
@@ -354,6 +377,9 @@ int rt28xx_init(VOID *pAdSrc, char * pDefaultMac, char * pHostName)
 
 	/* We should read EEPROM for all cases.  rt2860b*/
 	NICReadEEPROMParameters(pAd, (char *)pDefaultMac);
+#ifdef BOOT_PROF_SUPPORT
+	BootProfMark(pAd, BOOT_PROF_EEPROM);
+#endif /* BOOT_PROF_SUPPORT */
 
 	DBGPRINT(RT_DEBUG_OFF, ("3. Phy Mode = %d\n", pAd->CommonCfg.PhyMode));
 
@@ -363,6 +389,9 @@ int rt28xx_init(VOID *pAdSrc, char * pDefaultMac, char * pHostName)
 #endif /* LED_CONTROL_SUPPORT */
 
 	NICInitAsicFromEEPROM(pAd); /* rt2860b */
+#ifdef BOOT_PROF_SUPPORT
+	BootProfMark(pAd, BOOT_PROF_PHY_INIT);
+#endif /* BOOT_PROF_SUPPORT */
 
 #ifdef RALINK_ATE
 	if (ATEInit(pAd) != NDIS_STATUS_SUCCESS)
@@ -437,6 +466,9 @@ int rt28xx_init(VOID *pAdSrc, char * pDefaultMac, char * pHostName)
 		AsicLockChannel(pAd, pAd->CommonCfg.Channel);
 	}
 #endif /* CONFIG_AP_SUPPORT */
+#ifdef BOOT_PROF_SUPPORT
+	BootProfMark(pAd, BOOT_PROF_CHANNEL);
+#endif /* BOOT_PROF_SUPPORT */
 
 	/*
 		Some modules init must be called before APStartUp().
@@ -497,6 +529,9 @@ int rt28xx_init(VOID *pAdSrc, char * pDefaultMac, char * pHostName)
 				pAd->CommonCfg.Channel = AP_AUTO_CH_SEL(pAd, pAd->ApCfg.AutoChannelAlg);
 				pAd->ApCfg.bAutoChannelAtBootup = FALSE;
 			}
+#ifdef BOOT_PROF_SUPPORT
+			BootProfMark(pAd, BOOT_PROF_AUTO_CH);
+#endif /* BOOT_PROF_SUPPORT */
 
 #ifdef DOT11_N_SUPPORT
 			/* If WMODE_CAP_N(phymode) and BW=40 check extension channel, after select channel  */
@@ -529,6 +564,9 @@ int rt28xx_init(VOID *pAdSrc, char * pDefaultMac, char * pHostName)
 			APStartUp(pAd);
 			DBGPRINT(RT_DEBUG_OFF, ("Main bssid = %02x:%02x:%02x:%02x:%02x:%02x\n",
 							PRINT_MAC(pAd->ApCfg.MBSSID[BSS0].Bssid)));
+#ifdef BOOT_PROF_SUPPORT
+			BootProfMark(pAd, BOOT_PROF_AP_STARTUP);
+#endif /* BOOT_PROF_SUPPORT */
 		}
 #endif /* CONFIG_AP_SUPPORT */
 
@@ -833,6 +871,23 @@ VOID RTMPDrvOpen(
 		MultiChannelThreadInit(pAd);
 #endif /* CONFIG_MULTI_CHANNEL */
 
+#if defined(PHY_SHADOW_SUPPORT) || defined(BOOT_PROF_SUPPORT)
+	/* needs the interface name, kept until the adapter is freed */
+	if (pAd->pDebugfsDir == NULL)
+	{
+		pAd->pDebugfsDir = RtmpOsDebugfsDirCreate(RTMP_OS_NETDEV_GET_DEVNAME(pAd->net_dev));
+#ifdef PHY_SHADOW_SUPPORT
+		PhyShadowDebugfsInit(pAd);
+#endif /* PHY_SHADOW_SUPPORT */
+#ifdef BOOT_PROF_SUPPORT
+		BootProfDebugfsInit(pAd);
+#endif /* BOOT_PROF_SUPPORT */
+	}
+#endif /* PHY_SHADOW_SUPPORT || BOOT_PROF_SUPPORT */
+
+#ifdef BOOT_PROF_SUPPORT
+	BootProfMark(pAd, BOOT_PROF_DRV_OPEN);
+#endif /* BOOT_PROF_SUPPORT */
 
 }
 
@@ -998,6 +1053,11 @@ VOID RTMPDrvClose(
 	skb_queue_purge(&pAd->rx0_recycle);
 #endif /* WLAN_SKB_RECYCLE */
 
+#ifdef MAC_TABLE_RCU_SUPPORT
+	/* entries deleted by MacTableReset() are torn down after a grace period */
+	RtmpOsRcuBarrier();
+#endif /* MAC_TABLE_RCU_SUPPORT */
+
 #ifdef DOT11_N_SUPPORT
 	/* Free BA reorder resource*/
 	ba_reordering_resource_release(pAd);
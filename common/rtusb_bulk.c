@@ -252,6 +252,7 @@ VOID	RTUSBInitRxDesc(
 	PURB				pUrb;
 	POS_COOKIE			pObj = (POS_COOKIE) pAd->OS_Cookie;
 	unsigned long				RX_bulk_size;
+	unsigned long				RxPosition;
 	RTMP_CHIP_CAP *pChipCap = &pAd->chipCap;
 
 	pUrb = pRxContext->pUrb;
@@ -260,18 +261,27 @@ VOID	RTUSBInitRxDesc(
 	if ( pAd->BulkInMaxPacketSize == 64)
 		RX_bulk_size = 4096;
 	else
-		RX_bulk_size = MAX_RXBULK_SIZE;
-		
+		RX_bulk_size = pAd->RxBulkSize;
+
+	/* only the oldest context may resume a failed transfer, the ones queued behind it start afresh */
+	if (pRxContext == &pAd->RxContext[pAd->NextRxBulkInIndex])
+		RxPosition = pAd->NextRxBulkInPosition;
+	else
+		RxPosition = 0;
 
 	/*Initialize a rx bulk urb*/
 	RTUSB_FILL_RX_BULK_URB(pUrb,
 					pObj->pUsb_Dev,
 					pChipCap->DataBulkInAddr,
-					&(pRxContext->TransferBuffer[pAd->NextRxBulkInPosition]),
-					RX_bulk_size - (pAd->NextRxBulkInPosition),
+					&(pRxContext->TransferBuffer[RxPosition]),
+					RX_bulk_size - RxPosition,
 					RtmpUsbBulkRxComplete,
 					(void *)pRxContext,
-					(pRxContext->data_dma + pAd->NextRxBulkInPosition));
+					(pRxContext->data_dma + RxPosition));
+#ifdef RX_ZERO_COPY_SUPPORT
+	/* TransferBuffer is packet data, not a coherent buffer */
+	RTUSB_URB_DMA_MAPPING(pUrb);
+#endif /* RX_ZERO_COPY_SUPPORT */
 }
 
 
@@ -724,7 +734,7 @@ VOID	RTUSBBulkOutDataPacket(
 	
 	/* Init Tx context descriptor*/
 	RTUSBInitHTTxDesc(pAd, pHTTXContext, BulkOutPipeId, ThisBulkSize, (usb_complete_t)RtmpUsbBulkOutDataPacketComplete);
-	
+
 	pUrb = pHTTXContext->pUrb;
 	if((ret = RTUSB_SUBMIT_URB(pUrb))!=0)
 	{
@@ -742,8 +752,225 @@ VOID	RTUSBBulkOutDataPacket(
 	pHTTXContext->IRPPending = TRUE;
 	BULK_OUT_UNLOCK(&pAd->BulkOutLock[BulkOutPipeId], IrqFlags);
 	pAd->BulkOutReq++;
+#ifdef USB_TX_ADAPTIVE_BATCH
+	RTUSBTxBatchUrbSubmit(pAd, BulkOutPipeId, ThisBulkSize);
+#endif /* USB_TX_ADAPTIVE_BATCH */
+
+}
+
+
+#ifdef USB_BULK_OUT_SG_SUPPORT
+/*
+	========================================================================
+
+	Routine Description:
+		Bulk-out one frame on its own URB. TXINFO, TXWI and the 802.11 header
+		are built in the header arena of a free slot, the payload is taken
+		from the skb through the URB scatterlist.
+
+	Arguments:
+		pAd				Pointer to our adapter
+		pHTTXContext	HT TX ring of the pipe, locked by the caller
+		pTxBlk			frame, TXINFO and TXWI already in HeaderBuf
+		HdrLen			TXINFO + TXWI + 802.11 header length
+		Padding			bytes to round the USB DMA length up to 4
+
+	Return Value:
+		TRUE if the URB is submitted, the skb is released in
+		RTUSBBulkOutDataPacketComplete(). FALSE if the frame has to be
+		copied into the HT TX ring.
+
+	Note:
+		Only used while nothing is queued in the HT TX ring and no ring
+		bulk-out is being built, so the frame can't pass earlier ones.
+
+	========================================================================
+*/
+bool RTUSBBulkOutSgPacket(
+	IN RTMP_ADAPTER *pAd,
+	IN HT_TX_CONTEXT *pHTTXContext,
+	IN TX_BLK *pTxBlk,
+	IN unsigned int HdrLen,
+	IN unsigned int Padding)
+{
+	POS_COOKIE pObj = (POS_COOKIE) pAd->OS_Cookie;
+	RTMP_CHIP_CAP *pChipCap = &pAd->chipCap;
+	unsigned char BulkOutPipeId = pHTTXContext->BulkOutPipeId;
+	TX_SG_SLOT *pSlot = NULL;
+	TXINFO_STRUC *pTxInfo;
+	TXWI_STRUC *pTxWI;
+	unsigned char *pBuf[TX_SG_ENTRY_NUM];
+	unsigned int Len[TX_SG_ENTRY_NUM];
+	unsigned int EpAddr;
+	INT i, ret;
+
+	if ((pAd->bUsbTxSg == FALSE) || (pAd->bUsbTxSgEnable == FALSE))
+		return FALSE;
+
+	if ((HdrLen > TX_SG_HDR_SIZE) || (pTxBlk->SrcBufLen == 0))
+		return FALSE;
+
+#ifdef TX_PKT_SG
+	if (pTxBlk->pkt_info.BufferCount > 1)
+		return FALSE;
+#endif /* TX_PKT_SG */
+
+#ifdef UAPSD_SUPPORT
+	/* EOSP tracking works on HT TX ring offsets */
+	if (RTMP_GET_PACKET_UAPSD_Flag(pTxBlk->pPacket) == TRUE)
+		return FALSE;
+#endif /* UAPSD_SUPPORT */
+
+#ifdef CONFIG_MULTI_CHANNEL
+	if ((pAd->MultiChannelFlowCtl & (1 << BulkOutPipeId)) == (1 << BulkOutPipeId))
+		return FALSE;
+#endif /* CONFIG_MULTI_CHANNEL */
+
+	if ((pHTTXContext->ENextBulkOutPosition != pHTTXContext->CurWritePosition) ||
+		(pAd->BulkOutPending[BulkOutPipeId] == TRUE) ||
+		RTMP_TEST_FLAG(pAd, fRTMP_ADAPTER_NEED_STOP_TX))
+		return FALSE;
+
+	if ((!OPSTATUS_TEST_FLAG(pAd, fOP_AP_STATUS_MEDIA_STATE_CONNECTED)) &&
+		(!OPSTATUS_TEST_FLAG(pAd, fOP_STATUS_MEDIA_STATE_CONNECTED)))
+		return FALSE;
+
+	for (i = 0; i < TX_SG_SLOT_NUM; i++)
+	{
+		if (pAd->TxSgSlot[BulkOutPipeId][i].InUse == FALSE)
+		{
+			pSlot = &pAd->TxSgSlot[BulkOutPipeId][i];
+			break;
+		}
+	}
+
+	if (pSlot == NULL)
+	{
+		pAd->TxSgBusy++;
+		return FALSE;
+	}
+
+	NdisMoveMemory(pSlot->HdrBuf, pTxBlk->HeaderBuf, HdrLen);
+	pTxInfo = (TXINFO_STRUC *)pSlot->HdrBuf;
+	pTxWI = (TXWI_STRUC *)&pSlot->HdrBuf[TXINFO_SIZE];
+
+	pAd->RalinkCounters.OneSecTransmittedByteCount += pTxWI->TxWIMPDUByteCnt;
+	pAd->RalinkCounters.TransmittedByteCount += pTxWI->TxWIMPDUByteCnt;
+
+#ifdef RT_BIG_ENDIAN
+	RTMPFrameEndianChange(pAd, (unsigned char *)(pSlot->HdrBuf + TXINFO_SIZE + pChipCap->TXWISize + TSO_SIZE), DIR_WRITE, FALSE);
+	RTMPDescriptorEndianChange((unsigned char *)pTxInfo, TYPE_TXINFO);
+	RTMPWIEndianChange(pAd, (unsigned char *)pTxWI, TYPE_TXWI);
+#endif /* RT_BIG_ENDIAN */
+
+	/* The zero bytes behind the arena cover the padding and the 4-byte USB DMA tail */
+	pBuf[0] = pSlot->HdrBuf;
+	Len[0] = HdrLen;
+	pBuf[1] = pTxBlk->pSrcBufData;
+	Len[1] = pTxBlk->SrcBufLen;
+	pBuf[2] = &pSlot->HdrBuf[TX_SG_HDR_SIZE];
+	Len[2] = Padding + 4;
+
+	if (BulkOutPipeId == 4) //Use EP9
+		EpAddr = pChipCap->WMM1ACBulkOutAddr;
+	else
+		EpAddr = pChipCap->WMM0ACBulkOutAddr[BulkOutPipeId];
+
+	RtmpOsUsbInitSgTxDesc(pSlot->pUrb, pObj->pUsb_Dev, EpAddr,
+							pSlot->pSgTable, pBuf, Len, TX_SG_ENTRY_NUM,
+							(USB_COMPLETE_HANDLER)RtmpUsbBulkOutDataPacketComplete,
+							pHTTXContext);
+
+	pSlot->pPacket = pTxBlk->pPacket;
+	pSlot->InUse = TRUE;
+
+	if ((ret = RTUSB_SUBMIT_URB(pSlot->pUrb)) != 0)
+	{
+		DBGPRINT(RT_DEBUG_ERROR, ("RTUSBBulkOutSgPacket: Submit Tx URB failed %d\n", ret));
+		pSlot->pPacket = NULL;
+		pSlot->InUse = FALSE;
+		pAd->TxSgFail++;
+		return FALSE;
+	}
+
+	pAd->BulkOutReq++;
+	pAd->TxSgFrames++;
+#ifdef USB_TX_ADAPTIVE_BATCH
+	RTUSBTxBatchUrbSubmit(pAd, BulkOutPipeId, HdrLen + pTxBlk->SrcBufLen + Padding + 4);
+#endif /* USB_TX_ADAPTIVE_BATCH */
+
+	return TRUE;
+}
+
+
+/*
+	Bulk-out of a TX_SG_SLOT is done, called from the URB completion with
+	the HT TX ring of the pipe as context. Release the skb and the slot.
+*/
+VOID RTUSBBulkOutSgComplete(
+	IN RTMP_ADAPTER *pAd,
+	IN HT_TX_CONTEXT *pHTTXContext,
+	IN VOID *pUrb)
+{
+	unsigned char BulkOutPipeId = pHTTXContext->BulkOutPipeId;
+	TX_SG_SLOT *pSlot = NULL;
+	PNDIS_PACKET pPacket;
+	NTSTATUS Status;
+	unsigned long IrqFlags;
+	INT i;
+
+	Status = RTMP_USB_URB_STATUS_GET(pUrb);
+
+	RTMP_IRQ_LOCK(&pAd->TxContextQueueLock[BulkOutPipeId], IrqFlags);
+	for (i = 0; i < TX_SG_SLOT_NUM; i++)
+	{
+		if (pAd->TxSgSlot[BulkOutPipeId][i].pUrb == pUrb)
+		{
+			pSlot = &pAd->TxSgSlot[BulkOutPipeId][i];
+			break;
+		}
+	}
+
+	if (pSlot == NULL)
+	{
+		RTMP_IRQ_UNLOCK(&pAd->TxContextQueueLock[BulkOutPipeId], IrqFlags);
+		return;
+	}
+
+	pPacket = pSlot->pPacket;
+	pSlot->pPacket = NULL;
+	pSlot->InUse = FALSE;
+	RTMP_IRQ_UNLOCK(&pAd->TxContextQueueLock[BulkOutPipeId], IrqFlags);
+
+	if (Status == USB_ST_NOERROR)
+	{
+		pAd->BulkOutComplete++;
+		pAd->Counters8023.GoodTransmits++;
+	}
+	else
+	{
+		pAd->BulkOutCompleteOther++;
+		pAd->TxSgFail++;
+
+		RTMP_IRQ_LOCK(&pAd->BulkOutLock[BulkOutPipeId], IrqFlags);
+		if (!RTMP_TEST_FLAG(pAd, (fRTMP_ADAPTER_RESET_IN_PROGRESS |
+									fRTMP_ADAPTER_HALT_IN_PROGRESS |
+									fRTMP_ADAPTER_NIC_NOT_EXIST |
+									fRTMP_ADAPTER_BULKOUT_RESET)))
+		{
+			RTMP_SET_FLAG(pAd, fRTMP_ADAPTER_BULKOUT_RESET);
+			pAd->bulkResetPipeid = BulkOutPipeId;
+			pAd->bulkResetReq[BulkOutPipeId] = pAd->BulkOutReq;
+		}
+		RTMP_IRQ_UNLOCK(&pAd->BulkOutLock[BulkOutPipeId], IrqFlags);
+
+		DBGPRINT_RAW(RT_DEBUG_ERROR, ("BulkOutSgPacket failed: ReasonCode=%d!\n", Status));
+	}
 
+	if (pPacket)
+		RELEASE_NDIS_PACKET(pAd, pPacket, NDIS_STATUS_SUCCESS);
 }
+#endif /* USB_BULK_OUT_SG_SUPPORT */
 
 
 USBHST_STATUS RTUSBBulkOutDataPacketComplete(URBCompleteStatus Status, purbb_t pURB, pregs *pt_regs)
@@ -762,6 +989,15 @@ USBHST_STATUS RTUSBBulkOutDataPacketComplete(URBCompleteStatus Status, purbb_t p
 	BulkOutPipeId	= pHTTXContext->BulkOutPipeId;
 	pAd->BulkOutDataOneSecCount++;
 
+#ifdef USB_BULK_OUT_SG_SUPPORT
+	/* Single frame sent from its skb, the HT TX ring is not involved */
+	if ((PURB)pURB != pHTTXContext->pUrb)
+	{
+		RTUSBBulkOutSgComplete(pAd, pHTTXContext, pURB);
+		return;
+	}
+#endif /* USB_BULK_OUT_SG_SUPPORT */
+
 	switch (BulkOutPipeId)
 	{
 		case EDCA_AC0_PIPE:
@@ -1097,40 +1333,146 @@ VOID DoBulkIn(IN RTMP_ADAPTER *pAd)
 	PURB			pUrb;
 	int				ret = 0;
 	unsigned long	IrqFlags;
+	bool			bHead;
 	
+	/*
+		Keep up to RxUrbTarget bulk-in URBs in flight. Only one caller
+		submits at a time, so the host controller gets the contexts in
+		ring order and they complete in that order too.
+	*/
 	RTMP_IRQ_LOCK(&pAd->BulkInLock, IrqFlags);
-	pRxContext = &(pAd->RxContext[pAd->NextRxBulkInIndex]);
-	if ((pAd->PendingRx > 0) || (pRxContext->Readable == TRUE) || (pRxContext->InUse == TRUE))
+	if (pAd->bRxBulkInSubmit == TRUE)
 	{
 		RTMP_IRQ_UNLOCK(&pAd->BulkInLock, IrqFlags);
 		return;
 	}
-	pRxContext->InUse = TRUE;
-	pRxContext->IRPPending = TRUE;
-	pAd->PendingRx++;
-	pAd->BulkInReq++;
-	RTMP_IRQ_UNLOCK(&pAd->BulkInLock, IrqFlags);
+	pAd->bRxBulkInSubmit = TRUE;
 
-	/* Init Rx context descriptor*/
-	NdisZeroMemory(pRxContext->TransferBuffer, pRxContext->BulkInOffset);
-	RTUSBInitRxDesc(pAd, pRxContext);
+	while (1)
+	{
+		if (pAd->PendingRx == 0)
+			pAd->NextRxBulkInSubmitIndex = pAd->NextRxBulkInIndex;
+		pRxContext = &(pAd->RxContext[pAd->NextRxBulkInSubmitIndex]);
+		if ((pAd->PendingRx >= pAd->RxUrbTarget) || (pRxContext->Readable == TRUE) || (pRxContext->InUse == TRUE))
+			break;
 
-	pUrb = pRxContext->pUrb;
-	if ((ret = RTUSB_SUBMIT_URB(pUrb))!=0)
-	{	/* fail*/
-	
-		RTMP_IRQ_LOCK(&pAd->BulkInLock, IrqFlags);
-		pRxContext->InUse = FALSE;
-		pRxContext->IRPPending = FALSE;
-		pAd->PendingRx--;
-		pAd->BulkInReq--;
+		bHead = (pAd->PendingRx == 0) ? TRUE : FALSE;
+		pRxContext->InUse = TRUE;
+		pRxContext->IRPPending = TRUE;
+		pRxContext->bRxUrbDone = FALSE;
+		pAd->PendingRx++;
+		pAd->BulkInReq++;
 		RTMP_IRQ_UNLOCK(&pAd->BulkInLock, IrqFlags);
-		DBGPRINT(RT_DEBUG_ERROR, ("RTUSBBulkReceive: Submit Rx URB failed %d\n", ret));
+
+#ifdef RX_ZERO_COPY_SUPPORT
+		/*
+			Frames of the last bulk-in may still be referenced by the stack,
+			never let the hardware overwrite them. If no new buffer can be
+			found, the watchdog bulk-in reset retries later.
+		*/
+		if (RTMPRxZcBufRenew(pAd, pRxContext) == FALSE)
+		{
+			RTMP_IRQ_LOCK(&pAd->BulkInLock, IrqFlags);
+			pRxContext->InUse = FALSE;
+			pRxContext->IRPPending = FALSE;
+			pAd->PendingRx--;
+			pAd->BulkInReq--;
+			DBGPRINT(RT_DEBUG_ERROR, ("%s: no memory to renew the Rx buffer\n", __FUNCTION__));
+			break;
+		}
+#endif /* RX_ZERO_COPY_SUPPORT */
+
+		/* Init Rx context descriptor*/
+		NdisZeroMemory(pRxContext->TransferBuffer, pRxContext->BulkInOffset);
+		if (bHead == FALSE)
+			pRxContext->BulkInOffset = 0;
+		RTUSBInitRxDesc(pAd, pRxContext);
+
+		pUrb = pRxContext->pUrb;
+		ret = RTUSB_SUBMIT_URB(pUrb);
+
+		RTMP_IRQ_LOCK(&pAd->BulkInLock, IrqFlags);
+		if (ret != 0)
+		{	/* fail*/
+			pRxContext->InUse = FALSE;
+			pRxContext->IRPPending = FALSE;
+			pAd->PendingRx--;
+			pAd->BulkInReq--;
+			DBGPRINT(RT_DEBUG_ERROR, ("RTUSBBulkReceive: Submit Rx URB failed %d\n", ret));
+			break;
+		}
+
+		/* success*/
+		INC_RING_INDEX(pAd->NextRxBulkInSubmitIndex, RX_RING_SIZE);
 	}
-	else
-	{	/* success*/
-		ASSERT((pRxContext->InUse == pRxContext->IRPPending));
+
+	pAd->bRxBulkInSubmit = FALSE;
+	RTMP_IRQ_UNLOCK(&pAd->BulkInLock, IrqFlags);
+}
+
+
+/*
+	========================================================================
+
+	Routine Description:
+	Account one bulk-in completion in the RX ring histograms and move the
+	number of URBs kept in flight with the fill level of the transfers.
+	Full buffers mean the device had more to send (an AMPDU burst) and
+	another URB keeps the host controller busy, mostly empty ones mean
+	the aggregation timeout expired and one URB is enough.
+
+	Arguments:
+		BulkInLen		bytes received by this URB
+
+	Note:
+		Called with BulkInLock held, before PendingRx is decremented.
+
+	========================================================================
+*/
+VOID RTUSBBulkRxStat(
+	IN RTMP_ADAPTER *pAd,
+	IN unsigned long BulkInLen)
+{
+	unsigned long	RxSize;
+	unsigned int	i, Readable = 0, Fill;
+
+	if (pAd->PendingRx <= RX_RING_SIZE)
+		pAd->RxUrbInFlightHist[pAd->PendingRx]++;
+
+	for (i = 0; i < RX_RING_SIZE; i++)
+	{
+		if (pAd->RxContext[i].Readable == TRUE)
+			Readable++;
+	}
+	pAd->RxRingReadableHist[Readable]++;
+
+	RxSize = (pAd->BulkInMaxPacketSize == 64) ? 4096 : pAd->RxBulkSize;
+	Fill = (unsigned int)((BulkInLen * RX_BULK_FILL_BUCKET) / RxSize);
+	if (Fill >= RX_BULK_FILL_BUCKET)
+		Fill = RX_BULK_FILL_BUCKET - 1;
+	pAd->RxBulkFillHist[Fill]++;
+
+	if (Fill == RX_BULK_FILL_BUCKET - 1)
+		pAd->RxUrbAdaptFull++;
+
+	if (++pAd->RxUrbAdaptCnt < RX_URB_ADAPT_WINDOW)
+		return;
+
+	if ((pAd->RxUrbAdaptFull * 2 >= RX_URB_ADAPT_WINDOW) &&
+		(pAd->RxUrbTarget < pAd->CommonCfg.NumOfBulkInIRP))
+	{
+		pAd->RxUrbTarget++;
+		pAd->RxUrbTargetUp++;
+	}
+	else if ((pAd->RxUrbAdaptFull * 8 < RX_URB_ADAPT_WINDOW) &&
+			(pAd->RxUrbTarget > 1))
+	{
+		pAd->RxUrbTarget--;
+		pAd->RxUrbTargetDown++;
 	}
+
+	pAd->RxUrbAdaptCnt = 0;
+	pAd->RxUrbAdaptFull = 0;
 }
 
 
@@ -1203,8 +1545,10 @@ VOID BulkInCmdRspEvent(RTMP_ADAPTER *pAd)
 VOID	RTUSBBulkReceive(
 	IN	PRTMP_ADAPTER	pAd)
 {
+#ifndef RX_NAPI_SUPPORT
 	PRX_CONTEXT		pRxContext;
 	unsigned long	IrqFlags;
+#endif /* !RX_NAPI_SUPPORT */
 
 
 	/* sanity check */
@@ -1212,6 +1556,21 @@ VOID	RTUSBBulkReceive(
 					&& !RTMP_TEST_FLAG(pAd, fRTMP_ADAPTER_POLL_IDLE))
 		return;
 
+#ifdef RX_NAPI_SUPPORT
+	/*
+		Frames are parsed by the NAPI poll, only hand it the readable
+		buffers and re-arm the bulk-in right away.
+	*/
+	if (RTUSBBulkRxPending(pAd))
+		RtmpOsRxNapiSchedule(pAd);
+#else
+#ifdef DOT11_N_SUPPORT
+#ifdef BA_HRTIMER_SUPPORT
+	/* reorder sessions whose hold timer fired, flushed here to stay in step with the frames */
+	BaReorderTimeoutFlush(pAd);
+#endif /* BA_HRTIMER_SUPPORT */
+#endif /* DOT11_N_SUPPORT */
+
 	while(1)
 	{
 		RTMP_IRQ_LOCK(&pAd->BulkInLock, IrqFlags);
@@ -1245,6 +1604,7 @@ VOID	RTUSBBulkReceive(
 			break;
 		}
 	}
+#endif /* RX_NAPI_SUPPORT */
 
 	if (!((RTMP_TEST_FLAG(pAd, fRTMP_ADAPTER_NEED_STOP_RX) 
 						&& (!RTMP_TEST_FLAG(pAd, fRTMP_ADAPTER_POLL_IDLE)))))
@@ -1255,6 +1615,115 @@ VOID	RTUSBBulkReceive(
 	
 }
 
+
+#ifdef RX_NAPI_SUPPORT
+/*
+	========================================================================
+
+	Routine Description:
+	Check if the bulk-in buffer at the read index is ready to be parsed.
+
+	========================================================================
+*/
+bool RTUSBBulkRxPending(
+	IN RTMP_ADAPTER *pAd)
+{
+	PRX_CONTEXT		pRxContext;
+	unsigned long	IrqFlags;
+	bool			bPending;
+
+	RTMP_IRQ_LOCK(&pAd->BulkInLock, IrqFlags);
+	pRxContext = &(pAd->RxContext[pAd->NextRxBulkInReadIndex]);
+	bPending = ((pRxContext->InUse == FALSE) && (pRxContext->Readable == TRUE));
+	RTMP_IRQ_UNLOCK(&pAd->BulkInLock, IrqFlags);
+
+	return bPending;
+}
+
+
+/*
+	========================================================================
+
+	Routine Description:
+	NAPI poll body. Parse at most Budget frames out of the readable
+	bulk-in buffers. A buffer goes back to DoBulkIn only once it is fully
+	parsed, a partly parsed one is resumed from ReadPosition next poll.
+
+	Return Value:
+		number of frames handed to the stack or dropped
+
+	========================================================================
+*/
+INT RTUSBBulkRxPoll(
+	IN RTMP_ADAPTER *pAd,
+	IN INT Budget)
+{
+	PRX_CONTEXT		pRxContext;
+	unsigned long	IrqFlags;
+	INT				Done = 0;
+
+	if (RTMP_TEST_FLAG(pAd, fRTMP_ADAPTER_NEED_STOP_HANDLE_RX) 
+					&& !RTMP_TEST_FLAG(pAd, fRTMP_ADAPTER_POLL_IDLE))
+		return 0;
+
+	pAd->RxNapiPoll++;
+
+#ifdef DOT11_N_SUPPORT
+#ifdef BA_HRTIMER_SUPPORT
+	/* reorder sessions whose hold timer fired, flushed here to stay in step with the frames */
+	BaReorderTimeoutFlush(pAd);
+#endif /* BA_HRTIMER_SUPPORT */
+#endif /* DOT11_N_SUPPORT */
+
+	while (Done < Budget)
+	{
+		RTMP_IRQ_LOCK(&pAd->BulkInLock, IrqFlags);
+		pRxContext = &(pAd->RxContext[pAd->NextRxBulkInReadIndex]);
+		if ((pRxContext->InUse == TRUE) || (pRxContext->Readable == FALSE) ||
+			(pRxContext->bRxHandling == TRUE))
+		{
+			RTMP_IRQ_UNLOCK(&pAd->BulkInLock, IrqFlags);
+			break;
+		}
+		pRxContext->bRxHandling = TRUE;
+		RTMP_IRQ_UNLOCK(&pAd->BulkInLock, IrqFlags);
+
+		pAd->RxNapiQuota = Budget - Done;
+#ifdef CONFIG_AP_SUPPORT
+		IF_DEV_CONFIG_OPMODE_ON_AP(pAd)
+			APRxDoneInterruptHandle(pAd);
+#endif /* CONFIG_AP_SUPPORT */
+		Done = Budget - pAd->RxNapiQuota;
+
+		RTMP_IRQ_LOCK(&pAd->BulkInLock, IrqFlags);
+		pRxContext->bRxHandling = FALSE;
+		/* quota left means the parser hit the end of this buffer */
+		if (pAd->RxNapiQuota > 0)
+		{
+			pRxContext->BulkInOffset = 0;
+			pRxContext->Readable = FALSE;
+			pAd->ReadPosition = 0;
+			pAd->TransferBufferLength = 0;
+			INC_RING_INDEX(pAd->NextRxBulkInReadIndex, RX_RING_SIZE);
+		}
+		RTMP_IRQ_UNLOCK(&pAd->BulkInLock, IrqFlags);
+	}
+
+	pAd->RxNapiFrames += Done;
+	if (Done >= Budget)
+		pAd->RxNapiBudgetFull++;
+
+	/* the ring may have been full when the last bulk-in completed */
+	if (!((RTMP_TEST_FLAG(pAd, fRTMP_ADAPTER_NEED_STOP_RX) 
+						&& (!RTMP_TEST_FLAG(pAd, fRTMP_ADAPTER_POLL_IDLE)))))
+	{
+		DoBulkIn(pAd);
+	}
+
+	return Done;
+}
+#endif /* RX_NAPI_SUPPORT */
+
 #ifdef RLT_MAC
 VOID RTUSBBulkCmdRspEventReceive(PRTMP_ADAPTER pAd)
 {
@@ -1318,6 +1787,8 @@ USBHST_STATUS RTUSBBulkRxComplete(URBCompleteStatus Status, purbb_t pURB, pregs
 	pAd 		= pRxContext->pAd;
 	pObj 		= (POS_COOKIE) pAd->OS_Cookie;
 
+	/* several URBs may complete before the tasklet runs, it scans for this flag */
+	pRxContext->bRxUrbDone = TRUE;
 	RTMP_NET_TASK_DATA_ASSIGN(&pObj->rx_done_task, (unsigned long)pURB);
 	RTMP_OS_TASKLET_SCHE(&pObj->rx_done_task);
 	
@@ -1640,6 +2111,14 @@ VOID	RTUSBCancelPendingBulkOutIRP(
 			RTMPusecDelay(200);
 		}
 
+#ifdef USB_BULK_OUT_SG_SUPPORT
+		for (i = 0; i < TX_SG_SLOT_NUM; i++)
+		{
+			if (pAd->TxSgSlot[Idx][i].InUse == TRUE)
+				RTUSB_UNLINK_URB(pAd->TxSgSlot[Idx][i].pUrb);
+		}
+#endif /* USB_BULK_OUT_SG_SUPPORT */
+
 #ifdef RALINK_ATE
 		pHTTXContext->bCopySavePad = 0;
 		pHTTXContext->CurWritePosition = 0;
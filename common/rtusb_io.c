@@ -241,7 +241,6 @@ NTSTATUS RTUSBMultiWrite_nBytes(
 	unsigned short index = Offset, actLen = batchLen, leftLen = length;
 	unsigned int *pSrc = pData;
 
-
 	do
 	{
 		actLen = (actLen > batchLen ? batchLen : actLen);
@@ -266,6 +265,10 @@ NTSTATUS RTUSBMultiWrite_nBytes(
 		pSrc = pSrc + actLen;
 	}while(leftLen > 0);
 
+#ifdef REG_DEFER_SUPPORT
+	RegShadowInvalidate(pAd, Offset, length);
+#endif /* REG_DEFER_SUPPORT */
+
 	return Status;
 }
 
@@ -303,6 +306,10 @@ NTSTATUS	RTUSBMultiWrite_OneByte(
 		pData,
 		1);
 
+#ifdef REG_DEFER_SUPPORT
+	RegShadowInvalidate(pAd, Offset, 1);
+#endif /* REG_DEFER_SUPPORT */
+
 	return Status;
 }
 
@@ -353,6 +360,10 @@ NTSTATUS RTUSBSingleWrite(
 		NULL,
 		0);
 
+#ifdef REG_DEFER_SUPPORT
+	RegShadowInvalidate(pAd, Offset, 2);
+#endif /* REG_DEFER_SUPPORT */
+
 	return Status;
 
 }
@@ -380,6 +391,14 @@ NTSTATUS	RTUSBReadMACRegister(
 {
 	NTSTATUS	Status = 0;
 	unsigned int		localVal;
+#ifdef REG_DEFER_SUPPORT
+	unsigned int		ShadowGen;
+
+	if (RegShadowRead(pAd, Offset, pValue))
+		return STATUS_SUCCESS;
+
+	ShadowGen = RegShadowGenGet(pAd);
+#endif /* REG_DEFER_SUPPORT */
 
 	Status = RTUSB_VendorRequest(
 		pAd,
@@ -396,6 +415,10 @@ NTSTATUS	RTUSBReadMACRegister(
 
 	if (Status != 0)
 		*pValue = 0xffffffff;
+#ifdef REG_DEFER_SUPPORT
+	else
+		RegShadowFill(pAd, Offset, *pValue, ShadowGen);
+#endif /* REG_DEFER_SUPPORT */
 
 	return Status;
 }
@@ -425,10 +448,20 @@ NTSTATUS	RTUSBWriteMACRegister(
 	NTSTATUS Status;
 	unsigned int localVal;
 
+#ifdef REG_DEFER_SUPPORT
+	if (!bWriteHigh && RegDeferWrite(pAd, Offset, Value))
+		return STATUS_SUCCESS;
+#endif /* REG_DEFER_SUPPORT */
+
 	localVal = Value;
 	Status = RTUSBSingleWrite(pAd, Offset, (unsigned short)(localVal & 0xffff), bWriteHigh);
 	Status = RTUSBSingleWrite(pAd, Offset + 2, (unsigned short)((localVal & 0xffff0000) >> 16), bWriteHigh);
 
+#ifdef REG_DEFER_SUPPORT
+	if (!bWriteHigh)
+		RegShadowWrite(pAd, Offset, Value);
+#endif /* REG_DEFER_SUPPORT */
+
 	return Status;
 }
 
@@ -939,6 +972,15 @@ NTSTATUS    RTUSB_VendorRequest(
 		int RetryCount = 0; /* RTUSB_CONTROL_MSG retry counts*/
 		ASSERT(TransferBufferLength <MAX_PARAM_BUFFER_SIZE);
 
+#ifdef REG_DEFER_SUPPORT
+		RegDeferSync(pAd);
+#endif /* REG_DEFER_SUPPORT */
+
+#ifdef MCU_ASYNC_CMD_SUPPORT
+		/* the control pipe may overtake commands still queued for the MCU */
+		AndesBatchSync(pAd);
+#endif /* MCU_ASYNC_CMD_SUPPORT */
+
 		RTMP_SEM_EVENT_WAIT(&(pAd->UsbVendorReq_semaphore), RET);
 		if (RET != 0)
 		{
@@ -946,6 +988,11 @@ NTSTATUS    RTUSB_VendorRequest(
 			return NDIS_STATUS_FAILURE;
 		}
 
+#if defined(REG_DEFER_SUPPORT) || defined(BOOT_PROF_SUPPORT)
+		/* counted under the semaphore, every thread does vendor requests */
+		pAd->VendorReqCnt++;
+#endif /* REG_DEFER_SUPPORT || BOOT_PROF_SUPPORT */
+
 		if ((TransferBufferLength > 0) && (RequestType == DEVICE_VENDOR_REQUEST_OUT))
 			NdisMoveMemory(pAd->UsbVendorReqBuf, TransferBuffer, TransferBufferLength);
 
@@ -1207,6 +1254,7 @@ static NTSTATUS ResetBulkInHdlr(IN PRTMP_ADAPTER pAd, IN PCmdQElmt CMDQelmt)
 {
 	unsigned int MACValue;
 	NTSTATUS ntStatus;
+	unsigned char RxIdx;
 
 	DBGPRINT_RAW(RT_DEBUG_TRACE, ("CmdThread : CMDTHREAD_RESET_BULK_IN === >\n"));
 
@@ -1224,6 +1272,10 @@ static NTSTATUS ResetBulkInHdlr(IN PRTMP_ADAPTER pAd, IN PCmdQElmt CMDQelmt)
 			RTUSBCancelPendingBulkInIRP(pAd);
 			RTMPusecDelay(100000);
 			pAd->PendingRx = 0;
+
+			/* completions the tasklet never reached are stale now */
+			for (RxIdx = 0; RxIdx < RX_RING_SIZE; RxIdx++)
+				pAd->RxContext[RxIdx].bRxUrbDone = FALSE;
 		}
 	}
 
@@ -1274,8 +1326,11 @@ static NTSTATUS ResetBulkInHdlr(IN PRTMP_ADAPTER pAd, IN PCmdQElmt CMDQelmt)
 
 			pRxContext->InUse = TRUE;
 			pRxContext->IRPPending = TRUE;
+			pRxContext->bRxUrbDone = FALSE;
 			pAd->PendingRx++;
 			pAd->BulkInReq++;
+			pAd->NextRxBulkInSubmitIndex = pAd->NextRxBulkInIndex;
+			INC_RING_INDEX(pAd->NextRxBulkInSubmitIndex, RX_RING_SIZE);
 			RTMP_IRQ_UNLOCK(&pAd->BulkInLock, IrqFlags);
 
 			/* Init Rx context descriptor*/
@@ -1297,6 +1352,9 @@ static NTSTATUS ResetBulkInHdlr(IN PRTMP_ADAPTER pAd, IN PCmdQElmt CMDQelmt)
 				/*							pAd->PendingRx, pAd->NextRxBulkInIndex, pAd->NextRxBulkInReadIndex));*/
 				DBGPRINT_RAW(RT_DEBUG_TRACE, ("CMDTHREAD_RESET_BULK_IN: Submit Rx URB Done, status=%d!\n", RTMP_USB_URB_STATUS_GET(pUrb)));
 				ASSERT((pRxContext->InUse == pRxContext->IRPPending));
+
+				/* queue the rest of the bulk-in pipeline behind it */
+				DoBulkIn(pAd);
 			}
 		}
 
@@ -1679,6 +1737,29 @@ static NTSTATUS CmdRspEventCallback(IN PRTMP_ADAPTER pAd, IN PCmdQElmt CMDQelmt)
 }
 #endif /* RLT_MAC */
 
+#ifdef HDR_TRANS_SUPPORT
+static NTSTATUS SetHdrTransWcidHdlr(IN PRTMP_ADAPTER pAd, IN PCmdQElmt CMDQelmt)
+{
+	unsigned char Wcid = *((unsigned char *)(CMDQelmt->buffer));
+
+	if (Wcid >= MAX_LEN_OF_MAC_TABLE)
+		return NDIS_STATUS_FAILURE;
+
+	HdrTransRxWcidWrite(pAd, Wcid);
+
+	return NDIS_STATUS_SUCCESS;
+}
+#endif /* HDR_TRANS_SUPPORT */
+
+#ifdef ASSOC_STORM_SUPPORT
+static NTSTATUS FlushWcidTabHdlr(IN PRTMP_ADAPTER pAd, IN PCmdQElmt CMDQelmt)
+{
+	AssocStormWcidFlush(pAd);
+
+	return NDIS_STATUS_SUCCESS;
+}
+#endif /* ASSOC_STORM_SUPPORT */
+
 typedef NTSTATUS (*CMDHdlr)(IN PRTMP_ADAPTER pAd, IN PCmdQElmt CMDQelmt);
 
 static CMDHdlr CMDHdlrTable[] = {
@@ -1778,7 +1859,19 @@ static CMDHdlr CMDHdlrTable[] = {
 
 #ifdef RLT_MAC
 	CmdRspEventCallback, /* CMDTHREAD_RESPONSE_EVENT_CALLBACK */
+#else
+	NULL,
 #endif /* RLT_MAC */
+
+#ifdef HDR_TRANS_SUPPORT
+	SetHdrTransWcidHdlr, /* CMDTHREAD_SET_HDR_TRANS_WCID */
+#else
+	NULL,
+#endif /* HDR_TRANS_SUPPORT */
+
+#ifdef ASSOC_STORM_SUPPORT
+	FlushWcidTabHdlr, /* CMDTHREAD_FLUSH_WCID_TAB */
+#endif /* ASSOC_STORM_SUPPORT */
 };
 
 
@@ -1989,19 +2082,25 @@ VOID RTUSBWatchDog(IN RTMP_ADAPTER *pAd)
 		PBA_REC_ENTRY		pBAEntry = NULL;
 		unsigned char				count = 0;
 		struct reordering_mpdu *mpdu_blk;
+		unsigned int		slot, i;
 
 		Idx = pAd->MacTab.Content[BSSID_WCID].BARecWcidArray[0];
 
 		pBAEntry = &pAd->BATable.BARecEntry[Idx];
-		if((pBAEntry->list.qlen > 0) && (pBAEntry->list.next != NULL))
+		if (pBAEntry->list.qlen > 0)
 		{
 			DBGPRINT(RT_DEBUG_TRACE, ("NICUpdateRawCounters():The Queueing pkt in reordering buffer:\n"));
 			NdisAcquireSpinLock(&pBAEntry->RxReRingLock);
-			mpdu_blk = pBAEntry->list.next;
-			while (mpdu_blk)
+			/* slots in sequence order, starting right after the last indicated one */
+			slot = (pBAEntry->LastIndSeq == RESET_RCV_SEQ) ? 0 : BA_REORDER_SLOT(pBAEntry->LastIndSeq + 1);
+			for (i = 0; (i < BA_REORDER_SLOT_NUM) && (count < pBAEntry->list.qlen); i++)
 			{
+				mpdu_blk = pBAEntry->list.slot[slot];
+				slot = BA_REORDER_SLOT(slot + 1);
+				if (mpdu_blk == NULL)
+					continue;
+
 				DBGPRINT(RT_DEBUG_TRACE, ("\t%d:Seq-%d, bAMSDU-%d!\n", count, mpdu_blk->Sequence, mpdu_blk->bAMSDU));
-				mpdu_blk = mpdu_blk->next;
 				count++;
 			}
 
@@ -4272,6 +4272,9 @@ VOID WscBuildBeaconIE(
 		memcpy(pAd->ApCfg.MBSSID[apidx].WscIEBeacon.Value, &ieHdr, sizeof(WSC_IE_HEADER));
 		memcpy(pAd->ApCfg.MBSSID[apidx].WscIEBeacon.Value + sizeof(WSC_IE_HEADER), Data, Len);
 		pAd->ApCfg.MBSSID[apidx].WscIEBeacon.ValueLen = sizeof(WSC_IE_HEADER) + Len;
+#if defined(BCN_SEG_SUPPORT) || defined(PROBE_CACHE_SUPPORT)
+		APBeaconSegDirty(pAd, apidx, BCN_SEG_WSC);
+#endif /* BCN_SEG_SUPPORT || PROBE_CACHE_SUPPORT */
 	}
 #endif /* CONFIG_AP_SUPPORT */
 
@@ -4498,6 +4501,9 @@ VOID WscBuildProbeRespIE(
 		memcpy(pAd->ApCfg.MBSSID[apidx & 0xF].WscIEProbeResp.Value, &ieHdr, sizeof(WSC_IE_HEADER));
 		memcpy(pAd->ApCfg.MBSSID[apidx & 0xF].WscIEProbeResp.Value + sizeof(WSC_IE_HEADER), Data, Len);
 		pAd->ApCfg.MBSSID[apidx & 0xF].WscIEProbeResp.ValueLen = sizeof(WSC_IE_HEADER) + Len;
+#ifdef PROBE_CACHE_SUPPORT
+		APBeaconSegDirty(pAd, apidx & 0xF, BCN_SEG_WSC);
+#endif /* PROBE_CACHE_SUPPORT */
 	}
 #endif /* CONFIG_AP_SUPPORT */
 
@@ -5282,6 +5288,9 @@ VOID WscInit(
 			{
 				pAd->ApCfg.MBSSID[BssIndex & 0x0F].WscIEBeacon.ValueLen = 0;
 				pAd->ApCfg.MBSSID[BssIndex & 0x0F].WscIEProbeResp.ValueLen = 0;
+#if defined(BCN_SEG_SUPPORT) || defined(PROBE_CACHE_SUPPORT)
+				APBeaconSegDirty(pAd, BssIndex & 0x0F, BCN_SEG_WSC);
+#endif /* BCN_SEG_SUPPORT || PROBE_CACHE_SUPPORT */
 			}
 		}
 	}
@@ -8200,6 +8209,7 @@ static INT wsc_write_dat_file_thread (
 				NdisZeroMemory(pElme, sizeof(MLME_QUEUE_ELEM));
 				RTMP_SEM_LOCK(&pAd->WscElmeLock);
 				NdisMoveMemory(pElme, pAd->pWscElme, sizeof(MLME_QUEUE_ELEM));
+				MLME_ELEM_MSG_INIT(pElme);
 				pAd->pWscElme->MsgLen = 0;
 				NdisZeroMemory(pAd->pWscElme->Msg, MGMT_DMA_BUFFER_SIZE);
 				RTMP_SEM_UNLOCK(&pAd->WscElmeLock);
@@ -8363,6 +8373,10 @@ NDIS_STATUS WscThreadInit(RTMP_ADAPTER *pAd)
 		}
 		NdisAllocateSpinLock(pAd, &pAd->WscElmeLock);
 		os_alloc_mem(NULL, (unsigned char **)&pAd->pWscElme, sizeof(MLME_QUEUE_ELEM));
+#ifdef MLME_LANE_SUPPORT
+		if (pAd->pWscElme != NULL)
+			MLME_ELEM_MSG_INIT(pAd->pWscElme);
+#endif /* MLME_LANE_SUPPORT */
 	}
 	DBGPRINT(RT_DEBUG_TRACE, ("<--WscThreadInit(), status=%d!\n", status));
 
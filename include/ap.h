@@ -187,6 +187,19 @@ VOID  APUpdateBeaconFrame(
     IN  PRTMP_ADAPTER   pAd,
 	IN	INT				apidx);
 
+#if defined(BCN_SEG_SUPPORT) || defined(PROBE_CACHE_SUPPORT)
+VOID APBeaconSegDirty(
+	IN PRTMP_ADAPTER pAd,
+	IN INT apidx,
+	IN unsigned char Seg);
+#endif /* BCN_SEG_SUPPORT || PROBE_CACHE_SUPPORT */
+
+#ifdef BCN_SEG_SUPPORT
+INT Show_BcnSeg_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+#endif /* BCN_SEG_SUPPORT */
+
 VOID APMakeAllBssBeacon(
     IN  PRTMP_ADAPTER   pAd);
 
@@ -219,6 +232,15 @@ VOID APPeerProbeReqAction(
     IN  PRTMP_ADAPTER pAd, 
     IN  MLME_QUEUE_ELEM *Elem);
 
+#ifdef PROBE_CACHE_SUPPORT
+VOID APProbeRspCacheFree(
+	IN PRTMP_ADAPTER pAd);
+
+INT Show_ProbeCache_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+#endif /* PROBE_CACHE_SUPPORT */
+
 VOID APPeerBeaconAction(
     IN PRTMP_ADAPTER pAd, 
     IN MLME_QUEUE_ELEM *Elem);
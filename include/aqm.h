@@ -0,0 +1,76 @@
+#ifndef __AQM_H__
+#define __AQM_H__
+
+#include "rtmp.h"
+
+#define AQM_DEFAULT_TARGET		5000	/* usec */
+#define AQM_DEFAULT_INTERVAL	100000	/* usec */
+#define AQM_DEFAULT_QUANTUM		1514	/* bytes */
+
+/* values of AQM_FLOW.List */
+#define AQM_LIST_NONE			0
+#define AQM_LIST_NEW			1
+#define AQM_LIST_OLD			2
+
+VOID AQMInit(
+	IN PRTMP_ADAPTER pAd);
+
+PQUEUE_ENTRY AQMCoDelDequeue(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char QueIdx,
+	IN PQUEUE_HEADER pQueue,
+	IN PCODEL_VARS pVars,
+	IN unsigned int Now,
+	OUT PQUEUE_HEADER pDropQueue);
+
+PQUEUE_HEADER AQMDequeueBatchLocked(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char QueIdx,
+	OUT PQUEUE_HEADER pBatch,
+	IN bool bClassify,
+	OUT PQUEUE_HEADER pDropQueue);
+
+bool AQMRequeueBatchLocked(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char QueIdx,
+	IN PQUEUE_HEADER pSrcQueue,
+	IN PQUEUE_HEADER pBatch);
+
+PQUEUE_HEADER AQMDequeueBatch(
+	IN PRTMP_ADAPTER pAd,
+	IN bool bIntContext,
+	IN unsigned char QueIdx,
+	OUT PQUEUE_HEADER pBatch);
+
+VOID AQMRequeueBatch(
+	IN PRTMP_ADAPTER pAd,
+	IN bool bIntContext,
+	IN unsigned char QueIdx,
+	IN PQUEUE_HEADER pSrcQueue,
+	IN PQUEUE_HEADER pBatch);
+
+VOID AQMTrim(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char QueIdx,
+	OUT PQUEUE_HEADER pDropQueue);
+
+VOID AQMCleanupAll(
+	IN PRTMP_ADAPTER pAd);
+
+INT Set_AqmEnable_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+
+INT Set_AqmTarget_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+
+INT Set_AqmInterval_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+
+INT Show_AqmStats_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+#endif /* __AQM_H__ */
+
@@ -0,0 +1,54 @@
+#ifndef __ASSOC_STORM_H__
+#define __ASSOC_STORM_H__
+
+#include "rtmp.h"
+
+VOID AssocStormInit(
+	IN PRTMP_ADAPTER pAd);
+
+VOID AssocStormExit(
+	IN PRTMP_ADAPTER pAd);
+
+VOID AssocStormWcidMark(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Wcid,
+	IN MAC_TABLE_ENTRY *pEntry);
+
+VOID AssocStormWcidFlush(
+	IN PRTMP_ADAPTER pAd);
+
+VOID AssocStormWcidSync(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Wcid);
+
+bool AssocStormHsAdmit(
+	IN PRTMP_ADAPTER pAd,
+	IN MAC_TABLE_ENTRY *pEntry);
+
+#ifdef DBG
+VOID AssocStormPeriodic(
+	IN PRTMP_ADAPTER pAd);
+
+VOID AssocStormSimAuth(
+	IN PRTMP_ADAPTER pAd,
+	IN MAC_TABLE_ENTRY *pEntry);
+
+VOID AssocStormSimAssoc(
+	IN PRTMP_ADAPTER pAd,
+	IN MAC_TABLE_ENTRY *pEntry,
+	IN unsigned short StatusCode);
+
+INT Set_AssocStormSim_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+#endif /* DBG */
+
+INT Set_AssocHsMax_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+
+INT Show_AssocStorm_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+#endif /* __ASSOC_STORM_H__ */
+
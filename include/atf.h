@@ -0,0 +1,45 @@
+#ifndef __ATF_H__
+#define __ATF_H__
+
+#include "rtmp.h"
+
+#define ATF_DEFAULT_QUANTUM		1000	/* usec */
+#define ATF_MIN_QUANTUM			100
+#define ATF_MAX_QUANTUM			20000
+
+VOID ATFInit(
+	IN PRTMP_ADAPTER pAd);
+
+PQUEUE_HEADER ATFDequeueBatch(
+	IN PRTMP_ADAPTER pAd,
+	IN bool bIntContext,
+	IN unsigned char QueIdx,
+	OUT PQUEUE_HEADER pBatch);
+
+VOID ATFRequeueBatch(
+	IN PRTMP_ADAPTER pAd,
+	IN bool bIntContext,
+	IN unsigned char QueIdx,
+	IN PQUEUE_HEADER pSrcQueue,
+	IN PQUEUE_HEADER pBatch);
+
+VOID ATFCleanupEntry(
+	IN PRTMP_ADAPTER pAd,
+	IN PMAC_TABLE_ENTRY pEntry);
+
+VOID ATFCleanupAll(
+	IN PRTMP_ADAPTER pAd);
+
+INT Set_AtfEnable_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+
+INT Set_AtfQuantum_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+
+INT Show_AtfStats_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+#endif /* __ATF_H__ */
+
@@ -0,0 +1,27 @@
+#ifndef __BOOT_PROF_H__
+#define __BOOT_PROF_H__
+
+#include "rtmp.h"
+
+VOID BootProfStart(
+	IN PRTMP_ADAPTER pAd);
+
+VOID BootProfMark(
+	IN PRTMP_ADAPTER pAd,
+	IN enum BOOT_PROF_STAGE Stage);
+
+#define BOOT_PROF_STEP_BEGIN(_Begin)	((_Begin) = RtmpOsGetUsecTime())
+
+VOID BootProfStepEnd(
+	IN PRTMP_ADAPTER pAd,
+	IN enum BOOT_PROF_STEP Step,
+	IN unsigned int Begin);
+
+VOID BootProfDebugfsInit(
+	IN PRTMP_ADAPTER pAd);
+
+INT Show_BootProf_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+#endif /* __BOOT_PROF_H__ */
+
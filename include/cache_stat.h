@@ -0,0 +1,17 @@
+#ifndef __CACHE_STAT_H__
+#define __CACHE_STAT_H__
+
+#include "rtmp.h"
+
+VOID CacheMissStatStop(
+	IN PRTMP_ADAPTER pAd);
+
+INT Set_CacheMissStat_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+
+INT Show_CacheMissStat_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+#endif /* __CACHE_STAT_H__ */
+
@@ -631,6 +631,13 @@ NDIS_STATUS MT7601_BBP_read(
 	IN unsigned char regID,
 	IN unsigned char *pValue);
 
+#ifdef PHY_SHADOW_SUPPORT
+NDIS_STATUS MT7601_BBP_read_hw(
+	IN struct _RTMP_ADAPTER *pAd,
+	IN unsigned char regID,
+	IN unsigned char *pValue);
+#endif /* PHY_SHADOW_SUPPORT */
+
 #define RTMP_BBP_IO_READ8_BY_REG_ID(_A, _I, _pV)	MT7601_BBP_read(_A, _I, _pV)
 #define RTMP_BBP_IO_WRITE8_BY_REG_ID(_A, _I, _V)	MT7601_BBP_write(_A, _I, _V)
 #define BBP_IO_WRITE8_BY_REG_ID(_A, _I, _V)			MT7601_BBP_write(_A, _I, _V)
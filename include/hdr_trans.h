@@ -0,0 +1,56 @@
+#ifndef __HDR_TRANS_H__
+#define __HDR_TRANS_H__
+
+#include "rtmp.h"
+
+/* time a data path when HdrTransBench is on, _Begin stays 0 otherwise */
+#define HDR_TRANS_BENCH_BEGIN(_pAd, _Begin)								\
+			do {														\
+				(_Begin) = ((_pAd)->bHdrTransBench ? RtmpOsGetNsec() : 0);	\
+			} while(0)
+
+#define HDR_TRANS_BENCH_END(_pAd, _Dir, _Path, _Begin)					\
+			do {														\
+				if (((_Begin) != 0) && ((_Path) != HDR_TRANS_PATH_NONE))	\
+					HdrTransBenchAdd(_pAd, _Dir, _Path, RtmpOsGetNsec() - (_Begin));	\
+			} while(0)
+
+VOID HdrTransInit(
+	IN PRTMP_ADAPTER pAd);
+
+VOID HdrTransEntrySet(
+	IN PRTMP_ADAPTER pAd,
+	IN PMAC_TABLE_ENTRY pEntry,
+	IN unsigned char Mode);
+
+VOID HdrTransRxWcidWrite(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Wcid);
+
+unsigned char HdrTransTxSelect(
+	IN PRTMP_ADAPTER pAd,
+	IN TX_BLK *pTxBlk);
+
+VOID HdrTransBenchAdd(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Dir,
+	IN unsigned char Path,
+	IN unsigned long long Nsec);
+
+INT Set_HdrTrans_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+
+INT Set_HdrTransSta_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+
+INT Set_HdrTransBench_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+
+INT Show_HdrTrans_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+#endif /* __HDR_TRANS_H__ */
+
@@ -9,6 +9,23 @@ extern unsigned char EpToQueue[6];
 #define MAX_TXBULK_LIMIT			(LOCAL_TXBUF_SIZE*(BULKAGGRE_SIZE-1))
 #define MAX_TXBULK_SIZE			(LOCAL_TXBUF_SIZE*BULKAGGRE_SIZE)
 #define MAX_RXBULK_SIZE			(LOCAL_TXBUF_SIZE*RXBULKAGGRE_SIZE)
+#define RXBULKAGGRE_SIZE_MIN		4	/* bounds of the rx_bulk_agg module parameter */
+#define RXBULKAGGRE_SIZE_MAX		24
+#define RX_URB_NUM_DEFAULT		4	/* max bulk-in URBs in flight, rx_urb_num */
+#define RX_URB_ADAPT_WINDOW		64	/* bulk-in completions per in-flight target update */
+#define RX_BULK_FILL_BUCKET		4	/* bulk-in fill histogram, quarters of the buffer */
+#ifdef RX_ZERO_COPY_SUPPORT
+#define RX_ZC_COPY_BREAK			512	/* frames shorter than this are still copied out */
+#define RX_ZC_SPARE_NUM			8	/* shared bulk-in buffers parked for reuse */
+#endif /* RX_ZERO_COPY_SUPPORT */
+#ifdef RX_NAPI_SUPPORT
+#define RX_NAPI_WEIGHT			64	/* frames parsed per NAPI poll */
+#endif /* RX_NAPI_SUPPORT */
+#ifdef USB_BULK_OUT_SG_SUPPORT
+#define TX_SG_SLOT_NUM			8	/* scatter-gather bulk-outs in flight per pipe */
+#define TX_SG_HDR_SIZE			128	/* TXINFO + TXWI + 802.11 header arena of one slot */
+#define TX_SG_ENTRY_NUM			3	/* header, skb payload, padding + USB DMA tail */
+#endif /* USB_BULK_OUT_SG_SUPPORT */
 #define MAX_MLME_HANDLER_MEMORY 20
 #define CMD_RSP_BULK_SIZE	1024
 
@@ -226,6 +226,46 @@ typedef struct _HT_TX_CONTEXT
 }	HT_TX_CONTEXT, *PHT_TX_CONTEXT, **PPHT_TX_CONTEXT;
 
 
+#ifdef USB_TX_ADAPTIVE_BATCH
+/*
+	Per bulk-out pipe state of the adaptive TX batching. The averages are
+	updated with a 1/8 weight.
+*/
+typedef struct _TX_BATCH_CTRL
+{
+	unsigned int	StagedAvg;		/* bytes written into the ring while a URB was in flight */
+	unsigned int	FrameLenAvg;	/* bytes per frame written into the ring */
+	unsigned int	Budget;			/* last budget handed to RTMPDeQueuePacket() */
+	unsigned long	Holds;			/* frames kept in the software queue for aggregation */
+	unsigned long	UrbCount;
+	unsigned long long	UrbBytes;
+	unsigned long	UrbHist[TX_BATCH_URB_BUCKET];
+}	TX_BATCH_CTRL, *PTX_BATCH_CTRL;
+
+/* what a bulk-out should carry: what arrives during one URB in flight, at least an aggregate */
+#define TX_BATCH_TARGET(_pCtrl)											\
+	(((_pCtrl)->StagedAvg < MAX_AGGREGATION_SIZE) ? MAX_AGGREGATION_SIZE :	\
+	(((_pCtrl)->StagedAvg > TX_BATCH_URB_MAX_SIZE) ? TX_BATCH_URB_MAX_SIZE : (_pCtrl)->StagedAvg))
+#endif /* USB_TX_ADAPTIVE_BATCH */
+
+
+#ifdef USB_BULK_OUT_SG_SUPPORT
+/*
+	One single-frame bulk-out which carries the payload straight from the skb.
+	HdrBuf holds TXINFO + TXWI + 802.11 header followed by 8 zero bytes used
+	for the 4-byte alignment padding and the USB DMA tail.
+*/
+typedef struct _TX_SG_SLOT
+{
+	PURB			pUrb;
+	VOID			*pSgTable;
+	unsigned char	*HdrBuf;
+	PNDIS_PACKET	pPacket;
+	bool			InUse;
+}	TX_SG_SLOT, *PTX_SG_SLOT;
+#endif /* USB_BULK_OUT_SG_SUPPORT */
+
+
 typedef struct _CMD_CONTEXT
 {
 	void * pAd;
@@ -252,9 +292,13 @@ typedef struct _RX_CONTEXT
 	bool				InUse;			/* USB Hardware Occupied. Wait for USB HW to put packet. */
 	bool				Readable;		/* Receive Complete back. OK for driver to indicate receiving packet. */
 	bool				IRPPending;		/* TODO: To be removed */
+	bool				bRxUrbDone;		/* URB completed, waiting for rx_done_tasklet */
 	/*atomic_t				IrpLock; */
 	NDIS_SPIN_LOCK		RxContextLock;
 	ra_dma_addr_t			data_dma;		/* urb dma on linux */
+#ifdef RX_ZERO_COPY_SUPPORT
+	PNDIS_PACKET		pRxBufPkt;		/* packet owning TransferBuffer, frames are clones of it */
+#endif /* RX_ZERO_COPY_SUPPORT */
 }	RX_CONTEXT, *PRX_CONTEXT;
 
 
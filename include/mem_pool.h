@@ -0,0 +1,37 @@
+#ifndef __MEM_POOL_H__
+#define __MEM_POOL_H__
+
+#include "rtmp.h"
+
+#define MEM_POOL_RX_SKB_SIZE	1600	/* RX frames up to this long are copied into pool skbs */
+#define MEM_POOL_RX_SKB_NUM		256
+#define MEM_POOL_MLME_NUM		64		/* MGMT_DMA_BUFFER_SIZE buffers */
+#define MEM_POOL_MCU_CMD_SIZE	512		/* USBKickOutCmd() sends at most that */
+#define MEM_POOL_MCU_CMD_NUM	16
+#define MEM_POOL_MCU_RSP_NUM	16		/* struct CMD_RSP_EVENT */
+
+#define RTMP_AllocateRxPacketBuffer(_pAd, _Len)	RtmpOsSkbPoolAlloc((_pAd)->pRxSkbPool, _Len)
+#define McuCmdBufAlloc(_pAd, _Len)				RtmpOsMemPoolAlloc((_pAd)->pMcuCmdPool, _Len)
+#define McuCmdBufFree(_pAd, _pBuf)				RtmpOsMemPoolFree((_pAd)->pMcuCmdPool, _pBuf)
+#define McuRspEventAlloc(_pAd)					RtmpOsMemPoolAlloc((_pAd)->pMcuRspPool, sizeof(struct CMD_RSP_EVENT))
+#define McuRspEventFree(_pAd, _pEvent)			RtmpOsMemPoolFree((_pAd)->pMcuRspPool, _pEvent)
+
+VOID MemPoolInit(
+	IN PRTMP_ADAPTER pAd);
+
+VOID MemPoolExit(
+	IN PRTMP_ADAPTER pAd);
+
+NDIS_STATUS MlmePoolAllocate(
+	IN PRTMP_ADAPTER pAd,
+	OUT unsigned char **ppVA);
+
+VOID MlmePoolFree(
+	IN PRTMP_ADAPTER pAd,
+	IN VOID *pVA);
+
+INT Show_MemPool_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+#endif /* __MEM_POOL_H__ */
+
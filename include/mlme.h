@@ -121,6 +121,18 @@ extern unsigned int CW_MAX_IN_BITS;
 #define MAX_LEN_OF_MLME_QUEUE            20 /*10 */
 #endif /* CONFIG_AP_SUPPORT */
 
+#ifdef MLME_LANE_SUPPORT
+/* MLME queue lanes, dequeued in this order */
+#define MLME_LANE_CMD				0	/* driver messages, MlmeEnqueue() */
+#define MLME_LANE_CONN				1	/* received auth, assoc, EAPOL and action frames */
+#define MLME_LANE_SCAN				2	/* received ProbeReq, ProbeRsp and beacons */
+#define MLME_LANE_NUM				3
+
+#define MLME_LANE_CMD_MAX			64	/* elements queued per lane at most */
+#define MLME_LANE_CONN_MAX			128
+#define MLME_LANE_SCAN_MAX			32
+#endif /* MLME_LANE_SUPPORT */
+
 
 enum SCAN_MODE{
 	/* Active scan, send probe request, and wait beacon and probe response */
@@ -1221,7 +1233,11 @@ typedef struct {
 
 
 typedef struct _MLME_QUEUE_ELEM {
+#ifdef MLME_LANE_SUPPORT
+	unsigned char             *Msg;		/* into pMsgPkt, or MsgBuf */
+#else
 	unsigned char             Msg[MGMT_DMA_BUFFER_SIZE];	/* move here to fix alignment issue for ARM CPU */
+#endif /* MLME_LANE_SUPPORT */
     unsigned long             Machine;
     unsigned long             MsgType;
     unsigned long             MsgLen;
@@ -1236,14 +1252,45 @@ typedef struct _MLME_QUEUE_ELEM {
     bool           Occupied;
 	unsigned char			  OpMode;
 	unsigned long             Priv;
+#ifdef MLME_LANE_SUPPORT
+	struct _MLME_QUEUE_ELEM   *pNext;
+	PNDIS_PACKET              pMsgPkt;	/* the received frame, released with the element */
+	unsigned long             Lane;
+	unsigned char             MsgBuf[MGMT_DMA_BUFFER_SIZE];	/* last, queued elements end after the message */
+#endif /* MLME_LANE_SUPPORT */
 } MLME_QUEUE_ELEM, *PMLME_QUEUE_ELEM;
 
+#ifdef MLME_LANE_SUPPORT
+#define MLME_ELEM_HDR_LEN			((unsigned long) &((MLME_QUEUE_ELEM *) 0)->MsgBuf)
+
+/* an MLME_QUEUE_ELEM of its own, not from the queue, keeps the message in MsgBuf */
+#define MLME_ELEM_MSG_INIT(_pElem)	((_pElem)->Msg = (_pElem)->MsgBuf)
+
+typedef struct _MLME_LANE {
+	MLME_QUEUE_ELEM  *pHead;
+	MLME_QUEUE_ELEM  *pTail;
+	unsigned long    Num;
+	unsigned long    Max;
+	unsigned long    PeakNum;
+	unsigned long    EnqCnt;
+	unsigned long    DropCnt;
+} MLME_LANE;
+#else
+#define MLME_ELEM_MSG_INIT(_pElem)
+#endif /* MLME_LANE_SUPPORT */
+
 typedef struct _MLME_QUEUE {
     unsigned long             Num;
+#ifdef MLME_LANE_SUPPORT
+    MLME_LANE        Lane[MLME_LANE_NUM];
+#else
     unsigned long             Head;
     unsigned long             Tail;
+#endif /* MLME_LANE_SUPPORT */
     NDIS_SPIN_LOCK   Lock;
+#ifndef MLME_LANE_SUPPORT
     MLME_QUEUE_ELEM  Entry[MAX_LEN_OF_MLME_QUEUE];
+#endif /* !MLME_LANE_SUPPORT */
 } MLME_QUEUE, *PMLME_QUEUE;
 
 typedef VOID (*STATE_MACHINE_FUNC)(VOID *pAd, MLME_QUEUE_ELEM *Elem);
@@ -195,8 +195,13 @@ typedef char			* PNDIS_BUFFER;
 #define NdisEqualMemory(Source1, Source2, Length)   (!memcmp(Source1, Source2, Length))
 #define RTMPEqualMemory(Source1, Source2, Length)	(!memcmp(Source1, Source2, Length))
 
+#ifdef MEM_POOL_SUPPORT
+#define MlmeAllocateMemory(_pAd, _ppVA)			MlmePoolAllocate(_pAd, _ppVA)
+#define MlmeFreeMemory(_pAd, _pVA)			MlmePoolFree(_pAd, _pVA)
+#else
 #define MlmeAllocateMemory(_pAd, _ppVA)			os_alloc_mem(_pAd, _ppVA, MGMT_DMA_BUFFER_SIZE)
 #define MlmeFreeMemory(_pAd, _pVA)			os_free_mem(_pAd, _pVA)
+#endif /* MEM_POOL_SUPPORT */
 
 #define COPY_MAC_ADDR(Addr1, Addr2)             	memcpy((Addr1), (Addr2), MAC_ADDR_LEN)
 
@@ -839,6 +844,20 @@ extern unsigned long RtmpOsGetUnalignedlong(
 #define RTMP_SET_PACKET_NOBULKOUT(_p, _morebit)			(PACKET_CB(_p, 28) = _morebit)
 #define RTMP_GET_PACKET_NOBULKOUT(_p)					(PACKET_CB(_p, 28))
 #endif /* INF_AMAZON_SE */
+/* [CB_OFF+32], 4B, usec time the packet was put on TxSwQueue, for the AQM sojourn time */
+#define RTMP_SET_PACKET_ENQ_TIME(_p, _time) {\
+	(PACKET_CB(_p, 32) = (unsigned char)((_time) & 0xff)); \
+	(PACKET_CB(_p, 33) = (unsigned char)(((_time) >> 8) & 0xff)); \
+	(PACKET_CB(_p, 34) = (unsigned char)(((_time) >> 16) & 0xff)); \
+	(PACKET_CB(_p, 35) = (unsigned char)(((_time) >> 24) & 0xff)); \
+}
+
+#define RTMP_GET_PACKET_ENQ_TIME(_p) \
+	(((unsigned int)PACKET_CB(_p, 32)) \
+	| (((unsigned int)PACKET_CB(_p, 33)) << 8) \
+	| (((unsigned int)PACKET_CB(_p, 34)) << 16) \
+	| (((unsigned int)PACKET_CB(_p, 35)) << 24))
+
 /* Max skb->cb = 48B = [CB_OFF+38] */
 
 
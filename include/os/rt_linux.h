@@ -36,6 +36,14 @@
 #include <linux/if_arp.h>
 #include <linux/ctype.h>
 #include <linux/vmalloc.h>
+#include <linux/percpu.h>
+#include <linux/workqueue.h>
+#include <linux/timex.h>
+#include <linux/hrtimer.h>
+#include <linux/perf_event.h>
+#include <linux/rcupdate.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
 #ifdef RTMP_USB_SUPPORT
 #include <linux/usb.h>
 #endif /* RTMP_USB_SUPPORT */
@@ -440,8 +448,13 @@ do {													\
 #define NdisEqualMemory(Source1, Source2, Length)	(!memcmp(Source1, Source2, Length))
 #define RTMPEqualMemory(Source1, Source2, Length)	(!memcmp(Source1, Source2, Length))
 
+#ifdef MEM_POOL_SUPPORT
+#define MlmeAllocateMemory(_pAd, _ppVA)			MlmePoolAllocate(_pAd, _ppVA)
+#define MlmeFreeMemory(_pAd, _pVA)			MlmePoolFree(_pAd, _pVA)
+#else
 #define MlmeAllocateMemory(_pAd, _ppVA)			os_alloc_mem(_pAd, _ppVA, MGMT_DMA_BUFFER_SIZE)
 #define MlmeFreeMemory(_pAd, _pVA)			os_free_mem(_pAd, _pVA)
+#endif /* MEM_POOL_SUPPORT */
 
 #define COPY_MAC_ADDR(Addr1, Addr2)			memcpy((Addr1), (Addr2), MAC_ADDR_LEN)
 
@@ -506,6 +519,20 @@ typedef void (*TIMER_FUNCTION)(unsigned long);
 typedef void (*TIMER_FUNCTION)(struct timer_list *unused);
 #endif
 
+/* high resolution one shot timer, pFunc is called in hard irq context */
+typedef struct _OS_HRTIMER {
+	struct hrtimer Timer;
+	VOID (*pFunc)(VOID *pData);
+	VOID *pData;
+} OS_HRTIMER;
+
+/* callback run after an RCU grace period, pFunc is called in softirq context */
+typedef struct _OS_RCU_HEAD {
+	struct rcu_head Head;
+	VOID (*pFunc)(VOID *pData);
+	VOID *pData;
+} OS_RCU_HEAD;
+
 
 #define OS_WAIT(_time)									\
 {											\
@@ -572,6 +599,11 @@ struct os_cookie {
 #endif /* WORKQUEUE_BH */
 
 	RTMP_NET_TASK_STRUCT rx_done_task;
+#ifdef RX_NAPI_SUPPORT
+	struct napi_struct	rx_napi;
+	VOID				*rx_napi_pAd;
+	INT					rx_napi_cpu;	/* cpu running the poll, -1 if none */
+#endif /* RX_NAPI_SUPPORT */
 	RTMP_NET_TASK_STRUCT cmd_rsp_event_task;
 	RTMP_NET_TASK_STRUCT mgmt_dma_done_task;
 	RTMP_NET_TASK_STRUCT ac0_dma_done_task;
@@ -635,6 +667,12 @@ struct os_cookie {
 
 typedef struct os_cookie	* POS_COOKIE;
 
+#ifdef RX_NAPI_SUPPORT
+/* softirqs do not nest, so this only matches inside our own poll */
+#define RTMP_OS_RX_NAPI_IN_POLL(__pObj)	\
+	(in_serving_softirq() && ((__pObj)->rx_napi_cpu == raw_smp_processor_id()))
+#endif /* RX_NAPI_SUPPORT */
+
 
 
 /***********************************************************************************
@@ -1150,6 +1188,20 @@ void linux_pci_unmap_single(void *handle, ra_dma_addr_t dma_addr, size_t size, i
 #endif /* defined(CONFIG_CSO_SUPPORT) || defined(CONFIG_RX_CSO_SUPPORT) */
 
 
+/* [CB_OFF+32], 4B, usec time the packet was put on TxSwQueue, for the AQM sojourn time */
+#define RTMP_SET_PACKET_ENQ_TIME(_p, _time) {\
+	(RTPKT_TO_OSPKT(_p)->cb[CB_OFF+32] = (unsigned char)((_time) & 0xff)); \
+	(RTPKT_TO_OSPKT(_p)->cb[CB_OFF+33] = (unsigned char)(((_time) >> 8) & 0xff)); \
+	(RTPKT_TO_OSPKT(_p)->cb[CB_OFF+34] = (unsigned char)(((_time) >> 16) & 0xff)); \
+	(RTPKT_TO_OSPKT(_p)->cb[CB_OFF+35] = (unsigned char)(((_time) >> 24) & 0xff)); \
+}
+
+#define RTMP_GET_PACKET_ENQ_TIME(_p) \
+	(((unsigned int)RTPKT_TO_OSPKT(_p)->cb[CB_OFF+32]) \
+	| (((unsigned int)RTPKT_TO_OSPKT(_p)->cb[CB_OFF+33]) << 8) \
+	| (((unsigned int)RTPKT_TO_OSPKT(_p)->cb[CB_OFF+34]) << 16) \
+	| (((unsigned int)RTPKT_TO_OSPKT(_p)->cb[CB_OFF+35]) << 24))
+
 /* Max skb->cb = 48B = [CB_OFF+38] */
 
 
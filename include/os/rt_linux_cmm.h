@@ -144,6 +144,24 @@ RTMP_DECLARE_DRV_OPS_FUNCTION(usb);
 /* rt_linux.h */
 #define NDIS_MINIPORT_TIMER			OS_NDIS_MINIPORT_TIMER
 #define RTMP_OS_TIMER				OS_TIMER
+#define RTMP_OS_HRTIMER				OS_HRTIMER
+#define RTMP_OS_RCU_HEAD			OS_RCU_HEAD
+
+/*
+	RCU readers. Bottom halves disabled (RX tasklet, TX path) also counts
+	as a read-side section. No sleeping in between.
+*/
+#define RTMP_OS_RCU_READ_LOCK()		rcu_read_lock()
+#define RTMP_OS_RCU_READ_UNLOCK()	rcu_read_unlock()
+
+/* publish and read pointers shared with lockless readers */
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(3,19,0)
+#define RTMP_OS_RCU_ASSIGN(__Var, __Val)	smp_store_release(&(__Var), (__Val))
+#define RTMP_OS_RCU_DEREF(__Var)			READ_ONCE(__Var)
+#else
+#define RTMP_OS_RCU_ASSIGN(__Var, __Val)	do { smp_wmb(); (__Var) = (__Val); } while (0)
+#define RTMP_OS_RCU_DEREF(__Var)			ACCESS_ONCE(__Var)
+#endif
 
 #define RTMP_OS_FREE_TIMER(__pAd)
 #define RTMP_OS_FREE_LOCK(__pAd)
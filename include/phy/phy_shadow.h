@@ -0,0 +1,102 @@
+#ifndef __PHY_SHADOW_H__
+#define __PHY_SHADOW_H__
+
+#include "rtmp.h"
+
+VOID PhyShadowInit(
+	IN PRTMP_ADAPTER pAd);
+
+VOID PhyShadowExit(
+	IN PRTMP_ADAPTER pAd);
+
+VOID PhyShadowDebugfsInit(
+	IN PRTMP_ADAPTER pAd);
+
+VOID PhyShadowReset(
+	IN PRTMP_ADAPTER pAd);
+
+unsigned int PhyShadowGenGet(
+	IN PRTMP_ADAPTER pAd);
+
+bool PhyShadowBbpRead(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Id,
+	OUT unsigned char *pValue);
+
+VOID PhyShadowBbpFill(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Id,
+	IN unsigned char Value,
+	IN unsigned int Gen);
+
+bool PhyShadowBbpSkip(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Id,
+	IN unsigned char Value);
+
+VOID PhyShadowBbpUpdate(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Id,
+	IN unsigned char Value);
+
+VOID PhyShadowBbpInvalidate(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Id);
+
+NDIS_STATUS PhyShadowBbpModify(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Id,
+	IN unsigned char Mask,
+	IN unsigned char Bits);
+
+#ifdef RLT_RF
+bool PhyShadowRfRead(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Bank,
+	IN unsigned char Id,
+	OUT unsigned char *pValue);
+
+VOID PhyShadowRfFill(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Bank,
+	IN unsigned char Id,
+	IN unsigned char Value,
+	IN unsigned int Gen);
+
+bool PhyShadowRfSkip(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Bank,
+	IN unsigned char Id,
+	IN unsigned char Value);
+
+VOID PhyShadowRfUpdate(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Bank,
+	IN unsigned char Id,
+	IN unsigned char Value);
+
+VOID PhyShadowRfInvalidate(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Bank,
+	IN unsigned char Id);
+
+NDIS_STATUS PhyShadowRfModify(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Bank,
+	IN unsigned char Id,
+	IN unsigned char Mask,
+	IN unsigned char Bits);
+#endif /* RLT_RF */
+
+VOID PhyShadowCommit(
+	IN PRTMP_ADAPTER pAd);
+
+INT Set_PhyShadow_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+
+INT Show_PhyShadow_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+#endif /* __PHY_SHADOW_H__ */
+
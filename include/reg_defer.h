@@ -0,0 +1,61 @@
+#ifndef __REG_DEFER_H__
+#define __REG_DEFER_H__
+
+#include "rtmp.h"
+
+VOID RegDeferInit(
+	IN PRTMP_ADAPTER pAd);
+
+VOID RegDeferExit(
+	IN PRTMP_ADAPTER pAd);
+
+VOID RegDeferBegin(
+	IN PRTMP_ADAPTER pAd);
+
+VOID RegDeferEnd(
+	IN PRTMP_ADAPTER pAd);
+
+VOID RegDeferSync(
+	IN PRTMP_ADAPTER pAd);
+
+bool RegDeferWrite(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned short Offset,
+	IN unsigned int Value);
+
+bool RegShadowRead(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned short Offset,
+	OUT unsigned int *pValue);
+
+VOID RegShadowWrite(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned int Offset,
+	IN unsigned int Value);
+
+unsigned int RegShadowGenGet(
+	IN PRTMP_ADAPTER pAd);
+
+VOID RegShadowFill(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned short Offset,
+	IN unsigned int Value,
+	IN unsigned int Gen);
+
+VOID RegShadowInvalidate(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned int Offset,
+	IN unsigned int Len);
+
+VOID RegShadowReset(
+	IN PRTMP_ADAPTER pAd);
+
+INT Set_RegDefer_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+
+INT Show_RegDefer_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+#endif /* __REG_DEFER_H__ */
+
@@ -117,6 +117,42 @@
 #include "netif_block.h"
 #endif /* BLOCK_NET_IF */
 
+#ifdef AIRTIME_FAIRNESS_SUPPORT
+#include "atf.h"
+#endif /* AIRTIME_FAIRNESS_SUPPORT */
+
+#ifdef TX_AQM_SUPPORT
+#include "aqm.h"
+#endif /* TX_AQM_SUPPORT */
+
+#ifdef MEM_POOL_SUPPORT
+#include "mem_pool.h"
+#endif /* MEM_POOL_SUPPORT */
+
+#ifdef HDR_TRANS_SUPPORT
+#include "hdr_trans.h"
+#endif /* HDR_TRANS_SUPPORT */
+
+#ifdef CACHE_MISS_STAT_SUPPORT
+#include "cache_stat.h"
+#endif /* CACHE_MISS_STAT_SUPPORT */
+
+#ifdef REG_DEFER_SUPPORT
+#include "reg_defer.h"
+#endif /* REG_DEFER_SUPPORT */
+
+#ifdef PHY_SHADOW_SUPPORT
+#include "phy/phy_shadow.h"
+#endif /* PHY_SHADOW_SUPPORT */
+
+#ifdef BOOT_PROF_SUPPORT
+#include "boot_prof.h"
+#endif /* BOOT_PROF_SUPPORT */
+
+#ifdef ASSOC_STORM_SUPPORT
+#include "assoc_storm.h"
+#endif /* ASSOC_STORM_SUPPORT */
+
 #ifdef IGMP_SNOOP_SUPPORT
 #include "igmp_snoop.h"
 #endif /* IGMP_SNOOP_SUPPORT */
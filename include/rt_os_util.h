@@ -52,6 +52,64 @@ unsigned int RtmpOsTimerBefore(
 VOID RtmpOsGetSystemUpTime(
 	IN	unsigned long					*pTime);
 
+unsigned int RtmpOsGetUsecTime(VOID);
+
+unsigned long long RtmpOsGetNsec(VOID);
+
+VOID *RtmpOsCurrentTask(VOID);
+
+VOID *RtmpOsCacheMissStart(VOID);
+
+unsigned long long RtmpOsCacheMissRead(
+	IN	VOID							*pHandle);
+
+VOID RtmpOsCacheMissStop(
+	IN	VOID							*pHandle);
+
+VOID *RtmpOsDebugfsDirCreate(
+	IN	char							*pName);
+
+bool RtmpOsDebugfsFileCreate(
+	IN	VOID							*pHandle,
+	IN	char							*pName,
+	IN	INT								(*pShow)(VOID *pSeq, VOID *pData),
+	IN	VOID							*pData);
+
+VOID RtmpOsDebugfsRemove(
+	IN	VOID							*pHandle);
+
+VOID RtmpOsSeqPrintf(
+	IN	VOID							*pSeq,
+	IN	const char						*pFmt,
+	...);
+
+#ifndef OS_ABL_FUNC_SUPPORT
+VOID RtmpOsHrTimerInit(
+	IN	RTMP_OS_HRTIMER					*pTimer,
+	IN	VOID							(*pFunc)(VOID *pData),
+	IN	VOID							*pData);
+
+VOID RtmpOsHrTimerStart(
+	IN	RTMP_OS_HRTIMER					*pTimer,
+	IN	unsigned int					Usec);
+
+bool RtmpOsHrTimerPending(
+	IN	RTMP_OS_HRTIMER					*pTimer);
+
+VOID RtmpOsHrTimerCancel(
+	IN	RTMP_OS_HRTIMER					*pTimer);
+
+VOID RtmpOsHrTimerTryCancel(
+	IN	RTMP_OS_HRTIMER					*pTimer);
+
+VOID RtmpOsCallRcu(
+	IN	RTMP_OS_RCU_HEAD				*pHead,
+	IN	VOID							(*pFunc)(VOID *pData),
+	IN	VOID							*pData);
+
+VOID RtmpOsRcuBarrier(VOID);
+#endif /* OS_ABL_FUNC_SUPPORT */
+
 unsigned int RtmpOsTickUnitGet(VOID);
 
 /* OS Memory */
@@ -103,6 +161,47 @@ PNDIS_PACKET RTMP_AllocateFragPacketBuffer(
 	IN	VOID					*pReserved,
 	IN	unsigned long					Length);
 
+#ifdef MEM_POOL_SUPPORT
+typedef struct _RTMP_OS_POOL_STATS {
+	char Name[16];
+	unsigned int ObjSize;
+	unsigned int ObjNum;
+	unsigned int Free;			/* objects held by the pool */
+	unsigned int InUse;			/* pool objects handed out and not freed yet */
+	unsigned int HighWater;		/* most pool objects ever out at once */
+	unsigned long Alloc;		/* requests which fit the pool */
+	unsigned long Hit;			/* served by the pool */
+	unsigned long Fallback;		/* served by the general allocator */
+	unsigned long Fail;			/* the general allocator failed too */
+	unsigned long Refill;		/* skbs allocated by the refill work */
+} RTMP_OS_POOL_STATS;
+
+VOID *RtmpOsPoolCreate(
+	IN	const char				*pName,
+	IN	unsigned int			ObjSize,
+	IN	unsigned int			ObjNum,
+	IN	bool					bSkb);
+
+VOID RtmpOsPoolDestroy(
+	IN	VOID					*pPool);
+
+VOID *RtmpOsMemPoolAlloc(
+	IN	VOID					*pPool,
+	IN	unsigned long			Size);
+
+VOID RtmpOsMemPoolFree(
+	IN	VOID					*pPool,
+	IN	VOID					*pMem);
+
+PNDIS_PACKET RtmpOsSkbPoolAlloc(
+	IN	VOID					*pPool,
+	IN	unsigned long			Length);
+
+VOID RtmpOsPoolStatsGet(
+	IN	VOID					*pPool,
+	OUT	RTMP_OS_POOL_STATS		*pStats);
+#endif /* MEM_POOL_SUPPORT */
+
 NDIS_STATUS RTMPAllocateNdisPacket(
 	IN	VOID					*pReserved,
 	OUT PNDIS_PACKET			*ppPacket,
@@ -278,6 +377,12 @@ VOID RtmpOsPktInfPpaSend(
 VOID RtmpOsPktRcvHandle(
 	IN	PNDIS_PACKET			pNetPkt);
 
+#ifdef RX_NAPI_SUPPORT
+VOID RtmpOsPktNapiRcvHandle(
+	IN	VOID					*pNapi,
+	IN	PNDIS_PACKET			pNetPkt);
+#endif /* RX_NAPI_SUPPORT */
+
 VOID RtmpOsPktNatMagicTag(
 	IN	PNDIS_PACKET			pNetPkt);
 
@@ -860,6 +965,28 @@ NTSTATUS RtmpOsUsbStatusGet(
 
 VOID RtmpOsUsbDmaMapping(
 	IN	VOID			*pUrb);
+
+#ifdef USB_BULK_OUT_SG_SUPPORT
+bool RtmpOsUsbSgSupport(
+	IN	VOID			*pUsb_Dev);
+
+VOID *RtmpOsUsbSgTableAlloc(
+	IN	unsigned int	NumSg);
+
+VOID RtmpOsUsbSgTableFree(
+	IN	VOID			*pSgTable);
+
+VOID RtmpOsUsbInitSgTxDesc(
+	IN	VOID			*pUrbSrc,
+	IN	VOID			*pUsb_Dev,
+	IN	unsigned int			BulkOutEpAddr,
+	IN	VOID			*pSgTable,
+	IN	unsigned char	**ppBuf,
+	IN	unsigned int	*pLen,
+	IN	unsigned int	NumSg,
+	IN	USB_COMPLETE_HANDLER	Func,
+	IN	VOID			*pTxContext);
+#endif /* USB_BULK_OUT_SG_SUPPORT */
 #endif /* RTMP_MAC_USB */
 
 #if defined(RTMP_RBUS_SUPPORT) || defined(RTMP_FLASH_SUPPORT)
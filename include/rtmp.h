@@ -270,8 +270,20 @@ typedef struct _RSSI_SAMPLE {
 	(QueueHeader)->Number++;                                    \
 }
 
+#ifdef TX_AQM_SUPPORT
+/* remember when a frame was put on TxSwQueue, CoDel works on the time it waited */
+#define AQM_STAMP_PACKET(QueueEntry)									\
+{																		\
+	unsigned int _EnqTime = RtmpOsGetUsecTime();						\
+	RTMP_SET_PACKET_ENQ_TIME(QUEUE_ENTRY_TO_PACKET(QueueEntry), _EnqTime);	\
+}
+#else
+#define AQM_STAMP_PACKET(QueueEntry)
+#endif /* TX_AQM_SUPPORT */
+
 #define InsertTailQueueAc(pAd, pEntry, QueueHeader, QueueEntry)			\
 {																		\
+	AQM_STAMP_PACKET(QueueEntry);										\
 	((PQUEUE_ENTRY)QueueEntry)->Next = NULL;							\
 	if ((QueueHeader)->Tail)											\
 		(QueueHeader)->Tail->Next = (PQUEUE_ENTRY)(QueueEntry);			\
@@ -280,6 +292,62 @@ typedef struct _RSSI_SAMPLE {
 	(QueueHeader)->Tail = (PQUEUE_ENTRY)(QueueEntry);					\
 	(QueueHeader)->Number++;											\
 }
+/* Move up to Max entries from the head of QueueHeader into the empty BatchHeader */
+#define DequeueHeadBatch(QueueHeader, BatchHeader, Max)		\
+{																\
+	PQUEUE_ENTRY _pLast = (QueueHeader)->Head;					\
+	unsigned int _Num = 1;										\
+	InitializeQueueHeader(BatchHeader);							\
+	if (_pLast != NULL)											\
+	{															\
+		while ((_Num < (Max)) && (_pLast->Next != NULL))		\
+		{														\
+			_pLast = _pLast->Next;								\
+			_Num++;												\
+		}														\
+		(BatchHeader)->Head = (QueueHeader)->Head;				\
+		(BatchHeader)->Tail = _pLast;							\
+		(BatchHeader)->Number = _Num;							\
+		(QueueHeader)->Head = _pLast->Next;						\
+		if ((QueueHeader)->Head == NULL)						\
+			(QueueHeader)->Tail = NULL;							\
+		(QueueHeader)->Number -= _Num;							\
+		_pLast->Next = NULL;									\
+	}															\
+}
+
+/* Put what is left of BatchHeader back in front of QueueHeader, keeping the order */
+#define RequeueHeadBatch(QueueHeader, BatchHeader)				\
+{																\
+	if ((BatchHeader)->Head != NULL)							\
+	{															\
+		(BatchHeader)->Tail->Next = (QueueHeader)->Head;		\
+		(QueueHeader)->Head = (BatchHeader)->Head;				\
+		if ((QueueHeader)->Tail == NULL)						\
+			(QueueHeader)->Tail = (BatchHeader)->Tail;			\
+		(QueueHeader)->Number += (BatchHeader)->Number;			\
+		InitializeQueueHeader(BatchHeader);						\
+	}															\
+}
+
+/*
+	frames waiting to be sent for an AC: TxSwQueue, the dequeue batch and
+	what the airtime scheduler and AQM hold. This is what TxSwQMaxLen limits.
+*/
+#ifdef AIRTIME_FAIRNESS_SUPPORT
+#define TX_SWQ_ATF_PENDING(_pAd, _QueIdx)	((_pAd)->AtfQueued[_QueIdx])
+#else
+#define TX_SWQ_ATF_PENDING(_pAd, _QueIdx)	0
+#endif /* AIRTIME_FAIRNESS_SUPPORT */
+#ifdef TX_AQM_SUPPORT
+#define TX_SWQ_AQM_PENDING(_pAd, _QueIdx)	((_pAd)->AqmQueued[_QueIdx])
+#else
+#define TX_SWQ_AQM_PENDING(_pAd, _QueIdx)	0
+#endif /* TX_AQM_SUPPORT */
+#define TX_SWQ_PENDING(_pAd, _QueIdx)	\
+	((_pAd)->TxSwQueue[_QueIdx].Number + (_pAd)->TxSwQBatch[_QueIdx] +	\
+	 TX_SWQ_ATF_PENDING(_pAd, _QueIdx) + TX_SWQ_AQM_PENDING(_pAd, _QueIdx))
+
 void DisplayTxAgg (RTMP_ADAPTER *pAd);
 
 
@@ -509,6 +577,12 @@ typedef struct _RTMP_SCATTER_GATHER_LIST {
     unsigned int High32TSF=0, Low32TSF=0;                                                          \
     MlmeEnqueueForRecv(_pAd, Wcid, High32TSF, Low32TSF, (unsigned char)_Rssi0, (unsigned char)_Rssi1,(unsigned char)_Rssi2 ,_AntSel, _FrameSize, _pFrame, (unsigned char)_MinSNR, _OpMode);   \
 }
+
+#ifdef MLME_LANE_SUPPORT
+/* the frame stays in _pPkt, TRUE when queued and the MLME queue releases _pPkt */
+#define REPORT_MGMT_PKT_TO_MLME(_pAd, Wcid, _pFrame, _FrameSize, _Rssi0, _Rssi1, _Rssi2, _MinSNR, _AntSel, _OpMode, _pPkt)        \
+    MlmeEnqueueForRecvPkt(_pAd, Wcid, 0, 0, (unsigned char)_Rssi0, (unsigned char)_Rssi1,(unsigned char)_Rssi2 ,_AntSel, _FrameSize, _pFrame, (unsigned char)_MinSNR, _OpMode, _pPkt)
+#endif /* MLME_LANE_SUPPORT */
 #endif /* RTMP_MAC_USB */
 
 #define MAC_ADDR_EQUAL(pAddr1,pAddr2)           RTMPEqualMemory((void *)(pAddr1), (void *)(pAddr2), MAC_ADDR_LEN)
@@ -1037,14 +1111,38 @@ typedef struct _MLME_STRUCT {
   *	802.11 N related data structures
   **************************************************************************/
 struct reordering_mpdu {
-	struct reordering_mpdu *next;
+	struct reordering_mpdu *next;	/* only used on the free list */
 	PNDIS_PACKET pPacket;	/* coverted to 802.3 frame */
 	int Sequence;		/* sequence number of MPDU */
 	bool bAMSDU;
 	unsigned char					OpMode;
+#ifdef BA_HRTIMER_SUPPORT
+	unsigned int RxTime;	/* usec, when it was buffered */
+#endif /* BA_HRTIMER_SUPPORT */
 };
 
+/*
+	Reordering buffer of one BA session. An MPDU sits in the slot given by
+	its sequence number, so insert and duplicate checks take one lookup.
+	The slot count is a power of two that divides the 4096 sequence
+	numbers and covers the largest RxBAWinLimit, so the BAWinSize frames
+	after LastIndSeq never share a slot.
+*/
+#define BA_REORDER_SLOT_NUM		64
+#define BA_REORDER_SLOT(_Seq)	((_Seq) & (BA_REORDER_SLOT_NUM - 1))
+
+#ifdef BA_HRTIMER_SUPPORT
+#define BA_REORDER_TIMEOUT_DEFAULT	100000	/* usec a buffered frame waits for the hole before it */
+#define BA_HOLD_BUCKET			12	/* bucket i counts hold times below (256 << i) usec */
+#endif /* BA_HRTIMER_SUPPORT */
+
 struct reordering_list {
+	struct reordering_mpdu *slot[BA_REORDER_SLOT_NUM];
+	unsigned int bitmap[BA_REORDER_SLOT_NUM / 32];	/* occupied slots */
+	int qlen;
+};
+
+struct reordering_freelist {
 	struct reordering_mpdu *next;
 	int qlen;
 };
@@ -1052,7 +1150,7 @@ struct reordering_list {
 struct reordering_mpdu_pool {
 	void * mem;
 	NDIS_SPIN_LOCK lock;
-	struct reordering_list freelist;
+	struct reordering_freelist freelist;
 };
 
 typedef enum _REC_BLOCKACK_STATUS {
@@ -1103,6 +1201,9 @@ typedef struct _BA_REC_ENTRY {
 /*	struct _BA_REC_ENTRY *pNext; */
 	void * pAdapter;
 	struct reordering_list list;
+#ifdef BA_HRTIMER_SUPPORT
+	RTMP_OS_HRTIMER FlushTimer;	/* due when the oldest buffered frame times out */
+#endif /* BA_HRTIMER_SUPPORT */
 } BA_REC_ENTRY, *PBA_REC_ENTRY;
 
 
@@ -1307,6 +1408,11 @@ typedef struct _BEACON_SYNC_STRUCT_ {
 	bool EnableBeacon;	/* trigger to enable beacon transmission. */
 	unsigned char BeaconBitMap;	/* NOTE: If the MAX_MBSSID_NUM is larger than 8, this parameter need to change. */
 	unsigned char DtimBitOn;	/* NOTE: If the MAX_MBSSID_NUM is larger than 8, this parameter need to change. */
+#ifdef BCN_BURST_SUPPORT
+	unsigned long UpdateCnt;
+	unsigned long UsbXferCnt;	/* MCU commands, or vendor requests without them */
+	unsigned long WriteBytes;
+#endif /* BCN_BURST_SUPPORT */
 } BEACON_SYNC_STRUCT;
 #endif /* RTMP_MAC_USB */
 
@@ -1324,6 +1430,36 @@ typedef struct _BEACON_SYNC_STRUCT_ {
 #define WLAN_MR_TIM_BCMC_SET(apidx) \
 	pAd->ApCfg.MBSSID[apidx].TimBitmaps[WLAN_CT_TIM_BCMC_OFFSET] |= NUM_BIT8[0];
 
+#ifdef BCN_SEG_SUPPORT
+/*
+	TimLo/TimHi bound the TIM bytes with a station bit set, TimLo is
+	WLAN_MAX_NUM_OF_TIM while there is none. Setting a bit widens them,
+	clearing the last bit of a boundary byte has APUpdateBeaconFrame()
+	rescan the bitmap once.
+*/
+/* clear a station PS TIM bit */
+#define WLAN_MR_TIM_BIT_CLEAR(ad_p, apidx, wcid) \
+	{	unsigned char tim_offset = wcid >> 3; \
+		unsigned char bit_offset = wcid & 0x7; \
+		MULTISSID_STRUCT *tim_mbss = &ad_p->ApCfg.MBSSID[apidx]; \
+		tim_mbss->TimBitmaps[tim_offset] &= (~NUM_BIT8[bit_offset]); \
+		if (((tim_mbss->TimBitmaps[tim_offset] & ((tim_offset == 0) ? 0xfe : 0xff)) == 0) && \
+			((tim_offset == tim_mbss->TimLo) || (tim_offset == tim_mbss->TimHi))) \
+			tim_mbss->bTimRescan = TRUE; }
+
+/* set a station PS TIM bit */
+#define WLAN_MR_TIM_BIT_SET(ad_p, apidx, wcid) \
+	{	unsigned char tim_offset = wcid >> 3; \
+		unsigned char bit_offset = wcid & 0x7; \
+		MULTISSID_STRUCT *tim_mbss = &ad_p->ApCfg.MBSSID[apidx]; \
+		tim_mbss->TimBitmaps[tim_offset] |= NUM_BIT8[bit_offset]; \
+		if (tim_mbss->TimLo == WLAN_MAX_NUM_OF_TIM) \
+			tim_mbss->TimLo = tim_mbss->TimHi = tim_offset; \
+		else if (tim_offset < tim_mbss->TimLo) \
+			tim_mbss->TimLo = tim_offset; \
+		else if (tim_offset > tim_mbss->TimHi) \
+			tim_mbss->TimHi = tim_offset; }
+#else
 /* clear a station PS TIM bit */
 #define WLAN_MR_TIM_BIT_CLEAR(ad_p, apidx, wcid) \
 	{	unsigned char tim_offset = wcid >> 3; \
@@ -1335,6 +1471,84 @@ typedef struct _BEACON_SYNC_STRUCT_ {
 	{	unsigned char tim_offset = wcid >> 3; \
 		unsigned char bit_offset = wcid & 0x7; \
 		ad_p->ApCfg.MBSSID[apidx].TimBitmaps[tim_offset] |= NUM_BIT8[bit_offset]; }
+#endif /* BCN_SEG_SUPPORT */
+
+#if defined(BCN_SEG_SUPPORT) || defined(PROBE_CACHE_SUPPORT)
+/* beacon IEs after the TIM, see APBeaconSegDirty() */
+#define BCN_SEG_ERP			0x01	/* rewritten in place */
+#define BCN_SEG_QLOAD		0x02	/* rewritten in place */
+#define BCN_SEG_HT			0x04
+#define BCN_SEG_SEC			0x08
+#define BCN_SEG_WSC			0x10
+#define BCN_SEG_WMM			0x20
+#define BCN_SEG_ALL			0xff
+#define BCN_SEG_IN_PLACE	(BCN_SEG_ERP | BCN_SEG_QLOAD)
+#endif /* BCN_SEG_SUPPORT || PROBE_CACHE_SUPPORT */
+
+#ifdef BCN_SEG_SUPPORT
+#define BCN_SEG_NONE		0xffff	/* no such IE in BcnTail */
+#define BCN_SEG_REFRESH		16		/* DBG: tail reuses between checks for changes nobody marked */
+#endif /* BCN_SEG_SUPPORT */
+
+#ifdef PROBE_CACHE_SUPPORT
+/* ProbeReq handling, see APPeerProbeReqAction() */
+#define PROBE_CACHE_AGE			(OS_HZ)			/* rebuild a cached ProbeRsp at least this often */
+#define PROBE_SRC_TAB_SIZE		64				/* power of 2 */
+#define PROBE_RATE_WINDOW		(OS_HZ)
+#define PROBE_RATE_MAX			8				/* ProbeReq answered per station and window */
+#define PROBE_DUP_WINDOW		(OS_HZ / 50)	/* identical wildcard ProbeReq dropped within 20 ms */
+
+typedef struct _PROBE_SRC_ENTRY {
+	unsigned char Addr[MAC_ADDR_LEN];
+	unsigned char Count;			/* ProbeReq in the window since WinStart */
+	unsigned long WinStart;
+	unsigned long LastWildcard;		/* time and IE checksum of the last wildcard ProbeReq */
+	unsigned int WildcardSum;
+} PROBE_SRC_ENTRY;
+#endif /* PROBE_CACHE_SUPPORT */
+
+#ifdef ASSOC_STORM_SUPPORT
+/* association storms, see ap_storm.c */
+#define ASSOC_STORM_HS_MAX		16				/* AP initiated 4-way handshakes at a time, 0 for no limit */
+#define ASSOC_STORM_HS_GRACE	(OS_HZ / 2)		/* an admitted handshake counts until it reaches AS_PTKSTART */
+#define ASSOC_STORM_HS_RETRY	50				/* ms until a deferred handshake asks again */
+
+#ifdef DBG
+#define ASSOC_STORM_SIM_RETRY	(OS_HZ)			/* a simulated station stuck this long starts over */
+#define ASSOC_STORM_SIM_RESERVE	(MAX_LEN_OF_MAC_TABLE / 4)	/* MAC table entries the simulator leaves to real stations */
+
+enum ASSOC_STORM_SIM_STATE {
+	STORM_SIM_IDLE,
+	STORM_SIM_AUTH,
+	STORM_SIM_ASSOC,
+	STORM_SIM_DONE,
+	STORM_SIM_HS,
+	STORM_SIM_FAIL
+};
+
+typedef struct _ASSOC_STORM_SIM {
+	NDIS_SPIN_LOCK Lock;
+	bool bRunning;
+	unsigned short Num;				/* simulated stations */
+	unsigned short AssocCnt;
+	unsigned short FailCnt;
+	unsigned int StartUs;
+	unsigned int AssocUs;			/* time to all associated */
+	unsigned int WcidUs;			/* time to the last simulated WCID entry written */
+	unsigned long RetryCnt;
+	unsigned long DropCnt;			/* MLME queue full */
+	unsigned short HsCnt;			/* handshakes admitted */
+	unsigned int HsUs;				/* time to the last handshake admitted */
+	unsigned long HsDeferCnt;
+#if defined(REG_DEFER_SUPPORT) || defined(BOOT_PROF_SUPPORT)
+	unsigned long XferBegin;
+	unsigned long Xfer;				/* control transfers until all associated */
+#endif /* REG_DEFER_SUPPORT || BOOT_PROF_SUPPORT */
+	unsigned char State[MAX_LEN_OF_MAC_TABLE];
+	unsigned long Time[MAX_LEN_OF_MAC_TABLE];
+} ASSOC_STORM_SIM;
+#endif /* DBG */
+#endif /* ASSOC_STORM_SUPPORT */
 
 
 #ifdef CONFIG_AP_SUPPORT
@@ -1395,6 +1609,26 @@ typedef struct _MULTISSID_STRUCT {
 /*	unsigned long TimBitmap;      // bit0 for broadcast, 1 for AID1, 2 for AID2, ...so on */
 /*    unsigned long TimBitmap2;     // b0 for AID32, b1 for AID33, ... and so on */
 	unsigned char TimBitmaps[WLAN_MAX_NUM_OF_TIM];
+#ifdef BCN_SEG_SUPPORT
+	unsigned char TimLo, TimHi;
+	bool bTimRescan;
+
+	/* beacon IEs after the TIM as last built, BCN_SEG_* of what changed since */
+	unsigned char BcnTail[MAX_BEACON_SIZE];
+	unsigned short BcnTailLen;
+	unsigned short BcnErpPos, BcnQloadPos;	/* in BcnTail, or BCN_SEG_NONE */
+	unsigned char BcnSegDirty;
+	unsigned char BcnRefresh;
+	unsigned int BcnTailVersion;
+#endif /* BCN_SEG_SUPPORT */
+#ifdef PROBE_CACHE_SUPPORT
+	/* ProbeRsp as last built, only Addr1 changes per request */
+	unsigned char *pProbeRspCache;
+	unsigned long ProbeRspCacheLen;
+	unsigned long ProbeRspCacheTime;
+	bool bProbeRspStale;
+	unsigned int ProbeRspGen;	/* bumped by APBeaconSegDirty() */
+#endif /* PROBE_CACHE_SUPPORT */
 
 	/* WPA */
 	unsigned char GMK[32];
@@ -1934,6 +2168,94 @@ typedef enum _MAC_ENTRY_OP_MODE_ {
 #define RATE_UP			1		/* Trying higher rate or same rate with different BF */
 #define RATE_DOWN		2		/* Trying lower rate */
 
+#ifdef TX_AQM_SUPPORT
+#define AQM_FLOW_NUM			64	/* flow queues per AC */
+#define AQM_SOJOURN_BUCKET		16	/* bucket i counts sojourn times below (128 << i) usec */
+
+/* CoDel state of one queue, times in usec */
+typedef struct _CODEL_VARS {
+	unsigned int FirstAboveTime;	/* 0 while the sojourn time is below target */
+	unsigned int DropNext;
+	unsigned int Count;
+	unsigned int LastCount;
+	bool bDropping;
+} CODEL_VARS, *PCODEL_VARS;
+
+typedef struct _AQM_FLOW {
+	QUEUE_HEADER Queue;
+	CODEL_VARS CoDel;
+	INT Deficit;	/* bytes still to be sent in this round */
+	short Next;	/* next flow on the same list, -1 at the tail */
+	unsigned char List;	/* AQM_LIST_NONE, AQM_LIST_NEW or AQM_LIST_OLD */
+} AQM_FLOW, *PAQM_FLOW;
+
+typedef struct _AQM_FLOW_LIST {
+	short Head;
+	short Tail;
+} AQM_FLOW_LIST, *PAQM_FLOW_LIST;
+#endif /* TX_AQM_SUPPORT */
+
+#ifdef HDR_TRANS_SUPPORT
+/* values of MAC_TABLE_ENTRY.HdrTransMode */
+#define HDR_TRANS_MODE_OFF		0	/* the driver builds and strips the 802.11 header */
+#define HDR_TRANS_MODE_ON		1	/* unicast data goes to the MAC as 802.3, which translates it */
+
+/* data path a frame took, HDR_TRANS_PATH_NONE frames are not benchmarked */
+#define HDR_TRANS_PATH_NONE		0
+#define HDR_TRANS_PATH_80211	1
+#define HDR_TRANS_PATH_8023		2
+#define HDR_TRANS_PATH_NUM		2
+
+#define HDR_TRANS_BENCH_TX		0
+#define HDR_TRANS_BENCH_RX		1
+
+/* nanoseconds spent per packet on one data path */
+typedef struct _HDR_TRANS_BENCH {
+	unsigned long long Nsec;
+	unsigned long Packets;
+	unsigned long MinNsec;
+	unsigned long MaxNsec;
+} HDR_TRANS_BENCH, *PHDR_TRANS_BENCH;
+#endif /* HDR_TRANS_SUPPORT */
+
+#ifdef REG_DEFER_SUPPORT
+#define REG_DEFER_MAX			64	/* MAC register writes held back before they are flushed */
+#define REG_SHADOW_NUM			32	/* at most one RegShadowValid bit per RegShadowTable entry */
+#endif /* REG_DEFER_SUPPORT */
+
+#ifdef PHY_SHADOW_SUPPORT
+#define PHY_SHADOW_BBP_NUM		256	/* BBP R0 ~ R255 */
+#define PHY_SHADOW_RF_BANK_NUM	8	/* RF bank 0 ~ 7 */
+#define PHY_SHADOW_RF_NUM		64	/* RF R0 ~ R63 of each bank */
+#endif /* PHY_SHADOW_SUPPORT */
+
+#ifdef BOOT_PROF_SUPPORT
+/* interface up stages, in the order rt28xx_init() and RTMPDrvOpen() run them */
+enum BOOT_PROF_STAGE {
+	BOOT_PROF_CHIP_ON,
+	BOOT_PROF_FIRMWARE,
+	BOOT_PROF_TASK_INIT,
+	BOOT_PROF_MAC_INIT,
+	BOOT_PROF_PROFILE,
+	BOOT_PROF_EEPROM,
+	BOOT_PROF_PHY_INIT,
+	BOOT_PROF_CHANNEL,
+	BOOT_PROF_AUTO_CH,
+	BOOT_PROF_AP_STARTUP,
+	BOOT_PROF_DRV_OPEN,
+	BOOT_PROF_STAGE_NUM
+};
+
+/* steps timed inside one of the stages above, see BootProfStepEnd() */
+enum BOOT_PROF_STEP {
+	BOOT_PROF_FW_ILM,
+	BOOT_PROF_FW_DLM,
+	BOOT_PROF_FW_READY,
+	BOOT_PROF_INIT_CAL,
+	BOOT_PROF_STEP_NUM
+};
+#endif /* BOOT_PROF_SUPPORT */
+
 
 typedef struct _MAC_TABLE_ENTRY {
 	/*
@@ -1945,15 +2267,44 @@ typedef struct _MAC_TABLE_ENTRY {
 
 	bool isCached;
 	bool bIAmBadAtheros;	/* Flag if this is Atheros chip that has IOT problem.  We need to turn on RTS/CTS protection. */
+	unsigned short AggFlags;	/* MAC_AGG_xxx bits this entry is counted in, see MacTableAggUpdate() */
+
+	/*
+	   Fields read for every data frame, grouped here so the TX/RX path stays
+	   within the first cache lines of the entry. The WPA, WSC and rate
+	   adaptation state below is only touched by MLME and the periodic timers.
+	 */
+	unsigned char Addr[MAC_ADDR_LEN];
+	unsigned char apidx;		/* MBSS number */
+	unsigned char PsMode;
+	unsigned short Aid;
+	unsigned short PortSecured;
+	SST Sst;
+	NDIS_802_11_WEP_STATUS WepStatus;
+	/*
+		A bitmap of bool flags. each bit represent an operation status of a particular
+		bool control, either ON or OFF. These flags should always be accessed via
+		CLIENT_STATUS_TEST_FLAG(), CLIENT_STATUS_SET_FLAG(), CLIENT_STATUS_CLEAR_FLAG() macros.
+		see fOP_STATUS_xxx in RTMP_DEF.C for detail bit definition. fCLIENT_STATUS_AMSDU_INUSED
+	*/
+	unsigned long ClientStatusFlags;
+	unsigned long NoDataIdleCount;
+	HTTRANSMIT_SETTING HTPhyMode, MaxHTPhyMode, MinHTPhyMode;	/* For transmit phy setting in TXWI. */
+	unsigned char CurrTxRate;
+	unsigned short TxSeq[NUM_OF_TID];
+	unsigned short NonQosDataSeq;
+	struct _MAC_TABLE_ENTRY *pNext;
 
 	/* WPA/WPA2 4-way database */
 	unsigned char EnqueueEapolStartTimerRunning;	/* Enqueue EAPoL-Start for triggering EAP SM */
 	RALINK_TIMER_STRUCT EnqueueStartForPSKTimer;	/* A timer which enqueue EAPoL-Start for triggering PSK SM */
+#ifdef ASSOC_STORM_SUPPORT
+	unsigned long HsAdmitTime;	/* 4-way handshake admitted by AssocStormHsAdmit() */
+#endif /* ASSOC_STORM_SUPPORT */
 
 	/*jan for wpa */
 	/* record which entry revoke MIC Failure , if it leaves the BSS itself, AP won't update aMICFailTime MIB */
 	unsigned char CMTimerRunning;
-	unsigned char apidx;		/* MBSS number */
 	unsigned char RSNIE_Len;
 	unsigned char RSN_IE[MAX_LEN_OF_RSNIE];
 	unsigned char ANonce[LEN_KEY_DESC_NONCE];
@@ -1966,11 +2317,9 @@ typedef struct _MAC_TABLE_ENTRY {
 	RALINK_TIMER_STRUCT eTxBfProbeTimer;
 #endif /* TXBF_SUPPORT */
 	NDIS_802_11_AUTHENTICATION_MODE AuthMode;	/* This should match to whatever microsoft defined */
-	NDIS_802_11_WEP_STATUS WepStatus;
 	NDIS_802_11_WEP_STATUS GroupKeyWepStatus;
 	unsigned char WpaState;
 	unsigned char GTKState;
-	unsigned short PortSecured;
 	NDIS_802_11_PRIVACY_FILTER PrivacyFilter;	/* PrivacyFilter enum for 802.1X */
 	CIPHER_KEY PairwiseKey;
 	void * pAd;
@@ -1982,23 +2331,36 @@ typedef struct _MAC_TABLE_ENTRY {
 	unsigned char usk_id;		/* unicast key index for WPI */
 #endif				/* WAPI_SUPPORT */
 
-	unsigned char Addr[MAC_ADDR_LEN];
 	unsigned char			HdrAddr1[MAC_ADDR_LEN];
 	unsigned char			HdrAddr2[MAC_ADDR_LEN];
 	unsigned char			HdrAddr3[MAC_ADDR_LEN];
-	unsigned char PsMode;
 	unsigned char FlgPsModeIsWakeForAWhile; /* wake up for a while until a condition */
 	unsigned char VirtualTimeout; /* peer power save virtual timeout */
-	SST Sst;
 	AUTH_STATE AuthState;	/* for SHARED KEY authentication state machine used only */
 	bool IsReassocSta;	/* Indicate whether this is a reassociation procedure */
-	unsigned short Aid;
 	unsigned short CapabilityInfo;
 	unsigned char LastRssi;
-	unsigned long NoDataIdleCount;
 	unsigned short StationKeepAliveCount;	/* unit: second */
 	unsigned long PsQIdleCount;
 	QUEUE_HEADER PsQueue;
+#ifdef AIRTIME_FAIRNESS_SUPPORT
+	QUEUE_HEADER AtfTxQ[NUM_OF_TX_RING];	/* frames waiting for their airtime turn, protected by irq_lock */
+	INT AtfDeficit[NUM_OF_TX_RING];	/* usec still to be spent in this round */
+	unsigned long long AtfAirtime;	/* usec of airtime charged */
+	unsigned long AtfTxFrames;
+	unsigned long AtfDrops;	/* frames dropped because AtfTxQ was full or by CoDel */
+#ifdef TX_AQM_SUPPORT
+	CODEL_VARS AtfCoDel[NUM_OF_TX_RING];
+#endif /* TX_AQM_SUPPORT */
+#endif /* AIRTIME_FAIRNESS_SUPPORT */
+#ifdef HDR_TRANS_SUPPORT
+	unsigned char HdrTransMode;	/* HDR_TRANS_MODE_xxx, RX follows it through HT_RX_WCID_EN */
+	bool bHdrTransCached;	/* CachedBuf holds a WIFI_INFO rather than an 802.11 header */
+	unsigned long HdrTransTxFrames;	/* unicast frames handed to the MAC as 802.3 */
+#endif /* HDR_TRANS_SUPPORT */
+#ifdef BA_HRTIMER_SUPPORT
+	unsigned long BaTimeoutFlush;	/* reorder flushes forced by the hold timeout */
+#endif /* BA_HRTIMER_SUPPORT */
 
 	unsigned int StaConnectTime;	/* the live time of this station since associated with AP */
 	unsigned int StaIdleTimeout;	/* idle timeout per entry */
@@ -2067,7 +2429,6 @@ typedef struct _MAC_TABLE_ENTRY {
 /* If ValidAsWDS==TRUE, MatchWDSTabIdx is the index in WdsTab.MacTab */
 	unsigned int MatchWDSTabIdx;
 	unsigned char MaxSupportedRate;
-	unsigned char CurrTxRate;
 	unsigned char CurrTxRateIndex;
 	unsigned char lastRateIdx;
 	unsigned char *pTable;	/* Pointer to this entry's Tx Rate Table */
@@ -2163,17 +2524,6 @@ typedef struct _MAC_TABLE_ENTRY {
 #endif				/* CONFIG_AP_SUPPORT */
 
 
-
-	/*
-		A bitmap of bool flags. each bit represent an operation status of a particular
-		bool control, either ON or OFF. These flags should always be accessed via
-		CLIENT_STATUS_TEST_FLAG(), CLIENT_STATUS_SET_FLAG(), CLIENT_STATUS_CLEAR_FLAG() macros.
-		see fOP_STATUS_xxx in RTMP_DEF.C for detail bit definition. fCLIENT_STATUS_AMSDU_INUSED
-	*/
-	unsigned long ClientStatusFlags;
-
-	HTTRANSMIT_SETTING HTPhyMode, MaxHTPhyMode, MinHTPhyMode;	/* For transmit phy setting in TXWI. */
-
 #ifdef DOT11_N_SUPPORT
 	/* HT EWC MIMO-N used parameters */
 	unsigned short RXBAbitmap;	/* fill to on-chip  RXWI_BA_BITMASK in 8.1.3RX attribute entry format */
@@ -2207,9 +2557,6 @@ typedef struct _MAC_TABLE_ENTRY {
 	bool bAutoTxRateSwitch;
 
 	unsigned char RateLen;
-	struct _MAC_TABLE_ENTRY *pNext;
-	unsigned short TxSeq[NUM_OF_TID];
-	unsigned short NonQosDataSeq;
 
 	RSSI_SAMPLE RssiSample;
 	unsigned int LastRxRate;
@@ -2282,9 +2629,67 @@ bool SupportVHTMCS[MAX_LEN_OF_VHT_RATES];
 } MAC_TABLE_ENTRY, *PMAC_TABLE_ENTRY;
 
 
+/*
+	Client properties MAC_TABLE keeps a running count of, so the
+	fAnyStationXXX flags follow associations and capability changes
+	without a scan of the whole table.
+*/
+#define MAC_AGG_NON_GF			0
+#define MAC_AGG_20_ONLY			1
+#define MAC_AGG_LEGACY			2
+#define MAC_AGG_HT				3
+#define MAC_AGG_MIMOPS_DYNAMIC	4
+#define MAC_AGG_40_INTOLERANT	5
+#define MAC_AGG_BAD_ATHEROS		6
+#define MAC_AGG_NOT_RALINK		7
+#define MAC_AGG_WAPI			8
+#define MAC_AGG_NUM				9
+
+#define MAC_TABLE_MAP_WORDS		((MAX_LEN_OF_MAC_TABLE + 31) / 32)
+
+/*
+	What MacTableLookup() compares, kept apart from the large MAC_TABLE_ENTRY
+	so a lookup walks these 8-byte slots instead of pulling every entry on
+	the hash chain into the cache.
+*/
+typedef struct _MAC_TABLE_HOT {
+	unsigned char Addr[MAC_ADDR_LEN];
+	unsigned char Next;	/* WCID of the next entry on the hash chain, MAC_TABLE_HOT_END ends it */
+	unsigned char Rsv;
+} MAC_TABLE_HOT;
+
+#define MAC_TABLE_HOT_END		0	/* WCID 0 is never given to a station */
+
+/* stores and loads of the hot hash chains, which MacTableLookup() walks unlocked */
+#ifdef MAC_TABLE_RCU_SUPPORT
+#define MAC_TABLE_RCU_ASSIGN(_Var, _Val)	RTMP_OS_RCU_ASSIGN(_Var, _Val)
+#define MAC_TABLE_RCU_DEREF(_Var)			RTMP_OS_RCU_DEREF(_Var)
+#define MAC_TABLE_RCU_READ_LOCK()			RTMP_OS_RCU_READ_LOCK()
+#define MAC_TABLE_RCU_READ_UNLOCK()			RTMP_OS_RCU_READ_UNLOCK()
+#else
+#define MAC_TABLE_RCU_ASSIGN(_Var, _Val)	((_Var) = (_Val))
+#define MAC_TABLE_RCU_DEREF(_Var)			(_Var)
+#define MAC_TABLE_RCU_READ_LOCK()
+#define MAC_TABLE_RCU_READ_UNLOCK()
+#endif /* MAC_TABLE_RCU_SUPPORT */
+
+#ifdef MAC_TABLE_RCU_SUPPORT
+/* a deleted WCID waiting for the lookups that may still see it */
+typedef struct _MAC_TABLE_RETIRE {
+	RTMP_OS_RCU_HEAD Rcu;
+	VOID *pAd;
+	unsigned char Wcid;
+} MAC_TABLE_RETIRE;
+#endif /* MAC_TABLE_RCU_SUPPORT */
+
 typedef struct _MAC_TABLE {
 	MAC_TABLE_ENTRY *Hash[HASH_TABLE_SIZE];
 	MAC_TABLE_ENTRY Content[MAX_LEN_OF_MAC_TABLE];
+#ifdef MAC_TABLE_RCU_SUPPORT
+	/* kept across MacTableReset(), the grace periods are still running */
+	unsigned int RetireMap[MAC_TABLE_MAP_WORDS];	/* WCIDs not to be reused yet, protected by MacTabLock */
+	MAC_TABLE_RETIRE Retire[MAX_LEN_OF_MAC_TABLE];
+#endif /* MAC_TABLE_RCU_SUPPORT */
 	unsigned short Size;
 	QUEUE_HEADER McastPsQueue;
 	unsigned long PsQIdleCount;
@@ -2311,6 +2716,11 @@ typedef struct _MAC_TABLE {
 #ifdef WAPI_SUPPORT
 	bool fAnyWapiStation;
 #endif				/* WAPI_SUPPORT */
+
+	unsigned int OccupiedMap[MAC_TABLE_MAP_WORDS];	/* WCIDs of the entries in use, protected by MacTabLock */
+	unsigned short AggCount[MAC_AGG_NUM];	/* clients counted in each MAC_AGG_xxx, protected by MacTabLock */
+	unsigned char HotHash[HASH_TABLE_SIZE];	/* first WCID of each hash chain, MAC_TABLE_HOT_END if empty */
+	MAC_TABLE_HOT Hot[MAX_LEN_OF_MAC_TABLE];
 } MAC_TABLE, *PMAC_TABLE;
 
 
@@ -2544,6 +2954,28 @@ typedef struct _AP_ADMIN_CONFIG {
 	unsigned char DtimCount;	/* 0.. DtimPeriod-1 */
 	unsigned char DtimPeriod;	/* default = 3 */
 	unsigned char ErpIeContent;
+#ifdef BCN_SEG_SUPPORT
+	unsigned long BcnTailBuildCnt;
+	unsigned long BcnTailReuseCnt;
+	unsigned long BcnSegPatchCnt;
+	unsigned long TimRescanCnt;
+	unsigned long BcnTailMismatchCnt;	/* DBG: reused tails that missed an unmarked change */
+#endif /* BCN_SEG_SUPPORT */
+#ifdef PROBE_CACHE_SUPPORT
+	PROBE_SRC_ENTRY ProbeSrcTab[PROBE_SRC_TAB_SIZE];
+	unsigned long ProbeCacheHitCnt;
+	unsigned long ProbeCacheMissCnt;
+	unsigned long ProbeRateDropCnt;
+	unsigned long ProbeDupDropCnt;
+#endif /* PROBE_CACHE_SUPPORT */
+#ifdef ASSOC_STORM_SUPPORT
+	unsigned char AssocHsMax;		/* 4-way handshakes at a time, 0 for no limit */
+	unsigned char AssocHsPeak;
+	unsigned long AssocHsDeferCnt;
+#ifdef DBG
+	ASSOC_STORM_SIM StormSim;
+#endif /* DBG */
+#endif /* ASSOC_STORM_SUPPORT */
 	unsigned long LastOLBCDetectTime;
 	unsigned long LastNoneHTOLBCDetectTime;
 	unsigned long LastScanTime;	/* Record last scan time for issue BSSID_SCAN_LIST */
@@ -3037,6 +3469,13 @@ struct _RTMP_ADAPTER {
 
 	NDIS_SPIN_LOCK irq_lock;
 
+#ifdef MEM_POOL_SUPPORT
+	VOID *pRxSkbPool;	/* skbs for received frames up to MEM_POOL_RX_SKB_SIZE */
+	VOID *pMlmePool;	/* MlmeAllocateMemory() buffers */
+	VOID *pMcuCmdPool;	/* AsicSendCmdToAndes() command buffers */
+	VOID *pMcuRspPool;	/* struct CMD_RSP_EVENT */
+#endif /* MEM_POOL_SUPPORT */
+
 	/*======Cmd Thread in PCI/RBUS/USB */
 	CmdQ CmdQ;
 	NDIS_SPIN_LOCK CmdQLock;	/* CmdQLock spinlock */
@@ -3070,6 +3509,29 @@ struct _RTMP_ADAPTER {
 	RTMP_OS_SEM hw_atomic;
 	void * UsbVendorReqBuf;
 	bool VendorResetFlag;
+
+#ifdef REG_DEFER_SUPPORT
+	/* MAC register writes of the task in RegDeferBegin()/RegDeferEnd(), see cmm_reg_defer.c */
+	bool bRegDefer;
+	NDIS_SPIN_LOCK RegDeferLock;
+	VOID *pRegDeferOwner;
+	unsigned int RegDeferDepth;
+	unsigned int RegDeferNum;
+	bool bRegDeferFlushing;
+	RTMP_REG_PAIR RegDefer[REG_DEFER_MAX];
+	NDIS_SPIN_LOCK RegShadowLock;
+	unsigned int RegShadow[REG_SHADOW_NUM];
+	unsigned int RegShadowValid;
+	unsigned int RegShadowGen;		/* bumped by every shadow update, see RegShadowFill() */
+
+	unsigned long RegDeferWriteCnt;
+	unsigned long RegDeferCmdCnt;
+	unsigned long RegShadowHitCnt;
+	unsigned long RegShadowMissCnt;
+#endif /* REG_DEFER_SUPPORT */
+#if defined(REG_DEFER_SUPPORT) || defined(BOOT_PROF_SUPPORT)
+	unsigned long VendorReqCnt;		/* control transfers, see RTUSB_VendorRequest() */
+#endif /* REG_DEFER_SUPPORT || BOOT_PROF_SUPPORT */
 /*	wait_queue_head_t	 *wait; */
 	VOID *wait;
 
@@ -3114,6 +3576,18 @@ struct _RTMP_ADAPTER {
 
 	HT_TX_CONTEXT TxContext[NUM_OF_TX_RING];
 	NDIS_SPIN_LOCK TxContextQueueLock[NUM_OF_TX_RING];	/* TxContextQueue spinlock */
+#ifdef USB_BULK_OUT_SG_SUPPORT
+	TX_SG_SLOT TxSgSlot[NUM_OF_TX_RING][TX_SG_SLOT_NUM];	/* protected by TxContextQueueLock */
+	bool bUsbTxSg;	/* host controller takes unaligned sg lists and TxSgSlot is allocated */
+	bool bUsbTxSgEnable;	/* UsbTxSg iwpriv switch */
+	unsigned long TxSgFrames;	/* frames sent from the skb without copying */
+	unsigned long TxSgBusy;	/* eligible frames copied because every slot was in flight */
+	unsigned long TxSgFail;
+#endif /* USB_BULK_OUT_SG_SUPPORT */
+#ifdef USB_TX_ADAPTIVE_BATCH
+	TX_BATCH_CTRL TxBatchCtrl[NUM_OF_TX_RING];
+	bool bTxBatchAdaptive;	/* UsbTxBatch iwpriv switch, FALSE falls back to MAX_TX_PROCESS */
+#endif /* USB_TX_ADAPTIVE_BATCH */
 
 	/* 4 sets of Bulk Out index and pending flag */
 	/*
@@ -3144,6 +3618,55 @@ struct _RTMP_ADAPTER {
 	/* Maximum allowed tx software Queue length */
 	unsigned int					TxSwQMaxLen;
 
+	/* frames RTMPDeQueuePacket has taken off the queues and not sent or put back yet */
+	unsigned long TxSwQBatch[NUM_OF_TX_RING];
+	/* WCIDs deleted while their frames may sit in a batch, protected by irq_lock */
+	unsigned int TxSwQBatchStale[NUM_OF_TX_RING][(MAX_LEN_OF_MAC_TABLE + 31) / 32];
+	bool bTxSwQBatchStale[NUM_OF_TX_RING];
+
+#ifdef AIRTIME_FAIRNESS_SUPPORT
+	/* per-station queues behind TxSwQueue, all protected by irq_lock */
+	QUEUE_HEADER AtfBypassQ[NUM_OF_TX_RING];	/* mgmt, mcast and non-client frames, sent ahead of the stations */
+	unsigned char AtfRing[NUM_OF_TX_RING][MAX_LEN_OF_MAC_TABLE];	/* wcids with frames queued, in round-robin order */
+	unsigned short AtfRingHead[NUM_OF_TX_RING];
+	unsigned short AtfRingNum[NUM_OF_TX_RING];
+	bool AtfInRing[NUM_OF_TX_RING][MAX_LEN_OF_MAC_TABLE];
+	unsigned long AtfQueued[NUM_OF_TX_RING];	/* frames in AtfBypassQ and the station queues */
+	bool bAtfEnable;
+	unsigned int AtfQuantum;	/* usec of airtime a station earns per round */
+#endif /* AIRTIME_FAIRNESS_SUPPORT */
+
+#ifdef TX_AQM_SUPPORT
+	/* flow queues behind TxSwQueue, all protected by irq_lock */
+	QUEUE_HEADER AqmBypassQ[NUM_OF_TX_RING];	/* mgmt, mcast and non-client frames, sent ahead of the flows */
+	AQM_FLOW AqmFlow[NUM_OF_TX_RING][AQM_FLOW_NUM];
+	AQM_FLOW_LIST AqmNewFlows[NUM_OF_TX_RING];
+	AQM_FLOW_LIST AqmOldFlows[NUM_OF_TX_RING];
+	unsigned long AqmQueued[NUM_OF_TX_RING];	/* frames in AqmBypassQ and AqmFlow */
+	bool bAqmEnable;
+	unsigned int AqmTarget;	/* usec of standing queue CoDel tolerates */
+	unsigned int AqmInterval;	/* usec */
+	unsigned int AqmQuantum;	/* bytes a flow sends per round */
+	unsigned long AqmCoDelDrops[NUM_OF_TX_RING];
+	unsigned long AqmOverLimitDrops[NUM_OF_TX_RING];	/* dropped from the longest flow when over TxSwQMaxLen */
+	unsigned long AqmSojournHist[NUM_OF_TX_RING][AQM_SOJOURN_BUCKET];
+#endif /* TX_AQM_SUPPORT */
+
+#ifdef HDR_TRANS_SUPPORT
+	unsigned char HdrTransDefault;	/* HdrTransMode a station gets when it joins */
+	unsigned int HdrTransRxWcidMap[(MAX_LEN_OF_MAC_TABLE + 31) / 32];	/* shadow of HT_RX_WCID_EN, protected by MacTabLock */
+	bool bHdrTransBench;
+	HDR_TRANS_BENCH HdrTransBench[2][HDR_TRANS_PATH_NUM];	/* [TX/RX][HDR_TRANS_PATH_xxx - 1] */
+#endif /* HDR_TRANS_SUPPORT */
+
+#ifdef CACHE_MISS_STAT_SUPPORT
+	VOID *pCacheMissCounter;	/* from RtmpOsCacheMissStart(), NULL when not measuring */
+	unsigned long long CacheMissBase;
+	unsigned long CacheMissRxBase;	/* RalinkCounters.RxCount at start */
+	unsigned long CacheMissTxBase;	/* RalinkCounters.KickTxCount at start */
+	unsigned long CacheMissStartTime;
+#endif /* CACHE_MISS_STAT_SUPPORT */
+
 	RTMP_DMABUF MgmtDescRing;	/* Shared memory for MGMT descriptors */
 	RTMP_MGMT_RING MgmtRing;
 	NDIS_SPIN_LOCK MgmtRingLock;	/* Prio Ring spinlock */
@@ -3163,11 +3686,42 @@ struct _RTMP_ADAPTER {
 	unsigned char PendingRx;	/* The Maximum pending Rx value should be       RX_RING_SIZE. */
 	unsigned char NextRxBulkInIndex;	/* Indicate the current RxContext Index which hold by Host controller. */
 	unsigned char NextRxBulkInReadIndex;	/* Indicate the current RxContext Index which driver can read & process it. */
+	unsigned char NextRxBulkInSubmitIndex;	/* RxContext the next bulk-in URB goes to, ahead of NextRxBulkInIndex when several are in flight. */
+	bool bRxBulkInSubmit;	/* DoBulkIn is submitting, keeps the URBs in ring order */
+	unsigned char RxUrbTarget;	/* bulk-in URBs kept in flight now, 1 ~ NumOfBulkInIRP */
+	unsigned int RxUrbNum;	/* rx_urb_num module parameter */
+	unsigned long RxBulkSize;	/* bytes of each bulk-in buffer */
+	unsigned int RxUrbAdaptCnt;
+	unsigned int RxUrbAdaptFull;
+	unsigned long RxUrbTargetUp;
+	unsigned long RxUrbTargetDown;
+	unsigned long RxUrbInFlightHist[RX_RING_SIZE + 1];	/* URBs in flight when one completes */
+	unsigned long RxRingReadableHist[RX_RING_SIZE + 1];	/* buffers waiting to be parsed when one completes */
+	unsigned long RxBulkFillHist[RX_BULK_FILL_BUCKET];	/* fill level of completed bulk-in buffers */
 	unsigned long NextRxBulkInPosition;	/* Want to contatenate 2 URB buffer while 1st is bulkin failed URB. This Position is 1st URB TransferLength. */
 	unsigned long TransferBufferLength;	/* current length of the packet buffer */
 	unsigned long ReadPosition;	/* current read position in a packet buffer */
+#ifdef RX_ZERO_COPY_SUPPORT
+	unsigned int RxCopyBreak;	/* frames shorter than this are copied, others are cloned */
+	unsigned long long RxZcBytesCopied;	/* bytes memcpy'ed out of the bulk-in buffer */
+	unsigned long long RxZcBytesRef;	/* bytes handed up by reference */
+	unsigned long RxZcBufRenew;	/* bulk-in buffers replaced because frames still hold them */
+	unsigned long RxZcBufRenewFail;
+	unsigned long RxZcBufRecycle;	/* replaced by a parked buffer whose frames were all freed */
+	PNDIS_PACKET RxZcSpare[RX_ZC_SPARE_NUM];	/* replaced buffers, protected by BulkInLock */
+#endif /* RX_ZERO_COPY_SUPPORT */
+#ifdef RX_NAPI_SUPPORT
+	unsigned int RxNapiBudget;	/* max frames parsed in one poll */
+	unsigned int RxNapiQuota;	/* frames left in the current poll */
+	unsigned long RxNapiPoll;
+	unsigned long RxNapiFrames;
+	unsigned long RxNapiBudgetFull;	/* polls which ran out of budget */
+#endif /* RX_NAPI_SUPPORT */
 
 	CMD_RSP_CONTEXT CmdRspEventContext;
+#ifdef MCU_ASYNC_CMD_SUPPORT
+	CMD_CONTEXT McuCmdContext[MCU_CMD_SLOT_NUM];	/* IRPPending protected by MCUCtrl.CmdRspEventListLock */
+#endif /* MCU_ASYNC_CMD_SUPPORT */
 #endif /* RTMP_MAC_USB */
 
 /*****************************************************************************************/
@@ -3192,6 +3746,28 @@ struct _RTMP_ADAPTER {
 	/* BBP Control */
 	/* --------------------------- */
 	unsigned char BbpWriteLatch[MAX_BBP_ID + 1];	/* record last BBP register value written via BBP_IO_WRITE/BBP_IO_WRITE_VY_REG_ID */
+#ifdef PHY_SHADOW_SUPPORT
+	/* BBP and RF register shadow, one bit per register in the bitmaps, see phy_shadow.c */
+	bool bPhyShadow;
+	NDIS_SPIN_LOCK PhyShadowLock;	/* the shadow, the bitmaps and the counters below */
+	unsigned int PhyShadowGen;		/* bumped by every shadow update, see PhyShadowBbpFill() */
+	unsigned char BbpShadow[PHY_SHADOW_BBP_NUM];
+	unsigned int BbpShadowValid[PHY_SHADOW_BBP_NUM / 32];
+	unsigned int BbpShadowDirty[PHY_SHADOW_BBP_NUM / 32];
+	unsigned int BbpShadowVolatile[PHY_SHADOW_BBP_NUM / 32];
+	unsigned char RfShadow[PHY_SHADOW_RF_BANK_NUM][PHY_SHADOW_RF_NUM];
+	unsigned int RfShadowValid[PHY_SHADOW_RF_BANK_NUM][PHY_SHADOW_RF_NUM / 32];
+	unsigned int RfShadowDirty[PHY_SHADOW_RF_BANK_NUM][PHY_SHADOW_RF_NUM / 32];
+	unsigned int RfShadowVolatile[PHY_SHADOW_RF_BANK_NUM][PHY_SHADOW_RF_NUM / 32];
+
+	unsigned long PhyShadowHitCnt;
+	unsigned long PhyShadowMissCnt;
+	unsigned long PhyShadowSkipCnt;
+	unsigned long PhyShadowCommitCnt;
+#endif /* PHY_SHADOW_SUPPORT */
+#if defined(PHY_SHADOW_SUPPORT) || defined(BOOT_PROF_SUPPORT)
+	VOID *pDebugfsDir;	/* named after the interface, created on the first open */
+#endif /* PHY_SHADOW_SUPPORT || BOOT_PROF_SUPPORT */
 	CHAR BbpRssiToDbmDelta;	/* change from unsigned char to CHAR for high power */
 	BBP_R66_TUNING BbpTuning;
 
@@ -3435,6 +4011,15 @@ struct _RTMP_ADAPTER {
 	/*About MacTab, the sta driver will use #0 and #1 for multicast and AP. */
 	MAC_TABLE MacTab;	/* ASIC on-chip WCID entry table.  At TX, ASIC always use key according to this on-chip table. */
 	NDIS_SPIN_LOCK MacTabLock;
+#ifdef ASSOC_STORM_SUPPORT
+	unsigned int WcidDirtyMap[MAC_TABLE_MAP_WORDS];	/* WCIDs the ASIC does not know yet, protected by MacTabLock */
+	bool bWcidFlushQueued;							/* CMDTHREAD_FLUSH_WCID_TAB pending, protected by MacTabLock */
+	RTMP_OS_SEM WcidFlushLock;						/* ASIC WCID writes of ap_storm.c against key writes */
+	unsigned int WcidFlushBuf[MAX_LEN_OF_MAC_TABLE * 2];	/* protected by WcidFlushLock */
+	unsigned long WcidFlushCnt;
+	unsigned long WcidEntryCnt;
+	unsigned long WcidBurstCnt;
+#endif /* ASSOC_STORM_SUPPORT */
 
 #ifdef DOT11_N_SUPPORT
 	BA_TABLE BATable;
@@ -3554,6 +4139,13 @@ struct _RTMP_ADAPTER {
 
 #ifdef DOT11_N_SUPPORT
 	struct reordering_mpdu_pool mpdu_blk_pool;
+#ifdef BA_HRTIMER_SUPPORT
+	unsigned int BaReorderTimeout;	/* usec */
+	unsigned long BaHoldHist[BA_HOLD_BUCKET];	/* time frames spent in the reorder buffers */
+	unsigned long BaTimeoutFlush;
+	NDIS_SPIN_LOCK BaFlushLock;	/* BaFlushDue, taken from the hold timers in hard irq */
+	unsigned int BaFlushDue[(MAX_LEN_OF_BA_REC_TABLE + 31) / 32];	/* sessions whose hold timer fired */
+#endif /* BA_HRTIMER_SUPPORT */
 #endif /* DOT11_N_SUPPORT */
 
 	/* statistics count */
@@ -3766,6 +4358,18 @@ struct _RTMP_ADAPTER {
 	bool TestMulMac;
 
 	struct MCU_CTRL MCUCtrl;
+#ifdef BOOT_PROF_SUPPORT
+	/* per interface up, see cmm_boot_prof.c */
+	unsigned int BootProfRun;
+	unsigned int BootProfBegin;
+	unsigned long BootProfXferBegin;
+	unsigned int BootProfMarked;	/* one bit per stage reached */
+	unsigned int BootProfUsec[BOOT_PROF_STAGE_NUM];
+	unsigned long BootProfXfer[BOOT_PROF_STAGE_NUM];
+	unsigned int BootProfStepMarked;	/* one bit per step timed */
+	unsigned int BootProfStepUsec[BOOT_PROF_STEP_NUM];
+	bool bBootProfFwSkipped;		/* MCU was already running, see USBLoadFirmwareToAndes() */
+#endif /* BOOT_PROF_SUPPORT */
 
 #ifdef CONFIG_MULTI_CHANNEL
 	unsigned short NullBufOffset[2];
@@ -4497,6 +5101,14 @@ NDIS_STATUS rlt_rf_read(
 	IN unsigned char bank,
 	IN unsigned char regID,
 	IN unsigned char *pValue);
+
+#ifdef PHY_SHADOW_SUPPORT
+NDIS_STATUS rlt_rf_read_hw(
+	IN RTMP_ADAPTER *pAd,
+	IN unsigned char bank,
+	IN unsigned char regID,
+	IN unsigned char *pValue);
+#endif /* PHY_SHADOW_SUPPORT */
 #endif /* RLT_RF */
 
 VOID NICReadEEPROMParameters(
@@ -4880,6 +5492,10 @@ VOID RTMPDeQueuePacket(
 	IN unsigned char QueIdx,
 	IN INT Max_Tx_Packets);
 
+VOID RTMPTxBatchWcidStale(
+	IN RTMP_ADAPTER *pAd,
+	IN unsigned char Wcid);
+
 NDIS_STATUS	RTMPHardTransmit(
 	IN PRTMP_ADAPTER	pAd,
 	IN PNDIS_PACKET		pPacket,
@@ -5381,6 +5997,35 @@ bool MlmeEnqueueForRecv(
 	IN unsigned char Signal,
 	IN unsigned char OpMode);
 
+#ifdef MLME_LANE_SUPPORT
+bool MlmeEnqueueForRecvPkt(
+	IN  PRTMP_ADAPTER   pAd, 
+	IN unsigned long Wcid, 
+	IN unsigned long TimeStampHigh, 
+	IN unsigned long TimeStampLow, 
+	IN unsigned char Rssi0, 
+	IN unsigned char Rssi1, 
+	IN unsigned char Rssi2, 
+	IN unsigned char AntSel, 
+	IN unsigned long MsgLen, 
+	IN void * Msg,
+	IN unsigned char Signal,
+	IN unsigned char OpMode,
+	IN PNDIS_PACKET pPkt);
+
+VOID MlmeElemFree(
+	IN PRTMP_ADAPTER pAd,
+	IN MLME_QUEUE_ELEM *Elem);
+
+VOID MlmeQueueFlush(
+	IN PRTMP_ADAPTER pAd,
+	IN MLME_QUEUE *Queue);
+
+INT Show_MlmeQueue_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+#endif /* MLME_LANE_SUPPORT */
+
 #ifdef WSC_INCLUDED
 bool MlmeEnqueueForWsc(
 	IN PRTMP_ADAPTER	pAd,
@@ -5402,9 +6047,11 @@ VOID    MlmeRestartStateMachine(
 bool  MlmeQueueEmpty(
 	IN MLME_QUEUE *Queue);
 
+#ifndef MLME_LANE_SUPPORT
 bool  MlmeQueueFull(
 	IN MLME_QUEUE *Queue,
 	IN unsigned char SendId);
+#endif /* !MLME_LANE_SUPPORT */
 
 bool  MsgTypeSubst(
 	IN PRTMP_ADAPTER pAd, 
@@ -6706,6 +7353,15 @@ VOID RTMPResetTxRxRingMemory(
 VOID RTMPFreeTxRxRingMemory(
     IN  PRTMP_ADAPTER   pAd);
 
+#if defined(RTMP_MAC_USB) && defined(RX_ZERO_COPY_SUPPORT)
+bool RTMPRxZcBufRenew(
+	IN RTMP_ADAPTER *pAd,
+	IN RX_CONTEXT *pRxContext);
+
+VOID RTMPFreeRxZcSpare(
+	IN RTMP_ADAPTER *pAd);
+#endif /* RTMP_MAC_USB && RX_ZERO_COPY_SUPPORT */
+
 bool RTMP_FillTxBlkInfo(
 	IN RTMP_ADAPTER *pAd,
 	IN TX_BLK *pTxBlk);
@@ -7684,6 +8340,40 @@ INT	Show_DescInfo_Proc(
 	IN	PRTMP_ADAPTER	pAd, 
 	IN	char *			arg);
 
+#ifdef RTMP_MAC_USB
+INT	Show_RxRing_Proc(
+	IN	PRTMP_ADAPTER	pAd, 
+	IN	char *			arg);
+#endif /* RTMP_MAC_USB */
+
+#ifdef RX_ZERO_COPY_SUPPORT
+INT	Set_RxCopyBreak_Proc(
+	IN	PRTMP_ADAPTER	pAd,
+	IN	char *			arg);
+#endif /* RX_ZERO_COPY_SUPPORT */
+
+#ifdef RX_NAPI_SUPPORT
+INT	Set_RxNapiBudget_Proc(
+	IN	PRTMP_ADAPTER	pAd,
+	IN	char *			arg);
+#endif /* RX_NAPI_SUPPORT */
+
+#ifdef USB_BULK_OUT_SG_SUPPORT
+INT	Set_UsbTxSg_Proc(
+	IN	PRTMP_ADAPTER	pAd,
+	IN	char *			arg);
+#endif /* USB_BULK_OUT_SG_SUPPORT */
+
+#ifdef USB_TX_ADAPTIVE_BATCH
+INT	Set_UsbTxBatch_Proc(
+	IN	PRTMP_ADAPTER	pAd,
+	IN	char *			arg);
+
+INT	Show_TxBatch_Proc(
+	IN	PRTMP_ADAPTER	pAd,
+	IN	char *			arg);
+#endif /* USB_TX_ADAPTIVE_BATCH */
+
 INT	Show_MacTable_Proc(
 	IN	PRTMP_ADAPTER	pAd, 
 	IN	char *			arg);
@@ -7919,6 +8609,22 @@ VOID Indicate_AMSDU_Packet(
 
 VOID BaReOrderingBufferMaintain(
     IN PRTMP_ADAPTER pAd);
+
+#ifdef BA_HRTIMER_SUPPORT
+VOID BaReorderTimerExpire(
+	IN VOID *pData);
+
+VOID BaReorderTimeoutFlush(
+	IN PRTMP_ADAPTER pAd);
+
+INT Set_BaReorderTimeout_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+
+INT Show_BaReorder_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+#endif /* BA_HRTIMER_SUPPORT */
 #endif /* DOT11_N_SUPPORT */
 
 /* Normal legacy Rx packet indication */
@@ -8189,6 +8895,12 @@ VOID RT28xx_UpdateBeaconToAsic(
 	IN unsigned long BeaconLen,
 	IN unsigned long UpdatePos);
 
+#ifdef BCN_BURST_SUPPORT
+INT Show_BcnUpdate_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg);
+#endif /* BCN_BURST_SUPPORT */
+
 void CfgInitHook(PRTMP_ADAPTER pAd);
 
 
@@ -8198,6 +8910,11 @@ NDIS_STATUS RtmpNetTaskInit(
 VOID RtmpNetTaskExit(
 	IN PRTMP_ADAPTER pAd);
 
+#ifdef RX_NAPI_SUPPORT
+VOID RtmpOsRxNapiSchedule(
+	IN RTMP_ADAPTER *pAd);
+#endif /* RX_NAPI_SUPPORT */
+
 NDIS_STATUS RtmpMgmtTaskInit(
 	IN RTMP_ADAPTER *pAd);
 	
@@ -8414,6 +9131,27 @@ bool	RTUSBNeedQueueBackForAgg(
 	IN RTMP_ADAPTER *pAd, 
 	IN unsigned char		BulkOutPipeId);
 
+#ifdef USB_TX_ADAPTIVE_BATCH
+INT RTUSBTxBatchBudget(
+	IN RTMP_ADAPTER *pAd,
+	IN unsigned char BulkOutPipeId,
+	IN INT DefaultBudget);
+
+VOID RTUSBTxBatchFrameWritten(
+	IN RTMP_ADAPTER *pAd,
+	IN unsigned char BulkOutPipeId,
+	IN unsigned int FrameLen);
+
+VOID RTUSBTxBatchUrbSubmit(
+	IN RTMP_ADAPTER *pAd,
+	IN unsigned char BulkOutPipeId,
+	IN unsigned long BulkSize);
+
+VOID RTUSBTxBatchUrbComplete(
+	IN RTMP_ADAPTER *pAd,
+	IN unsigned char BulkOutPipeId);
+#endif /* USB_TX_ADAPTIVE_BATCH */
+
 
 /* Function Prototype in cmm_data_usb.c */
 unsigned short RtmpUSB_WriteSubTxResource(
@@ -8655,6 +9393,20 @@ VOID RTUSBBulkOutDataPacket(
 	IN	unsigned char			BulkOutPipeId,
 	IN	unsigned char			Index);
 
+#ifdef USB_BULK_OUT_SG_SUPPORT
+bool RTUSBBulkOutSgPacket(
+	IN RTMP_ADAPTER *pAd,
+	IN HT_TX_CONTEXT *pHTTXContext,
+	IN TX_BLK *pTxBlk,
+	IN unsigned int HdrLen,
+	IN unsigned int Padding);
+
+VOID RTUSBBulkOutSgComplete(
+	IN RTMP_ADAPTER *pAd,
+	IN HT_TX_CONTEXT *pHTTXContext,
+	IN VOID *pUrb);
+#endif /* USB_BULK_OUT_SG_SUPPORT */
+
 VOID RTUSBBulkOutNullFrame(
 	IN	PRTMP_ADAPTER	pAd);
 
@@ -8683,12 +9435,25 @@ VOID RTUSBKickBulkOut(
 VOID	RTUSBBulkReceive(
 	IN	PRTMP_ADAPTER	pAd);
 
+#ifdef RX_NAPI_SUPPORT
+INT RTUSBBulkRxPoll(
+	IN RTMP_ADAPTER *pAd,
+	IN INT Budget);
+
+bool RTUSBBulkRxPending(
+	IN RTMP_ADAPTER *pAd);
+#endif /* RX_NAPI_SUPPORT */
+
 VOID RTUSBBulkCmdRspEventReceive(
 	IN PRTMP_ADAPTER pAd);
 
 VOID DoBulkIn(
 	IN RTMP_ADAPTER *pAd);
 
+VOID RTUSBBulkRxStat(
+	IN RTMP_ADAPTER *pAd,
+	IN unsigned long BulkInLen);
+
 VOID RTUSBInitRxDesc(
 	IN	PRTMP_ADAPTER	pAd,
 	IN  PRX_CONTEXT		pRxContext);
@@ -8978,6 +9743,10 @@ MAC_TABLE_ENTRY *MacTableInsertEntry(
 	IN unsigned char OpMode,
 	IN bool CleanAll);
 
+INT MacTableNextEntry(MAC_TABLE *pMacTable, INT Wcid);
+VOID MacTableAggUpdate(RTMP_ADAPTER *pAd, MAC_TABLE_ENTRY *pEntry);
+VOID MacTableAggFlagsUpdate(RTMP_ADAPTER *pAd);
+
 
 
 VOID dumpTxWI(RTMP_ADAPTER *pAd, TXWI_STRUC *pTxWI);
@@ -134,4 +134,10 @@ INT AndesPwrSavingOP(PRTMP_ADAPTER pAd, unsigned int PwrOP, unsigned int PwrLeve
 void AndesCalibrationOP(PRTMP_ADAPTER, unsigned int CalibrationID, unsigned int Param);
 bool IsInBandCmdProcessing(PRTMP_ADAPTER pAd);
 unsigned char GetCmdRspNum(PRTMP_ADAPTER pAd);
+#ifdef MCU_ASYNC_CMD_SUPPORT
+VOID AndesBatchBegin(PRTMP_ADAPTER pAd);
+INT AndesBatchEnd(PRTMP_ADAPTER pAd);
+VOID AndesBatchSync(PRTMP_ADAPTER pAd);
+INT Show_McuCmd_Proc(PRTMP_ADAPTER pAd, char *arg);
+#endif /* MCU_ASYNC_CMD_SUPPORT */
 #endif
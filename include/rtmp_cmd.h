@@ -408,6 +408,8 @@ typedef struct __RT_CMD_USB_DEV_CONFIG {
 	IN unsigned char BulkOutEpAddr[6];
 	IN unsigned short BulkOutMaxPacketSize;
 	IN VOID *pConfig;
+	IN unsigned int RxUrbNum;	/* max bulk-in URBs in flight */
+	IN unsigned int RxBulkAgg;	/* bulk-in buffer size in LOCAL_TXBUF_SIZE units */
 } RT_CMD_USB_DEV_CONFIG;
 
 typedef struct __RT_CMD_CFG80211_CONFIG {
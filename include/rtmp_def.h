@@ -80,6 +80,11 @@
 #define RX_RING_SIZE            8
 #endif /* INF_AMAZON_SE */
 #define MAX_TX_PROCESS          4
+#define TX_DEQUEUE_BATCH_NUM    8	/* frames taken off a TxSwQueue per irq_lock section */
+#define TX_BATCH_MAX_FRAMES     32	/* ceiling of the adaptive dequeue budget of an AC */
+#define TX_BATCH_URB_MAX_SIZE   0x6000	/* largest bulk-out the adaptive batching aims for */
+#define TX_BATCH_FRAME_OVERHEAD 64	/* TXINFO, TXWI, 802.11 header and padding of a frame in the ring */
+#define TX_BATCH_URB_BUCKET     8	/* 4 KB wide buckets of the bytes-per-URB histogram */
 #define LOCAL_TXBUF_SIZE        2048
 #endif /* RTMP_MAC_USB */
 
@@ -66,10 +66,34 @@ struct CMD_UNIT {
 };
 
 
+#ifdef MCU_ASYNC_CMD_SUPPORT
+#define MCU_CMD_SLOT_NUM		8	/* command URBs in flight without waiting on each */
+#define MCU_CMD_SLOT_LEN		512
+#define MCU_BATCH_BUF_LEN		256	/* >= InbandPacketMaxLen */
+#endif /* MCU_ASYNC_CMD_SUPPORT */
+
 struct MCU_CTRL {
 	unsigned char CmdSeq;
 	NDIS_SPIN_LOCK CmdRspEventListLock;
 	DL_LIST CmdRspEventList;
+#ifdef MCU_ASYNC_CMD_SUPPORT
+	/* CMD_RANDOM_WRITE payloads posted between AndesBatchBegin() and AndesBatchEnd() */
+	RTMP_OS_SEM BatchLock;
+	unsigned int BatchDepth;
+	unsigned int BatchLen;
+	unsigned char BatchBuf[MCU_BATCH_BUF_LEN];
+
+	unsigned long CmdCnt;		/* commands sent to the MCU */
+	unsigned long FencedCmdCnt;	/* CmdCnt of the last command whose response came back */
+	unsigned long AsyncKickCnt;	/* sent without waiting for their URB */
+	unsigned long SyncKickCnt;	/* all slots busy, waited for the URB */
+	unsigned long BatchPairCnt;	/* register writes that went through the batch */
+	unsigned long BatchCmdCnt;	/* commands the batch turned them into */
+	unsigned long SwitchChCnt;
+	unsigned long SwitchChCmds;	/* commands of the last channel switch */
+	unsigned long SwitchChCmdTotal;
+	unsigned int SwitchChUsec;	/* duration of the last channel switch */
+#endif /* MCU_ASYNC_CMD_SUPPORT */
 };
 
 
@@ -81,6 +105,9 @@ struct CMD_RSP_EVENT {
 	void *	AckDone;
 	unsigned char **RspPayload;
 	unsigned short *RspPayloadLen;
+#ifdef MCU_ASYNC_CMD_SUPPORT
+	unsigned long CmdCnt;	/* MCU_CTRL CmdCnt when it was sent */
+#endif /* MCU_ASYNC_CMD_SUPPORT */
 };
 
 VOID ChipOpsMCUHook(struct _RTMP_ADAPTER *pAd, enum MCU_TYPE MCUType);
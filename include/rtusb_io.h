@@ -89,6 +89,14 @@
 
 #define CMDTHREAD_RESPONSE_EVENT_CALLBACK			0x0D730123
 
+#ifdef HDR_TRANS_SUPPORT
+#define CMDTHREAD_SET_HDR_TRANS_WCID				0x0D730124
+#endif /* HDR_TRANS_SUPPORT */
+
+#ifdef ASSOC_STORM_SUPPORT
+#define CMDTHREAD_FLUSH_WCID_TAB					0x0D730125
+#endif /* ASSOC_STORM_SUPPORT */
+
 
 typedef struct _CMDHandler_TLV {
 	unsigned short Offset;
@@ -84,6 +84,283 @@ static NDIS_STATUS USBLoadIVB(RTMP_ADAPTER *pAd)
 }
 
 
+#ifdef FW_FAST_LOAD_SUPPORT
+/*
+	Firmware upload for FW_FAST_LOAD_SUPPORT.
+
+	The FCE has a single DMA descriptor (TX_CPU_PORT_FROM_FCE_MAX_COUNT
+	is 1), so the chunks still reach the MCU one after the other. What
+	overlaps is the host side: the next chunk is copied into the second
+	buffer while the current one is on the bus. COM_REG0, and after ILM
+	chunks the DMA done bit, are polled every millisecond instead of the
+	fixed 5ms and 10ms sleeps. DDONE is only known to be valid for ILM,
+	so DLM chunks keep the fixed 5ms.
+*/
+#define FW_CHUNK_LEN		14336
+#define FW_CHUNK_BUF_LEN	14592
+#define FW_CHUNK_BUF_NUM	2
+
+typedef struct _FW_LOAD_CTRL {
+	PURB pURB;
+	VOID *pDone;
+	unsigned char *pBuf[FW_CHUNK_BUF_NUM];
+	ra_dma_addr_t BufDMA[FW_CHUNK_BUF_NUM];
+} FW_LOAD_CTRL;
+
+
+/* TXINFO, the chunk, padding to a dword and the 4 byte end mark */
+static unsigned int USBFwChunkFill(unsigned char *pBuf, unsigned char *pSrc, unsigned int Len)
+{
+	TXINFO_NMAC_CMD *TxInfoCmd = (TXINFO_NMAC_CMD *)pBuf;
+	unsigned int PadLen = (Len + 3) & ~3;
+
+	NdisZeroMemory(TxInfoCmd, sizeof(*TxInfoCmd));
+	TxInfoCmd->info_type = CMD_PACKET;
+	TxInfoCmd->pkt_len = Len;
+	TxInfoCmd->d_port = CPU_TX_PORT;
+#ifdef RT_BIG_ENDIAN
+	RTMPDescriptorEndianChange((unsigned char *)TxInfoCmd, TYPE_TXINFO);
+#endif
+
+	NdisMoveMemory(pBuf + sizeof(*TxInfoCmd), pSrc, Len);
+	NdisZeroMemory(pBuf + sizeof(*TxInfoCmd) + Len, PadLen - Len + 4);
+
+	return PadLen;
+}
+
+
+/* a 32-bit FCE DMA register, as two 16-bit halves */
+static NDIS_STATUS USBFwFceWrite(RTMP_ADAPTER *pAd, unsigned short Offset, unsigned int Value)
+{
+	NDIS_STATUS Status;
+
+	Status = RTUSB_VendorRequest(pAd,
+								 USBD_TRANSFER_DIRECTION_OUT,
+								 DEVICE_VENDOR_REQUEST_OUT,
+								 0x42,
+								 Value & 0xFFFF,
+								 Offset,
+								 NULL,
+								 0);
+
+	if (Status == NDIS_STATUS_SUCCESS)
+		Status = RTUSB_VendorRequest(pAd,
+									 USBD_TRANSFER_DIRECTION_OUT,
+									 DEVICE_VENDOR_REQUEST_OUT,
+									 0x42,
+									 (Value >> 16) & 0xFFFF,
+									 Offset + 2,
+									 NULL,
+									 0);
+
+	return Status;
+}
+
+
+static NDIS_STATUS USBFwChunkSend(RTMP_ADAPTER *pAd, FW_LOAD_CTRL *pCtrl, INT Buf,
+									unsigned int Dest, unsigned int PadLen)
+{
+	POS_COOKIE pObj = (POS_COOKIE) pAd->OS_Cookie;
+	RTMP_CHIP_CAP *pChipCap = &pAd->chipCap;
+	NDIS_STATUS Status;
+
+	/* FCE DMA descriptor and length */
+	Status = USBFwFceWrite(pAd, 0x230, Dest);
+	if (Status == NDIS_STATUS_SUCCESS)
+		Status = USBFwFceWrite(pAd, 0x234, PadLen << 16);
+
+	if (Status)
+	{
+		DBGPRINT(RT_DEBUG_ERROR, ("Set FCE DMA descriptor fail\n"));
+		return Status;
+	}
+
+	RTUSB_FILL_HTTX_BULK_URB(pCtrl->pURB,
+							 pObj->pUsb_Dev,
+							 pChipCap->CommandBulkOutAddr,
+							 pCtrl->pBuf[Buf],
+							 PadLen + sizeof(TXINFO_NMAC_CMD) + 4,
+							 USBUploadFWComplete,
+							 pCtrl->pDone,
+							 pCtrl->BufDMA[Buf]);
+
+	Status = RTUSB_SUBMIT_URB(pCtrl->pURB);
+
+	if (Status)
+		DBGPRINT(RT_DEBUG_ERROR, ("SUBMIT URB fail\n"));
+
+	return Status;
+}
+
+
+static NDIS_STATUS USBFwChunkWait(RTMP_ADAPTER *pAd, FW_LOAD_CTRL *pCtrl, bool bPollDone)
+{
+	unsigned int MACValue, Loop;
+
+	if (!RtmpWaitForCompletionTimeout(pCtrl->pDone, RtmpMsecsToJiffies(1000)))
+	{
+		RTUSB_UNLINK_URB(pCtrl->pURB);
+		DBGPRINT(RT_DEBUG_ERROR, ("Upload FW timeout\n"));
+		return NDIS_STATUS_FAILURE;
+	}
+
+	RTMP_IO_READ32(pAd, TX_CPU_PORT_FROM_FCE_CPU_DESC_INDEX, &MACValue);
+	MACValue++;
+	RTMP_IO_WRITE32(pAd, TX_CPU_PORT_FROM_FCE_CPU_DESC_INDEX, MACValue);
+
+	if (!bPollDone)
+	{
+		RtmpOsMsDelay(5);
+		return NDIS_STATUS_SUCCESS;
+	}
+
+	/* DDONE 0x400234, bit[31] */
+	for (Loop = 0; Loop < 500; Loop++)
+	{
+		RTMP_IO_READ32(pAd, COM_REG1, &MACValue);
+		if (MACValue & 0x80000000)
+			break;
+		RtmpOsMsDelay(1);
+	}
+
+	return NDIS_STATUS_SUCCESS;
+}
+
+
+static NDIS_STATUS USBFwSegmentLoad(RTMP_ADAPTER *pAd, FW_LOAD_CTRL *pCtrl,
+									unsigned char *pSrc, unsigned int Len, unsigned int Dest,
+									bool bPollDone)
+{
+	unsigned int CurLen = 0, SentLen, NextLen, PadLen, NextPadLen = 0;
+	INT Buf = 0;
+	NDIS_STATUS Status;
+
+	if (Len == 0)
+		return NDIS_STATUS_SUCCESS;
+
+	SentLen = (Len > FW_CHUNK_LEN) ? FW_CHUNK_LEN : Len;
+	PadLen = USBFwChunkFill(pCtrl->pBuf[Buf], pSrc, SentLen);
+
+	while (1)
+	{
+		Status = USBFwChunkSend(pAd, pCtrl, Buf, Dest + CurLen, PadLen);
+		if (Status != NDIS_STATUS_SUCCESS)
+			return Status;
+
+		CurLen += SentLen;
+
+		/* copy the next chunk while this one is on the bus */
+		NextLen = ((Len - CurLen) > FW_CHUNK_LEN) ? FW_CHUNK_LEN : (Len - CurLen);
+		if (NextLen > 0)
+			NextPadLen = USBFwChunkFill(pCtrl->pBuf[Buf ^ 1], pSrc + CurLen, NextLen);
+
+		Status = USBFwChunkWait(pAd, pCtrl, bPollDone);
+		if ((Status != NDIS_STATUS_SUCCESS) || (NextLen == 0))
+			return Status;
+
+		DBGPRINT(RT_DEBUG_INFO, ("%s: Len = %d, CurLen = %d\n", __FUNCTION__, Len, CurLen));
+
+		Buf ^= 1;
+		SentLen = NextLen;
+		PadLen = NextPadLen;
+	}
+}
+
+
+/* ILM, DLM, interrupt vector, then wait for the MCU */
+static NDIS_STATUS USBLoadFwFast(RTMP_ADAPTER *pAd, unsigned int ILMLen, unsigned int DLMLen)
+{
+	POS_COOKIE pObj = (POS_COOKIE) pAd->OS_Cookie;
+	RTMP_CHIP_CAP *pChipCap = &pAd->chipCap;
+	unsigned char *pImage = pChipCap->FWImageName + 32;
+	FW_LOAD_CTRL Ctrl;
+	NDIS_STATUS Status = NDIS_STATUS_RESOURCES;
+	unsigned int MACValue = 0, Loop;
+	INT i;
+#ifdef BOOT_PROF_SUPPORT
+	unsigned int Begin;
+#endif /* BOOT_PROF_SUPPORT */
+
+	NdisZeroMemory(&Ctrl, sizeof(Ctrl));
+
+	Ctrl.pURB = RTUSB_ALLOC_URB(0);
+	if (Ctrl.pURB == NULL)
+		goto done;
+
+	for (i = 0; i < FW_CHUNK_BUF_NUM; i++)
+	{
+		Ctrl.pBuf[i] = RTUSB_URB_ALLOC_BUFFER(pObj->pUsb_Dev, FW_CHUNK_BUF_LEN, &Ctrl.BufDMA[i]);
+		if (Ctrl.pBuf[i] == NULL)
+			goto done;
+	}
+
+	Ctrl.pDone = RtmpInitCompletion();
+	if (Ctrl.pDone == NULL)
+		goto done;
+
+	DBGPRINT(RT_DEBUG_OFF, ("Loading FW\n"));
+
+	/* the first 64 bytes of the ILM are the interrupt vector, it goes last */
+#ifdef BOOT_PROF_SUPPORT
+	BOOT_PROF_STEP_BEGIN(Begin);
+#endif /* BOOT_PROF_SUPPORT */
+	Status = USBFwSegmentLoad(pAd, &Ctrl, pImage + 0x40, ILMLen - 0x40, 0x40, TRUE);
+#ifdef BOOT_PROF_SUPPORT
+	BootProfStepEnd(pAd, BOOT_PROF_FW_ILM, Begin);
+#endif /* BOOT_PROF_SUPPORT */
+	if (Status != NDIS_STATUS_SUCCESS)
+		goto done;
+
+#ifdef BOOT_PROF_SUPPORT
+	BOOT_PROF_STEP_BEGIN(Begin);
+#endif /* BOOT_PROF_SUPPORT */
+	Status = USBFwSegmentLoad(pAd, &Ctrl, pImage + ILMLen, DLMLen, 0x80000, FALSE);
+#ifdef BOOT_PROF_SUPPORT
+	BootProfStepEnd(pAd, BOOT_PROF_FW_DLM, Begin);
+#endif /* BOOT_PROF_SUPPORT */
+	if (Status != NDIS_STATUS_SUCCESS)
+		goto done;
+
+	Status = USBLoadIVB(pAd);
+	if (Status != NDIS_STATUS_SUCCESS)
+		goto done;
+
+#ifdef BOOT_PROF_SUPPORT
+	BOOT_PROF_STEP_BEGIN(Begin);
+#endif /* BOOT_PROF_SUPPORT */
+	for (Loop = 0; Loop < 1000; Loop++)
+	{
+		RTMP_IO_READ32(pAd, COM_REG0, &MACValue);
+		if (MACValue == 0x1)
+			break;
+		RtmpOsMsDelay(1);
+	}
+#ifdef BOOT_PROF_SUPPORT
+	BootProfStepEnd(pAd, BOOT_PROF_FW_READY, Begin);
+#endif /* BOOT_PROF_SUPPORT */
+
+	DBGPRINT(RT_DEBUG_TRACE, ("%s: COM_REG0(0x%x) = 0x%x\n", __FUNCTION__, COM_REG0, MACValue));
+
+	Status = (MACValue == 0x1) ? NDIS_STATUS_SUCCESS : NDIS_STATUS_FAILURE;
+
+done:
+	if (Ctrl.pDone != NULL)
+		os_free_mem(NULL, Ctrl.pDone);
+
+	for (i = 0; i < FW_CHUNK_BUF_NUM; i++)
+	{
+		if (Ctrl.pBuf[i] != NULL)
+			RTUSB_URB_FREE_BUFFER(pObj->pUsb_Dev, FW_CHUNK_BUF_LEN, Ctrl.pBuf[i], Ctrl.BufDMA[i]);
+	}
+
+	if (Ctrl.pURB != NULL)
+		RTUSB_FREE_URB(Ctrl.pURB);
+
+	return Status;
+}
+#endif /* FW_FAST_LOAD_SUPPORT */
+
+
 int USBLoadFirmwareToAndes(RTMP_ADAPTER *pAd)
 {
 	PURB pURB;
@@ -122,7 +399,16 @@ loadfw_protect:
 	RTUSBReadMACRegister(pAd, COM_REG0, &MACValue);
 
 	if (MACValue == 0x01)
+	{
+		/*
+			The MCU reports no version of what it runs, so a running
+			firmware is trusted as is.
+		*/
+#ifdef BOOT_PROF_SUPPORT
+		pAd->bBootProfFwSkipped = TRUE;
+#endif /* BOOT_PROF_SUPPORT */
 		goto error0;
+	}
 
 	RTUSBVenderReset(pAd);
 	//mdelay(5);
@@ -195,6 +481,9 @@ loadfw_protect:
 	/* FCE skip_fs_en */
 	RTMP_IO_WRITE32(pAd, FCE_SKIP_FS, 0x03);
 
+#ifdef FW_FAST_LOAD_SUPPORT
+	Status = USBLoadFwFast(pAd, ILMLen, DLMLen);
+#else
 	/* Allocate URB */
 	pURB = RTUSB_ALLOC_URB(0);
 
@@ -563,6 +852,7 @@ error2:
 error1:
 	/* Free URB */
 	RTUSB_FREE_URB(pURB);
+#endif /* FW_FAST_LOAD_SUPPORT */
 
 error0: 	
 	if (pChipCap->IsComboChip)
@@ -572,6 +862,60 @@ error0:
 #endif /* RTMP_USB_SUPPORT */
 
 
+#if defined(MCU_ASYNC_CMD_SUPPORT) && defined(RTMP_USB_SUPPORT)
+/* URBs and buffers for USBKickOutCmdAsync(), a slot that fails to allocate stays unused */
+static VOID USBCmdContextInit(PRTMP_ADAPTER pAd)
+{
+	POS_COOKIE pObj = (POS_COOKIE) pAd->OS_Cookie;
+	PCMD_CONTEXT pCmdContext;
+	INT i;
+
+	for (i = 0; i < MCU_CMD_SLOT_NUM; i++)
+	{
+		pCmdContext = &pAd->McuCmdContext[i];
+		NdisZeroMemory(pCmdContext, sizeof(*pCmdContext));
+		pCmdContext->pAd = pAd;
+
+		pCmdContext->pUrb = RTUSB_ALLOC_URB(0);
+		if (pCmdContext->pUrb == NULL)
+			continue;
+
+		pCmdContext->TransferBuffer = RTUSB_URB_ALLOC_BUFFER(pObj->pUsb_Dev, MCU_CMD_SLOT_LEN,
+														&pCmdContext->data_dma);
+		if (pCmdContext->TransferBuffer == NULL)
+		{
+			RTUSB_FREE_URB(pCmdContext->pUrb);
+			pCmdContext->pUrb = NULL;
+		}
+	}
+}
+
+
+static VOID USBCmdContextExit(PRTMP_ADAPTER pAd)
+{
+	POS_COOKIE pObj = (POS_COOKIE) pAd->OS_Cookie;
+	PCMD_CONTEXT pCmdContext;
+	INT i;
+
+	for (i = 0; i < MCU_CMD_SLOT_NUM; i++)
+	{
+		pCmdContext = &pAd->McuCmdContext[i];
+		if (pCmdContext->pUrb == NULL)
+			continue;
+
+		if (pCmdContext->IRPPending)
+			RTUSB_UNLINK_URB(pCmdContext->pUrb);
+
+		RTUSB_URB_FREE_BUFFER(pObj->pUsb_Dev, MCU_CMD_SLOT_LEN,
+								pCmdContext->TransferBuffer, pCmdContext->data_dma);
+		RTUSB_FREE_URB(pCmdContext->pUrb);
+		pCmdContext->pUrb = NULL;
+		pCmdContext->TransferBuffer = NULL;
+	}
+}
+#endif /* MCU_ASYNC_CMD_SUPPORT && RTMP_USB_SUPPORT */
+
+
 VOID MCUCtrlInit(PRTMP_ADAPTER pAd)
 {
 	struct MCU_CTRL *MCtrl = &pAd->MCUCtrl;
@@ -582,6 +926,12 @@ VOID MCUCtrlInit(PRTMP_ADAPTER pAd)
 	RTMP_CLEAR_FLAG(pAd, fRTMP_ADAPTER_MCU_SEND_IN_BAND_CMD);
 	NdisAllocateSpinLock(pAd, &MCtrl->CmdRspEventListLock);
 	DlListInit(&MCtrl->CmdRspEventList);
+#ifdef MCU_ASYNC_CMD_SUPPORT
+	RTMP_SEM_EVENT_INIT(&MCtrl->BatchLock, &pAd->RscSemMemList);
+#ifdef RTMP_USB_SUPPORT
+	USBCmdContextInit(pAd);
+#endif /* RTMP_USB_SUPPORT */
+#endif /* MCU_ASYNC_CMD_SUPPORT */
 }
 
 
@@ -599,11 +949,22 @@ VOID MCUCtrlExit(PRTMP_ADAPTER pAd)
 		if (!CmdRspEvent->NeedWait)
 		{
 			DlListDel(&CmdRspEvent->List);
+#ifdef MEM_POOL_SUPPORT
+			McuRspEventFree(pAd, CmdRspEvent);
+#else
 			os_free_mem(NULL, CmdRspEvent);
+#endif /* MEM_POOL_SUPPORT */
 		}
 	}
 	RTMP_IRQ_UNLOCK(&MCtrl->CmdRspEventListLock, IrqFlags);
 
+#ifdef MCU_ASYNC_CMD_SUPPORT
+#ifdef RTMP_USB_SUPPORT
+	USBCmdContextExit(pAd);
+#endif /* RTMP_USB_SUPPORT */
+	RTMP_SEM_EVENT_DESTORY(&MCtrl->BatchLock);
+#endif /* MCU_ASYNC_CMD_SUPPORT */
+
 	NdisFreeSpinLock(&MCtrl->CmdRspEventListLock);
 	NdisZeroMemory(MCtrl, sizeof(*MCtrl));
 }
@@ -772,10 +1133,138 @@ error1:
 error0: 
 	return Status;
 }
+
+
+#ifdef MCU_ASYNC_CMD_SUPPORT
+USBHST_STATUS USBKickOutCmdAsyncComplete(URBCompleteStatus Status, purbb_t pURB, pregs *pt_regs)
+{
+	PCMD_CONTEXT pCmdContext = (PCMD_CONTEXT)RTMP_OS_USB_CONTEXT_GET(pURB);
+	PRTMP_ADAPTER pAd = (PRTMP_ADAPTER)pCmdContext->pAd;
+	unsigned long IrqFlags;
+
+	if (RTMP_USB_URB_STATUS_GET(pURB) != 0)
+		DBGPRINT(RT_DEBUG_ERROR, ("%s: status %d\n", __FUNCTION__, RTMP_USB_URB_STATUS_GET(pURB)));
+
+	RTMP_IRQ_LOCK(&pAd->MCUCtrl.CmdRspEventListLock, IrqFlags);
+	pCmdContext->IRPPending = FALSE;
+	RTMP_IRQ_UNLOCK(&pAd->MCUCtrl.CmdRspEventListLock, IrqFlags);
+}
+
+
+/*
+	Like USBKickOutCmd() but returns once the URB is submitted. The command
+	pipe delivers in order, so a later command that waits for its response
+	also waits for everything kicked before it. With all slots busy this
+	falls back to USBKickOutCmd().
+*/
+INT USBKickOutCmdAsync(PRTMP_ADAPTER pAd, unsigned char *Buf, unsigned int Len)
+{
+	struct MCU_CTRL *MCtrl = &pAd->MCUCtrl;
+	POS_COOKIE pObj = (POS_COOKIE) pAd->OS_Cookie;
+	PCMD_CONTEXT pCmdContext = NULL;
+	unsigned long IrqFlags;
+	INT i, Status;
+
+	if ((Len + 4) <= MCU_CMD_SLOT_LEN)
+	{
+		RTMP_IRQ_LOCK(&MCtrl->CmdRspEventListLock, IrqFlags);
+		for (i = 0; i < MCU_CMD_SLOT_NUM; i++)
+		{
+			if ((pAd->McuCmdContext[i].pUrb != NULL) && !pAd->McuCmdContext[i].IRPPending)
+			{
+				pCmdContext = &pAd->McuCmdContext[i];
+				pCmdContext->IRPPending = TRUE;
+				break;
+			}
+		}
+		RTMP_IRQ_UNLOCK(&MCtrl->CmdRspEventListLock, IrqFlags);
+	}
+
+	if (pCmdContext == NULL)
+	{
+		MCtrl->SyncKickCnt++;
+		return USBKickOutCmd(pAd, Buf, Len);
+	}
+
+	NdisMoveMemory(pCmdContext->TransferBuffer, Buf, Len);
+	NdisZeroMemory(pCmdContext->TransferBuffer + Len, 4);
+
+	RTUSB_FILL_HTTX_BULK_URB(pCmdContext->pUrb,
+							 pObj->pUsb_Dev,
+							 pAd->chipCap.CommandBulkOutAddr,
+							 pCmdContext->TransferBuffer,
+							 Len + 4,
+							 USBKickOutCmdAsyncComplete,
+							 pCmdContext,
+							 pCmdContext->data_dma);
+
+	Status = RTUSB_SUBMIT_URB(pCmdContext->pUrb);
+	if (Status)
+	{
+		DBGPRINT(RT_DEBUG_ERROR, ("%s: SUBMIT URB fail(%d)\n", __FUNCTION__, Status));
+		RTMP_IRQ_LOCK(&MCtrl->CmdRspEventListLock, IrqFlags);
+		pCmdContext->IRPPending = FALSE;
+		RTMP_IRQ_UNLOCK(&MCtrl->CmdRspEventListLock, IrqFlags);
+		return NDIS_STATUS_FAILURE;
+	}
+
+	MCtrl->AsyncKickCnt++;
+	return NDIS_STATUS_SUCCESS;
+}
+#endif /* MCU_ASYNC_CMD_SUPPORT */
 #endif /* RTMP_MAC_USB */
 
 
+/* wait for the response of a NeedWait command and drop its event */
+static INT AndesCmdWait(PRTMP_ADAPTER pAd, struct CMD_UNIT *CmdUnit, struct CMD_RSP_EVENT *CmdRspEvent)
+{
+	struct MCU_CTRL *MCtrl = &pAd->MCUCtrl;
+	unsigned long Timeout = CmdUnit->u.ANDES.Timeout;
+	unsigned long Expire;
+	unsigned long IrqFlags;
+	INT Ret = NDIS_STATUS_SUCCESS;
+
+	Expire = Timeout ? RtmpMsecsToJiffies(Timeout) : RtmpMsecsToJiffies(300);
+	if (!RtmpWaitForCompletionTimeout(CmdRspEvent->AckDone, Expire))
+	{
+		Ret = NDIS_STATUS_FAILURE;
+		DBGPRINT(RT_DEBUG_ERROR, ("Wait for command response timeout(300ms)\n"));
+	}
+#ifdef MCU_ASYNC_CMD_SUPPORT
+	/*
+		Responses come back in order, so everything sent up to this one has
+		been run. Racing waiters may leave an older count, which only costs
+		AndesBatchSync() an extra fence.
+	*/
+	else if ((long)(CmdRspEvent->CmdCnt - MCtrl->FencedCmdCnt) > 0)
+	{
+		MCtrl->FencedCmdCnt = CmdRspEvent->CmdCnt;
+	}
+#endif /* MCU_ASYNC_CMD_SUPPORT */
+
+	RTMP_IRQ_LOCK(&MCtrl->CmdRspEventListLock, IrqFlags);
+	DlListDel(&CmdRspEvent->List);
+	os_free_mem(NULL, CmdRspEvent->AckDone);
+#ifdef MEM_POOL_SUPPORT
+	McuRspEventFree(pAd, CmdRspEvent);
+#else
+	os_free_mem(NULL, CmdRspEvent);
+#endif /* MEM_POOL_SUPPORT */
+	RTMP_IRQ_UNLOCK(&MCtrl->CmdRspEventListLock, IrqFlags);
+
+	return Ret;
+}
+
+
+#ifdef MCU_ASYNC_CMD_SUPPORT
+/*
+	Send a command. For NeedWait the response event is handed back in
+	*ppWaitEvent, so the caller can drop BatchLock before AndesCmdWait().
+*/
+static INT AndesSendCmd(PRTMP_ADAPTER pAd, struct CMD_UNIT *CmdUnit, struct CMD_RSP_EVENT **ppWaitEvent)
+#else
 INT AsicSendCmdToAndes(PRTMP_ADAPTER pAd, struct CMD_UNIT *CmdUnit)
+#endif /* MCU_ASYNC_CMD_SUPPORT */
 {
 	unsigned int VarLen;
 	unsigned char *Pos, *Buf;
@@ -783,9 +1272,16 @@ INT AsicSendCmdToAndes(PRTMP_ADAPTER pAd, struct CMD_UNIT *CmdUnit)
 	int Ret = NDIS_STATUS_SUCCESS;
 	struct MCU_CTRL *MCtrl = &pAd->MCUCtrl;
 	struct CMD_RSP_EVENT *CmdRspEvent;
-	unsigned long Expire;
 	unsigned long IrqFlags;
 
+#ifdef MCU_ASYNC_CMD_SUPPORT
+	*ppWaitEvent = NULL;
+#endif /* MCU_ASYNC_CMD_SUPPORT */
+
+#if defined(REG_DEFER_SUPPORT) && !defined(MCU_ASYNC_CMD_SUPPORT)
+	RegDeferSync(pAd);
+#endif /* REG_DEFER_SUPPORT && !MCU_ASYNC_CMD_SUPPORT */
+
 	if (!RTMP_TEST_FLAG(pAd, fRTMP_ADAPTER_MCU_SEND_IN_BAND_CMD))
 	{
 		DBGPRINT(RT_DEBUG_ERROR, ("%s: !fRTMP_ADAPTER_MCU_SEND_IN_BAND_CMD && fRTMP_ADAPTER_IDLE_RADIO_OFF\n", __FUNCTION__));
@@ -800,7 +1296,11 @@ INT AsicSendCmdToAndes(PRTMP_ADAPTER pAd, struct CMD_UNIT *CmdUnit)
 
 	VarLen = sizeof(*TxInfoCmd) + CmdUnit->u.ANDES.CmdPayloadLen;
 
+#ifdef MEM_POOL_SUPPORT
+	Buf = (unsigned char *)McuCmdBufAlloc(pAd, VarLen);
+#else
 	os_alloc_mem(pAd, (unsigned char **)&Buf, VarLen);
+#endif /* MEM_POOL_SUPPORT */
 	
 	NdisZeroMemory(Buf, VarLen);
 
@@ -816,7 +1316,11 @@ INT AsicSendCmdToAndes(PRTMP_ADAPTER pAd, struct CMD_UNIT *CmdUnit)
 
 		//printk("cmd seq = %d\n", TxInfoCmd->cmd_seq);
 
+#ifdef MEM_POOL_SUPPORT
+		CmdRspEvent = (struct CMD_RSP_EVENT *)McuRspEventAlloc(pAd);
+#else
 		os_alloc_mem(NULL, (unsigned char **)&CmdRspEvent, sizeof(*CmdRspEvent));
+#endif /* MEM_POOL_SUPPORT */
 
 		if (!CmdRspEvent)
 		{
@@ -858,33 +1362,261 @@ INT AsicSendCmdToAndes(PRTMP_ADAPTER pAd, struct CMD_UNIT *CmdUnit)
 	NdisMoveMemory(Pos, CmdUnit->u.ANDES.CmdPayload, CmdUnit->u.ANDES.CmdPayloadLen);
 	
 #ifdef RTMP_USB_SUPPORT
+#ifdef MCU_ASYNC_CMD_SUPPORT
+	/* a waiting caller waits for the response, which comes after the URB anyway */
+	MCtrl->CmdCnt++;
+	USBKickOutCmdAsync(pAd, Buf, VarLen);
+#else
 	USBKickOutCmd(pAd, Buf, VarLen);
+#endif /* MCU_ASYNC_CMD_SUPPORT */
 #endif
 
 
 	/* Wait for Command Rsp */
-	if (CmdUnit->u.ANDES.NeedWait) {
-		unsigned long Timeout = CmdUnit->u.ANDES.Timeout;
-		Expire = Timeout ? RtmpMsecsToJiffies(Timeout) : RtmpMsecsToJiffies(300);
-		if (!RtmpWaitForCompletionTimeout(CmdRspEvent->AckDone, Expire))
-		{
-			Ret = NDIS_STATUS_FAILURE;
-			DBGPRINT(RT_DEBUG_ERROR, ("Wait for command response timeout(300ms)\n"));
-		}
-	
-		RTMP_IRQ_LOCK(&MCtrl->CmdRspEventListLock, IrqFlags);
-		DlListDel(&CmdRspEvent->List);
-		os_free_mem(NULL, CmdRspEvent->AckDone);
-		os_free_mem(NULL, CmdRspEvent);
-		RTMP_IRQ_UNLOCK(&MCtrl->CmdRspEventListLock, IrqFlags);
+	if (CmdUnit->u.ANDES.NeedWait)
+	{
+#ifdef MCU_ASYNC_CMD_SUPPORT
+		CmdRspEvent->CmdCnt = MCtrl->CmdCnt;
+		*ppWaitEvent = CmdRspEvent;
+#else
+		Ret = AndesCmdWait(pAd, CmdUnit, CmdRspEvent);
+#endif /* MCU_ASYNC_CMD_SUPPORT */
 	}
 
 error:
+#ifdef MEM_POOL_SUPPORT
+	McuCmdBufFree(pAd, Buf);
+#else
 	os_free_mem(NULL, Buf);
+#endif /* MEM_POOL_SUPPORT */
+
+	return Ret;
+}
+
+
+#ifdef MCU_ASYNC_CMD_SUPPORT
+/*
+	Register write batching.
+
+	Between AndesBatchBegin() and AndesBatchEnd() the payload of every
+	CMD_RANDOM_WRITE (MAC, BBP and RF pairs alike) is appended to
+	MCtrl->BatchBuf instead of being sent, and goes out as
+	InbandPacketMaxLen sized commands without waiting for a response.
+	Any other command sends the pending pairs first so the MCU still sees
+	the writes in program order. AndesBatchEnd() sends the rest and waits
+	for the response, so on return every write has been applied.
+
+	BatchLock only covers building and submitting commands. Responses are
+	waited for after it is released, so one caller waiting up to 300ms
+	does not hold up the others.
+
+	Call with BatchLock held. For bWait, CmdUnit must stay valid until
+	AndesCmdWait() on *ppWaitEvent has returned.
+*/
+static INT AndesBatchSendLocked(PRTMP_ADAPTER pAd, bool bWait,
+	struct CMD_UNIT *CmdUnit, struct CMD_RSP_EVENT **ppWaitEvent)
+{
+	struct MCU_CTRL *MCtrl = &pAd->MCUCtrl;
+	INT Ret;
+
+	*ppWaitEvent = NULL;
+
+	if (MCtrl->BatchLen == 0)
+		return NDIS_STATUS_SUCCESS;
+
+	NdisZeroMemory(CmdUnit, sizeof(*CmdUnit));
+	CmdUnit->u.ANDES.Type = CMD_RANDOM_WRITE;
+	CmdUnit->u.ANDES.CmdPayloadLen = MCtrl->BatchLen;
+	CmdUnit->u.ANDES.CmdPayload = MCtrl->BatchBuf;
+
+	if (bWait)
+	{
+		CmdUnit->u.ANDES.NeedRsp = TRUE;
+		CmdUnit->u.ANDES.NeedWait = TRUE;
+		CmdUnit->u.ANDES.Timeout = 0;
+	}
+
+	/* the payload is copied into the command buffer, BatchBuf is free again */
+	Ret = AndesSendCmd(pAd, CmdUnit, ppWaitEvent);
+	MCtrl->BatchLen = 0;
+	MCtrl->BatchCmdCnt++;
+
+	return Ret;
+}
+
+
+static INT AndesBatchAdd(PRTMP_ADAPTER pAd, struct CMD_UNIT *CmdUnit)
+{
+	struct MCU_CTRL *MCtrl = &pAd->MCUCtrl;
+	struct CMD_UNIT FlushUnit;
+	struct CMD_RSP_EVENT *WaitEvent;
+	unsigned int Len = CmdUnit->u.ANDES.CmdPayloadLen;
+	INT Ret = NDIS_STATUS_SUCCESS;
+
+	if ((MCtrl->BatchLen + Len) > pAd->chipCap.InbandPacketMaxLen)
+		Ret = AndesBatchSendLocked(pAd, FALSE, &FlushUnit, &WaitEvent);
+
+	NdisMoveMemory(&MCtrl->BatchBuf[MCtrl->BatchLen], CmdUnit->u.ANDES.CmdPayload, Len);
+	MCtrl->BatchLen += Len;
+	MCtrl->BatchPairCnt += (Len / 8);
+
+	return Ret;
+}
+
+
+INT AsicSendCmdToAndes(PRTMP_ADAPTER pAd, struct CMD_UNIT *CmdUnit)
+{
+	struct MCU_CTRL *MCtrl = &pAd->MCUCtrl;
+	struct CMD_UNIT FlushUnit;
+	struct CMD_RSP_EVENT *WaitEvent = NULL, *FlushEvent;
+	INT Ret, SemRet;
+
+#ifdef REG_DEFER_SUPPORT
+	/* deferred register writes go first, and go through the batch themselves */
+	RegDeferSync(pAd);
+#endif /* REG_DEFER_SUPPORT */
+
+	RTMP_SEM_EVENT_WAIT(&MCtrl->BatchLock, SemRet);
+	if (SemRet != 0)
+	{
+		DBGPRINT(RT_DEBUG_ERROR, ("%s: BatchLock interrupted(%d)\n", __FUNCTION__, SemRet));
+		return NDIS_STATUS_FAILURE;
+	}
+
+	if ((MCtrl->BatchDepth > 0) && (CmdUnit->u.ANDES.Type == CMD_RANDOM_WRITE) &&
+		(CmdUnit->u.ANDES.CmdPayloadLen <= pAd->chipCap.InbandPacketMaxLen))
+	{
+		Ret = AndesBatchAdd(pAd, CmdUnit);
+	}
+	else
+	{
+		AndesBatchSendLocked(pAd, FALSE, &FlushUnit, &FlushEvent);
+		Ret = AndesSendCmd(pAd, CmdUnit, &WaitEvent);
+	}
+
+	RTMP_SEM_EVENT_UP(&MCtrl->BatchLock);
+
+	if (WaitEvent)
+		Ret = AndesCmdWait(pAd, CmdUnit, WaitEvent);
+
+	return Ret;
+}
+
+
+VOID AndesBatchBegin(PRTMP_ADAPTER pAd)
+{
+	struct MCU_CTRL *MCtrl = &pAd->MCUCtrl;
+	INT SemRet;
+
+	RTMP_SEM_EVENT_WAIT(&MCtrl->BatchLock, SemRet);
+	if (SemRet != 0)
+		return;
+
+	MCtrl->BatchDepth++;
+	RTMP_SEM_EVENT_UP(&MCtrl->BatchLock);
+}
+
+
+INT AndesBatchEnd(PRTMP_ADAPTER pAd)
+{
+	struct MCU_CTRL *MCtrl = &pAd->MCUCtrl;
+	struct CMD_UNIT CmdUnit;
+	struct CMD_RSP_EVENT *WaitEvent = NULL;
+	INT Ret = NDIS_STATUS_SUCCESS, SemRet;
+
+	RTMP_SEM_EVENT_WAIT(&MCtrl->BatchLock, SemRet);
+	if (SemRet != 0)
+		return NDIS_STATUS_FAILURE;
+
+	if (MCtrl->BatchDepth > 0)
+		MCtrl->BatchDepth--;
+
+	if (MCtrl->BatchDepth == 0)
+		Ret = AndesBatchSendLocked(pAd, TRUE, &CmdUnit, &WaitEvent);
+
+	RTMP_SEM_EVENT_UP(&MCtrl->BatchLock);
+
+	if (WaitEvent)
+		Ret = AndesCmdWait(pAd, &CmdUnit, WaitEvent);
 
 	return Ret;
 }
 
+
+/*
+	Called before register access over the control pipe, which can
+	overtake commands still queued on the bulk command pipe. Sends what
+	is batched and waits for it. When nothing is batched but a command
+	sent earlier has not been answered yet, a one register CMD_RANDOM_READ
+	is sent as a fence: its response comes after every earlier command has
+	been run by the MCU.
+*/
+VOID AndesBatchSync(PRTMP_ADAPTER pAd)
+{
+	struct MCU_CTRL *MCtrl = &pAd->MCUCtrl;
+	struct CMD_UNIT CmdUnit;
+	struct CMD_RSP_EVENT *WaitEvent = NULL;
+	unsigned char Fence[8], FenceRsp[8];
+	unsigned int Value;
+	INT SemRet;
+
+	if ((MCtrl->BatchLen == 0) && (MCtrl->FencedCmdCnt == MCtrl->CmdCnt))
+		return;
+
+	RTMP_SEM_EVENT_WAIT(&MCtrl->BatchLock, SemRet);
+	if (SemRet != 0)
+		return;
+
+	if (MCtrl->BatchLen > 0)
+	{
+		AndesBatchSendLocked(pAd, TRUE, &CmdUnit, &WaitEvent);
+	}
+	else if (MCtrl->FencedCmdCnt != MCtrl->CmdCnt)
+	{
+		NdisZeroMemory(Fence, sizeof(Fence));
+		Value = cpu2le32(MAC_CSR0 + pAd->chipCap.WlanMemmapOffset);
+		NdisMoveMemory(Fence, &Value, 4);
+
+		NdisZeroMemory(&CmdUnit, sizeof(CmdUnit));
+		CmdUnit.u.ANDES.Type = CMD_RANDOM_READ;
+		CmdUnit.u.ANDES.CmdPayloadLen = sizeof(Fence);
+		CmdUnit.u.ANDES.CmdPayload = Fence;
+		CmdUnit.u.ANDES.RspPayload = FenceRsp;
+		CmdUnit.u.ANDES.RspPayloadLen = sizeof(FenceRsp);
+		CmdUnit.u.ANDES.NeedRsp = TRUE;
+		CmdUnit.u.ANDES.NeedWait = TRUE;
+		CmdUnit.u.ANDES.Timeout = 0;
+
+		/* not through AsicSendCmdToAndes(), which would sync the deferred writes again */
+		AndesSendCmd(pAd, &CmdUnit, &WaitEvent);
+	}
+
+	RTMP_SEM_EVENT_UP(&MCtrl->BatchLock);
+
+	if (WaitEvent)
+		AndesCmdWait(pAd, &CmdUnit, WaitEvent);
+}
+
+
+INT Show_McuCmd_Proc(PRTMP_ADAPTER pAd, char *arg)
+{
+	struct MCU_CTRL *MCtrl = &pAd->MCUCtrl;
+	unsigned long AvgCmds;
+
+	DBGPRINT(RT_DEBUG_OFF, ("McuCmd: Cmds=%ld, AsyncKick=%ld, SyncKick=%ld\n",
+				MCtrl->CmdCnt, MCtrl->AsyncKickCnt, MCtrl->SyncKickCnt));
+	DBGPRINT(RT_DEBUG_OFF, ("McuCmd: BatchedPairs=%ld, BatchCmds=%ld\n",
+				MCtrl->BatchPairCnt, MCtrl->BatchCmdCnt));
+
+	AvgCmds = (MCtrl->SwitchChCnt != 0) ? (MCtrl->SwitchChCmdTotal * 10 / MCtrl->SwitchChCnt) : 0;
+	DBGPRINT(RT_DEBUG_OFF, ("McuCmd: SwitchCh=%ld, Cmds/Switch=%ld.%ld, LastSwitch=%d cmds %dus\n",
+				MCtrl->SwitchChCnt, AvgCmds / 10, AvgCmds % 10,
+				(INT)MCtrl->SwitchChCmds, MCtrl->SwitchChUsec));
+
+	return TRUE;
+}
+#endif /* MCU_ASYNC_CMD_SUPPORT */
+
 static VOID CmdDoneHandler(PRTMP_ADAPTER pAd, unsigned char *Data)
 {
 
@@ -955,7 +1687,7 @@ INT AndesBurstWrite(PRTMP_ADAPTER pAd, unsigned int Offset, unsigned int *Data,
 	unsigned int VarLen, OffsetNum, CurLen = 0, SentLen;
 	unsigned int Value, i, CurIndex = 0;
 	RTMP_CHIP_CAP *pChipCap = &pAd->chipCap;
-	int Ret;
+	int Ret = NDIS_STATUS_SUCCESS;
 	bool LastPacket = FALSE;
 
 	OffsetNum = Cnt / ((pChipCap->InbandPacketMaxLen - sizeof(Offset)) / 4);
@@ -1015,6 +1747,17 @@ INT AndesBurstWrite(PRTMP_ADAPTER pAd, unsigned int Offset, unsigned int *Data,
 error:
 	os_free_mem(NULL, Buf);
 
+#ifdef REG_DEFER_SUPPORT
+	/* only once the write went out, see cmm_reg_defer.c */
+	if (Ret == NDIS_STATUS_SUCCESS)
+	{
+		for (i = 0; i < Cnt; i++)
+			RegShadowWrite(pAd, Offset + i * 4, Data[i]);
+	}
+	else
+		RegShadowInvalidate(pAd, Offset, Cnt * 4);
+#endif /* REG_DEFER_SUPPORT */
+
 	return NDIS_STATUS_SUCCESS;
 }
 
@@ -1345,6 +2088,11 @@ INT AndesReadModifyWrite(PRTMP_ADAPTER pAd, R_M_W_REG *RegPair, unsigned int Num
 error:
 	os_free_mem(NULL, Buf);
 
+#ifdef REG_DEFER_SUPPORT
+	for (i = 0; i < Num; i++)
+		RegShadowInvalidate(pAd, RegPair[i].Register, 4);
+#endif /* REG_DEFER_SUPPORT */
+
 	return NDIS_STATUS_SUCCESS;
 }
 
@@ -1431,6 +2179,12 @@ INT AndesRFReadModifyWrite(PRTMP_ADAPTER pAd, RF_R_M_W_REG *RegPair, unsigned in
 error:
 	os_free_mem(NULL, Buf);
 
+#ifdef PHY_SHADOW_SUPPORT
+	/* new values are computed by the MCU, drop them once it is done */
+	for (i = 0; i < Num; i++)
+		PhyShadowRfInvalidate(pAd, RegPair[i].Bank, RegPair[i].Register);
+#endif /* PHY_SHADOW_SUPPORT */
+
 	return NDIS_STATUS_SUCCESS;
 }
 
@@ -1442,7 +2196,7 @@ INT AndesRandomWritePair(PRTMP_ADAPTER pAd, RTMP_REG_PAIR *RegPair, unsigned int
 	unsigned int VarLen = Num * 8, CurLen = 0, SentLen;
 	unsigned int Value, i, CurIndex = 0;
 	RTMP_CHIP_CAP *pChipCap = &pAd->chipCap;
-	int Ret;
+	int Ret = NDIS_STATUS_SUCCESS;
 	bool LastPacket = FALSE;
 
 	os_alloc_mem(pAd, (unsigned char **)&Buf, VarLen);
@@ -1497,6 +2251,17 @@ INT AndesRandomWritePair(PRTMP_ADAPTER pAd, RTMP_REG_PAIR *RegPair, unsigned int
 error:
 	os_free_mem(NULL, Buf);
 
+#ifdef REG_DEFER_SUPPORT
+	/* only once the write went out, see cmm_reg_defer.c */
+	for (i = 0; i < Num; i++)
+	{
+		if (Ret == NDIS_STATUS_SUCCESS)
+			RegShadowWrite(pAd, RegPair[i].Register, RegPair[i].Value);
+		else
+			RegShadowInvalidate(pAd, RegPair[i].Register, 4);
+	}
+#endif /* REG_DEFER_SUPPORT */
+
 	return NDIS_STATUS_SUCCESS;
 }
 
@@ -1574,7 +2339,7 @@ INT AndesRFRandomWritePair(PRTMP_ADAPTER pAd, BANK_RF_REG_PAIR *RegPair, unsigne
 	unsigned int VarLen = Num * 8, CurLen = 0, SentLen;
 	unsigned int Value, i, CurIndex = 0;
 	RTMP_CHIP_CAP *pChipCap = &pAd->chipCap;
-	int Ret;
+	int Ret = NDIS_STATUS_SUCCESS;
 	bool LastPacket = FALSE;
 
 	os_alloc_mem(pAd, (unsigned char **)&Buf, VarLen);
@@ -1644,6 +2409,17 @@ INT AndesRFRandomWritePair(PRTMP_ADAPTER pAd, BANK_RF_REG_PAIR *RegPair, unsigne
 error:
 	os_free_mem(NULL, Buf);
 
+#ifdef PHY_SHADOW_SUPPORT
+	/* only once the MCU took the writes, see phy_shadow.c */
+	for (i = 0; i < Num; i++)
+	{
+		if (Ret == NDIS_STATUS_SUCCESS)
+			PhyShadowRfUpdate(pAd, RegPair[i].Bank, RegPair[i].Register, RegPair[i].Value);
+		else
+			PhyShadowRfInvalidate(pAd, RegPair[i].Bank, RegPair[i].Register);
+	}
+#endif /* PHY_SHADOW_SUPPORT */
+
 	return NDIS_STATUS_SUCCESS;
 }
 
@@ -1725,6 +2501,11 @@ int AndesRFRandomWrite(PRTMP_ADAPTER pAd, BANK_RF_REG_PAIR *RegPair, unsigned in
 error:
 	os_free_mem(NULL, Buf);
 
+#ifdef PHY_SHADOW_SUPPORT
+	/* the register written is not the one in RegPair, see above */
+	PhyShadowReset(pAd);
+#endif /* PHY_SHADOW_SUPPORT */
+
 	return NDIS_STATUS_SUCCESS;
 }
 
@@ -1737,7 +2518,7 @@ INT AndesBBPRandomWritePair(PRTMP_ADAPTER pAd, RTMP_REG_PAIR *RegPair, unsigned
 	unsigned int VarLen = Num * 8, CurLen = 0, SentLen;
 	unsigned int Value, i, CurIndex = 0;
 	RTMP_CHIP_CAP *pChipCap = &pAd->chipCap;
-	int Ret;
+	int Ret = NDIS_STATUS_SUCCESS;
 	bool LastPacket = FALSE;
 
 	os_alloc_mem(pAd, (unsigned char **)&Buf, VarLen);
@@ -1801,6 +2582,17 @@ INT AndesBBPRandomWritePair(PRTMP_ADAPTER pAd, RTMP_REG_PAIR *RegPair, unsigned
 error:
 	os_free_mem(NULL, Buf);
 
+#ifdef PHY_SHADOW_SUPPORT
+	/* only once the MCU took the writes, see phy_shadow.c */
+	for (i = 0; i < Num; i++)
+	{
+		if (Ret == NDIS_STATUS_SUCCESS)
+			PhyShadowBbpUpdate(pAd, (unsigned char)RegPair[i].Register, (unsigned char)RegPair[i].Value);
+		else
+			PhyShadowBbpInvalidate(pAd, (unsigned char)RegPair[i].Register);
+	}
+#endif /* PHY_SHADOW_SUPPORT */
+
 	return NDIS_STATUS_SUCCESS;
 }
 
@@ -1812,9 +2604,12 @@ INT AndesBBPRandomWrite(PRTMP_ADAPTER pAd, unsigned int Num, ...)
 	unsigned int VarLen = Num * 8, CurLen = 0, SentLen;
 	unsigned int Value, i, CurIndex = 0;
 	RTMP_CHIP_CAP *pChipCap = &pAd->chipCap;
-	int Ret;
+	int Ret = NDIS_STATUS_SUCCESS;
 	va_list argptr;
 	bool LastPacket = FALSE;
+#ifdef PHY_SHADOW_SUPPORT
+	unsigned int BbpId;
+#endif /* PHY_SHADOW_SUPPORT */
 
 	va_start(argptr, Num);
 
@@ -1877,6 +2672,22 @@ INT AndesBBPRandomWrite(PRTMP_ADAPTER pAd, unsigned int Num, ...)
 	}
 
 error:
+#ifdef PHY_SHADOW_SUPPORT
+	/* only once the MCU took the writes, see phy_shadow.c; pairs from Buf */
+	for (i = 0; i < (unsigned int)(Pos - Buf) / 8; i++)
+	{
+		NdisMoveMemory(&BbpId, Buf + i * 8, 4);
+		NdisMoveMemory(&Value, Buf + i * 8 + 4, 4);
+		BbpId = le2cpu32(BbpId);
+		Value = le2cpu32(Value);
+
+		if (Ret == NDIS_STATUS_SUCCESS)
+			PhyShadowBbpUpdate(pAd, (unsigned char)BbpId, (unsigned char)Value);
+		else
+			PhyShadowBbpInvalidate(pAd, (unsigned char)BbpId);
+	}
+#endif /* PHY_SHADOW_SUPPORT */
+
 	os_free_mem(NULL, Buf);
 	va_end(argptr);
 
@@ -1905,6 +2716,10 @@ INT AndesPwrSavingOP(PRTMP_ADAPTER pAd, unsigned int PwrOP, unsigned int PwrLeve
 		VarLen += 12;
 	}
 
+#ifdef PHY_SHADOW_SUPPORT
+	PhyShadowCommit(pAd);
+#endif /* PHY_SHADOW_SUPPORT */
+
 	os_alloc_mem(pAd, (unsigned char **)&Buf, VarLen);
 
 	Pos = Buf;
@@ -1956,6 +2771,11 @@ INT AndesPwrSavingOP(PRTMP_ADAPTER pAd, unsigned int PwrOP, unsigned int PwrLeve
 
 	Ret = AsicSendCmdToAndes(pAd, &CmdUnit);
 
+#ifdef PHY_SHADOW_SUPPORT
+	/* the MCU changes BBP and RF registers on its own */
+	PhyShadowReset(pAd);
+#endif /* PHY_SHADOW_SUPPORT */
+
 	os_free_mem(NULL, Buf);
 
 	return NDIS_STATUS_SUCCESS;
@@ -2020,6 +2840,10 @@ void AndesCalibrationOP(PRTMP_ADAPTER pAd, unsigned int CalibrationID, unsigned
 	/* Calibration ID and Parameter */
 	VarLen = 8;
 
+#ifdef PHY_SHADOW_SUPPORT
+	PhyShadowCommit(pAd);
+#endif /* PHY_SHADOW_SUPPORT */
+
 	os_alloc_mem(pAd, (unsigned char **)&Buf, VarLen);
 
 	Pos = Buf;
@@ -2046,6 +2870,11 @@ void AndesCalibrationOP(PRTMP_ADAPTER pAd, unsigned int CalibrationID, unsigned
 
 	Ret = AsicSendCmdToAndes(pAd, &CmdUnit);
 
+#ifdef PHY_SHADOW_SUPPORT
+	/* the MCU changes BBP and RF registers on its own */
+	PhyShadowReset(pAd);
+#endif /* PHY_SHADOW_SUPPORT */
+
 	os_free_mem(NULL, Buf);
 }
 
@@ -34,6 +34,15 @@ VOID set_entry_phy_cfg(RTMP_ADAPTER *pAd, MAC_TABLE_ENTRY *pEntry)
 	==========================================================================
 	Description:
 		Look up the MAC address in the MAC table. Return NULL if not found.
+
+		Takes no lock. With MAC_TABLE_RCU_SUPPORT MacTableDeleteEntry()
+		only unlinks the entry; it is torn down and its WCID freed after
+		an RCU grace period, see MacTableRetireDone(). Callers may use
+		pEntry while in a read-side section: the RX tasklet and the TX
+		path run with bottom halves disabled, which counts as one, other
+		callers that do not sleep hold MAC_TABLE_RCU_READ_LOCK. The MLME
+		state machines and the ioctls that write registers sleep and get
+		no such guarantee, as without MAC_TABLE_RCU_SUPPORT.
 	Return:
 		pEntry - pointer to the MAC entry; NULL is not found
 	==========================================================================
@@ -43,22 +52,301 @@ MAC_TABLE_ENTRY *MacTableLookup(
 	unsigned char * pAddr)
 {
 	unsigned long HashIdx;
-	MAC_TABLE_ENTRY *pEntry = NULL;
+	unsigned char Wcid;
+	MAC_TABLE_ENTRY *pEntry;
 	
 	HashIdx = MAC_ADDR_HASH_INDEX(pAddr);
-	pEntry = pAd->MacTab.Hash[HashIdx];
+	Wcid = MAC_TABLE_RCU_DEREF(pAd->MacTab.HotHash[HashIdx]);
 
-	while (pEntry && !IS_ENTRY_NONE(pEntry))
+	/* only the matching entry itself is touched */
+	while (Wcid != MAC_TABLE_HOT_END)
 	{
-		if (MAC_ADDR_EQUAL(pEntry->Addr, pAddr))
+		if (MAC_ADDR_EQUAL(pAd->MacTab.Hot[Wcid].Addr, pAddr))
 		{
-			break;
+			pEntry = &pAd->MacTab.Content[Wcid];
+			return (IS_ENTRY_NONE(pEntry) ? NULL : pEntry);
+		}
+		Wcid = MAC_TABLE_RCU_DEREF(pAd->MacTab.Hot[Wcid].Next);
+	}
+
+	return NULL;
+}
+
+
+/* put Wcid on the hot hash chain of pAddr, caller holds MacTabLock */
+static VOID MacTableHotLink(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Wcid,
+	IN unsigned char *pAddr)
+{
+	unsigned long HashIdx = MAC_ADDR_HASH_INDEX(pAddr);
+	MAC_TABLE_HOT *pHot = &pAd->MacTab.Hot[Wcid];
+
+	COPY_MAC_ADDR(pHot->Addr, pAddr);
+	pHot->Next = pAd->MacTab.HotHash[HashIdx];
+	/* publish the slot only once it is filled in */
+	MAC_TABLE_RCU_ASSIGN(pAd->MacTab.HotHash[HashIdx], Wcid);
+}
+
+
+/* take Wcid off its hot hash chain, caller holds MacTabLock */
+static VOID MacTableHotUnlink(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Wcid)
+{
+	unsigned long HashIdx = MAC_ADDR_HASH_INDEX(pAd->MacTab.Hot[Wcid].Addr);
+	unsigned char *pLink = &pAd->MacTab.HotHash[HashIdx];
+
+	while (*pLink != MAC_TABLE_HOT_END)
+	{
+		if (*pLink == Wcid)
+		{
+			/* Hot[Wcid] itself stays intact for the lookups still on it */
+			MAC_TABLE_RCU_ASSIGN(*pLink, pAd->MacTab.Hot[Wcid].Next);
+			return;
 		}
+		pLink = &pAd->MacTab.Hot[*pLink].Next;
+	}
+
+	/* not found !!!*/
+	ASSERT(FALSE);
+}
+
+
+/*
+	Release what the lookups of a deleted entry may still use, caller
+	holds MacTabLock. Does not sleep: the register writes it needs on
+	USB go through the command thread.
+*/
+static VOID MacTableEntryTeardown(
+	IN PRTMP_ADAPTER pAd,
+	IN MAC_TABLE_ENTRY *pEntry)
+{
+#ifdef DOT11_N_SUPPORT
+	/* free resources of BA*/
+	BASessionTearDownALL(pAd, pEntry->Aid);
+#endif /* DOT11_N_SUPPORT */
+
+#ifdef CONFIG_AP_SUPPORT
+	APCleanupPsQueue(pAd, &pEntry->PsQueue); /* return all NDIS packet in PSQ*/
+#endif /* CONFIG_AP_SUPPORT */
+#ifdef AIRTIME_FAIRNESS_SUPPORT
+	ATFCleanupEntry(pAd, pEntry);
+#endif /* AIRTIME_FAIRNESS_SUPPORT */
+#ifdef HDR_TRANS_SUPPORT
+	HdrTransEntrySet(pAd, pEntry, HDR_TRANS_MODE_OFF);
+#endif /* HDR_TRANS_SUPPORT */
+
+	NdisZeroMemory(pEntry->Addr, MAC_ADDR_LEN);
+	/* invalidate the entry */
+	SET_ENTRY_NONE(pEntry);
+#ifdef TXBF_SUPPORT
+	if (pAd->chipCap.FlgHwTxBfCap)
+		NdisFreeSpinLock(&pEntry->TxSndgLock);
+#endif /* TXBF_SUPPORT */
+}
+
+
+#ifdef MAC_TABLE_RCU_SUPPORT
+/*
+	Grace period of a deleted WCID is over, no lookup holds its entry
+	any more. Tear it down and let MacTableInsertEntry() have it again.
+	Called in softirq context.
+*/
+static VOID MacTableRetireDone(
+	IN VOID *pData)
+{
+	MAC_TABLE_RETIRE *pRetire = (MAC_TABLE_RETIRE *)pData;
+	PRTMP_ADAPTER pAd = (PRTMP_ADAPTER)pRetire->pAd;
+	unsigned char Wcid = pRetire->Wcid;
+
+	NdisAcquireSpinLock(&pAd->MacTabLock);
+	MacTableEntryTeardown(pAd, &pAd->MacTab.Content[Wcid]);
+	pAd->MacTab.RetireMap[Wcid >> 5] &= ~(1 << (Wcid & 0x1f));
+	NdisReleaseSpinLock(&pAd->MacTabLock);
+}
+
+
+/* tear Wcid down after a grace period, until then keep it out of MacTableInsertEntry(); caller holds MacTabLock */
+static VOID MacTableRetire(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Wcid)
+{
+	MAC_TABLE_RETIRE *pRetire = &pAd->MacTab.Retire[Wcid];
+
+	pAd->MacTab.RetireMap[Wcid >> 5] |= (1 << (Wcid & 0x1f));
+	pRetire->pAd = pAd;
+	pRetire->Wcid = Wcid;
+	RtmpOsCallRcu(&pRetire->Rcu, MacTableRetireDone, pRetire);
+}
+
+
+static bool MacTableRetiring(
+	IN PRTMP_ADAPTER pAd,
+	IN INT Wcid)
+{
+	return (pAd->MacTab.RetireMap[Wcid >> 5] & (1 << (Wcid & 0x1f))) ? TRUE : FALSE;
+}
+#endif /* MAC_TABLE_RCU_SUPPORT */
+
+/*
+	==========================================================================
+	Description:
+		Next WCID in use after Wcid, walking OccupiedMap so empty parts
+		of the table cost one test per 32 entries.
+	Return:
+		the WCID; MAX_LEN_OF_MAC_TABLE when there is none
+	==========================================================================
+*/
+INT MacTableNextEntry(
+	IN MAC_TABLE *pMacTable,
+	IN INT Wcid)
+{
+	unsigned int Map;
+
+	for (Wcid++; Wcid < MAX_LEN_OF_MAC_TABLE; Wcid++)
+	{
+		Map = pMacTable->OccupiedMap[Wcid >> 5] >> (Wcid & 0x1f);
+		if (Map == 0)
+		{
+			/* nothing left in this word */
+			Wcid |= 0x1f;
+			continue;
+		}
+
+		while ((Map & 1) == 0)
+		{
+			Map >>= 1;
+			Wcid++;
+		}
+		return Wcid;
+	}
+
+	return MAX_LEN_OF_MAC_TABLE;
+}
+
+
+static unsigned short MacTableAggFlagsGet(
+	IN MAC_TABLE_ENTRY *pEntry)
+{
+	unsigned short Flags = 0;
+
+	if (!IS_ENTRY_CLIENT(pEntry))
+		return 0;
+
+#ifdef DOT11_N_SUPPORT
+	if (pEntry->MmpsMode == MMPS_DYNAMIC)
+		Flags |= (1 << MAC_AGG_MIMOPS_DYNAMIC);
+
+	if (pEntry->MaxHTPhyMode.field.BW == BW_20)
+		Flags |= (1 << MAC_AGG_20_ONLY);
+
+	if (pEntry->MaxHTPhyMode.field.MODE != MODE_HTGREENFIELD)
+		Flags |= (1 << MAC_AGG_NON_GF);
+
+	if ((pEntry->MaxHTPhyMode.field.MODE == MODE_OFDM) || (pEntry->MaxHTPhyMode.field.MODE == MODE_CCK))
+		Flags |= (1 << MAC_AGG_LEGACY);
+	else
+		Flags |= (1 << MAC_AGG_HT);
+
+#ifdef DOT11N_DRAFT3
+	if (pEntry->bForty_Mhz_Intolerant)
+		Flags |= (1 << MAC_AGG_40_INTOLERANT);
+#endif /* DOT11N_DRAFT3 */
+#endif /* DOT11_N_SUPPORT */
+
+	if (pEntry->bIAmBadAtheros)
+		Flags |= (1 << MAC_AGG_BAD_ATHEROS);
+
+	if (!CLIENT_STATUS_TEST_FLAG(pEntry, fCLIENT_STATUS_RALINK_CHIPSET))
+		Flags |= (1 << MAC_AGG_NOT_RALINK);
+
+#ifdef WAPI_SUPPORT
+	if (pEntry->WepStatus == Ndis802_11EncryptionSMS4Enabled)
+		Flags |= (1 << MAC_AGG_WAPI);
+#endif /* WAPI_SUPPORT */
+
+	return Flags;
+}
+
+
+/* move the contribution of pEntry to Flags, caller holds MacTabLock */
+static VOID MacTableAggSet(
+	IN PRTMP_ADAPTER pAd,
+	IN MAC_TABLE_ENTRY *pEntry,
+	IN unsigned short Flags)
+{
+	unsigned short Changed = pEntry->AggFlags ^ Flags;
+	INT i;
+
+	for (i = 0; (i < MAC_AGG_NUM) && (Changed != 0); i++, Changed >>= 1)
+	{
+		if ((Changed & 1) == 0)
+			continue;
+
+		if (Flags & (1 << i))
+			pAd->MacTab.AggCount[i]++;
 		else
-			pEntry = pEntry->pNext;
+			pAd->MacTab.AggCount[i]--;
 	}
+	pEntry->AggFlags = Flags;
+}
 
-	return pEntry;
+
+/*
+	==========================================================================
+	Description:
+		Derive the fAnyStationXXX flags of the MAC table from AggCount.
+	==========================================================================
+*/
+VOID MacTableAggFlagsUpdate(
+	IN PRTMP_ADAPTER pAd)
+{
+	MAC_TABLE *pMacTable = &pAd->MacTab;
+
+	pMacTable->fAnyStationBadAtheros = (pMacTable->AggCount[MAC_AGG_BAD_ATHEROS] > 0);
+	pMacTable->fAllStationAsRalink = (pMacTable->AggCount[MAC_AGG_NOT_RALINK] == 0);
+#ifdef DOT11_N_SUPPORT
+	pMacTable->fAnyStationNonGF = (pMacTable->AggCount[MAC_AGG_NON_GF] > 0);
+	pMacTable->fAnyStation20Only = (pMacTable->AggCount[MAC_AGG_20_ONLY] > 0);
+	pMacTable->fAnyStationIsLegacy = (pMacTable->AggCount[MAC_AGG_LEGACY] > 0);
+	pMacTable->fAnyStationMIMOPSDynamic = (pMacTable->AggCount[MAC_AGG_MIMOPS_DYNAMIC] > 0);
+#ifdef GREENAP_SUPPORT
+	pMacTable->fAnyStationIsHT = (pMacTable->AggCount[MAC_AGG_HT] > 0);
+#endif /* GREENAP_SUPPORT */
+#ifdef DOT11N_DRAFT3
+	pMacTable->fAnyStaFortyIntolerant = (pMacTable->AggCount[MAC_AGG_40_INTOLERANT] > 0);
+#endif /* DOT11N_DRAFT3 */
+#endif /* DOT11_N_SUPPORT */
+#ifdef WAPI_SUPPORT
+	pMacTable->fAnyWapiStation = (pMacTable->AggCount[MAC_AGG_WAPI] > 0);
+#endif /* WAPI_SUPPORT */
+}
+
+
+/*
+	==========================================================================
+	Description:
+		Recount pEntry after its capabilities changed and refresh the
+		table wide flags. Called on association, on SMPS and Atheros
+		detection, and for every client by MacTableMaintenance().
+	==========================================================================
+*/
+VOID MacTableAggUpdate(
+	IN PRTMP_ADAPTER pAd,
+	IN MAC_TABLE_ENTRY *pEntry)
+{
+	unsigned short Flags = MacTableAggFlagsGet(pEntry);
+
+	if (Flags == pEntry->AggFlags)
+		return;
+
+	NdisAcquireSpinLock(&pAd->MacTabLock);
+	if (!IS_ENTRY_NONE(pEntry))
+		MacTableAggSet(pAd, pEntry, Flags);
+	NdisReleaseSpinLock(&pAd->MacTabLock);
+
+	MacTableAggFlagsUpdate(pAd);
 }
 
 
@@ -88,7 +376,11 @@ MAC_TABLE_ENTRY *MacTableInsertEntry(
 	for (i = FirstWcid; i< MAX_LEN_OF_MAC_TABLE; i++)   /* skip entry#0 so that "entry index == AID" for fast lookup*/
 	{
 		/* pick up the first available vacancy*/
-		if (IS_ENTRY_NONE(&pAd->MacTab.Content[i]))
+		if (IS_ENTRY_NONE(&pAd->MacTab.Content[i])
+#ifdef MAC_TABLE_RCU_SUPPORT
+			&& !MacTableRetiring(pAd, i)
+#endif /* MAC_TABLE_RCU_SUPPORT */
+			)
 		{
 			pEntry = &pAd->MacTab.Content[i];
 
@@ -329,12 +621,22 @@ MAC_TABLE_ENTRY *MacTableInsertEntry(
 #endif /* CONFIG_AP_SUPPORT */
 
 			pAd->MacTab.Size ++;
+			pAd->MacTab.OccupiedMap[i >> 5] |= (1 << (i & 0x1f));
 
+#ifdef ASSOC_STORM_SUPPORT
+			/* OPEN-NONE and the RX WCID search table, with the other new entries */
+			AssocStormWcidMark(pAd, (unsigned char)i, pEntry);
+#else
 			/* Set the security mode of this entry as OPEN-NONE in ASIC */
 			RTMP_REMOVE_PAIRWISE_KEY_ENTRY(pAd, (unsigned char)i);
 
 			/* Add this entry into ASIC RX WCID search table */
 			RTMP_STA_ENTRY_ADD(pAd, pEntry);
+#endif /* ASSOC_STORM_SUPPORT */
+
+#ifdef HDR_TRANS_SUPPORT
+			HdrTransEntrySet(pAd, pEntry, pAd->HdrTransDefault);
+#endif /* HDR_TRANS_SUPPORT */
 
 
 #ifdef CONFIG_AP_SUPPORT
@@ -373,6 +675,7 @@ MAC_TABLE_ENTRY *MacTableInsertEntry(
 				pCurrEntry = pCurrEntry->pNext;
 			pCurrEntry->pNext = pEntry;
 		}
+		MacTableHotLink(pAd, (unsigned char)i, pAddr);
 #ifdef CONFIG_AP_SUPPORT
 		IF_DEV_CONFIG_OPMODE_ON_AP(pAd)
 		{
@@ -423,6 +726,11 @@ bool MacTableDeleteEntry(
 	HashIdx = MAC_ADDR_HASH_INDEX(pAddr);
 	/*pEntry = pAd->MacTab.Hash[HashIdx];*/
 	pEntry = &pAd->MacTab.Content[wcid];
+#ifdef MAC_TABLE_RCU_SUPPORT
+	/* already deleted, waiting for its grace period */
+	if (MacTableRetiring(pAd, wcid))
+		pEntry = NULL;
+#endif /* MAC_TABLE_RCU_SUPPORT */
 
 	if (pEntry && !IS_ENTRY_NONE(pEntry))
 	{
@@ -434,12 +742,11 @@ bool MacTableDeleteEntry(
 		{
 
 			/* Delete this entry from ASIC on-chip WCID Table*/
+#ifdef ASSOC_STORM_SUPPORT
+			AssocStormWcidMark(pAd, (unsigned char)wcid, NULL);
+#else
 			RTMP_STA_ENTRY_MAC_RESET(pAd, wcid);
-
-#ifdef DOT11_N_SUPPORT
-			/* free resources of BA*/
-			BASessionTearDownALL(pAd, pEntry->Aid);
-#endif /* DOT11_N_SUPPORT */
+#endif /* ASSOC_STORM_SUPPORT */
 
 #ifdef TXBF_SUPPORT
 			if (pAd->chipCap.FlgHwTxBfCap)
@@ -533,10 +840,9 @@ bool MacTableDeleteEntry(
 
 			/* not found !!!*/
 			ASSERT(pProbeEntry != NULL);
+			MacTableHotUnlink(pAd, (unsigned char)wcid);
 
-#ifdef CONFIG_AP_SUPPORT
-			APCleanupPsQueue(pAd, &pEntry->PsQueue); /* return all NDIS packet in PSQ*/
-#endif /* CONFIG_AP_SUPPORT */
+			RTMPTxBatchWcidStale(pAd, (unsigned char)wcid);
 			/*RTMP_REMOVE_PAIRWISE_KEY_ENTRY(pAd, wcid);*/
 
 #ifdef UAPSD_SUPPORT
@@ -582,14 +888,15 @@ bool MacTableDeleteEntry(
 
 
 //   			NdisZeroMemory(pEntry, sizeof(MAC_TABLE_ENTRY));
-			NdisZeroMemory(pEntry->Addr, MAC_ADDR_LEN);
-			/* invalidate the entry */
-			SET_ENTRY_NONE(pEntry);
+			MacTableAggSet(pAd, pEntry, 0);
 			pAd->MacTab.Size --;
-#ifdef TXBF_SUPPORT
-			if (pAd->chipCap.FlgHwTxBfCap)
-				NdisFreeSpinLock(&pEntry->TxSndgLock);
-#endif /* TXBF_SUPPORT */
+			pAd->MacTab.OccupiedMap[wcid >> 5] &= ~(1 << (wcid & 0x1f));
+#ifdef MAC_TABLE_RCU_SUPPORT
+			/* lookups already holding pEntry may go on using it, Content[] walks still see it too */
+			MacTableRetire(pAd, (unsigned char)wcid);
+#else
+			MacTableEntryTeardown(pAd, pEntry);
+#endif /* MAC_TABLE_RCU_SUPPORT */
 			DBGPRINT(RT_DEBUG_TRACE, ("MacTableDeleteEntry1 - Total= %d\n", pAd->MacTab.Size));
 		}
 		else
@@ -600,6 +907,8 @@ bool MacTableDeleteEntry(
 
 	NdisReleaseSpinLock(&pAd->MacTabLock);
 
+	MacTableAggFlagsUpdate(pAd);
+
 	/*Reset operating mode when no Sta.*/
 	if (pAd->MacTab.Size == 0)
 	{
@@ -712,12 +1021,22 @@ VOID MacTableReset(
 		if (pAd->MacTab.McastPsQueue.Number > 0)
 			APCleanupPsQueue(pAd, &pAd->MacTab.McastPsQueue);
 		DBGPRINT(RT_DEBUG_TRACE, ("2McastPsQueue.Number %ld...\n",pAd->MacTab.McastPsQueue.Number));
+#ifdef AIRTIME_FAIRNESS_SUPPORT
+		ATFCleanupAll(pAd);
+#endif /* AIRTIME_FAIRNESS_SUPPORT */
+#ifdef TX_AQM_SUPPORT
+		AQMCleanupAll(pAd);
+#endif /* TX_AQM_SUPPORT */
 
 		/* ENTRY PREEMPTION: Zero Mac Table but entry's content */
 /*		NdisZeroMemory(&pAd->MacTab, sizeof(MAC_TABLE));*/
 		NdisZeroMemory(&pAd->MacTab.Size,
 						sizeof(MAC_TABLE)-
 							sizeof(pAd->MacTab.Hash)-
+#ifdef MAC_TABLE_RCU_SUPPORT
+							sizeof(pAd->MacTab.RetireMap)-
+							sizeof(pAd->MacTab.Retire)-
+#endif /* MAC_TABLE_RCU_SUPPORT */
 							sizeof(pAd->MacTab.Content));
 
 		InitializeQueueHeader(&pAd->MacTab.McastPsQueue);
@@ -685,6 +685,12 @@ INT	SetCommonHT(RTMP_ADAPTER *pAd)
 	}
 #endif /* DOT11N_DRAFT3 */
 
+#ifdef CONFIG_AP_SUPPORT
+#if defined(BCN_SEG_SUPPORT) || defined(PROBE_CACHE_SUPPORT)
+	APBeaconSegDirty(pAd, -1, BCN_SEG_HT);
+#endif /* BCN_SEG_SUPPORT || PROBE_CACHE_SUPPORT */
+#endif /* CONFIG_AP_SUPPORT */
+
 	return TRUE;
 }
 
@@ -26,6 +26,54 @@ HAS_APCLI=n
 # Support Net interface block while Tx-Sw queue full
 HAS_BLOCK_NET_IF=y
 
+# Support airtime fair scheduling of per-station TX queues
+HAS_AIRTIME_FAIRNESS_SUPPORT=n
+
+# Support CoDel and flow queueing on the software TX queues
+HAS_TX_AQM_SUPPORT=n
+
+# Support per-CPU object pools for RX skbs, MLME buffers and MCU commands
+HAS_MEM_POOL_SUPPORT=n
+
+# Support per-session hrtimers flushing the BA reorder buffer
+HAS_BA_HRTIMER_SUPPORT=n
+
+# Support measuring cache misses per packet through perf counters
+HAS_CACHE_MISS_STAT_SUPPORT=n
+
+# Support tearing deleted MAC table entries down after an RCU grace period, for unlocked lookups
+HAS_MAC_TABLE_RCU_SUPPORT=n
+
+# Support async MCU command URBs and batched register writes on channel switch
+HAS_MCU_ASYNC_CMD_SUPPORT=n
+
+# Support deferring MAC register writes into MCU commands and a shadow of driver-owned registers
+HAS_REG_DEFER_SUPPORT=n
+
+# Support a BBP/RF register shadow that skips unchanged writes and commits local updates in one MCU command
+HAS_PHY_SHADOW_SUPPORT=n
+
+# Support double-buffered firmware upload
+HAS_FW_FAST_LOAD_SUPPORT=n
+
+# Support per-stage time and USB control transfer counts of interface up
+HAS_BOOT_PROF_SUPPORT=n
+
+# Support beacon updates as MCU burst writes of the changed byte runs
+HAS_BCN_BURST_SUPPORT=n
+
+# Support rebuilding only the beacon IEs that changed and incremental TIM bounds
+HAS_BCN_SEG_SUPPORT=n
+
+# Support a cached ProbeRsp per BSS and rate limiting of ProbeReq floods
+HAS_PROBE_CACHE_SUPPORT=n
+
+# Support a pointer based MLME queue with priority lanes
+HAS_MLME_LANE_SUPPORT=n
+
+# Support batched admission of association storms
+HAS_ASSOC_STORM_SUPPORT=n
+
 #Support IGMP-Snooping function.
 HAS_IGMP_SNOOP_SUPPORT=n
 
@@ -97,6 +145,18 @@ HAS_TSSI_ANTENNA_VARIATION=n
 #Support USB_BULK_BUF_ALIGMENT
 HAS_USB_BULK_BUF_ALIGMENT=n
 
+#Support handing bulk-in frames to the stack without copying them
+HAS_RX_ZERO_COPY_SUPPORT=n
+
+#Support NAPI polling of bulk-in frames
+HAS_RX_NAPI_SUPPORT=n
+
+#Support bulk-out of single frames from the skb through a scatter-gather URB
+HAS_USB_BULK_OUT_SG_SUPPORT=n
+
+#Support sizing the TX dequeue budget from the bulk-out completions
+HAS_USB_TX_ADAPTIVE_BATCH=n
+
 #Support for USB_SUPPORT_SELECTIVE_SUSPEND
 HAS_USB_SUPPORT_SELECTIVE_SUSPEND=y
 
@@ -344,6 +404,22 @@ ifeq ($(HAS_USB_BULK_BUF_ALIGMENT),y)
 WFLAGS += -DUSB_BULK_BUF_ALIGMENT
 endif
 
+ifeq ($(HAS_RX_ZERO_COPY_SUPPORT),y)
+WFLAGS += -DRX_ZERO_COPY_SUPPORT
+endif
+
+ifeq ($(HAS_RX_NAPI_SUPPORT),y)
+WFLAGS += -DRX_NAPI_SUPPORT
+endif
+
+ifeq ($(HAS_USB_BULK_OUT_SG_SUPPORT),y)
+WFLAGS += -DUSB_BULK_OUT_SG_SUPPORT
+endif
+
+ifeq ($(HAS_USB_TX_ADAPTIVE_BATCH),y)
+WFLAGS += -DUSB_TX_ADAPTIVE_BATCH
+endif
+
 ifeq ($(HAS_CFG80211_SUPPORT),y)
 WFLAGS += -DRT_CFG80211_SUPPORT -DEXT_BUILD_CHANNEL_LIST
 ifeq ($(HAS_RFKILL_HW_SUPPORT),y)
@@ -762,6 +838,70 @@ ifeq ($(HAS_BLOCK_NET_IF),y)
 WFLAGS += -DBLOCK_NET_IF
 endif
 
+ifeq ($(HAS_AIRTIME_FAIRNESS_SUPPORT),y)
+WFLAGS += -DAIRTIME_FAIRNESS_SUPPORT
+endif
+
+ifeq ($(HAS_TX_AQM_SUPPORT),y)
+WFLAGS += -DTX_AQM_SUPPORT
+endif
+
+ifeq ($(HAS_MEM_POOL_SUPPORT),y)
+WFLAGS += -DMEM_POOL_SUPPORT
+endif
+
+ifeq ($(HAS_BA_HRTIMER_SUPPORT),y)
+WFLAGS += -DBA_HRTIMER_SUPPORT
+endif
+
+ifeq ($(HAS_CACHE_MISS_STAT_SUPPORT),y)
+WFLAGS += -DCACHE_MISS_STAT_SUPPORT
+endif
+
+ifeq ($(HAS_MAC_TABLE_RCU_SUPPORT),y)
+WFLAGS += -DMAC_TABLE_RCU_SUPPORT
+endif
+
+ifeq ($(HAS_MCU_ASYNC_CMD_SUPPORT),y)
+WFLAGS += -DMCU_ASYNC_CMD_SUPPORT
+endif
+
+ifeq ($(HAS_REG_DEFER_SUPPORT),y)
+WFLAGS += -DREG_DEFER_SUPPORT
+endif
+
+ifeq ($(HAS_PHY_SHADOW_SUPPORT),y)
+WFLAGS += -DPHY_SHADOW_SUPPORT
+endif
+
+ifeq ($(HAS_FW_FAST_LOAD_SUPPORT),y)
+WFLAGS += -DFW_FAST_LOAD_SUPPORT
+endif
+
+ifeq ($(HAS_BOOT_PROF_SUPPORT),y)
+WFLAGS += -DBOOT_PROF_SUPPORT
+endif
+
+ifeq ($(HAS_BCN_BURST_SUPPORT),y)
+WFLAGS += -DBCN_BURST_SUPPORT
+endif
+
+ifeq ($(HAS_BCN_SEG_SUPPORT),y)
+WFLAGS += -DBCN_SEG_SUPPORT
+endif
+
+ifeq ($(HAS_PROBE_CACHE_SUPPORT),y)
+WFLAGS += -DPROBE_CACHE_SUPPORT
+endif
+
+ifeq ($(HAS_MLME_LANE_SUPPORT),y)
+WFLAGS += -DMLME_LANE_SUPPORT
+endif
+
+ifeq ($(HAS_ASSOC_STORM_SUPPORT),y)
+WFLAGS += -DASSOC_STORM_SUPPORT
+endif
+
 ifeq ($(HAS_DFS_SUPPORT),y)
 WFLAGS += -DDFS_SUPPORT
 endif
@@ -345,6 +345,383 @@ PNDIS_PACKET RTMP_AllocateFragPacketBuffer(VOID *dummy, unsigned long len)
 }
 
 
+#ifdef MEM_POOL_SUPPORT
+/*
+	Object pools. Each CPU keeps a few free objects it can take without a
+	lock, the rest sit in a shared depot. A memory pool carves its objects
+	out of one block reserved when it is created and takes back what it
+	handed out. An skb pool hands out skbs allocated ahead of time and is
+	refilled from a work item, where GFP_KERNEL may reclaim and compact
+	instead of failing like the GFP_ATOMIC allocations of the RX path.
+	Either kind falls back to the general allocator when it runs dry.
+*/
+#define OS_POOL_CPU_CACHE	16
+
+typedef struct _OS_POOL_CPU {
+	unsigned int Num;
+	VOID *pObj[OS_POOL_CPU_CACHE];
+	unsigned long Alloc;	/* requests which fit the pool */
+	unsigned long Hit;
+} OS_POOL_CPU;
+
+typedef struct _OS_POOL {
+	char Name[16];
+	bool bSkb;
+	unsigned int ObjSize;
+	unsigned int ObjNum;
+	unsigned char *pRegion;		/* objects of a memory pool */
+	spinlock_t DepotLock;
+	VOID **pDepot;
+	unsigned int DepotNum;
+	unsigned int DepotLow;
+	OS_POOL_CPU *pCpu;
+	struct work_struct RefillWork;
+	atomic_t InUse;
+	unsigned int HighWater;
+	atomic_t Fallback;
+	atomic_t Fail;
+	unsigned long Refill;
+} OS_POOL;
+
+
+static VOID *RtmpOsPoolGet(
+	IN OS_POOL *pPool)
+{
+	OS_POOL_CPU *pCpu;
+	VOID *pObj = NULL;
+	unsigned long Flags;
+	unsigned int Num;
+
+	local_irq_save(Flags);
+	pCpu = per_cpu_ptr(pPool->pCpu, smp_processor_id());
+	if (pCpu->Num == 0)
+	{
+		spin_lock(&pPool->DepotLock);
+		Num = min_t(unsigned int, pPool->DepotNum, OS_POOL_CPU_CACHE / 2);
+		pPool->DepotNum -= Num;
+		memcpy(pCpu->pObj, &pPool->pDepot[pPool->DepotNum], Num * sizeof(VOID *));
+		pCpu->Num = Num;
+		if (pPool->DepotNum < pPool->DepotLow)
+			pPool->DepotLow = pPool->DepotNum;
+		spin_unlock(&pPool->DepotLock);
+	}
+
+	pCpu->Alloc++;
+	if (pCpu->Num > 0)
+	{
+		pObj = pCpu->pObj[--pCpu->Num];
+		pCpu->Hit++;
+	}
+	local_irq_restore(Flags);
+
+	return pObj;
+}
+
+
+static VOID RtmpOsPoolPut(
+	IN OS_POOL *pPool,
+	IN VOID *pObj)
+{
+	OS_POOL_CPU *pCpu;
+	unsigned long Flags;
+	unsigned int Num;
+
+	local_irq_save(Flags);
+	pCpu = per_cpu_ptr(pPool->pCpu, smp_processor_id());
+	if (pCpu->Num == OS_POOL_CPU_CACHE)
+	{
+		/* the depot has room for every object of the pool */
+		spin_lock(&pPool->DepotLock);
+		Num = OS_POOL_CPU_CACHE / 2;
+		pCpu->Num -= Num;
+		memcpy(&pPool->pDepot[pPool->DepotNum], &pCpu->pObj[pCpu->Num], Num * sizeof(VOID *));
+		pPool->DepotNum += Num;
+		spin_unlock(&pPool->DepotLock);
+	}
+	pCpu->pObj[pCpu->Num++] = pObj;
+	local_irq_restore(Flags);
+}
+
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,20)
+static void RtmpOsSkbPoolRefill(struct work_struct *pWork)
+{
+	OS_POOL *pPool = container_of(pWork, OS_POOL, RefillWork);
+#else
+static void RtmpOsSkbPoolRefill(void *pData)
+{
+	OS_POOL *pPool = (OS_POOL *)pData;
+#endif
+	struct sk_buff *pSkb;
+	unsigned long Flags;
+
+	while (pPool->DepotNum < pPool->ObjNum)
+	{
+		pSkb = __dev_alloc_skb(pPool->ObjSize, GFP_KERNEL);
+		if (pSkb == NULL)
+			break;
+
+		spin_lock_irqsave(&pPool->DepotLock, Flags);
+		if (pPool->DepotNum < pPool->ObjNum)
+		{
+			pPool->pDepot[pPool->DepotNum++] = pSkb;
+			pSkb = NULL;
+			pPool->Refill++;
+		}
+		spin_unlock_irqrestore(&pPool->DepotLock, Flags);
+
+		if (pSkb != NULL)
+		{
+			dev_kfree_skb(pSkb);
+			break;
+		}
+	}
+}
+
+
+/*
+========================================================================
+Routine Description:
+	Create an object pool.
+
+Arguments:
+	pName			name shown in the statistics
+	ObjSize			object size, or data size of the skbs
+	ObjNum			number of objects kept by the pool
+	bSkb			TRUE for a pool of skbs
+
+Return Value:
+	pool handle, NULL on failure
+
+Note:
+	Process context only.
+========================================================================
+*/
+VOID *RtmpOsPoolCreate(
+	IN const char *pName,
+	IN unsigned int ObjSize,
+	IN unsigned int ObjNum,
+	IN bool bSkb)
+{
+	OS_POOL *pPool;
+	unsigned int i;
+
+	pPool = kzalloc(sizeof(OS_POOL), GFP_KERNEL);
+	if (pPool == NULL)
+		return NULL;
+
+	strncpy(pPool->Name, pName, sizeof(pPool->Name) - 1);
+	pPool->bSkb = bSkb;
+	pPool->ObjSize = bSkb ? ObjSize : ALIGN(ObjSize, sizeof(unsigned long long));
+	pPool->ObjNum = ObjNum;
+	spin_lock_init(&pPool->DepotLock);
+	atomic_set(&pPool->InUse, 0);
+	atomic_set(&pPool->Fallback, 0);
+	atomic_set(&pPool->Fail, 0);
+
+	pPool->pDepot = kmalloc(ObjNum * sizeof(VOID *), GFP_KERNEL);
+	pPool->pCpu = alloc_percpu(OS_POOL_CPU);
+	if ((pPool->pDepot == NULL) || (pPool->pCpu == NULL))
+		goto err;
+
+	if (bSkb)
+	{
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,20)
+		INIT_WORK(&pPool->RefillWork, RtmpOsSkbPoolRefill);
+		RtmpOsSkbPoolRefill(&pPool->RefillWork);
+#else
+		INIT_WORK(&pPool->RefillWork, RtmpOsSkbPoolRefill, pPool);
+		RtmpOsSkbPoolRefill(pPool);
+#endif
+	}
+	else
+	{
+		pPool->pRegion = vmalloc(pPool->ObjSize * ObjNum);
+		if (pPool->pRegion == NULL)
+			goto err;
+
+		for (i = 0; i < ObjNum; i++)
+			pPool->pDepot[i] = pPool->pRegion + i * pPool->ObjSize;
+		pPool->DepotNum = ObjNum;
+	}
+	pPool->DepotLow = pPool->DepotNum;
+
+	return pPool;
+
+err:
+	if (pPool->pCpu)
+		free_percpu(pPool->pCpu);
+	if (pPool->pDepot)
+		kfree(pPool->pDepot);
+	kfree(pPool);
+	return NULL;
+}
+
+
+/* Every object taken from a memory pool must have been given back */
+VOID RtmpOsPoolDestroy(
+	IN VOID *pPoolHandle)
+{
+	OS_POOL *pPool = (OS_POOL *)pPoolHandle;
+	OS_POOL_CPU *pCpu;
+	unsigned int i;
+	int Cpu;
+
+	if (pPool == NULL)
+		return;
+
+	if (pPool->bSkb)
+	{
+		cancel_work_sync(&pPool->RefillWork);
+
+		for (i = 0; i < pPool->DepotNum; i++)
+			dev_kfree_skb((struct sk_buff *)pPool->pDepot[i]);
+		for_each_possible_cpu(Cpu)
+		{
+			pCpu = per_cpu_ptr(pPool->pCpu, Cpu);
+			for (i = 0; i < pCpu->Num; i++)
+				dev_kfree_skb((struct sk_buff *)pCpu->pObj[i]);
+		}
+	}
+	else
+		vfree(pPool->pRegion);
+
+	free_percpu(pPool->pCpu);
+	kfree(pPool->pDepot);
+	kfree(pPool);
+}
+
+
+/*
+	Take an object of up to Size bytes. It comes from the general allocator
+	when the pool is empty, too small or not there.
+*/
+VOID *RtmpOsMemPoolAlloc(
+	IN VOID *pPoolHandle,
+	IN unsigned long Size)
+{
+	OS_POOL *pPool = (OS_POOL *)pPoolHandle;
+	VOID *pMem;
+	unsigned int InUse;
+
+	if ((pPool != NULL) && (Size <= pPool->ObjSize))
+	{
+		pMem = RtmpOsPoolGet(pPool);
+		if (pMem != NULL)
+		{
+			InUse = atomic_inc_return(&pPool->InUse);
+			if (InUse > pPool->HighWater)
+				pPool->HighWater = InUse;
+			return pMem;
+		}
+	}
+
+	pMem = kmalloc(Size, GFP_ATOMIC);
+	if (pPool != NULL)
+	{
+		atomic_inc(&pPool->Fallback);
+		if (pMem == NULL)
+			atomic_inc(&pPool->Fail);
+	}
+
+	return pMem;
+}
+
+
+VOID RtmpOsMemPoolFree(
+	IN VOID *pPoolHandle,
+	IN VOID *pMem)
+{
+	OS_POOL *pPool = (OS_POOL *)pPoolHandle;
+
+	if ((pPool != NULL)
+		&& ((unsigned char *)pMem >= pPool->pRegion)
+		&& ((unsigned char *)pMem < pPool->pRegion + pPool->ObjSize * pPool->ObjNum))
+	{
+		atomic_dec(&pPool->InUse);
+		RtmpOsPoolPut(pPool, pMem);
+		return;
+	}
+
+	kfree(pMem);
+}
+
+
+/* Same as RTMP_AllocateFragPacketBuffer(), from the pool when Length fits */
+PNDIS_PACKET RtmpOsSkbPoolAlloc(
+	IN VOID *pPoolHandle,
+	IN unsigned long Length)
+{
+	OS_POOL *pPool = (OS_POOL *)pPoolHandle;
+	struct sk_buff *pSkb;
+
+	if ((pPool != NULL) && (Length <= pPool->ObjSize))
+	{
+		pSkb = (struct sk_buff *)RtmpOsPoolGet(pPool);
+
+		/* unlocked peek, a late refill only costs a few fallbacks */
+		if (pPool->DepotNum < pPool->ObjNum / 2)
+			schedule_work(&pPool->RefillWork);
+
+		if (pSkb != NULL)
+		{
+			MEM_DBG_PKT_ALLOC_INC(pSkb);
+			RTMP_SET_PACKET_SOURCE(OSPKT_TO_RTPKT(pSkb), PKTSRC_NDIS);
+			return (PNDIS_PACKET)pSkb;
+		}
+
+		atomic_inc(&pPool->Fallback);
+	}
+
+	pSkb = (struct sk_buff *)RTMP_AllocateFragPacketBuffer(NULL, Length);
+	if ((pPool != NULL) && (pSkb == NULL))
+		atomic_inc(&pPool->Fail);
+
+	return (PNDIS_PACKET)pSkb;
+}
+
+
+VOID RtmpOsPoolStatsGet(
+	IN VOID *pPoolHandle,
+	OUT RTMP_OS_POOL_STATS *pStats)
+{
+	OS_POOL *pPool = (OS_POOL *)pPoolHandle;
+	OS_POOL_CPU *pCpu;
+	int Cpu;
+
+	memset(pStats, 0, sizeof(RTMP_OS_POOL_STATS));
+	if (pPool == NULL)
+		return;
+
+	memcpy(pStats->Name, pPool->Name, sizeof(pStats->Name));
+	pStats->ObjSize = pPool->ObjSize;
+	pStats->ObjNum = pPool->ObjNum;
+	pStats->Free = pPool->DepotNum;
+	for_each_possible_cpu(Cpu)
+	{
+		pCpu = per_cpu_ptr(pPool->pCpu, Cpu);
+		pStats->Free += pCpu->Num;
+		pStats->Alloc += pCpu->Alloc;
+		pStats->Hit += pCpu->Hit;
+	}
+
+	if (pPool->bSkb)
+	{
+		/* skbs don't come back, the deepest the depot went is the high-water mark */
+		pStats->InUse = 0;
+		pStats->HighWater = pPool->ObjNum - pPool->DepotLow;
+	}
+	else
+	{
+		pStats->InUse = atomic_read(&pPool->InUse);
+		pStats->HighWater = pPool->HighWater;
+	}
+	pStats->Fallback = atomic_read(&pPool->Fallback);
+	pStats->Fail = atomic_read(&pPool->Fail);
+	pStats->Refill = pPool->Refill;
+}
+#endif /* MEM_POOL_SUPPORT */
+
 
 /*
 	The allocated NDIS PACKET must be freed via RTMPFreeNdisPacket()
@@ -2115,6 +2492,41 @@ VOID RtmpOsPktRcvHandle(PNDIS_PACKET pNetPkt)
 }
 
 
+#ifdef RX_NAPI_SUPPORT
+/*
+========================================================================
+Routine Description:
+	Pass the received packet to OS through GRO, only valid from inside
+	the NAPI poll.
+
+Arguments:
+	pNapi			- the napi_struct being polled
+	pPkt			- the packet
+
+Return Value:
+	None
+
+Note:
+========================================================================
+*/
+VOID RtmpOsPktNapiRcvHandle(VOID *pNapi, PNDIS_PACKET pNetPkt)
+{
+	struct sk_buff *pRxPkt = RTPKT_TO_OSPKT(pNetPkt);
+
+#ifdef CONFIG_RX_CSO_SUPPORT
+
+	if (RTMP_GET_TCP_CHKSUM_FAIL(pNetPkt))
+		pRxPkt->ip_summed = CHECKSUM_NONE;
+	else
+		pRxPkt->ip_summed = CHECKSUM_UNNECESSARY;
+
+#endif
+
+	napi_gro_receive((struct napi_struct *)pNapi, pRxPkt);
+}
+#endif /* RX_NAPI_SUPPORT */
+
+
 VOID RtmpOsTaskPidInit(RTMP_OS_PID *pPid)
 {
 	*pPid = THREAD_PID_INIT_VALUE;
@@ -4282,6 +4694,551 @@ VOID RtmpOsGetSystemUpTime(unsigned long *pTime)
 	NdisGetSystemUpTime(pTime);
 }
 
+
+/*
+========================================================================
+Routine Description:
+	Get a free running time stamp in usec, for measuring intervals
+	shorter than a tick.
+
+Arguments:
+	None
+
+Return Value:
+	usec, wraps around every 71 minutes
+
+Note:
+========================================================================
+*/
+unsigned int RtmpOsGetUsecTime(VOID)
+{
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,22)
+	return (unsigned int)ktime_to_us(ktime_get());
+#else
+	return jiffies_to_usecs(jiffies);
+#endif
+}
+
+/*
+========================================================================
+Routine Description:
+	Read a monotonic nanosecond clock, for measuring the cost of a code path.
+
+Arguments:
+	None
+
+Return Value:
+	nanoseconds
+
+Note:
+	get_cycles() reads 0 on ARM32 and others without a usable cycle
+	counter, so the clock source is used instead.
+========================================================================
+*/
+unsigned long long RtmpOsGetNsec(VOID)
+{
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,22)
+	return (unsigned long long)ktime_to_ns(ktime_get());
+#else
+	return (unsigned long long)jiffies_to_usecs(jiffies) * 1000;
+#endif
+}
+
+/*
+========================================================================
+Routine Description:
+	Identify the calling task, for state only its owner may touch.
+
+Arguments:
+	None
+
+Return Value:
+	an opaque handle, equal for calls from the same task
+
+Note:
+========================================================================
+*/
+VOID *RtmpOsCurrentTask(VOID)
+{
+	return (VOID *)current;
+}
+
+/*
+========================================================================
+Routine Description:
+	Start counting hardware cache misses in kernel mode on every online
+	CPU.
+
+Arguments:
+	None
+
+Return Value:
+	handle for RtmpOsCacheMissRead(), NULL if the PMU has no such counter
+
+Note:
+	May sleep. CPUs brought online later are not counted.
+========================================================================
+*/
+VOID *RtmpOsCacheMissStart(VOID)
+{
+#ifdef CONFIG_PERF_EVENTS
+	struct perf_event_attr Attr;
+	struct perf_event **ppEvent, *pEvent;
+	INT Cpu, Count = 0;
+
+	ppEvent = kcalloc(nr_cpu_ids, sizeof(struct perf_event *), GFP_KERNEL);
+	if (ppEvent == NULL)
+		return NULL;
+
+	memset(&Attr, 0, sizeof(Attr));
+	Attr.type = PERF_TYPE_HARDWARE;
+	Attr.config = PERF_COUNT_HW_CACHE_MISSES;
+	Attr.size = sizeof(Attr);
+	Attr.pinned = 1;
+	Attr.exclude_user = 1;
+
+	for_each_online_cpu(Cpu)
+	{
+		pEvent = perf_event_create_kernel_counter(&Attr, Cpu, NULL, NULL, NULL);
+		if (IS_ERR(pEvent))
+			continue;
+		ppEvent[Cpu] = pEvent;
+		Count++;
+	}
+
+	if (Count == 0)
+	{
+		kfree(ppEvent);
+		return NULL;
+	}
+
+	return ppEvent;
+#else
+	return NULL;
+#endif /* CONFIG_PERF_EVENTS */
+}
+
+/*
+========================================================================
+Routine Description:
+	Read the cache misses counted since RtmpOsCacheMissStart().
+
+Arguments:
+	pHandle			- from RtmpOsCacheMissStart()
+
+Return Value:
+	misses summed over all CPUs
+
+Note:
+	May sleep.
+========================================================================
+*/
+unsigned long long RtmpOsCacheMissRead(
+	IN	VOID						*pHandle)
+{
+	unsigned long long Misses = 0;
+#ifdef CONFIG_PERF_EVENTS
+	struct perf_event **ppEvent = (struct perf_event **)pHandle;
+	u64 Enabled, Running;
+	INT Cpu;
+
+	for (Cpu = 0; Cpu < nr_cpu_ids; Cpu++)
+	{
+		if (ppEvent[Cpu] != NULL)
+			Misses += perf_event_read_value(ppEvent[Cpu], &Enabled, &Running);
+	}
+#endif /* CONFIG_PERF_EVENTS */
+	return Misses;
+}
+
+/*
+========================================================================
+Routine Description:
+	Release the counters of RtmpOsCacheMissStart().
+
+Arguments:
+	pHandle			- from RtmpOsCacheMissStart()
+
+Return Value:
+	None
+
+Note:
+========================================================================
+*/
+VOID RtmpOsCacheMissStop(
+	IN	VOID						*pHandle)
+{
+#ifdef CONFIG_PERF_EVENTS
+	struct perf_event **ppEvent = (struct perf_event **)pHandle;
+	INT Cpu;
+
+	for (Cpu = 0; Cpu < nr_cpu_ids; Cpu++)
+	{
+		if (ppEvent[Cpu] != NULL)
+			perf_event_release_kernel(ppEvent[Cpu]);
+	}
+	kfree(ppEvent);
+#endif /* CONFIG_PERF_EVENTS */
+}
+
+#ifdef CONFIG_DEBUG_FS
+typedef struct _OS_DEBUGFS_FILE {
+	struct _OS_DEBUGFS_FILE *pNext;
+	INT (*pShow)(VOID *pSeq, VOID *pData);
+	VOID *pData;
+} OS_DEBUGFS_FILE;
+
+typedef struct _OS_DEBUGFS_DIR {
+	struct dentry *pDentry;
+	OS_DEBUGFS_FILE *pFileList;
+} OS_DEBUGFS_DIR;
+
+static int RtmpOsDebugfsShow(struct seq_file *pSeq, void *pUnused)
+{
+	OS_DEBUGFS_FILE *pFile = (OS_DEBUGFS_FILE *)pSeq->private;
+
+	return pFile->pShow(pSeq, pFile->pData);
+}
+
+static int RtmpOsDebugfsOpen(struct inode *pInode, struct file *pFile)
+{
+	return single_open(pFile, RtmpOsDebugfsShow, pInode->i_private);
+}
+
+static const struct file_operations RtmpOsDebugfsFops = {
+	.owner		= THIS_MODULE,
+	.open		= RtmpOsDebugfsOpen,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+#endif /* CONFIG_DEBUG_FS */
+
+/*
+========================================================================
+Routine Description:
+	Create a directory in the root of debugfs.
+
+Arguments:
+	pName			- directory name
+
+Return Value:
+	handle for RtmpOsDebugfsFileCreate(), NULL if debugfs is not available
+
+Note:
+	May sleep.
+========================================================================
+*/
+VOID *RtmpOsDebugfsDirCreate(
+	IN	char						*pName)
+{
+#ifdef CONFIG_DEBUG_FS
+	OS_DEBUGFS_DIR *pDir;
+
+	pDir = kzalloc(sizeof(OS_DEBUGFS_DIR), GFP_KERNEL);
+	if (pDir == NULL)
+		return NULL;
+
+	pDir->pDentry = debugfs_create_dir(pName, NULL);
+	if (IS_ERR_OR_NULL(pDir->pDentry))
+	{
+		kfree(pDir);
+		return NULL;
+	}
+
+	return pDir;
+#else
+	return NULL;
+#endif /* CONFIG_DEBUG_FS */
+}
+
+/*
+========================================================================
+Routine Description:
+	Create a read-only file whose content is produced by a show function
+	on every open.
+
+Arguments:
+	pHandle			- from RtmpOsDebugfsDirCreate()
+	pName			- file name
+	pShow			- prints the content with RtmpOsSeqPrintf(pSeq, ...)
+	pData			- second argument of pShow
+
+Return Value:
+	TRUE if the file was created
+
+Note:
+	May sleep. pShow runs in process context and may sleep too.
+========================================================================
+*/
+bool RtmpOsDebugfsFileCreate(
+	IN	VOID						*pHandle,
+	IN	char						*pName,
+	IN	INT							(*pShow)(VOID *pSeq, VOID *pData),
+	IN	VOID						*pData)
+{
+#ifdef CONFIG_DEBUG_FS
+	OS_DEBUGFS_DIR *pDir = (OS_DEBUGFS_DIR *)pHandle;
+	OS_DEBUGFS_FILE *pFile;
+	struct dentry *pDentry;
+
+	if (pDir == NULL)
+		return FALSE;
+
+	pFile = kzalloc(sizeof(OS_DEBUGFS_FILE), GFP_KERNEL);
+	if (pFile == NULL)
+		return FALSE;
+
+	pFile->pShow = pShow;
+	pFile->pData = pData;
+
+	pDentry = debugfs_create_file(pName, 0444, pDir->pDentry, pFile, &RtmpOsDebugfsFops);
+	if (IS_ERR_OR_NULL(pDentry))
+	{
+		kfree(pFile);
+		return FALSE;
+	}
+
+	pFile->pNext = pDir->pFileList;
+	pDir->pFileList = pFile;
+
+	return TRUE;
+#else
+	return FALSE;
+#endif /* CONFIG_DEBUG_FS */
+}
+
+/*
+========================================================================
+Routine Description:
+	Remove a debugfs directory with all files in it.
+
+Arguments:
+	pHandle			- from RtmpOsDebugfsDirCreate()
+
+Return Value:
+	None
+
+Note:
+	May sleep, waits for readers of the files.
+========================================================================
+*/
+VOID RtmpOsDebugfsRemove(
+	IN	VOID						*pHandle)
+{
+#ifdef CONFIG_DEBUG_FS
+	OS_DEBUGFS_DIR *pDir = (OS_DEBUGFS_DIR *)pHandle;
+	OS_DEBUGFS_FILE *pFile;
+
+	if (pDir == NULL)
+		return;
+
+	debugfs_remove_recursive(pDir->pDentry);
+
+	while (pDir->pFileList != NULL)
+	{
+		pFile = pDir->pFileList;
+		pDir->pFileList = pFile->pNext;
+		kfree(pFile);
+	}
+	kfree(pDir);
+#endif /* CONFIG_DEBUG_FS */
+}
+
+/*
+========================================================================
+Routine Description:
+	printf into the file being produced by a debugfs show function.
+
+Arguments:
+	pSeq			- first argument of the show function
+	pFmt			- printf format
+
+Return Value:
+	None
+
+Note:
+========================================================================
+*/
+VOID RtmpOsSeqPrintf(
+	IN	VOID						*pSeq,
+	IN	const char					*pFmt,
+	...)
+{
+#ifdef CONFIG_DEBUG_FS
+	va_list Args;
+
+	va_start(Args, pFmt);
+	seq_vprintf((struct seq_file *)pSeq, pFmt, Args);
+	va_end(Args);
+#endif /* CONFIG_DEBUG_FS */
+}
+
+#ifndef OS_ABL_FUNC_SUPPORT
+static enum hrtimer_restart RtmpOsHrTimerHandler(struct hrtimer *pHrTimer)
+{
+	OS_HRTIMER *pTimer = container_of(pHrTimer, OS_HRTIMER, Timer);
+
+	pTimer->pFunc(pTimer->pData);
+	return HRTIMER_NORESTART;
+}
+
+/*
+========================================================================
+Routine Description:
+	Initialize a one shot high resolution timer.
+
+Arguments:
+	pTimer			- the timer
+	pFunc			- called in hard irq context when the timer expires
+	pData			- argument of pFunc
+
+Return Value:
+	None
+
+Note:
+	pFunc must not sleep or take bh locks, defer the work to a tasklet.
+========================================================================
+*/
+VOID RtmpOsHrTimerInit(
+	IN	OS_HRTIMER					*pTimer,
+	IN	VOID						(*pFunc)(VOID *pData),
+	IN	VOID						*pData)
+{
+	pTimer->pFunc = pFunc;
+	pTimer->pData = pData;
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6,13,0)
+	hrtimer_setup(&pTimer->Timer, RtmpOsHrTimerHandler, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+#else
+	hrtimer_init(&pTimer->Timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	pTimer->Timer.function = RtmpOsHrTimerHandler;
+#endif
+}
+
+/*
+========================================================================
+Routine Description:
+	(Re)start a high resolution timer, a pending expiry is replaced.
+
+Arguments:
+	pTimer			- the timer
+	Usec			- expire after this many usec
+
+Return Value:
+	None
+
+Note:
+========================================================================
+*/
+VOID RtmpOsHrTimerStart(
+	IN	OS_HRTIMER					*pTimer,
+	IN	unsigned int				Usec)
+{
+	hrtimer_start(&pTimer->Timer, ns_to_ktime((u64)Usec * NSEC_PER_USEC), HRTIMER_MODE_REL);
+}
+
+bool RtmpOsHrTimerPending(
+	IN	OS_HRTIMER					*pTimer)
+{
+	return hrtimer_is_queued(&pTimer->Timer) ? TRUE : FALSE;
+}
+
+/*
+========================================================================
+Routine Description:
+	Stop a high resolution timer and wait for a running handler.
+
+Arguments:
+	pTimer			- the timer
+
+Return Value:
+	None
+
+Note:
+========================================================================
+*/
+VOID RtmpOsHrTimerCancel(
+	IN	OS_HRTIMER					*pTimer)
+{
+	hrtimer_cancel(&pTimer->Timer);
+}
+
+/*
+========================================================================
+Routine Description:
+	Stop a high resolution timer without waiting for a running handler.
+
+Arguments:
+	pTimer			- the timer
+
+Return Value:
+	None
+
+Note:
+	For atomic context, a handler already running still completes.
+========================================================================
+*/
+VOID RtmpOsHrTimerTryCancel(
+	IN	OS_HRTIMER					*pTimer)
+{
+	hrtimer_try_to_cancel(&pTimer->Timer);
+}
+
+static VOID RtmpOsRcuHandler(struct rcu_head *pRcu)
+{
+	OS_RCU_HEAD *pHead = container_of(pRcu, OS_RCU_HEAD, Head);
+
+	pHead->pFunc(pHead->pData);
+}
+
+/*
+========================================================================
+Routine Description:
+	Call a function once every RCU reader running now has finished.
+
+Arguments:
+	pHead			- must stay untouched until pFunc is called
+	pFunc			- called in softirq context
+	pData			- argument of pFunc
+
+Return Value:
+	None
+
+Note:
+	Does not sleep. Use RtmpOsRcuBarrier() before freeing pHead.
+========================================================================
+*/
+VOID RtmpOsCallRcu(
+	IN	OS_RCU_HEAD					*pHead,
+	IN	VOID						(*pFunc)(VOID *pData),
+	IN	VOID						*pData)
+{
+	pHead->pFunc = pFunc;
+	pHead->pData = pData;
+	call_rcu(&pHead->Head, RtmpOsRcuHandler);
+}
+
+/*
+========================================================================
+Routine Description:
+	Wait for the callbacks queued by RtmpOsCallRcu().
+
+Arguments:
+	None
+
+Return Value:
+	None
+
+Note:
+	May sleep.
+========================================================================
+*/
+VOID RtmpOsRcuBarrier(VOID)
+{
+	rcu_barrier();
+}
+#endif /* OS_ABL_FUNC_SUPPORT */
+
 /*
 ========================================================================
 Routine Description:
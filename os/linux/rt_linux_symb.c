@@ -48,6 +48,14 @@ EXPORT_SYMBOL(os_free_mem);
 EXPORT_SYMBOL(ExpandPacket);
 EXPORT_SYMBOL(ClonePacket);
 EXPORT_SYMBOL(RTMP_AllocateFragPacketBuffer);
+#ifdef MEM_POOL_SUPPORT
+EXPORT_SYMBOL(RtmpOsPoolCreate);
+EXPORT_SYMBOL(RtmpOsPoolDestroy);
+EXPORT_SYMBOL(RtmpOsMemPoolAlloc);
+EXPORT_SYMBOL(RtmpOsMemPoolFree);
+EXPORT_SYMBOL(RtmpOsSkbPoolAlloc);
+EXPORT_SYMBOL(RtmpOsPoolStatsGet);
+#endif /* MEM_POOL_SUPPORT */
 EXPORT_SYMBOL(Sniff2BytesFromNdisBuffer);
 EXPORT_SYMBOL(RtmpOSNetPktAlloc);
 EXPORT_SYMBOL(duplicate_pkt_with_TKIP_MIC);
@@ -151,6 +159,25 @@ EXPORT_SYMBOL(RtmpOsWait);
 EXPORT_SYMBOL(RtmpOsTimerAfter);
 EXPORT_SYMBOL(RtmpOsTimerBefore);
 EXPORT_SYMBOL(RtmpOsGetSystemUpTime);
+EXPORT_SYMBOL(RtmpOsGetUsecTime);
+EXPORT_SYMBOL(RtmpOsGetNsec);
+EXPORT_SYMBOL(RtmpOsCurrentTask);
+EXPORT_SYMBOL(RtmpOsCacheMissStart);
+EXPORT_SYMBOL(RtmpOsCacheMissRead);
+EXPORT_SYMBOL(RtmpOsCacheMissStop);
+EXPORT_SYMBOL(RtmpOsDebugfsDirCreate);
+EXPORT_SYMBOL(RtmpOsDebugfsFileCreate);
+EXPORT_SYMBOL(RtmpOsDebugfsRemove);
+EXPORT_SYMBOL(RtmpOsSeqPrintf);
+#ifndef OS_ABL_FUNC_SUPPORT
+EXPORT_SYMBOL(RtmpOsHrTimerInit);
+EXPORT_SYMBOL(RtmpOsHrTimerStart);
+EXPORT_SYMBOL(RtmpOsHrTimerPending);
+EXPORT_SYMBOL(RtmpOsHrTimerCancel);
+EXPORT_SYMBOL(RtmpOsHrTimerTryCancel);
+EXPORT_SYMBOL(RtmpOsCallRcu);
+EXPORT_SYMBOL(RtmpOsRcuBarrier);
+#endif /* OS_ABL_FUNC_SUPPORT */
 
 EXPORT_SYMBOL(RtmpOsDCacheFlush);
 
@@ -262,6 +289,12 @@ EXPORT_SYMBOL(RtmpOsUsbInitRxDesc);
 EXPORT_SYMBOL(RtmpOsUsbContextGet);
 EXPORT_SYMBOL(RtmpOsUsbStatusGet);
 EXPORT_SYMBOL(RtmpOsUsbDmaMapping);
+#ifdef USB_BULK_OUT_SG_SUPPORT
+EXPORT_SYMBOL(RtmpOsUsbSgSupport);
+EXPORT_SYMBOL(RtmpOsUsbSgTableAlloc);
+EXPORT_SYMBOL(RtmpOsUsbSgTableFree);
+EXPORT_SYMBOL(RtmpOsUsbInitSgTxDesc);
+#endif /* USB_BULK_OUT_SG_SUPPORT */
 EXPORT_SYMBOL(RtmpOsGetUsbDevVendorID);
 EXPORT_SYMBOL(RtmpOsGetUsbDevProductID);
 #endif /* RTMP_MAC_USB */
@@ -386,6 +386,8 @@ void tbtt_tasklet(unsigned long data)
 					{
 						RTMP_SET_PACKET_MOREDATA(pEntry, TRUE);
 					}
+					/* CoDel works on the time a frame waits on TxSwQueue */
+					AQM_STAMP_PACKET(pEntry);
 					InsertHeadQueue(&pAd->TxSwQueue[QID_AC_BE], pEntry);
 					count++;
 				}
@@ -425,7 +427,7 @@ void announce_802_3_packet(
 	IN PNDIS_PACKET pPacket,
 	IN unsigned char OpMode)
 {
-#if defined(IKANOS_VX_1X0) || defined(INF_PPA_SUPPORT)
+#if defined(IKANOS_VX_1X0) || defined(INF_PPA_SUPPORT) || defined(RX_NAPI_SUPPORT)
 	RTMP_ADAPTER *pAd = (RTMP_ADAPTER *)pAdSrc;
 #endif
 	PNDIS_PACKET pRxPkt = pPacket;
@@ -490,6 +492,18 @@ if (0) {
 //---Add by shiang for debug
 
 		RtmpOsPktProtocolAssign(pRxPkt);
+#ifdef RX_NAPI_SUPPORT
+{
+		POS_COOKIE pObj = (POS_COOKIE) pAd->OS_Cookie;
+
+		/* BA flush timers and the MLME path still use netif_rx */
+		if (RTMP_OS_RX_NAPI_IN_POLL(pObj))
+		{
+			RtmpOsPktNapiRcvHandle(&pObj->rx_napi, pRxPkt);
+			return;
+		}
+}
+#endif /* RX_NAPI_SUPPORT */
 		RtmpOsPktRcvHandle(pRxPkt);
 }
 
@@ -507,6 +521,11 @@ VOID	RTMPFreeAdapter(
 
 	os_cookie=(POS_COOKIE)pAd->OS_Cookie;
 
+#ifdef MAC_TABLE_RCU_SUPPORT
+	/* the MAC table retire callbacks tear entries down, before their locks and pools go */
+	RtmpOsRcuBarrier();
+#endif /* MAC_TABLE_RCU_SUPPORT */
+
 	if (pAd->BeaconBuf)
 		os_free_mem(NULL, pAd->BeaconBuf);
 
@@ -546,6 +565,33 @@ VOID	RTMPFreeAdapter(
 
 	NdisFreeSpinLock(&TimerSemLock);
 
+#ifdef MEM_POOL_SUPPORT
+	MemPoolExit(pAd);
+#endif /* MEM_POOL_SUPPORT */
+
+#ifdef CACHE_MISS_STAT_SUPPORT
+	CacheMissStatStop(pAd);
+#endif /* CACHE_MISS_STAT_SUPPORT */
+
+#if defined(PHY_SHADOW_SUPPORT) || defined(BOOT_PROF_SUPPORT)
+	RtmpOsDebugfsRemove(pAd->pDebugfsDir);
+	pAd->pDebugfsDir = NULL;
+#endif /* PHY_SHADOW_SUPPORT || BOOT_PROF_SUPPORT */
+
+#ifdef REG_DEFER_SUPPORT
+	RegDeferExit(pAd);
+#endif /* REG_DEFER_SUPPORT */
+
+#ifdef PHY_SHADOW_SUPPORT
+	PhyShadowExit(pAd);
+#endif /* PHY_SHADOW_SUPPORT */
+
+#ifdef CONFIG_AP_SUPPORT
+#ifdef PROBE_CACHE_SUPPORT
+	APProbeRspCacheFree(pAd);
+#endif /* PROBE_CACHE_SUPPORT */
+#endif /* CONFIG_AP_SUPPORT */
+
 #ifdef RALINK_ATE
 #ifdef RTMP_MAC_USB
 	RTMP_OS_ATMOIC_DESTROY(&pAd->BulkOutRemained);
@@ -216,6 +216,9 @@ static void rtusb_dataout_complete(unsigned long data)
 		RTMP_IRQ_UNLOCK(&pAd->BulkOutLock[BulkOutPipeId], IrqFlags);
 	
 		pAd->Counters8023.GoodTransmits++;
+#ifdef USB_TX_ADAPTIVE_BATCH
+		RTUSBTxBatchUrbComplete(pAd, BulkOutPipeId);
+#endif /* USB_TX_ADAPTIVE_BATCH */
 		/*RTMP_IRQ_LOCK(&pAd->TxContextQueueLock[BulkOutPipeId], IrqFlags); */
 		FREE_HTTX_RING(pAd, BulkOutPipeId, pHTTXContext);			
 		/*RTMP_IRQ_UNLOCK(&pAd->TxContextQueueLock[BulkOutPipeId], IrqFlags); */
@@ -474,57 +477,92 @@ static void rx_done_tasklet(unsigned long data)
 	PRTMP_ADAPTER		pAd;
 	NTSTATUS			Status;
 	unsigned int		IrqFlags;
+	unsigned char		Index, Count;
 
 	pUrb		= (purbb_t)data;
 /*	pRxContext	= (PRX_CONTEXT)pUrb->context; */
 	pRxContext	= (PRX_CONTEXT)RTMP_USB_URB_DATA_GET(pUrb);
-	Status		= RTMP_USB_URB_STATUS_GET(pUrb);
 	pAd 		= pRxContext->pAd;
 /*	Status = pUrb->status; */
 
-
+	/*
+		With several bulk-in URBs in flight more than one may have
+		completed since we were scheduled. They complete in submit
+		order, so walk the ring from the oldest one.
+	*/
 	RTMP_IRQ_LOCK(&pAd->BulkInLock, IrqFlags);
-	pRxContext->InUse = FALSE;
-	pRxContext->IRPPending = FALSE;
-	pRxContext->BulkInOffset += RTMP_USB_URB_LEN_GET(pUrb); /*pUrb->actual_length; */
-	/*NdisInterlockedDecrement(&pAd->PendingRx); */
-	if ( pAd->PendingRx > 0 )
-		pAd->PendingRx--;
+	Index = pAd->NextRxBulkInIndex;
+	RTMP_IRQ_UNLOCK(&pAd->BulkInLock, IrqFlags);
 
-	if (Status == USB_ST_NOERROR)
+	for (Count = 0; Count < RX_RING_SIZE; Count++)
 	{
-		pAd->BulkInComplete++;
-		pAd->NextRxBulkInPosition = 0;
-		if (pRxContext->BulkInOffset)	/* As jan's comment, it may bulk-in success but size is zero. */
+		RTMP_IRQ_LOCK(&pAd->BulkInLock, IrqFlags);
+		pRxContext = &pAd->RxContext[Index];
+		if (pRxContext->bRxUrbDone == FALSE)
 		{
-			pRxContext->Readable = TRUE;
-			INC_RING_INDEX(pAd->NextRxBulkInIndex, RX_RING_SIZE);
+			RTMP_IRQ_UNLOCK(&pAd->BulkInLock, IrqFlags);
+			break;
 		}
-		RTMP_IRQ_UNLOCK(&pAd->BulkInLock, IrqFlags);
-	}
-	else	 /* STATUS_OTHER */
-	{
-		pAd->BulkInCompleteFail++;
-		/* Still read this packet although it may comtain wrong bytes. */
-		pRxContext->Readable = FALSE;
-		RTMP_IRQ_UNLOCK(&pAd->BulkInLock, IrqFlags);
-
-		/* Parsing all packets. because after reset, the index will reset to all zero. */
-		if ((!RTMP_TEST_FLAG(pAd, (fRTMP_ADAPTER_RESET_IN_PROGRESS |
-									fRTMP_ADAPTER_BULKIN_RESET |
-									fRTMP_ADAPTER_HALT_IN_PROGRESS |
-									fRTMP_ADAPTER_NIC_NOT_EXIST))))
+		pRxContext->bRxUrbDone = FALSE;
+		pUrb = pRxContext->pUrb;
+		Status = RTMP_USB_URB_STATUS_GET(pUrb);
+		INC_RING_INDEX(Index, RX_RING_SIZE);
+
+		RTUSBBulkRxStat(pAd, RTMP_USB_URB_LEN_GET(pUrb));
+
+		pRxContext->InUse = FALSE;
+		pRxContext->IRPPending = FALSE;
+		pRxContext->BulkInOffset += RTMP_USB_URB_LEN_GET(pUrb); /*pUrb->actual_length; */
+		/*NdisInterlockedDecrement(&pAd->PendingRx); */
+		if ( pAd->PendingRx > 0 )
+			pAd->PendingRx--;
+
+		if ((Status == USB_ST_NOERROR) && RTMP_TEST_FLAG(pAd, fRTMP_ADAPTER_BULKIN_RESET))
 		{
-			
-			DBGPRINT_RAW(RT_DEBUG_ERROR, ("Bulk In Failed. Status=%d, BIIdx=0x%x, BIRIdx=0x%x, actual_length= 0x%x\n", 
-							Status, pAd->NextRxBulkInIndex, pAd->NextRxBulkInReadIndex, RTMP_USB_URB_LEN_GET(pRxContext->pUrb))); /*->actual_length)); */
+			/* queued behind a failed transfer, the reset starts over from that one */
+			pRxContext->BulkInOffset = 0;
+			RTMP_IRQ_UNLOCK(&pAd->BulkInLock, IrqFlags);
+		}
+		else if (Status == USB_ST_NOERROR)
+		{
+			pAd->BulkInComplete++;
+			pAd->NextRxBulkInPosition = 0;
+			/*
+				As jan's comment, it may bulk-in success but size is zero.
+				An empty buffer with URBs queued behind it is still handed
+				to the parser, or the ring would stop at it.
+			*/
+			if (pRxContext->BulkInOffset || (pAd->PendingRx > 0))
+			{
+				pRxContext->Readable = TRUE;
+				pAd->NextRxBulkInIndex = Index;
+			}
+			RTMP_IRQ_UNLOCK(&pAd->BulkInLock, IrqFlags);
+		}
+		else	 /* STATUS_OTHER */
+		{
+			pAd->BulkInCompleteFail++;
+			/* Still read this packet although it may comtain wrong bytes. */
+			pRxContext->Readable = FALSE;
+			RTMP_IRQ_UNLOCK(&pAd->BulkInLock, IrqFlags);
+
+			/* Parsing all packets. because after reset, the index will reset to all zero. */
+			if ((!RTMP_TEST_FLAG(pAd, (fRTMP_ADAPTER_RESET_IN_PROGRESS |
+										fRTMP_ADAPTER_BULKIN_RESET |
+										fRTMP_ADAPTER_HALT_IN_PROGRESS |
+										fRTMP_ADAPTER_NIC_NOT_EXIST))))
+			{
+				
+				DBGPRINT_RAW(RT_DEBUG_ERROR, ("Bulk In Failed. Status=%d, BIIdx=0x%x, BIRIdx=0x%x, actual_length= 0x%x\n", 
+								Status, pAd->NextRxBulkInIndex, pAd->NextRxBulkInReadIndex, RTMP_USB_URB_LEN_GET(pRxContext->pUrb))); /*->actual_length)); */
 
-			RTMP_SET_FLAG(pAd, fRTMP_ADAPTER_BULKIN_RESET);
-			RTEnqueueInternalCmd(pAd, CMDTHREAD_RESET_BULK_IN, NULL, 0);
+				RTMP_SET_FLAG(pAd, fRTMP_ADAPTER_BULKIN_RESET);
+				RTEnqueueInternalCmd(pAd, CMDTHREAD_RESET_BULK_IN, NULL, 0);
+			}
 		}
+		
+		ASSERT((pRxContext->InUse == pRxContext->IRPPending));
 	}
-	
-	ASSERT((pRxContext->InUse == pRxContext->IRPPending));
 
 #ifdef RALINK_ATE
 	if (ATE_ON(pAd))
@@ -727,7 +765,7 @@ static void rtusb_hcca_dma_done_tasklet(unsigned long data)
 		}
 		else
 		{	pHTTXContext = &pAd->TxContext[BulkOutPipeId];
-			if ((pAd->TxSwQueue[BulkOutPipeId].Number > 0) && 
+			if ((TX_SWQ_PENDING(pAd, BulkOutPipeId) > 0) && 
 				/*((pHTTXContext->CurWritePosition > (pHTTXContext->NextBulkOutPosition + 0x6000)) || (pHTTXContext->NextBulkOutPosition > pHTTXContext->CurWritePosition + 0x6000)) && */
 				(pAd->DeQueueRunning[BulkOutPipeId] == FALSE) && 
 				(pHTTXContext->bCurWriting == FALSE))
@@ -780,7 +818,7 @@ static void rtusb_ac3_dma_done_tasklet(unsigned long data)
 		}
 		else
 		{	pHTTXContext = &pAd->TxContext[BulkOutPipeId];
-			if ((pAd->TxSwQueue[BulkOutPipeId].Number > 0) && 
+			if ((TX_SWQ_PENDING(pAd, BulkOutPipeId) > 0) && 
 				/*((pHTTXContext->CurWritePosition > (pHTTXContext->NextBulkOutPosition + 0x6000)) || (pHTTXContext->NextBulkOutPosition > pHTTXContext->CurWritePosition + 0x6000)) && */
 				(pAd->DeQueueRunning[BulkOutPipeId] == FALSE) && 
 				(pHTTXContext->bCurWriting == FALSE))
@@ -831,7 +869,7 @@ static void rtusb_ac2_dma_done_tasklet(unsigned long data)
 		}
 		else
 		{	pHTTXContext = &pAd->TxContext[BulkOutPipeId];
-			if ((pAd->TxSwQueue[BulkOutPipeId].Number > 0) && 
+			if ((TX_SWQ_PENDING(pAd, BulkOutPipeId) > 0) && 
 				/*((pHTTXContext->CurWritePosition > (pHTTXContext->NextBulkOutPosition + 0x6000)) || (pHTTXContext->NextBulkOutPosition > pHTTXContext->CurWritePosition + 0x6000)) && */
 				(pAd->DeQueueRunning[BulkOutPipeId] == FALSE) && 
 				(pHTTXContext->bCurWriting == FALSE))
@@ -878,7 +916,7 @@ static void rtusb_ac1_dma_done_tasklet(unsigned long data)
 		}
 		else
 		{	pHTTXContext = &pAd->TxContext[BulkOutPipeId];
-			if ((pAd->TxSwQueue[BulkOutPipeId].Number > 0) && 
+			if ((TX_SWQ_PENDING(pAd, BulkOutPipeId) > 0) && 
 				/*((pHTTXContext->CurWritePosition > (pHTTXContext->NextBulkOutPosition + 0x6000)) || (pHTTXContext->NextBulkOutPosition > pHTTXContext->CurWritePosition + 0x6000)) && */
 				(pAd->DeQueueRunning[BulkOutPipeId] == FALSE) && 
 				(pHTTXContext->bCurWriting == FALSE))
@@ -924,7 +962,7 @@ static void rtusb_ac0_dma_done_tasklet(unsigned long data)
 		}
 		else
 		{	pHTTXContext = &pAd->TxContext[BulkOutPipeId];
-			if ((pAd->TxSwQueue[BulkOutPipeId].Number > 0) && 
+			if ((TX_SWQ_PENDING(pAd, BulkOutPipeId) > 0) && 
 				/*  ((pHTTXContext->CurWritePosition > (pHTTXContext->NextBulkOutPosition + 0x6000)) || (pHTTXContext->NextBulkOutPosition > pHTTXContext->CurWritePosition + 0x6000)) && */
 				(pAd->DeQueueRunning[BulkOutPipeId] == FALSE) &&
 				(pHTTXContext->bCurWriting == FALSE))
@@ -1094,6 +1132,65 @@ static void rtusb_ate_ac0_dma_done_tasklet(unsigned long data)
 #endif /* RALINK_ATE */
 
 
+#ifdef RX_NAPI_SUPPORT
+/*
+========================================================================
+Routine Description:
+    NAPI poll, parse the readable bulk-in buffers within the budget.
+
+Arguments:
+	napi				- the rx napi_struct of the adapter
+	budget				- max frames to handle
+
+Return Value:
+    frames handled
+
+Note:
+	The per-adapter RxNapiBudget may be lower than the NAPI weight. When
+	it is used up we still report the full budget so the core keeps us
+	in polling mode instead of re-enabling the completion path.
+========================================================================
+*/
+static int rx_napi_poll(struct napi_struct *napi, int budget)
+{
+	POS_COOKIE		pObj = container_of(napi, struct os_cookie, rx_napi);
+	PRTMP_ADAPTER	pAd = (PRTMP_ADAPTER)pObj->rx_napi_pAd;
+	int				quota, work_done;
+
+	quota = min_t(int, budget, pAd->RxNapiBudget);
+
+	pObj->rx_napi_cpu = raw_smp_processor_id();
+	work_done = RTUSBBulkRxPoll(pAd, quota);
+	pObj->rx_napi_cpu = -1;
+
+	if (work_done >= quota)
+		return budget;
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4, 10, 0)
+	if (!napi_complete_done(napi, work_done))
+		return work_done;
+#else
+	napi_complete(napi);
+#endif
+
+	/* a bulk-in may have completed after the ring was found empty */
+	if (RTUSBBulkRxPending(pAd))
+		napi_schedule(napi);
+
+	return work_done;
+}
+
+
+VOID RtmpOsRxNapiSchedule(
+	IN RTMP_ADAPTER *pAd)
+{
+	POS_COOKIE pObj = (POS_COOKIE) pAd->OS_Cookie;
+
+	napi_schedule(&pObj->rx_napi);
+}
+#endif /* RX_NAPI_SUPPORT */
+
+
 NDIS_STATUS RtmpNetTaskInit(
 	IN RTMP_ADAPTER *pAd)
 {
@@ -1101,6 +1198,16 @@ NDIS_STATUS RtmpNetTaskInit(
 	
 	/* Create receive tasklet */
 	RTMP_OS_TASKLET_INIT(pAd, &pObj->rx_done_task, rx_done_tasklet, (unsigned long)pAd);
+#ifdef RX_NAPI_SUPPORT
+	pObj->rx_napi_pAd = pAd;
+	pObj->rx_napi_cpu = -1;
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 1, 0)
+	netif_napi_add_weight(pAd->net_dev, &pObj->rx_napi, rx_napi_poll, RX_NAPI_WEIGHT);
+#else
+	netif_napi_add(pAd->net_dev, &pObj->rx_napi, rx_napi_poll, RX_NAPI_WEIGHT);
+#endif
+	napi_enable(&pObj->rx_napi);
+#endif /* RX_NAPI_SUPPORT */
 #ifdef RLT_MAC
 	RTMP_OS_TASKLET_INIT(pAd, &pObj->cmd_rsp_event_task, cmd_rsp_event_tasklet, (unsigned long)pAd);
 #endif /* RLT_MAC */
@@ -1132,6 +1239,10 @@ void RtmpNetTaskExit(IN RTMP_ADAPTER *pAd)
 	pObj = (POS_COOKIE) pAd->OS_Cookie;
 
 	RTMP_OS_TASKLET_KILL(&pObj->rx_done_task);
+#ifdef RX_NAPI_SUPPORT
+	napi_disable(&pObj->rx_napi);
+	netif_napi_del(&pObj->rx_napi);
+#endif /* RX_NAPI_SUPPORT */
 #ifdef RLT_MAC
 	RTMP_OS_TASKLET_KILL(&pObj->cmd_rsp_event_task);
 #endif /* RLT_MAC */
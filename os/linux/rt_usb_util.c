@@ -481,6 +481,120 @@ VOID	RtmpOsUsbInitRxDesc(
 }
 
 
+#ifdef USB_BULK_OUT_SG_SUPPORT
+/*
+========================================================================
+Routine Description:
+	Check if the host controller can take a bulk-out scatter-gather list
+	whose entries are not multiples of the endpoint max packet size.
+
+Arguments:
+	pUsb_Dev		- the usb device
+
+Return Value:
+	TRUE or FALSE
+
+Note:
+========================================================================
+*/
+bool RtmpOsUsbSgSupport(
+	IN	VOID			*pUsb_Dev)
+{
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(3,15,0)
+	struct usb_device *pUsbDev = (struct usb_device *)pUsb_Dev;
+
+	if ((pUsbDev->bus->sg_tablesize > 0) && pUsbDev->bus->no_sg_constraint)
+		return TRUE;
+#endif /* LINUX_VERSION_CODE */
+
+	return FALSE;
+}
+
+
+VOID *RtmpOsUsbSgTableAlloc(
+	IN	unsigned int	NumSg)
+{
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(3,15,0)
+	struct scatterlist *pSg;
+
+	pSg = kmalloc(sizeof(struct scatterlist) * NumSg, GFP_KERNEL);
+	if (pSg)
+		sg_init_table(pSg, NumSg);
+
+	return pSg;
+#else
+	return NULL;
+#endif /* LINUX_VERSION_CODE */
+}
+
+
+VOID RtmpOsUsbSgTableFree(
+	IN	VOID			*pSgTable)
+{
+	if (pSgTable)
+		kfree(pSgTable);
+}
+
+
+/*
+========================================================================
+Routine Description:
+	Initialize a bulk-out URB which gathers its data from several buffers.
+
+Arguments:
+	pUrbSrc			- the URB
+	pUsb_Dev		- the usb device
+	BulkOutEpAddr	- bulk-out endpoint
+	pSgTable		- scatterlist of NumSg entries
+	ppBuf			- buffer of each entry, must be DMA capable
+	pLen			- length of each entry
+	NumSg			- number of entries
+	Func			- completion handler
+	pTxContext		- context of the completion handler
+
+Return Value:
+	None
+
+Note:
+	Caller has to check RtmpOsUsbSgSupport() first.
+========================================================================
+*/
+VOID RtmpOsUsbInitSgTxDesc(
+	IN	VOID			*pUrbSrc,
+	IN	VOID			*pUsb_Dev,
+	IN	unsigned int			BulkOutEpAddr,
+	IN	VOID			*pSgTable,
+	IN	unsigned char	**ppBuf,
+	IN	unsigned int	*pLen,
+	IN	unsigned int	NumSg,
+	IN	USB_COMPLETE_HANDLER	Func,
+	IN	VOID			*pTxContext)
+{
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(3,15,0)
+	PURB pUrb = (PURB)pUrbSrc;
+	struct usb_device *pUsbDev = (struct usb_device *)pUsb_Dev;
+	struct scatterlist *pSg = (struct scatterlist *)pSgTable;
+	unsigned int i, TotalLen = 0;
+
+
+	ASSERT(pUrb);
+
+	sg_init_table(pSg, NumSg);
+	for (i = 0; i < NumSg; i++)
+	{
+		sg_set_buf(&pSg[i], ppBuf[i], pLen[i]);
+		TotalLen += pLen[i];
+	}
+
+	usb_fill_bulk_urb(pUrb, pUsbDev, usb_sndbulkpipe(pUsbDev, BulkOutEpAddr),
+						NULL, TotalLen, (usb_complete_t)Func, pTxContext);
+	pUrb->sg = pSg;
+	pUrb->num_sgs = NumSg;
+#endif /* LINUX_VERSION_CODE */
+}
+#endif /* USB_BULK_OUT_SG_SUPPORT */
+
+
 VOID *RtmpOsUsbContextGet(
 	IN	VOID			*pUrb)
 {
@@ -31,6 +31,14 @@ MODULE_DESCRIPTION("RT2870 Wireless Lan Linux Driver");
 MODULE_VERSION(AP_DRIVER_VERSION);
 #endif
 
+/* 0 or out of range values fall back to the driver defaults */
+static unsigned int rx_urb_num = 0;
+static unsigned int rx_bulk_agg = 0;
+module_param(rx_urb_num, uint, 0);
+MODULE_PARM_DESC(rx_urb_num, "max bulk-in URBs in flight");
+module_param(rx_bulk_agg, uint, 0);
+MODULE_PARM_DESC(rx_bulk_agg, "bulk-in buffer size in 2KB units (4~24)");
+
 extern USB_DEVICE_ID rtusb_dev_id[];
 extern INT const rtusb_usb_id_len;
 
@@ -142,6 +150,8 @@ static bool USBDevConfigInit(
 	}
 
 	pConfig->pConfig = dev->config;
+	pConfig->RxUrbNum = rx_urb_num;
+	pConfig->RxBulkAgg = rx_bulk_agg;
 	RTMP_DRIVER_USB_CONFIG_INIT(pAd, pConfig);
 	RT28XXVendorSpecificCheck(dev, pAd);
 
@@ -274,6 +284,8 @@ static bool USBDevConfigInit(
 	}
 
 	pConfig->pConfig = &dev->config->desc;
+	pConfig->RxUrbNum = rx_urb_num;
+	pConfig->RxBulkAgg = rx_bulk_agg;
 	usb_set_intfdata(intf, pAd);
 	RTMP_DRIVER_USB_CONFIG_INIT(pAd, pConfig);
 	RT28XXVendorSpecificCheck(dev, pAd);
@@ -0,0 +1,696 @@
+#ifdef PHY_SHADOW_SUPPORT
+
+#include "rt_config.h"
+
+/*
+	BBP and RF register shadow.
+
+	A BBP or RF register access is a polled BBP_CSR_CFG / RF_CSR_CFG
+	handshake, several vendor requests each. Once a register has been
+	read or written its value is kept in pAd->BbpShadow / pAd->RfShadow:
+	reads are answered from there and writes of the value already in the
+	register are dropped. Registers the hardware changes by itself
+	(status, read-back, self-clearing triggers and the R195/R196 indirect
+	window) are listed below and always go to the hardware.
+
+	PhyShadowBbpModify() / PhyShadowRfModify() only change the shadow and
+	mark the register dirty, PhyShadowCommit() then writes all dirty
+	registers in one AndesBBPRandomWritePair() / AndesRFRandomWritePair().
+	Commit before anything whose result depends on the new values.
+
+	The MCU calibrations, power saving and an ASIC re-init change the
+	registers behind our back, the shadow is dropped for all of them.
+
+	Writers update the shadow only after their write went out, a failed
+	write drops the registers it touched. PhyShadowLock covers the shadow
+	and its bitmaps. The Andes writes do not take reg_atomic, so a read
+	only fills the shadow if PhyShadowGen shows no update since it
+	started, else a value read before a concurrent write could be stored
+	after it. Committed registers stay invalid until their write is done.
+
+	"cat /sys/kernel/debug/<if>/phy_shadow" compares every valid entry
+	with a fresh read of the hardware, MT7601_BBP_read_hw() and
+	rlt_rf_read_hw() go around the shadow.
+*/
+
+#define PHY_SHADOW_COMMIT_MAX	24	/* register pairs in one in-band packet */
+
+#define PHY_SHADOW_TEST(_Map, _Id)		(((_Map)[(_Id) >> 5] >> ((_Id) & 31)) & 1)
+#define PHY_SHADOW_SET(_Map, _Id)		((_Map)[(_Id) >> 5] |= (1 << ((_Id) & 31)))
+#define PHY_SHADOW_CLEAR(_Map, _Id)		((_Map)[(_Id) >> 5] &= ~(1 << ((_Id) & 31)))
+
+static const unsigned char BbpVolatileTable[] = {
+	BBP_R0,							/* chip version / ready */
+	BBP_R21, BBP_R22,				/* reset, continuous tx */
+	BBP_R47, BBP_R49,				/* TSSI/temperature select and read-back */
+	BBP_R50, BBP_R51, BBP_R52, BBP_R53, BBP_R54,	/* noise, the random seed */
+	BBP_R195, BBP_R196,				/* indirect register window */
+};
+
+static const BANK_RF_REG_PAIR RfVolatileTable[] = {
+	{RF_BANK0, RF_R04, 0},			/* vcocal_en clears itself */
+	{RF_BANK0, RF_R05, 0},
+};
+
+
+static VOID PhyShadowVolatileInit(
+	IN PRTMP_ADAPTER pAd)
+{
+	INT i;
+
+	NdisZeroMemory(pAd->BbpShadowVolatile, sizeof(pAd->BbpShadowVolatile));
+	NdisZeroMemory(pAd->RfShadowVolatile, sizeof(pAd->RfShadowVolatile));
+
+	for (i = 0; i < sizeof(BbpVolatileTable) / sizeof(BbpVolatileTable[0]); i++)
+		PHY_SHADOW_SET(pAd->BbpShadowVolatile, BbpVolatileTable[i]);
+
+	for (i = 0; i < sizeof(RfVolatileTable) / sizeof(RfVolatileTable[0]); i++)
+		PHY_SHADOW_SET(pAd->RfShadowVolatile[RfVolatileTable[i].Bank], RfVolatileTable[i].Register);
+}
+
+
+VOID PhyShadowReset(
+	IN PRTMP_ADAPTER pAd)
+{
+	NdisAcquireSpinLock(&pAd->PhyShadowLock);
+	NdisZeroMemory(pAd->BbpShadowValid, sizeof(pAd->BbpShadowValid));
+	NdisZeroMemory(pAd->BbpShadowDirty, sizeof(pAd->BbpShadowDirty));
+	NdisZeroMemory(pAd->RfShadowValid, sizeof(pAd->RfShadowValid));
+	NdisZeroMemory(pAd->RfShadowDirty, sizeof(pAd->RfShadowDirty));
+	pAd->PhyShadowGen++;
+	NdisReleaseSpinLock(&pAd->PhyShadowLock);
+}
+
+
+/* take before reading a register from the hardware, for PhyShadowBbpFill() / PhyShadowRfFill() */
+unsigned int PhyShadowGenGet(
+	IN PRTMP_ADAPTER pAd)
+{
+	unsigned int Gen;
+
+	NdisAcquireSpinLock(&pAd->PhyShadowLock);
+	Gen = pAd->PhyShadowGen;
+	NdisReleaseSpinLock(&pAd->PhyShadowLock);
+
+	return Gen;
+}
+
+
+bool PhyShadowBbpRead(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Id,
+	OUT unsigned char *pValue)
+{
+	bool bHit;
+
+	if (!pAd->bPhyShadow)
+		return FALSE;
+
+	NdisAcquireSpinLock(&pAd->PhyShadowLock);
+	bHit = PHY_SHADOW_TEST(pAd->BbpShadowValid, Id) ? TRUE : FALSE;
+	if (bHit)
+	{
+		*pValue = pAd->BbpShadow[Id];
+		pAd->PhyShadowHitCnt++;
+	}
+	else
+		pAd->PhyShadowMissCnt++;
+	NdisReleaseSpinLock(&pAd->PhyShadowLock);
+
+	return bHit;
+}
+
+
+/* after a read of the hardware, unless the shadow changed while reading it */
+VOID PhyShadowBbpFill(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Id,
+	IN unsigned char Value,
+	IN unsigned int Gen)
+{
+	if (!pAd->bPhyShadow || PHY_SHADOW_TEST(pAd->BbpShadowVolatile, Id))
+		return;
+
+	NdisAcquireSpinLock(&pAd->PhyShadowLock);
+	if ((pAd->PhyShadowGen == Gen) && !PHY_SHADOW_TEST(pAd->BbpShadowDirty, Id))
+	{
+		pAd->BbpShadow[Id] = Value;
+		PHY_SHADOW_SET(pAd->BbpShadowValid, Id);
+	}
+	NdisReleaseSpinLock(&pAd->PhyShadowLock);
+}
+
+
+/* TRUE if the register holds Value already and the write can be dropped */
+bool PhyShadowBbpSkip(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Id,
+	IN unsigned char Value)
+{
+	bool bSkip;
+
+	if (!pAd->bPhyShadow)
+		return FALSE;
+
+	NdisAcquireSpinLock(&pAd->PhyShadowLock);
+	bSkip = (PHY_SHADOW_TEST(pAd->BbpShadowValid, Id) &&
+			 !PHY_SHADOW_TEST(pAd->BbpShadowDirty, Id) && (pAd->BbpShadow[Id] == Value)) ? TRUE : FALSE;
+	if (bSkip)
+		pAd->PhyShadowSkipCnt++;
+	NdisReleaseSpinLock(&pAd->PhyShadowLock);
+
+	return bSkip;
+}
+
+
+/* after a write of the hardware went out, by whatever path */
+VOID PhyShadowBbpUpdate(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Id,
+	IN unsigned char Value)
+{
+	if (!pAd->bPhyShadow)
+		return;
+
+	NdisAcquireSpinLock(&pAd->PhyShadowLock);
+	PHY_SHADOW_CLEAR(pAd->BbpShadowDirty, Id);
+	if (!PHY_SHADOW_TEST(pAd->BbpShadowVolatile, Id))
+	{
+		pAd->BbpShadow[Id] = Value;
+		PHY_SHADOW_SET(pAd->BbpShadowValid, Id);
+	}
+	pAd->PhyShadowGen++;
+	NdisReleaseSpinLock(&pAd->PhyShadowLock);
+}
+
+
+/* for writes that failed or whose result is not known here */
+VOID PhyShadowBbpInvalidate(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Id)
+{
+	NdisAcquireSpinLock(&pAd->PhyShadowLock);
+	PHY_SHADOW_CLEAR(pAd->BbpShadowValid, Id);
+	PHY_SHADOW_CLEAR(pAd->BbpShadowDirty, Id);
+	/* also fences reads that started before the write */
+	pAd->PhyShadowGen++;
+	NdisReleaseSpinLock(&pAd->PhyShadowLock);
+}
+
+
+/*
+	Change the bits of Mask to Bits in the shadow only, the register is
+	written by the next PhyShadowCommit(). Volatile registers are written
+	through, after the pending ones so the order is kept. So is a register
+	whose first read raced a write, its value is not known then.
+*/
+NDIS_STATUS PhyShadowBbpModify(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Id,
+	IN unsigned char Mask,
+	IN unsigned char Bits)
+{
+	unsigned char Value = 0, Old;
+
+	if (!pAd->bPhyShadow || PHY_SHADOW_TEST(pAd->BbpShadowVolatile, Id))
+	{
+		PhyShadowCommit(pAd);
+		RTMP_BBP_IO_READ8_BY_REG_ID(pAd, Id, &Value);
+		return RTMP_BBP_IO_WRITE8_BY_REG_ID(pAd, Id, (Value & ~Mask) | (Bits & Mask));
+	}
+
+	/* fills the shadow */
+	if (RTMP_BBP_IO_READ8_BY_REG_ID(pAd, Id, &Value) != NDIS_STATUS_SUCCESS)
+		return STATUS_UNSUCCESSFUL;
+
+	NdisAcquireSpinLock(&pAd->PhyShadowLock);
+	if (!PHY_SHADOW_TEST(pAd->BbpShadowValid, Id))
+	{
+		NdisReleaseSpinLock(&pAd->PhyShadowLock);
+		PhyShadowCommit(pAd);
+		return RTMP_BBP_IO_WRITE8_BY_REG_ID(pAd, Id, (Value & ~Mask) | (Bits & Mask));
+	}
+
+	Old = pAd->BbpShadow[Id];
+	Value = (Old & ~Mask) | (Bits & Mask);
+	if ((Value == Old) && !PHY_SHADOW_TEST(pAd->BbpShadowDirty, Id))
+		pAd->PhyShadowSkipCnt++;
+	else
+	{
+		pAd->BbpShadow[Id] = Value;
+		PHY_SHADOW_SET(pAd->BbpShadowDirty, Id);
+		pAd->PhyShadowGen++;
+	}
+	NdisReleaseSpinLock(&pAd->PhyShadowLock);
+
+	return NDIS_STATUS_SUCCESS;
+}
+
+
+#ifdef RLT_RF
+#define PHY_SHADOW_RF_VALID(_Bank, _Id)	\
+			(((_Bank) < PHY_SHADOW_RF_BANK_NUM) && ((_Id) < PHY_SHADOW_RF_NUM))
+
+bool PhyShadowRfRead(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Bank,
+	IN unsigned char Id,
+	OUT unsigned char *pValue)
+{
+	bool bHit;
+
+	if (!pAd->bPhyShadow || !PHY_SHADOW_RF_VALID(Bank, Id))
+		return FALSE;
+
+	NdisAcquireSpinLock(&pAd->PhyShadowLock);
+	bHit = PHY_SHADOW_TEST(pAd->RfShadowValid[Bank], Id) ? TRUE : FALSE;
+	if (bHit)
+	{
+		*pValue = pAd->RfShadow[Bank][Id];
+		pAd->PhyShadowHitCnt++;
+	}
+	else
+		pAd->PhyShadowMissCnt++;
+	NdisReleaseSpinLock(&pAd->PhyShadowLock);
+
+	return bHit;
+}
+
+
+VOID PhyShadowRfFill(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Bank,
+	IN unsigned char Id,
+	IN unsigned char Value,
+	IN unsigned int Gen)
+{
+	if (!pAd->bPhyShadow || !PHY_SHADOW_RF_VALID(Bank, Id) ||
+		PHY_SHADOW_TEST(pAd->RfShadowVolatile[Bank], Id))
+		return;
+
+	NdisAcquireSpinLock(&pAd->PhyShadowLock);
+	if ((pAd->PhyShadowGen == Gen) && !PHY_SHADOW_TEST(pAd->RfShadowDirty[Bank], Id))
+	{
+		pAd->RfShadow[Bank][Id] = Value;
+		PHY_SHADOW_SET(pAd->RfShadowValid[Bank], Id);
+	}
+	NdisReleaseSpinLock(&pAd->PhyShadowLock);
+}
+
+
+bool PhyShadowRfSkip(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Bank,
+	IN unsigned char Id,
+	IN unsigned char Value)
+{
+	bool bSkip;
+
+	if (!pAd->bPhyShadow || !PHY_SHADOW_RF_VALID(Bank, Id))
+		return FALSE;
+
+	NdisAcquireSpinLock(&pAd->PhyShadowLock);
+	bSkip = (PHY_SHADOW_TEST(pAd->RfShadowValid[Bank], Id) &&
+			 !PHY_SHADOW_TEST(pAd->RfShadowDirty[Bank], Id) && (pAd->RfShadow[Bank][Id] == Value)) ? TRUE : FALSE;
+	if (bSkip)
+		pAd->PhyShadowSkipCnt++;
+	NdisReleaseSpinLock(&pAd->PhyShadowLock);
+
+	return bSkip;
+}
+
+
+VOID PhyShadowRfUpdate(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Bank,
+	IN unsigned char Id,
+	IN unsigned char Value)
+{
+	if (!pAd->bPhyShadow || !PHY_SHADOW_RF_VALID(Bank, Id))
+		return;
+
+	NdisAcquireSpinLock(&pAd->PhyShadowLock);
+	PHY_SHADOW_CLEAR(pAd->RfShadowDirty[Bank], Id);
+	if (!PHY_SHADOW_TEST(pAd->RfShadowVolatile[Bank], Id))
+	{
+		pAd->RfShadow[Bank][Id] = Value;
+		PHY_SHADOW_SET(pAd->RfShadowValid[Bank], Id);
+	}
+	pAd->PhyShadowGen++;
+	NdisReleaseSpinLock(&pAd->PhyShadowLock);
+}
+
+
+/* for writes that failed or whose result is not known here, e.g. AndesRFReadModifyWrite() */
+VOID PhyShadowRfInvalidate(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Bank,
+	IN unsigned char Id)
+{
+	if (!PHY_SHADOW_RF_VALID(Bank, Id))
+		return;
+
+	NdisAcquireSpinLock(&pAd->PhyShadowLock);
+	PHY_SHADOW_CLEAR(pAd->RfShadowValid[Bank], Id);
+	PHY_SHADOW_CLEAR(pAd->RfShadowDirty[Bank], Id);
+	pAd->PhyShadowGen++;
+	NdisReleaseSpinLock(&pAd->PhyShadowLock);
+}
+
+
+/* see PhyShadowBbpModify() */
+NDIS_STATUS PhyShadowRfModify(
+	IN PRTMP_ADAPTER pAd,
+	IN unsigned char Bank,
+	IN unsigned char Id,
+	IN unsigned char Mask,
+	IN unsigned char Bits)
+{
+	unsigned char Value = 0, Old;
+
+	if (!pAd->bPhyShadow || !PHY_SHADOW_RF_VALID(Bank, Id) ||
+		PHY_SHADOW_TEST(pAd->RfShadowVolatile[Bank], Id))
+	{
+		PhyShadowCommit(pAd);
+		rlt_rf_read(pAd, Bank, Id, &Value);
+		return rlt_rf_write(pAd, Bank, Id, (Value & ~Mask) | (Bits & Mask));
+	}
+
+	/* fills the shadow */
+	if (rlt_rf_read(pAd, Bank, Id, &Value) != NDIS_STATUS_SUCCESS)
+		return STATUS_UNSUCCESSFUL;
+
+	NdisAcquireSpinLock(&pAd->PhyShadowLock);
+	if (!PHY_SHADOW_TEST(pAd->RfShadowValid[Bank], Id))
+	{
+		NdisReleaseSpinLock(&pAd->PhyShadowLock);
+		PhyShadowCommit(pAd);
+		return rlt_rf_write(pAd, Bank, Id, (Value & ~Mask) | (Bits & Mask));
+	}
+
+	Old = pAd->RfShadow[Bank][Id];
+	Value = (Old & ~Mask) | (Bits & Mask);
+	if ((Value == Old) && !PHY_SHADOW_TEST(pAd->RfShadowDirty[Bank], Id))
+		pAd->PhyShadowSkipCnt++;
+	else
+	{
+		pAd->RfShadow[Bank][Id] = Value;
+		PHY_SHADOW_SET(pAd->RfShadowDirty[Bank], Id);
+		pAd->PhyShadowGen++;
+	}
+	NdisReleaseSpinLock(&pAd->PhyShadowLock);
+
+	return NDIS_STATUS_SUCCESS;
+}
+
+
+/*
+	Take up to PHY_SHADOW_COMMIT_MAX dirty registers off the shadow. They
+	are not valid until their write went out and updates the shadow, so a
+	failed write leaves nothing behind that would skip a later one.
+*/
+static unsigned int PhyShadowRfCollect(
+	IN PRTMP_ADAPTER pAd,
+	OUT BANK_RF_REG_PAIR *pPair)
+{
+	unsigned int Num = 0, Bank, Id;
+
+	NdisAcquireSpinLock(&pAd->PhyShadowLock);
+
+	for (Bank = 0; (Bank < PHY_SHADOW_RF_BANK_NUM) && (Num < PHY_SHADOW_COMMIT_MAX); Bank++)
+	{
+		for (Id = 0; (Id < PHY_SHADOW_RF_NUM) && (Num < PHY_SHADOW_COMMIT_MAX); Id++)
+		{
+			if (pAd->RfShadowDirty[Bank][Id >> 5] == 0)
+			{
+				Id |= 31;
+				continue;
+			}
+
+			if (!PHY_SHADOW_TEST(pAd->RfShadowDirty[Bank], Id))
+				continue;
+
+			PHY_SHADOW_CLEAR(pAd->RfShadowDirty[Bank], Id);
+			PHY_SHADOW_CLEAR(pAd->RfShadowValid[Bank], Id);
+
+			pPair[Num].Bank = Bank;
+			pPair[Num].Register = Id;
+			pPair[Num].Value = pAd->RfShadow[Bank][Id];
+			Num++;
+		}
+	}
+
+	if (Num > 0)
+		pAd->PhyShadowGen++;
+
+	NdisReleaseSpinLock(&pAd->PhyShadowLock);
+
+	return Num;
+}
+
+
+static VOID PhyShadowRfCommit(
+	IN PRTMP_ADAPTER pAd,
+	IN bool bInBand)
+{
+	BANK_RF_REG_PAIR Pair[PHY_SHADOW_COMMIT_MAX];
+	unsigned int Num, i;
+
+	while ((Num = PhyShadowRfCollect(pAd, Pair)) > 0)
+	{
+		if (!bInBand)
+		{
+			for (i = 0; i < Num; i++)
+				rlt_rf_write(pAd, Pair[i].Bank, Pair[i].Register, Pair[i].Value);
+			continue;
+		}
+
+		AndesRFRandomWritePair(pAd, Pair, Num);
+		pAd->PhyShadowCommitCnt++;
+	}
+}
+#endif /* RLT_RF */
+
+
+/* see PhyShadowRfCollect() */
+static unsigned int PhyShadowBbpCollect(
+	IN PRTMP_ADAPTER pAd,
+	OUT RTMP_REG_PAIR *pPair)
+{
+	unsigned int Num = 0, Id;
+
+	NdisAcquireSpinLock(&pAd->PhyShadowLock);
+
+	for (Id = 0; (Id < PHY_SHADOW_BBP_NUM) && (Num < PHY_SHADOW_COMMIT_MAX); Id++)
+	{
+		if (pAd->BbpShadowDirty[Id >> 5] == 0)
+		{
+			Id |= 31;
+			continue;
+		}
+
+		if (!PHY_SHADOW_TEST(pAd->BbpShadowDirty, Id))
+			continue;
+
+		PHY_SHADOW_CLEAR(pAd->BbpShadowDirty, Id);
+		PHY_SHADOW_CLEAR(pAd->BbpShadowValid, Id);
+
+		pPair[Num].Register = Id;
+		pPair[Num].Value = pAd->BbpShadow[Id];
+		Num++;
+	}
+
+	if (Num > 0)
+		pAd->PhyShadowGen++;
+
+	NdisReleaseSpinLock(&pAd->PhyShadowLock);
+
+	return Num;
+}
+
+
+static VOID PhyShadowBbpCommit(
+	IN PRTMP_ADAPTER pAd,
+	IN bool bInBand)
+{
+	RTMP_REG_PAIR Pair[PHY_SHADOW_COMMIT_MAX];
+	unsigned int Num, i;
+
+	while ((Num = PhyShadowBbpCollect(pAd, Pair)) > 0)
+	{
+		if (!bInBand)
+		{
+			for (i = 0; i < Num; i++)
+				RTMP_BBP_IO_WRITE8_BY_REG_ID(pAd, (unsigned char)Pair[i].Register, (unsigned char)Pair[i].Value);
+			continue;
+		}
+
+		AndesBBPRandomWritePair(pAd, Pair, Num);
+		pAd->PhyShadowCommitCnt++;
+	}
+}
+
+
+/* write every dirty register, BBP first, each in ascending register order */
+VOID PhyShadowCommit(
+	IN PRTMP_ADAPTER pAd)
+{
+	bool bInBand = RTMP_TEST_FLAG(pAd, fRTMP_ADAPTER_MCU_SEND_IN_BAND_CMD) ? TRUE : FALSE;
+
+	if (!pAd->bPhyShadow)
+		return;
+
+	PhyShadowBbpCommit(pAd, bInBand);
+#ifdef RLT_RF
+	PhyShadowRfCommit(pAd, bInBand);
+#endif /* RLT_RF */
+}
+
+
+static INT PhyShadowDebugfsShow(
+	IN VOID *pSeq,
+	IN VOID *pData)
+{
+	PRTMP_ADAPTER pAd = (PRTMP_ADAPTER)pData;
+	unsigned char Value, Shadow;
+	bool bValid, bDirty;
+	INT Id;
+#ifdef RLT_RF
+	INT Bank;
+#endif /* RLT_RF */
+
+	RtmpOsSeqPrintf(pSeq, "PhyShadow=%d, Hit=%ld, Miss=%ld, SkippedWrites=%ld, Commits=%ld\n",
+					pAd->bPhyShadow, pAd->PhyShadowHitCnt, pAd->PhyShadowMissCnt,
+					pAd->PhyShadowSkipCnt, pAd->PhyShadowCommitCnt);
+	RtmpOsSeqPrintf(pSeq, "register   shadow  hw\n");
+
+	/* the *_hw reads go to the hardware and leave the shadow alone */
+	for (Id = 0; Id < PHY_SHADOW_BBP_NUM; Id++)
+	{
+		NdisAcquireSpinLock(&pAd->PhyShadowLock);
+		bValid = PHY_SHADOW_TEST(pAd->BbpShadowValid, Id);
+		bDirty = PHY_SHADOW_TEST(pAd->BbpShadowDirty, Id);
+		Shadow = pAd->BbpShadow[Id];
+		NdisReleaseSpinLock(&pAd->PhyShadowLock);
+
+		if (!bValid)
+			continue;
+
+		if (MT7601_BBP_read_hw(pAd, Id, &Value) != NDIS_STATUS_SUCCESS)
+		{
+			RtmpOsSeqPrintf(pSeq, "BBP R%-3d   0x%02x    --\n", Id, Shadow);
+			continue;
+		}
+
+		RtmpOsSeqPrintf(pSeq, "BBP R%-3d   0x%02x    0x%02x%s\n", Id, Shadow, Value,
+						bDirty ? " dirty" : ((Value != Shadow) ? " MISMATCH" : ""));
+	}
+
+#ifdef RLT_RF
+	for (Bank = 0; Bank < PHY_SHADOW_RF_BANK_NUM; Bank++)
+	{
+		for (Id = 0; Id < PHY_SHADOW_RF_NUM; Id++)
+		{
+			NdisAcquireSpinLock(&pAd->PhyShadowLock);
+			bValid = PHY_SHADOW_TEST(pAd->RfShadowValid[Bank], Id);
+			bDirty = PHY_SHADOW_TEST(pAd->RfShadowDirty[Bank], Id);
+			Shadow = pAd->RfShadow[Bank][Id];
+			NdisReleaseSpinLock(&pAd->PhyShadowLock);
+
+			if (!bValid)
+				continue;
+
+			if (rlt_rf_read_hw(pAd, Bank, Id, &Value) != NDIS_STATUS_SUCCESS)
+			{
+				RtmpOsSeqPrintf(pSeq, "RF B%d R%-2d  0x%02x    --\n", Bank, Id, Shadow);
+				continue;
+			}
+
+			RtmpOsSeqPrintf(pSeq, "RF B%d R%-2d  0x%02x    0x%02x%s\n", Bank, Id, Shadow, Value,
+							bDirty ? " dirty" : ((Value != Shadow) ? " MISMATCH" : ""));
+		}
+	}
+#endif /* RLT_RF */
+
+	return 0;
+}
+
+
+/* called once pAd->pDebugfsDir exists, on the first open */
+VOID PhyShadowDebugfsInit(
+	IN PRTMP_ADAPTER pAd)
+{
+	if (pAd->pDebugfsDir == NULL)
+		return;
+
+	if (!RtmpOsDebugfsFileCreate(pAd->pDebugfsDir, "phy_shadow", PhyShadowDebugfsShow, pAd))
+		DBGPRINT(RT_DEBUG_ERROR, ("PhyShadowDebugfsInit::no phy_shadow file\n"));
+}
+
+
+VOID PhyShadowInit(
+	IN PRTMP_ADAPTER pAd)
+{
+	NdisAllocateSpinLock(pAd, &pAd->PhyShadowLock);
+	pAd->PhyShadowGen = 0;
+	PhyShadowVolatileInit(pAd);
+	PhyShadowReset(pAd);
+	pAd->bPhyShadow = TRUE;
+}
+
+
+VOID PhyShadowExit(
+	IN PRTMP_ADAPTER pAd)
+{
+	pAd->bPhyShadow = FALSE;
+	NdisFreeSpinLock(&pAd->PhyShadowLock);
+}
+
+
+INT Set_PhyShadow_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	PhyShadowCommit(pAd);
+	PhyShadowReset(pAd);
+	pAd->bPhyShadow = (simple_strtol(arg, 0, 10) != 0);
+
+	pAd->PhyShadowHitCnt = 0;
+	pAd->PhyShadowMissCnt = 0;
+	pAd->PhyShadowSkipCnt = 0;
+	pAd->PhyShadowCommitCnt = 0;
+
+	DBGPRINT(RT_DEBUG_TRACE, ("Set_PhyShadow_Proc::(PhyShadow=%d)\n", pAd->bPhyShadow));
+
+	return TRUE;
+}
+
+
+INT Show_PhyShadow_Proc(
+	IN PRTMP_ADAPTER pAd,
+	IN char * arg)
+{
+	INT Id, BbpValid = 0, RfValid = 0;
+#ifdef RLT_RF
+	INT Bank;
+
+	for (Bank = 0; Bank < PHY_SHADOW_RF_BANK_NUM; Bank++)
+	{
+		for (Id = 0; Id < PHY_SHADOW_RF_NUM; Id++)
+			RfValid += PHY_SHADOW_TEST(pAd->RfShadowValid[Bank], Id);
+	}
+#endif /* RLT_RF */
+
+	for (Id = 0; Id < PHY_SHADOW_BBP_NUM; Id++)
+		BbpValid += PHY_SHADOW_TEST(pAd->BbpShadowValid, Id);
+
+	DBGPRINT(RT_DEBUG_OFF, ("PhyShadow=%d, valid BBP=%d, RF=%d\n", pAd->bPhyShadow, BbpValid, RfValid));
+	DBGPRINT(RT_DEBUG_OFF, ("Hit=%ld, Miss=%ld, SkippedWrites=%ld, Commits=%ld\n",
+				pAd->PhyShadowHitCnt, pAd->PhyShadowMissCnt,
+				pAd->PhyShadowSkipCnt, pAd->PhyShadowCommitCnt));
+
+	return TRUE;
+}
+
+#endif /* PHY_SHADOW_SUPPORT */
+
@@ -28,6 +28,11 @@ NDIS_STATUS rlt_rf_write(
 		return STATUS_UNSUCCESSFUL;
 	}
 
+#ifdef PHY_SHADOW_SUPPORT
+	if (PhyShadowRfSkip(pAd, bank, regID, value))
+		return NDIS_STATUS_SUCCESS;
+#endif /* PHY_SHADOW_SUPPORT */
+
 #ifdef RTMP_MAC_USB
 	if (IS_USB_INF(pAd)) {
 		RTMP_SEM_EVENT_WAIT(&pAd->reg_atomic, ret);
@@ -66,6 +71,10 @@ NDIS_STATUS rlt_rf_write(
 	rfcsr.field.RF_CSR_DATA = value;
 	RTMP_IO_WRITE32(pAd, RF_CSR_CFG, rfcsr.word);
 
+#ifdef PHY_SHADOW_SUPPORT
+	PhyShadowRfUpdate(pAd, bank, regID, value);
+#endif /* PHY_SHADOW_SUPPORT */
+
 	ret = NDIS_STATUS_SUCCESS;
 done:
 
@@ -95,7 +104,33 @@ done:
 	
 	========================================================================
 */
+#ifdef PHY_SHADOW_SUPPORT
+NDIS_STATUS rlt_rf_read(
+	IN RTMP_ADAPTER *pAd,
+	IN unsigned char bank,
+	IN unsigned char regID,
+	IN unsigned char *pValue)
+{
+	unsigned int Gen;
+	NDIS_STATUS ret;
+
+	if ((pAd->WlanFunCtrl.field.WLAN_EN != 0) && PhyShadowRfRead(pAd, bank, regID, pValue))
+		return NDIS_STATUS_SUCCESS;
+
+	Gen = PhyShadowGenGet(pAd);
+	ret = rlt_rf_read_hw(pAd, bank, regID, pValue);
+	if (ret == STATUS_SUCCESS)
+		PhyShadowRfFill(pAd, bank, regID, *pValue, Gen);
+
+	return ret;
+}
+
+
+/* the hardware itself, the shadow is left alone */
+NDIS_STATUS rlt_rf_read_hw(
+#else
 NDIS_STATUS rlt_rf_read(
+#endif /* PHY_SHADOW_SUPPORT */
 	IN RTMP_ADAPTER *pAd,
 	IN unsigned char bank,
 	IN unsigned char regID,
@@ -485,6 +485,11 @@ NDIS_STATUS MT7601_BBP_write(
 		return STATUS_UNSUCCESSFUL;
 	}
 
+#ifdef PHY_SHADOW_SUPPORT
+	if (PhyShadowBbpSkip(pAd, regID, value))
+		return NDIS_STATUS_SUCCESS;
+#endif /* PHY_SHADOW_SUPPORT */
+
 #ifdef RTMP_MAC_USB
 	if (IS_USB_INF(pAd)) {
 		RTMP_SEM_EVENT_WAIT(&pAd->reg_atomic, ret);
@@ -524,6 +529,10 @@ NDIS_STATUS MT7601_BBP_write(
 
 	RTMP_IO_WRITE32(pAd, BBP_CSR_CFG, BbpCsr.word);
 
+#ifdef PHY_SHADOW_SUPPORT
+	PhyShadowBbpUpdate(pAd, regID, value);
+#endif /* PHY_SHADOW_SUPPORT */
+
 	ret = NDIS_STATUS_SUCCESS;
 done:
 
@@ -538,7 +547,32 @@ done:
 }
 
 
+#ifdef PHY_SHADOW_SUPPORT
+NDIS_STATUS MT7601_BBP_read(
+	IN RTMP_ADAPTER *pAd,
+	IN unsigned char regID,
+	IN unsigned char *pValue)
+{
+	unsigned int Gen;
+	NDIS_STATUS ret;
+
+	if ((pAd->WlanFunCtrl.field.WLAN_EN != 0) && PhyShadowBbpRead(pAd, regID, pValue))
+		return NDIS_STATUS_SUCCESS;
+
+	Gen = PhyShadowGenGet(pAd);
+	ret = MT7601_BBP_read_hw(pAd, regID, pValue);
+	if (ret == STATUS_SUCCESS)
+		PhyShadowBbpFill(pAd, regID, *pValue, Gen);
+
+	return ret;
+}
+
+
+/* the hardware itself, the shadow is left alone */
+NDIS_STATUS MT7601_BBP_read_hw(
+#else
 NDIS_STATUS MT7601_BBP_read(
+#endif /* PHY_SHADOW_SUPPORT */
 	IN RTMP_ADAPTER *pAd,
 	IN unsigned char regID,
 	IN unsigned char *pValue)
@@ -0,0 +1,56 @@
+#!/bin/sh
+#
+# Compare two interface up profiles of a BOOT_PROF_SUPPORT build.
+#
+# Save one after each "ifconfig ra0 up":
+#	cat /sys/kernel/debug/ra0/boot_prof > before.txt
+#	...
+#	cat /sys/kernel/debug/ra0/boot_prof > after.txt
+#	./bootprof_diff.sh before.txt after.txt
+#
+# Prints the time and the USB control transfers of every stage in both
+# runs and the change from the first to the second. Steps within a stage
+# (names starting with ".") are listed but not added to the total.
+
+if [ $# -ne 2 ]; then
+	echo "usage: $0 <before> <after>" >&2
+	exit 1
+fi
+
+for f in "$1" "$2"; do
+	if [ ! -r "$f" ]; then
+		echo "$0: cannot read $f" >&2
+		exit 1
+	fi
+done
+
+awk '
+	/^#/ { next }
+	NF != 4 { next }
+	FNR == NR {
+		if (!($1 in seen)) { order[n++] = $1; seen[$1] = 1 }
+		us0[$1] = $3; xf0[$1] = $4
+		next
+	}
+	{
+		if (!($1 in seen)) { order[n++] = $1; seen[$1] = 1 }
+		us1[$1] = $3; xf1[$1] = $4
+	}
+	function val(v) { return (v == "" || v == "-") ? "-" : v }
+	function diff(a, b) { return (val(a) == "-" || val(b) == "-") ? "-" : sprintf("%+d", b - a) }
+	END {
+		printf("%-12s %10s %10s %10s   %8s %8s %8s\n",
+			"stage", "before_us", "after_us", "delta_us", "xfer_b", "xfer_a", "delta")
+		for (i = 0; i < n; i++) {
+			s = order[i]
+			printf("%-12s %10s %10s %10s   %8s %8s %8s\n", s,
+				val(us0[s]), val(us1[s]), diff(us0[s], us1[s]),
+				val(xf0[s]), val(xf1[s]), diff(xf0[s], xf1[s]))
+			if (s ~ /^\./) continue
+			if (val(us0[s]) != "-") { t0 += us0[s]; x0 += xf0[s] }
+			if (val(us1[s]) != "-") { t1 += us1[s]; x1 += xf1[s] }
+		}
+		printf("%-12s %10d %10d %10s   %8d %8d %8s\n", "total",
+			t0, t1, sprintf("%+d", t1 - t0), x0, x1, sprintf("%+d", x1 - x0))
+	}
+' "$1" "$2"